@@ -1,7 +1,48 @@
 #version 330 core
 out vec4 FragColor;
 in vec3 ourColor;
+#ifdef TEXTURED
+in vec3 materialCoord;
+uniform sampler2DArray materials;
+#endif
+#ifdef VIRTUAL_TEXTURE
+// Paging of the sparse material array (virtual_texture.h). Only the resident pages of the levels below
+// pagedLevels may be sampled; the residency texture holds, per finest-level page, the finest such level.
+uniform usampler2DArray residency;
+uniform vec2 pageSize;  // Page size in texels, the same at every level.
+uniform int pagedLevels;
+uniform int lodShift;   // log2 of the downscale of the feedback target in the feedback pass, else 0.
+
+// Mipmap level the texture unit picks for a coordinate in texels, from its screen-space derivatives.
+float virtualLod(vec2 texel)
+{
+    vec2 dx = dFdx(texel);
+    vec2 dy = dFdy(texel);
+    return 0.5 * log2(max(max(dot(dx, dx), dot(dy, dy)), 1e-8)) - float(lodShift);
+}
+#endif
 void main()
 {
+#if defined(VIRTUAL_TEXTURE_FEEDBACK)
+    // The page this pixel samples, as x, y, level and layer + 1; zero if it only needs the pinned levels
+    int level = int(max(virtualLod(materialCoord.xy * vec2(textureSize(materials, 0).xy)), 0.0));
+    if (level >= pagedLevels)
+    {
+        FragColor = vec4(0.0);
+        return;
+    }
+    vec2 page = floor(fract(materialCoord.xy) * vec2(textureSize(materials, level).xy) / pageSize);
+    FragColor = vec4(page, float(level), materialCoord.z + 1.0) / 255.0;
+#elif defined(VIRTUAL_TEXTURE)
+    // Never below the finest resident level, so missing pages show blurred instead of undefined
+    vec2 size = vec2(textureSize(materials, 0).xy);
+    float lod = virtualLod(materialCoord.xy * size);
+    ivec2 page = ivec2(fract(materialCoord.xy) * size / pageSize);
+    float finest = float(texelFetch(residency, ivec3(page, int(materialCoord.z)), 0).r);
+    FragColor = vec4(ourColor * textureLod(materials, materialCoord, max(lod, finest)).rgb, 1.0);
+#elif defined(TEXTURED)
+    FragColor = vec4(ourColor * texture(materials, materialCoord).rgb, 1.0);
+#else
     FragColor = vec4(ourColor, 1.0);
+#endif
 }
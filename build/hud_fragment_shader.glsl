@@ -0,0 +1,14 @@
+#version 330 core
+out vec4 FragColor;
+in vec2 glyphPosition;
+flat in int glyph;
+in vec4 color;
+uniform sampler2D font; // All glyph cells side by side, one byte per pixel.
+void main()
+{
+    // texelFetch reads the font pixel exactly, so the text stays sharp at any scale.
+    ivec2 texel = ivec2(glyph * 6 + min(int(glyphPosition.x), 5), min(int(glyphPosition.y), 7));
+    if (texelFetch(font, texel, 0).r < 0.5)
+        discard;
+    FragColor = color;
+}
@@ -0,0 +1,28 @@
+// Specifies the version of GLSL to use. "330 core" means version 3.3 in core profile.
+#version 330 core
+
+// Per-instance attributes: one instance is one character (or panel) of the overlay.
+layout (location = 0) in vec4 aRect;  // x, y, width, height in pixels, origin at the top left.
+layout (location = 1) in float aGlyph; // Glyph index in the font texture.
+layout (location = 2) in vec4 aColor;  // Color and opacity.
+
+uniform vec2 screenSize; // Framebuffer size in pixels.
+
+out vec2 glyphPosition;  // Position inside the glyph cell, in font pixels.
+flat out int glyph;
+out vec4 color;
+
+void main()
+{
+    // The quad is drawn as a triangle strip of four vertices without a vertex buffer:
+    // vertex 0 is the top left corner, 1 top right, 2 bottom left, 3 bottom right.
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1);
+    vec2 pixel = aRect.xy + corner * aRect.zw;
+
+    // Pixels to normalized device coordinates; y points down on screen.
+    gl_Position = vec4(pixel.x / screenSize.x * 2.0 - 1.0, 1.0 - pixel.y / screenSize.y * 2.0, 0.0, 1.0);
+
+    glyphPosition = corner * vec2(6.0, 8.0); // A glyph cell is 6x8 font pixels.
+    glyph = int(aGlyph);
+    color = aColor;
+}
@@ -0,0 +1,15 @@
+// Specifies the version of GLSL to use. "330 core" means version 3.3 in core profile.
+#version 330 core
+in vec3 ourColor;
+in vec2 atlasCoord;
+uniform sampler2D impostorAtlas; // Baked white pyramids on a transparent background.
+out vec4 FragColor;
+
+void main()
+{
+    // The mipmaps mixed the transparent black background into the edges; dividing by alpha removes it again
+    vec4 texel = texture(impostorAtlas, atlasCoord);
+    if (texel.a < 0.5)
+        discard;
+    FragColor = vec4(ourColor * texel.rgb / texel.a, 1.0);
+}
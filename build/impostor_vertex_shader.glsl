@@ -0,0 +1,55 @@
+// Specifies the version of GLSL to use. "330 core" means version 3.3 in core profile.
+#version 330 core
+// Draws the distant pyramids of the field (pyramid_field.h) as camera-facing quads textured from their
+// octahedral impostor atlas (impostor.h). Instance i is pyramid firstRecord + i; its four strip vertices are
+// the corners of the quad. Pyramids near enough for geometry are collapsed out of the view volume.
+
+// One RGBA32UI texel per pyramid: the center as float bits, then r | g << 8 | b << 16 | scale << 24.
+uniform usamplerBuffer points;
+uniform mat4 viewProjection; // Projection * view matrix of the camera.
+uniform vec4 impostorCamera; // xyz: camera position. w: a pyramid of scale s farther than s * w is an impostor.
+uniform int firstRecord;     // Record of instance 0.
+uniform vec2 impostorGrid;   // x: cells per atlas side. y: bounding sphere radius of a pyramid of scale 1.
+
+out vec3 ourColor;   // Tint of the atlas image.
+out vec2 atlasCoord; // Position in the atlas.
+
+// Atlas coordinates of a unit direction, as octahedralEncode in impostor.cpp.
+vec2 octahedralEncode(vec3 direction)
+{
+    vec3 d = direction / (abs(direction.x) + abs(direction.y) + abs(direction.z));
+    vec2 p = d.xz;
+    if (d.y < 0.0)
+        p = (1.0 - abs(d.zx)) * vec2(d.x >= 0.0 ? 1.0 : -1.0, d.z >= 0.0 ? 1.0 : -1.0);
+    return p * 0.5 + 0.5;
+}
+
+void main()
+{
+    uvec4 record = texelFetch(points, firstRecord + gl_InstanceID);
+    vec3 center = uintBitsToFloat(record.xyz);
+    float scale = float(record.w >> 24) / 64.0;
+    vec3 toCamera = impostorCamera.xyz - center;
+    if (!(length(impostorCamera.xyz - center) > scale * impostorCamera.w))
+    {
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0); // Drawn as geometry: the quad is dropped
+        ourColor = vec3(0.0);
+        atlasCoord = vec2(0.0);
+        return;
+    }
+
+    // Quad axes as impostorBasis in impostor.cpp, so the baked image lines up with the quad
+    vec3 direction = normalize(toCamera);
+    vec3 right = cross(vec3(0.0, 1.0, 0.0), direction);
+    right = length(right) > 1e-4 ? normalize(right) : vec3(1.0, 0.0, 0.0);
+    vec3 up = cross(direction, right);
+
+    vec2 corner = vec2(gl_VertexID & 1, gl_VertexID >> 1) * 2.0 - 1.0; // (-1, -1), (1, -1), (-1, 1), (1, 1)
+    float halfSize = impostorGrid.y * scale;
+    gl_Position = viewProjection * vec4(center + (right * corner.x + up * corner.y) * halfSize, 1.0);
+
+    // The cell baked from the direction nearest to the camera's
+    vec2 cell = clamp(floor(octahedralEncode(direction) * impostorGrid.x), 0.0, impostorGrid.x - 1.0);
+    atlasCoord = (cell + corner * 0.5 + 0.5) / impostorGrid.x;
+    ourColor = vec3(record.w & 255u, (record.w >> 8) & 255u, (record.w >> 16) & 255u) / 255.0;
+}
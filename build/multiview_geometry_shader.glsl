@@ -0,0 +1,25 @@
+// Specifies the version of GLSL to use. "330 core" means version 3.3 in core profile.
+#version 330 core
+// The application inserts "#extension GL_ARB_viewport_array : require" after the version directive.
+
+// Pass-through geometry shader whose only job is to write gl_ViewportIndex for drivers
+// that cannot set it from the vertex shader.
+layout (triangles) in;
+layout (triangle_strip, max_vertices = 3) out;
+
+in vec3 vertexColor[]; // Colors from the vertex shader.
+flat in int viewIndex[]; // View of the primitive, identical for its three vertices.
+
+out vec3 ourColor; // Color passed to the fragment shader.
+
+void main()
+{
+    for (int i = 0; i < 3; ++i)
+    {
+        gl_ViewportIndex = viewIndex[0];
+        gl_Position = gl_in[i].gl_Position;
+        ourColor = vertexColor[i];
+        EmitVertex();
+    }
+    EndPrimitive();
+}
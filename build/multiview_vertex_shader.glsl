@@ -0,0 +1,45 @@
+// Specifies the version of GLSL to use. "330 core" means version 3.3 in core profile.
+#version 330 core
+// The application inserts MAX_VIEWS, MAX_OBJECTS and optionally VIEWPORT_FROM_VERTEX or
+// VIEWPORT_FROM_GEOMETRY (plus the matching #extension) right after the version directive.
+
+// Input vertex attributes. These are set from the OpenGL application.
+layout (location = 0) in vec3 aPos;   // Vertex position attribute.
+layout (location = 1) in vec3 aColor; // Vertex color attribute.
+
+// Per-view and per-object matrices, shared by every instance of the draw call.
+layout (std140) uniform MultiViewBlock
+{
+    mat4 viewProjection[MAX_VIEWS]; // Projection * view matrix of each viewport.
+    mat4 model[MAX_OBJECTS];        // Model matrix of each pyramid.
+};
+
+uniform int viewCount; // Number of views each pyramid is amplified to by this draw call.
+uniform int baseView;  // First view of this draw call (only non-zero when drawing one viewport at a time).
+
+#ifdef VIEWPORT_FROM_GEOMETRY
+// The geometry shader forwards the color and routes the triangle to its viewport.
+out vec3 vertexColor;
+flat out int viewIndex;
+#else
+// Output variable for passing the vertex color to the fragment shader.
+out vec3 ourColor;
+#endif
+
+void main()
+{
+    // Every pyramid is drawn once per view: consecutive instances cycle through the views.
+    int view = baseView + gl_InstanceID % viewCount;
+    int object = gl_InstanceID / viewCount;
+    gl_Position = viewProjection[view] * model[object] * vec4(aPos, 1.0);
+
+#ifdef VIEWPORT_FROM_GEOMETRY
+    vertexColor = aColor;
+    viewIndex = view;
+#else
+    ourColor = aColor;
+#ifdef VIEWPORT_FROM_VERTEX
+    gl_ViewportIndex = view; // Route the primitive to the viewport of its view.
+#endif
+#endif
+}
@@ -0,0 +1,46 @@
+// Specifies the version of GLSL to use. "330 core" means version 3.3 in core profile.
+#version 330 core
+// Expands the point records of the pyramid field (pyramid_field.h) into pyramids. There are no vertex
+// attributes: vertex gl_VertexID draws corner gl_VertexID % 18 of pyramid gl_VertexID / 18. Pyramids that the
+// impostor shader draws as a quad instead are collapsed out of the view volume.
+
+// One RGBA32UI texel per pyramid: the center as float bits, then r | g << 8 | b << 16 | scale << 24.
+uniform usamplerBuffer points;
+uniform mat4 viewProjection; // Projection * view matrix of the camera; the centers are in world space.
+uniform vec4 impostorCamera; // xyz: camera position. w: a pyramid of scale s farther than s * w is an impostor; 0 for none.
+
+// Output variable for passing the vertex color to the fragment shader.
+out vec3 ourColor;
+
+// The pyramid mesh of createPyramidMesh unrolled through its index buffer, 3 corners per triangle, for an
+// edge length of 1.
+const vec3 corners[18] = vec3[18](
+    vec3(0.0, 0.5, 0.0), vec3(-0.5, -0.5, 0.5), vec3(0.5, -0.5, 0.5),    // Front face
+    vec3(0.0, 0.5, 0.0), vec3(0.5, -0.5, 0.5), vec3(0.5, -0.5, -0.5),    // Right face
+    vec3(0.0, 0.5, 0.0), vec3(0.5, -0.5, -0.5), vec3(-0.5, -0.5, -0.5),  // Back face
+    vec3(0.0, 0.5, 0.0), vec3(-0.5, -0.5, -0.5), vec3(-0.5, -0.5, 0.5),  // Left face
+    vec3(-0.5, -0.5, 0.5), vec3(0.5, -0.5, 0.5), vec3(0.5, -0.5, -0.5),  // Base right triangle
+    vec3(-0.5, -0.5, 0.5), vec3(0.5, -0.5, -0.5), vec3(-0.5, -0.5, -0.5) // Base left triangle
+);
+
+// Brightness of each triangle, so the faces of a single-colored pyramid stay apart.
+const float faceShade[6] = float[6](1.0, 0.8, 0.6, 0.7, 0.4, 0.4);
+
+void main()
+{
+    uvec4 record = texelFetch(points, gl_VertexID / 18);
+    int corner = gl_VertexID % 18;
+
+    vec3 center = uintBitsToFloat(record.xyz);
+    float scale = float(record.w >> 24) / 64.0;
+    if (impostorCamera.w > 0.0 && length(impostorCamera.xyz - center) > scale * impostorCamera.w)
+    {
+        gl_Position = vec4(2.0, 2.0, 2.0, 1.0); // Every corner outside the clip volume: the triangles are dropped
+        ourColor = vec3(0.0);
+        return;
+    }
+    gl_Position = viewProjection * vec4(center + corners[corner] * scale, 1.0);
+
+    vec3 color = vec3(record.w & 255u, (record.w >> 8) & 255u, (record.w >> 16) & 255u) / 255.0;
+    ourColor = color * faceShade[corner / 3];
+}
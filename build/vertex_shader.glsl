@@ -1,10 +1,43 @@
 // Specifies the version of GLSL to use. "330 core" means version 3.3 in core profile.
 #version 330 core
+// The application inserts "#define TEXTURED" right after the version directive for the program that samples
+// the material texture array, and "#define VERTEX_PULLING" for the programs that fetch their vertices from
+// buffer textures instead of vertex attributes (vertex_pulling.h).
 
 // Input vertex attributes. These are set from the OpenGL application.
 layout (location = 0) in vec3 aPos;   // Vertex position attribute. Expected to be provided by the application.
 layout (location = 1) in vec3 aColor; // Vertex color attribute. Expected to be provided by the application.
 
+#ifdef VERTEX_PULLING
+// The mesh as buffer textures: the index of vertex gl_VertexID, then the vertex at that index, either as the
+// 6 interleaved floats of the attribute layout or quantized into two words (vertex_pulling.h).
+uniform int vertexEncoding; // 0: the attributes above, 1: floats, 2: quantized (VertexEncoding).
+uniform usamplerBuffer vertexIndices;
+uniform samplerBuffer vertexFloats;
+uniform usamplerBuffer vertexWords;
+uniform vec4 positionScale;  // Quantized positions are code * scale + offset.
+uniform vec4 positionOffset;
+
+// Fetches and decodes the position and color of the vertex drawn by this invocation.
+void pullVertex(out vec3 position, out vec3 color)
+{
+    int index = int(texelFetch(vertexIndices, gl_VertexID).r);
+    if (vertexEncoding == 2)
+    {
+        uvec2 words = texelFetch(vertexWords, index).rg;
+        position = vec3(words.x & 0xFFFFu, words.x >> 16, words.y & 0xFFFFu) * positionScale.xyz + positionOffset.xyz;
+        uint rgb565 = words.y >> 16;
+        color = vec3(rgb565 >> 11, (rgb565 >> 5) & 63u, rgb565 & 31u) / vec3(31.0, 63.0, 31.0);
+    }
+    else
+    {
+        int base = index * 6;
+        position = vec3(texelFetch(vertexFloats, base).r, texelFetch(vertexFloats, base + 1).r, texelFetch(vertexFloats, base + 2).r);
+        color = vec3(texelFetch(vertexFloats, base + 3).r, texelFetch(vertexFloats, base + 4).r, texelFetch(vertexFloats, base + 5).r);
+    }
+}
+#endif
+
 // Uniforms are parameters that are the same for all vertices processed by the shader program.
 uniform mat4 model;      // Model matrix used to transform vertex positions from model space to world space.
 uniform mat4 view;       // View matrix used to transform vertex positions from world space to camera space.
@@ -13,17 +46,42 @@ uniform mat4 projection; // Projection matrix used to transform vertex positions
 // Output variable for passing the vertex color to the next stage in the pipeline (e.g., the fragment shader).
 out vec3 ourColor;
 
+#ifdef TEXTURED
+uniform int materialLayer; // Layer of the material texture array used by this pyramid.
+uniform vec4 materialRect; // Place of the material in its layer: scale in xy, offset in zw. (1, 1, 0, 0) for a whole layer.
+
+// Texture coordinate and array layer passed to the fragment shader.
+out vec3 materialCoord;
+#endif
+
 // The main function of the shader, which is executed for each vertex.
 void main()
 {
+    vec3 position = aPos, color = aColor;
+#ifdef VERTEX_PULLING
+    // A mesh that could not be set up for pulling still comes through the attributes
+    if (vertexEncoding != 0)
+        pullVertex(position, color);
+#endif
+
     // Calculate the position of the vertex. The vertex's position is transformed by the model, view,
     // and projection matrices in order to place it correctly in the scene according to the world's,
     // camera's, and projection's settings. The multiplication order is important and is done in reverse
     // order of how you might expect because matrix multiplication is not commutative.
-    gl_Position = projection * view * model * vec4(aPos, 1.0);
+    gl_Position = projection * view * model * vec4(position, 1.0);
 
     // Pass the vertex's color to the next stage in the pipeline without modification.
-    ourColor = aColor;
+    ourColor = color;
+
+#ifdef TEXTURED
+    // The meshes have no texture coordinates, so they are projected from the object-space position along the
+    // diagonal of the x and z axes, so no side of the pyramid has its texture squashed to a line.
+    // In an atlas the coordinates are clamped to [0, 1] first, so they never reach the neighboring textures.
+    vec2 uv = vec2(position.x + position.z, position.y) * vec2(0.5, 1.0) + 0.5;
+    if (materialRect != vec4(1.0, 1.0, 0.0, 0.0))
+        uv = clamp(uv, 0.0, 1.0);
+    materialCoord = vec3(uv * materialRect.xy + materialRect.zw, float(materialLayer));
+#endif
 }
 
 
@@ -0,0 +1,156 @@
+#include "alloc_audit.h"
+
+#ifdef ALLOC_AUDIT
+
+#include <cstdlib> // malloc, aligned_alloc and free behind the replaced operators.
+#include <new>     // std::bad_alloc, std::align_val_t, std::nothrow_t.
+
+// Counters of the calling thread. Constant-initialized, so touching them from operator new never allocates.
+static thread_local AllocationCounts threadCounts;
+
+static void *countedAllocate(std::size_t size) noexcept
+{
+    ++threadCounts.allocations;
+    threadCounts.bytes += (long long)size;
+    return std::malloc(size != 0 ? size : 1);
+}
+
+static void *countedAllocateAligned(std::size_t size, std::align_val_t alignment) noexcept
+{
+    ++threadCounts.allocations;
+    threadCounts.bytes += (long long)size;
+    std::size_t align = (std::size_t)alignment;
+    std::size_t rounded = (size + align - 1) / align * align; // aligned_alloc wants a multiple of the alignment.
+    return std::aligned_alloc(align, rounded != 0 ? rounded : align);
+}
+
+static void countedFree(void *pointer) noexcept
+{
+    if (pointer == nullptr)
+        return;
+    ++threadCounts.frees;
+    std::free(pointer);
+}
+
+// Replacements of the global allocation functions. The sized and aligned forms of delete forward to the
+// plain one; every allocation comes from malloc or aligned_alloc, so free releases all of them.
+void *operator new(std::size_t size)
+{
+    void *pointer = countedAllocate(size);
+    if (pointer == nullptr)
+        throw std::bad_alloc();
+    return pointer;
+}
+
+void *operator new[](std::size_t size) { return operator new(size); }
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept { return countedAllocate(size); }
+void *operator new[](std::size_t size, const std::nothrow_t &) noexcept { return countedAllocate(size); }
+
+void *operator new(std::size_t size, std::align_val_t alignment)
+{
+    void *pointer = countedAllocateAligned(size, alignment);
+    if (pointer == nullptr)
+        throw std::bad_alloc();
+    return pointer;
+}
+
+void *operator new[](std::size_t size, std::align_val_t alignment) { return operator new(size, alignment); }
+void *operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept { return countedAllocateAligned(size, alignment); }
+void *operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t &) noexcept { return countedAllocateAligned(size, alignment); }
+
+void operator delete(void *pointer) noexcept { countedFree(pointer); }
+void operator delete[](void *pointer) noexcept { countedFree(pointer); }
+void operator delete(void *pointer, std::size_t) noexcept { countedFree(pointer); }
+void operator delete[](void *pointer, std::size_t) noexcept { countedFree(pointer); }
+void operator delete(void *pointer, const std::nothrow_t &) noexcept { countedFree(pointer); }
+void operator delete[](void *pointer, const std::nothrow_t &) noexcept { countedFree(pointer); }
+void operator delete(void *pointer, std::align_val_t) noexcept { countedFree(pointer); }
+void operator delete[](void *pointer, std::align_val_t) noexcept { countedFree(pointer); }
+void operator delete(void *pointer, std::size_t, std::align_val_t) noexcept { countedFree(pointer); }
+void operator delete[](void *pointer, std::size_t, std::align_val_t) noexcept { countedFree(pointer); }
+
+bool allocationAuditAvailable() { return true; }
+AllocationCounts threadAllocationCounts() { return threadCounts; }
+
+#else
+
+bool allocationAuditAvailable() { return false; }
+AllocationCounts threadAllocationCounts() { return AllocationCounts(); }
+
+#endif
+
+// The audit state below only lives on the render thread. It is all fixed size, so the audit itself never
+// shows up as an allocation.
+static const int recordedViolations = 16; // Offending frames kept for the report.
+
+struct FrameViolation
+{
+    long long frameIndex;
+    AllocationCounts counts;
+};
+
+static int warmup = -1;                  // Negative until startAllocationAudit.
+static AllocationCounts frameStart;      // Render thread totals when the current frame began.
+static AllocationCounts lastFrame;
+static long long checkedFrames = 0;
+static long long violations = 0;
+static FrameViolation firstViolations[recordedViolations];
+
+AllocationCounts AllocationScope::counts() const
+{
+    AllocationCounts now = threadAllocationCounts();
+    AllocationCounts result;
+    result.allocations = now.allocations - start.allocations;
+    result.bytes = now.bytes - start.bytes;
+    result.frees = now.frees - start.frees;
+    return result;
+}
+
+// Function to start checking the render thread.
+// warmupFrames: Frames that may allocate, while caches, queues and driver state fill up.
+void startAllocationAudit(int warmupFrames)
+{
+    warmup = warmupFrames < 0 ? 0 : warmupFrames;
+    frameStart = threadAllocationCounts();
+    checkedFrames = 0;
+    violations = 0;
+}
+
+// Function to close the audit frame. Counts everything the render thread did since the previous call.
+// frameIndex: Number of the frame, kept for the report.
+void allocationAuditEndFrame(long long frameIndex)
+{
+    AllocationCounts now = threadAllocationCounts();
+    lastFrame.allocations = now.allocations - frameStart.allocations;
+    lastFrame.bytes = now.bytes - frameStart.bytes;
+    lastFrame.frees = now.frees - frameStart.frees;
+    frameStart = now;
+
+    if (warmup < 0 || frameIndex < warmup)
+        return;
+    ++checkedFrames;
+    if (lastFrame.allocations > 0)
+    {
+        if (violations < recordedViolations)
+            firstViolations[violations] = {frameIndex, lastFrame};
+        ++violations;
+    }
+}
+
+AllocationCounts lastFrameAllocations() { return lastFrame; }
+long long allocationAuditViolations() { return violations; }
+
+// Function to print the result of the audit.
+void printAllocationAuditReport(std::ostream &out)
+{
+    if (warmup < 0)
+        return;
+    out << "Allocation audit: " << checkedFrames << " frames checked after " << warmup << " warm-up frames, "
+        << violations << " allocated on the render thread\n";
+    for (long long i = 0; i < violations && i < recordedViolations; ++i)
+        out << "  frame " << firstViolations[i].frameIndex << ": " << firstViolations[i].counts.allocations
+            << " allocations, " << firstViolations[i].counts.bytes << " bytes\n";
+    if (violations > recordedViolations)
+        out << "  ...\n";
+    out << std::flush;
+}
@@ -0,0 +1,41 @@
+#ifndef ALLOC_AUDIT_H
+#define ALLOC_AUDIT_H
+
+// Heap allocation auditing, for keeping the steady-state frame free of allocations.
+// Only available in the audit build (cmake -DALLOC_AUDIT=ON): the global operator new and delete are
+// replaced by versions that count the allocations and bytes of the calling thread. The render loop closes
+// one audit frame per frame; once the warm-up is over, every frame that allocated on the render thread is
+// a violation, and --alloc-audit turns the violations into a failing exit status. Only C++ allocations
+// are seen: malloc from C libraries and the driver is not counted. In normal builds nothing is replaced
+// and allocationAuditAvailable returns false.
+#include <ostream> // Report output.
+
+// Heap activity of one thread.
+struct AllocationCounts
+{
+    long long allocations = 0;
+    long long bytes = 0; // Requested bytes of the allocations.
+    long long frees = 0;
+};
+
+bool allocationAuditAvailable();           // True in the audit build.
+AllocationCounts threadAllocationCounts(); // Totals of the calling thread since it started.
+
+// Counts the heap activity of the calling thread from construction to counts().
+class AllocationScope
+{
+public:
+    AllocationScope() : start(threadAllocationCounts()) {}
+    AllocationCounts counts() const;
+
+private:
+    AllocationCounts start;
+};
+
+void startAllocationAudit(int warmupFrames);        // Frames before warmupFrames are not checked.
+void allocationAuditEndFrame(long long frameIndex); // Once per frame on the render thread: closes the frame and checks it.
+AllocationCounts lastFrameAllocations();            // Render thread activity of the last completed frame.
+long long allocationAuditViolations();              // Checked frames that allocated.
+void printAllocationAuditReport(std::ostream &out); // Checked frames, violations and the first offending frames.
+
+#endif
@@ -0,0 +1,181 @@
+#include "asset_pack.h"
+#include "compression.h" // Chunk decompression.
+#include "logger.h"      // Damaged packs.
+#include <algorithm>     // std::lower_bound.
+#include <atomic>        // Chunks left of an asynchronous extraction.
+#include <cstring>       // std::memcmp, std::memcpy.
+#include <fcntl.h>       // open.
+#include <memory>        // Shared state of an asynchronous extraction.
+#include <sys/mman.h>    // mmap.
+#include <sys/stat.h>    // fstat.
+#include <unistd.h>      // close.
+
+static AssetPack mountedPack;
+static bool packMounted = false;
+
+// Function to map a pack file and check that every record points inside it, so lookups and extraction
+// need no further checks.
+bool AssetPack::open(const std::string &packPath)
+{
+    close();
+    int fd = ::open(packPath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0)
+        return false;
+    struct stat status;
+    void *mapping = MAP_FAILED;
+    if (fstat(fd, &status) == 0 && status.st_size >= (off_t)sizeof(AssetPackHeader))
+        mapping = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // The mapping stays valid
+    if (mapping == MAP_FAILED)
+    {
+        logError("Could not map the asset pack {}", packPath);
+        return false;
+    }
+    data = (const char *)mapping;
+    size = (size_t)status.st_size;
+    path = packPath;
+
+    header = (const AssetPackHeader *)data;
+    uint64_t tableEnd = sizeof(AssetPackHeader) + (uint64_t)header->entryCount * sizeof(AssetPackEntry) +
+                        (uint64_t)header->chunkCount * sizeof(AssetPackChunk);
+    bool valid = std::memcmp(header->magic, assetPackMagic, sizeof(header->magic)) == 0 && header->chunkSize > 0 &&
+                 header->chunkSize <= (uint32_t)lz4MaxInputSize && tableEnd + header->namesSize <= size;
+    if (valid)
+    {
+        entries = (const AssetPackEntry *)(data + sizeof(AssetPackHeader));
+        chunks = (const AssetPackChunk *)(entries + header->entryCount);
+        names = data + tableEnd;
+    }
+    for (uint32_t i = 0; valid && i < header->chunkCount; ++i)
+        valid = chunks[i].offset <= size && chunks[i].storedSize <= size - chunks[i].offset && // No wrap for huge offsets
+                chunks[i].rawSize <= header->chunkSize &&
+                chunks[i].storedSize <= (uint32_t)compressBoundLz4((int)chunks[i].rawSize);
+    for (uint32_t i = 0; valid && i < header->entryCount; ++i)
+    {
+        const AssetPackEntry &entry = entries[i];
+        valid = (uint64_t)entry.nameOffset + entry.nameLength <= header->namesSize &&
+                (uint64_t)entry.firstChunk + entry.chunkCount <= header->chunkCount;
+        uint64_t rawSize = 0;
+        for (uint32_t c = 0; valid && c < entry.chunkCount; ++c)
+            rawSize += chunks[entry.firstChunk + c].rawSize;
+        valid = valid && rawSize == entry.size;
+    }
+    if (!valid)
+    {
+        logError("{} is not an asset pack or is damaged", packPath);
+        close();
+        return false;
+    }
+    return true;
+}
+
+void AssetPack::close()
+{
+    if (data != nullptr)
+        munmap((void *)data, size);
+    data = nullptr;
+    size = 0;
+    header = nullptr;
+    entries = nullptr;
+    chunks = nullptr;
+    names = nullptr;
+}
+
+std::string AssetPack::name(const AssetPackEntry &entry) const
+{
+    return std::string(names + entry.nameOffset, entry.nameLength);
+}
+
+// Function to look a file up by name: a binary search over the sorted entries.
+const AssetPackEntry *AssetPack::find(const std::string &fileName) const
+{
+    if (header == nullptr)
+        return nullptr;
+    auto compare = [this](const AssetPackEntry &entry, const std::string &key)
+    {
+        int order = std::memcmp(names + entry.nameOffset, key.data(), std::min<size_t>(entry.nameLength, key.size()));
+        return order != 0 ? order < 0 : entry.nameLength < key.size();
+    };
+    const AssetPackEntry *end = entries + header->entryCount;
+    const AssetPackEntry *entry = std::lower_bound(entries, end, fileName, compare);
+    if (entry == end || entry->nameLength != fileName.size() ||
+        std::memcmp(names + entry->nameOffset, fileName.data(), fileName.size()) != 0)
+        return nullptr;
+    return entry;
+}
+
+bool AssetPack::extractChunk(const AssetPackChunk &chunk, char *destination) const
+{
+    const char *stored = data + chunk.offset;
+    if (chunk.storedSize == chunk.rawSize)
+    {
+        std::memcpy(destination, stored, chunk.rawSize);
+        return true;
+    }
+    return decompressLz4(stored, (int)chunk.storedSize, destination, (int)chunk.rawSize);
+}
+
+// Function to decompress every chunk of a file in order, on the calling thread.
+bool AssetPack::extract(const AssetPackEntry &entry, char *destination) const
+{
+    for (uint32_t c = 0; c < entry.chunkCount; ++c)
+    {
+        const AssetPackChunk &chunk = chunks[entry.firstChunk + c];
+        if (!extractChunk(chunk, destination))
+        {
+            logError("Chunk {} of {} in {} is damaged", c, name(entry), path);
+            return false;
+        }
+        destination += chunk.rawSize;
+    }
+    return true;
+}
+
+// Function to decompress the chunks of a file in parallel: one job per chunk, each writing its own range.
+void AssetPack::extractAsync(const AssetPackEntry &entry, char *destination, WorkerPool &workers,
+                             std::function<void(bool ok)> done) const
+{
+    struct Extraction
+    {
+        std::atomic<uint32_t> chunksLeft;
+        std::atomic<bool> failed{false};
+        std::function<void(bool ok)> done;
+    };
+    if (entry.chunkCount == 0)
+    {
+        workers.submit([done] { done(true); });
+        return;
+    }
+    auto extraction = std::make_shared<Extraction>();
+    extraction->chunksLeft = entry.chunkCount;
+    extraction->done = std::move(done);
+    for (uint32_t c = 0; c < entry.chunkCount; ++c)
+    {
+        const AssetPackChunk *chunk = &chunks[entry.firstChunk + c];
+        workers.submit([this, chunk, destination, extraction, &entry]
+                       {
+                           if (!extractChunk(*chunk, destination))
+                           {
+                               logError("A chunk of {} in {} is damaged", name(entry), path);
+                               extraction->failed = true;
+                           }
+                           if (extraction->chunksLeft.fetch_sub(1) == 1) // The last chunk completes the file
+                               extraction->done(!extraction->failed);
+                       });
+        destination += chunk->rawSize;
+    }
+}
+
+// Function to mount a pack for readFile and the asset streamer. Call before the threads that read assets start.
+bool mountAssetPack(const std::string &path)
+{
+    packMounted = mountedPack.open(path);
+    if (packMounted)
+        logInfo("Mounted the asset pack {} ({} files)", path, mountedPack.fileCount());
+    return packMounted;
+}
+
+const AssetPack *mountedAssetPack()
+{
+    return packMounted ? &mountedPack : nullptr;
+}
@@ -0,0 +1,86 @@
+#ifndef ASSET_PACK_H
+#define ASSET_PACK_H
+
+// Asset packs: the shaders and other assets of the program in one file, built by pack_builder.
+// Every file is split into chunks of chunkSize bytes that are compressed independently (compression.h),
+// so a large file is decompressed by several workers at once and a damaged chunk stays contained.
+// A pack is mapped into memory when it is mounted, so looking a file up and decompressing it takes no
+// system call; loose files cost an open, a stat, reads and a close each.
+//
+// File layout (native byte order, like the traces): an AssetPackHeader, entryCount AssetPackEntry records
+// sorted by name, chunkCount AssetPackChunk records, namesSize bytes of names (not terminated), then the
+// chunk data. A chunk whose stored size equals its raw size is stored uncompressed.
+#include "worker_pool.h" // Parallel decompression.
+#include <cstdint>       // Fixed size fields of the file format.
+#include <functional>    // Completion of asynchronous extraction.
+#include <string>        // File names.
+
+const char assetPackMagic[8] = {'P', 'Y', 'R', 'P', 'A', 'C', 'K', '1'};
+
+struct AssetPackHeader
+{
+    char magic[8];       // assetPackMagic.
+    uint32_t entryCount;
+    uint32_t chunkCount;
+    uint32_t chunkSize;  // Raw size of every chunk but the last of each file.
+    uint32_t namesSize;
+};
+
+struct AssetPackEntry
+{
+    uint32_t nameOffset; // Into the names.
+    uint32_t nameLength;
+    uint64_t size;       // Uncompressed size of the file.
+    uint32_t firstChunk; // Index of the file's first chunk; its chunks are consecutive.
+    uint32_t chunkCount;
+};
+
+struct AssetPackChunk
+{
+    uint64_t offset;     // From the start of the pack.
+    uint32_t storedSize; // Bytes in the pack.
+    uint32_t rawSize;    // Bytes after decompression.
+};
+
+class AssetPack
+{
+public:
+    AssetPack() = default;
+    ~AssetPack() { close(); }
+
+    AssetPack(const AssetPack &) = delete;
+    AssetPack &operator=(const AssetPack &) = delete;
+
+    bool open(const std::string &path); // Maps and validates the pack; logs and returns false if it is damaged.
+    void close();
+
+    const AssetPackEntry *find(const std::string &name) const; // nullptr if the pack has no such file.
+    std::string name(const AssetPackEntry &entry) const;
+    int fileCount() const { return header == nullptr ? 0 : (int)header->entryCount; }
+
+    // Decompresses a file into destination (entry.size bytes), which may be mapped GPU memory.
+    bool extract(const AssetPackEntry &entry, char *destination) const;
+
+    // Decompresses the chunks of a file as separate jobs on workers and calls done(ok) on the worker that
+    // finishes last. destination and the pack must stay valid until then. Never waits, so it can be
+    // called from a job of the same pool.
+    void extractAsync(const AssetPackEntry &entry, char *destination, WorkerPool &workers,
+                      std::function<void(bool ok)> done) const;
+
+private:
+    bool extractChunk(const AssetPackChunk &chunk, char *destination) const;
+
+    const char *data = nullptr; // The mapped pack.
+    size_t size = 0;
+    const AssetPackHeader *header = nullptr;
+    const AssetPackEntry *entries = nullptr;
+    const AssetPackChunk *chunks = nullptr;
+    const char *names = nullptr;
+    std::string path;
+};
+
+// The pack readFile and the asset streamer look files up in before going to the disk.
+bool mountAssetPack(const std::string &path); // Replaces the mounted pack; false (and nothing mounted) if it cannot be opened.
+const AssetPack *mountedAssetPack();          // nullptr if none is mounted.
+
+#endif
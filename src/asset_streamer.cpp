@@ -0,0 +1,673 @@
+#include "asset_streamer.h"
+#include "asset_pack.h" // Assets of the mounted pack.
+#include "gl_context.h" // The hidden upload window.
+#include "gpu_memory.h" // Accounting of the streamed buffers and textures.
+#include "image_io.h"   // TGA decoding.
+#include "logger.h"     // Load failures.
+#include <algorithm>    // Heap operations on the queues.
+#include <atomic>       // Files left to read of a request.
+#include <cstdlib>      // std::strtof, std::strtol.
+#include <cstring>      // std::memcpy into the staging buffer.
+
+static const long long uploadChunkBytes = 4 << 20; // Copied per glBufferSubData, so one large mesh does not hog the driver.
+static const int atlasLevels = 4;                  // Mipmap levels of an atlas; the gutters between its textures are 8 texels wide.
+
+// Heap order of the queues: the top is the highest priority, and among equal priorities the oldest request.
+static bool lessUrgent(int priorityA, long long sequenceA, int priorityB, long long sequenceB)
+{
+    return priorityA != priorityB ? priorityA < priorityB : sequenceA > sequenceB;
+}
+
+// Function to parse a Wavefront OBJ file into interleaved positions and colors.
+// Reads "v x y z [r g b]" and "f a b c ..." lines (polygons are split into triangle fans, texture and normal
+// indices are ignored); everything else is skipped. The mesh is centered and scaled to the pyramid's unit box
+// so it can take the pyramid's place. Vertices without a color are colored by their position in the box.
+// text: The file contents; the line ends are overwritten while parsing.
+static bool parseObjMesh(const std::string &path, std::string &text, std::vector<float> &vertices, std::vector<uint32_t> &indices)
+{
+    std::vector<uint32_t> polygon;
+    bool hasColors = true;
+    for (size_t lineStart = 0; lineStart < text.size();)
+    {
+        size_t lineEnd = text.find('\n', lineStart);
+        if (lineEnd == std::string::npos)
+            lineEnd = text.size();
+        if (lineEnd < text.size())
+            text[lineEnd] = '\0'; // Keeps the number parsing on this line
+        const char *line = text.c_str() + lineStart;
+        lineStart = lineEnd + 1;
+        if (line[0] == 'v' && line[1] == ' ')
+        {
+            char *end = (char *)line + 2;
+            float values[6] = {0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f};
+            int count = 0;
+            for (; count < 6; ++count)
+            {
+                char *next;
+                float value = std::strtof(end, &next);
+                if (next == end)
+                    break;
+                values[count] = value;
+                end = next;
+            }
+            if (count < 3)
+            {
+                logError("Malformed vertex in {}: {}", path, line);
+                return false;
+            }
+            hasColors = hasColors && count == 6;
+            vertices.insert(vertices.end(), values, values + 6);
+        }
+        else if (line[0] == 'f' && line[1] == ' ')
+        {
+            polygon.clear();
+            char *end = (char *)line + 2;
+            for (;;)
+            {
+                char *next;
+                long index = std::strtol(end, &next, 10);
+                if (next == end)
+                    break;
+                long vertexCount = (long)(vertices.size() / 6);
+                if (index < 0)
+                    index += vertexCount + 1; // Relative to the last vertex read.
+                if (index < 1 || index > vertexCount)
+                {
+                    logError("Face refers to a missing vertex in {}: {}", path, line);
+                    return false;
+                }
+                polygon.push_back((uint32_t)(index - 1));
+                while (*next != '\0' && *next != ' ' && *next != '\t') // Skip "/texture/normal".
+                    ++next;
+                end = next;
+            }
+            for (size_t i = 2; i < polygon.size(); ++i)
+                indices.insert(indices.end(), {polygon[0], polygon[i - 1], polygon[i]});
+        }
+    }
+    if (vertices.empty() || indices.empty())
+    {
+        logError("The mesh {} has no triangles", path);
+        return false;
+    }
+
+    // Fit the mesh into the box of the pyramid, from -0.5 to 0.5 on every axis
+    float low[3] = {vertices[0], vertices[1], vertices[2]};
+    float high[3] = {vertices[0], vertices[1], vertices[2]};
+    for (size_t v = 0; v < vertices.size(); v += 6)
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            low[axis] = std::min(low[axis], vertices[v + axis]);
+            high[axis] = std::max(high[axis], vertices[v + axis]);
+        }
+    float extent = std::max({high[0] - low[0], high[1] - low[1], high[2] - low[2], 1e-6f});
+    for (size_t v = 0; v < vertices.size(); v += 6)
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            float position = (vertices[v + axis] - low[axis]) / extent;
+            if (!hasColors)
+                vertices[v + 3 + axis] = 0.2f + 0.8f * position;
+            vertices[v + axis] = position - 0.5f * (high[axis] - low[axis]) / extent;
+        }
+    return true;
+}
+
+// Constructor: creates the upload context and starts the file reader, the parse workers and the upload thread.
+// mainWindow: Window whose context shares its objects with the upload context; it is current again on return.
+// debugOutput: Debug level of the upload context, usually the one of the main context.
+// ioBackend: How the files are read. mipFilter: Filter of the atlas mipmaps. parseThreads: Threads parsing the files.
+AssetStreamer::AssetStreamer(GLFWwindow *mainWindow, GlDebugLevel debugOutput, FileReaderBackend ioBackend, MipFilter mipFilter,
+                             int parseThreads)
+    : parseWorkers(parseThreads), reader(ioBackend), mipFilter(mipFilter)
+{
+    ContextSettings settings;
+    settings.width = 1;
+    settings.height = 1;
+    settings.title = "Asset upload";
+    settings.visible = false;
+    settings.shareWith = mainWindow;
+    settings.debugOutput = debugOutput;
+    uploadWindow = createContextWindow(settings); // Makes the new context current and reloads the functions
+    if (uploadWindow != nullptr)
+    {
+        driver.genBuffers = glad_glGenBuffers;
+        driver.bindBuffer = glad_glBindBuffer;
+        driver.bufferData = glad_glBufferData;
+        driver.bufferSubData = glad_glBufferSubData;
+        driver.mapBufferRange = glad_glMapBufferRange;
+        driver.unmapBuffer = glad_glUnmapBuffer;
+        driver.genTextures = glad_glGenTextures;
+        driver.bindTexture = glad_glBindTexture;
+        driver.texParameteri = glad_glTexParameteri;
+        driver.texStorage3D = GLAD_GL_ARB_texture_storage ? glad_glTexStorage3D : nullptr;
+        driver.compressedTexImage3D = glad_glCompressedTexImage3D;
+        driver.compressedTexSubImage3D = glad_glCompressedTexSubImage3D;
+        driver.texImage3D = glad_glTexImage3D;
+        driver.texSubImage3D = glad_glTexSubImage3D;
+        driver.fenceSync = glad_glFenceSync;
+        driver.clientWaitSync = glad_glClientWaitSync;
+        driver.deleteSync = glad_glDeleteSync;
+        driver.deleteBuffers = glad_glDeleteBuffers;
+        driver.deleteTextures = glad_glDeleteTextures;
+        driver.flush = glad_glFlush;
+        glad_glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+        glad_glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxArrayLayers);
+    }
+    glfwMakeContextCurrent(mainWindow); // A context can only be current on one thread
+    if (uploadWindow == nullptr)
+    {
+        logError("Could not create the upload context; assets will not be streamed");
+        return;
+    }
+    uploadThread = std::thread(&AssetStreamer::uploadMain, this);
+}
+
+// Destructor: drops the requests that were not parsed yet, lets the reads, the running parses and the upload in
+// progress finish, then deletes the buffers and textures that were never handed over.
+AssetStreamer::~AssetStreamer()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        parseQueue.clear();
+    }
+    uploadAvailable.notify_all();
+    reader.waitIdle();       // Reads completing from now on are dropped
+    parseWorkers.waitIdle(); // The remaining jobs find the queue empty
+    if (uploadThread.joinable())
+        uploadThread.join();
+
+    for (LoadedAsset &asset : fencedUploads)
+    {
+        driver.deleteSync(asset.fence);
+        if (asset.materials)
+            driver.deleteTextures(1, &asset.texture);
+        else
+            driver.deleteBuffers(2, asset.buffers);
+    }
+    if (uploadWindow != nullptr)
+        glfwDestroyWindow(uploadWindow);
+}
+
+// Function to queue the loading of a mesh file.
+// path: OBJ file. priority: Higher values are read, parsed and uploaded first.
+// onReady: Receives the mesh on the render thread; the caller owns it from then on.
+void AssetStreamer::requestMesh(const std::string &path, int priority, MeshReadyCallback onReady)
+{
+    if (uploadWindow == nullptr)
+        return;
+    int id = nextId++;
+    callbacks[id] = std::move(onReady);
+
+    auto mesh = std::make_shared<LoadedAsset>(); // std::function needs a copyable callback
+    mesh->id = id;
+    mesh->priority = priority;
+    mesh->sequence = nextSequence++;
+    mesh->paths.push_back(path);
+    mesh->requestTime = std::chrono::steady_clock::now();
+    readFiles(mesh);
+}
+
+// Function to queue the loading of a texture array.
+// paths: DDS or KTX files, one layer each (or as many as the file has), or TGA files for an atlas. priority: As for meshes.
+// onReady: Receives the texture array on the render thread; the caller owns it from then on.
+void AssetStreamer::requestMaterials(const std::vector<std::string> &paths, int priority, MaterialsReadyCallback onReady)
+{
+    if (uploadWindow == nullptr || paths.empty())
+        return;
+    int id = nextId++;
+    materialCallbacks[id] = std::move(onReady);
+
+    auto materials = std::make_shared<LoadedAsset>();
+    materials->id = id;
+    materials->priority = priority;
+    materials->sequence = nextSequence++;
+    materials->materials = true;
+    materials->paths = paths;
+    materials->requestTime = std::chrono::steady_clock::now();
+    readFiles(materials);
+}
+
+// Function to read every file of a request, in parallel. Files of the mounted pack are decompressed by the
+// parse workers, one job per chunk; the others go to the file reader. The last file to arrive queues the parsing.
+void AssetStreamer::readFiles(const std::shared_ptr<LoadedAsset> &asset)
+{
+    struct ReadProgress
+    {
+        std::atomic<int> filesLeft;
+        std::atomic<bool> failed{false};
+    };
+    // One count more than there are files, released after the loop: a read that completes while the loop still
+    // issues the others must not move the request out from under it
+    auto progress = std::make_shared<ReadProgress>();
+    progress->filesLeft = (int)asset->paths.size() + 1;
+    asset->contents.resize(asset->paths.size());
+    auto fileDone = [this, asset, progress](bool ok)
+    {
+        if (!ok)
+            progress->failed = true;
+        if (progress->filesLeft.fetch_sub(1) == 1)
+            contentsReady(*asset, !progress->failed);
+    };
+
+    const AssetPack *pack = mountedAssetPack();
+    for (size_t i = 0; i < asset->paths.size(); ++i)
+    {
+        std::string &contents = asset->contents[i];
+        if (const AssetPackEntry *entry = pack != nullptr ? pack->find(asset->paths[i]) : nullptr)
+        {
+            contents.resize(entry->size);
+            pack->extractAsync(*entry, &contents[0], parseWorkers, fileDone);
+            continue;
+        }
+        reader.read(asset->paths[i], asset->priority, [&contents, fileDone](const FileReadResult &result)
+                    {
+                        if (result.ok)
+                            contents.assign(result.data, (size_t)result.size);
+                        fileDone(result.ok);
+                    });
+    }
+    fileDone(true);
+}
+
+// Function called once every file of a request is read, by the file reader or by the pack extraction. Queues the
+// parsing; the reader's thread must not be held up by the parser.
+void AssetStreamer::contentsReady(LoadedAsset &asset, bool ok)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping)
+            return;
+        if (!ok)
+        {
+            failedIds.push_back(asset.id);
+            return;
+        }
+        parseQueue.push_back(std::move(asset));
+        std::push_heap(parseQueue.begin(), parseQueue.end(), [](const LoadedAsset &a, const LoadedAsset &b)
+                       { return lessUrgent(a.priority, a.sequence, b.priority, b.sequence); });
+    }
+    parseWorkers.submit([this] { parseNext(); }); // One job per request; each takes whichever request is most urgent by then
+}
+
+// Function run by a parse worker: parses the most urgent read request and passes it to the upload thread.
+void AssetStreamer::parseNext()
+{
+    auto order = [](const LoadedAsset &a, const LoadedAsset &b)
+    { return lessUrgent(a.priority, a.sequence, b.priority, b.sequence); };
+
+    LoadedAsset asset;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (parseQueue.empty())
+            return; // Dropped by the destructor
+        std::pop_heap(parseQueue.begin(), parseQueue.end(), order);
+        asset = std::move(parseQueue.back());
+        parseQueue.pop_back();
+    }
+
+    bool parsed;
+    if (asset.materials)
+        parsed = parseMaterials(asset); // The images stay in the file contents until the upload
+    else
+    {
+        parsed = parseObjMesh(asset.paths[0], asset.contents[0], asset.vertices, asset.indices);
+        std::vector<std::string>().swap(asset.contents);
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!parsed)
+        {
+            failedIds.push_back(asset.id);
+            return;
+        }
+        if (stopping)
+            return;
+        uploadQueue.push_back(std::move(asset));
+        std::push_heap(uploadQueue.begin(), uploadQueue.end(), order);
+    }
+    uploadAvailable.notify_one();
+}
+
+// Function to parse the texture files of a material request and check that they fit into one texture array
+// the driver can sample. Parse workers only.
+bool AssetStreamer::parseMaterials(LoadedAsset &asset)
+{
+    auto isTga = [](const std::string &path)
+    { return path.size() > 4 && (path.compare(path.size() - 4, 4, ".tga") == 0 || path.compare(path.size() - 4, 4, ".TGA") == 0); };
+    if (isTga(asset.paths[0]))
+    {
+        for (const std::string &path : asset.paths)
+            if (!isTga(path))
+            {
+                logError("{} is not a TGA file like {}; an atlas is built from TGA files only", path, asset.paths[0]);
+                return false;
+            }
+        return parseAtlas(asset);
+    }
+
+    asset.images.resize(asset.paths.size());
+    for (size_t i = 0; i < asset.paths.size(); ++i)
+    {
+        TextureImage &image = asset.images[i];
+        const TextureImage &first = asset.images[0];
+        if (!parseTextureFile(asset.paths[i], asset.contents[i], image))
+            return false;
+        if (i > 0 && (image.format != first.format || image.width != first.width || image.height != first.height ||
+                      image.levels != first.levels))
+        {
+            logError("{} ({} {}x{}, {} levels) does not match {} ({} {}x{}, {} levels); the layers of a texture array must",
+                     asset.paths[i], compressedFormatName(image.format), image.width, image.height, image.levels,
+                     asset.paths[0], compressedFormatName(first.format), first.width, first.height, first.levels);
+            return false;
+        }
+        asset.layerCount += image.layers;
+    }
+
+    const TextureImage &first = asset.images[0];
+    if (!compressedFormatSupported(first.format))
+    {
+        logError("The driver cannot sample {} textures ({})", compressedFormatName(first.format), asset.paths[0]);
+        return false;
+    }
+    if (first.width > maxTextureSize || first.height > maxTextureSize || asset.layerCount > maxArrayLayers)
+    {
+        logError("{} layers of {}x{} exceed the limits of the driver ({} layers of {}x{})", asset.layerCount, first.width,
+                 first.height, maxArrayLayers, maxTextureSize, maxTextureSize);
+        return false;
+    }
+    for (int level = 0; level < first.levels; ++level)
+        asset.textureSize += compressedImageSize(first.format, first.width >> level, first.height >> level) * asset.layerCount;
+    return true;
+}
+
+// Function to decode the TGA files of a material request, generate their mipmaps and pack them into one atlas.
+// Parse workers only; the other parse workers help with the mipmaps.
+bool AssetStreamer::parseAtlas(LoadedAsset &asset)
+{
+    std::vector<std::vector<RgbaImage>> chains(asset.paths.size());
+    for (size_t i = 0; i < asset.paths.size(); ++i)
+    {
+        chains[i].resize(1);
+        RgbaImage &image = chains[i][0];
+        if (!decodeTga(asset.paths[i], asset.contents[i], image.pixels, image.width, image.height))
+            return false;
+        std::string().swap(asset.contents[i]); // Decoded
+    }
+    std::vector<std::string>().swap(asset.contents);
+
+    // Color textures: the mipmaps are filtered in linear light
+    generateMipChains(chains, mipFilter, true, parseWorkers, atlasLevels);
+    if (!buildTextureAtlas(chains, atlasLevels, maxTextureSize, asset.atlas))
+    {
+        logError("The {} textures of {} do not fit into a {}x{} atlas", asset.paths.size(), asset.paths[0], maxTextureSize, maxTextureSize);
+        return false;
+    }
+    asset.layerCount = 1;
+    for (const RgbaImage &level : asset.atlas.levels)
+        asset.textureSize += (long long)level.pixels.size();
+    return true;
+}
+
+// Loop of the upload thread: uploads the most urgent parsed mesh, repeat. Owns the upload context.
+void AssetStreamer::uploadMain()
+{
+    auto order = [](const LoadedAsset &a, const LoadedAsset &b)
+    { return lessUrgent(a.priority, a.sequence, b.priority, b.sequence); };
+
+    glfwMakeContextCurrent(uploadWindow);
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;)
+    {
+        uploadAvailable.wait(lock, [this] { return stopping || !uploadQueue.empty(); });
+        if (stopping)
+            break;
+        std::pop_heap(uploadQueue.begin(), uploadQueue.end(), order);
+        LoadedAsset asset = std::move(uploadQueue.back());
+        uploadQueue.pop_back();
+
+        lock.unlock();
+        bool uploaded = true;
+        if (asset.materials)
+            uploaded = uploadMaterials(asset);
+        else
+            uploadMesh(asset);
+        lock.lock();
+        if (uploaded)
+            fencedUploads.push_back(std::move(asset));
+        else
+            failedIds.push_back(asset.id);
+    }
+    lock.unlock();
+    glfwMakeContextCurrent(nullptr);
+}
+
+// Function to copy the geometry of a mesh into new buffers and fence the copies. Upload thread only.
+void AssetStreamer::uploadMesh(LoadedAsset &mesh)
+{
+    const void *data[2] = {mesh.vertices.data(), mesh.indices.data()};
+    mesh.bufferSizes[0] = (long long)(mesh.vertices.size() * sizeof(float));
+    mesh.bufferSizes[1] = (long long)(mesh.indices.size() * sizeof(uint32_t));
+    mesh.indexCount = (int)mesh.indices.size();
+
+    // Both buffers are filled through GL_ARRAY_BUFFER: the element array binding belongs to a VAO, and this context has none
+    driver.genBuffers(2, mesh.buffers);
+    for (int i = 0; i < 2; ++i)
+    {
+        driver.bindBuffer(GL_ARRAY_BUFFER, mesh.buffers[i]);
+        driver.bufferData(GL_ARRAY_BUFFER, mesh.bufferSizes[i], nullptr, GL_STATIC_DRAW);
+        for (long long offset = 0; offset < mesh.bufferSizes[i]; offset += uploadChunkBytes)
+        {
+            long long size = std::min(uploadChunkBytes, mesh.bufferSizes[i] - offset);
+            driver.bufferSubData(GL_ARRAY_BUFFER, offset, size, (const char *)data[i] + offset);
+            driver.flush(); // Lets the driver start the copy while the next chunk is submitted
+        }
+    }
+    driver.bindBuffer(GL_ARRAY_BUFFER, 0);
+
+    // The fence must reach the GPU before another context can wait for it
+    mesh.fence = driver.fenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    driver.flush();
+
+    std::vector<float>().swap(mesh.vertices); // The copies are on the GPU now
+    std::vector<uint32_t>().swap(mesh.indices);
+}
+
+// Function to copy the images of a texture array into new immutable storage and fence the copies. Upload thread only.
+// The file contents (or the atlas levels) are copied once, into a pixel unpack buffer; the driver then copies from
+// there into the texture on the GPU timeline, so the calls return without waiting for the copy. Returns false if the
+// staging buffer cannot be mapped.
+bool AssetStreamer::uploadMaterials(LoadedAsset &asset)
+{
+    bool atlas = !asset.atlas.levels.empty();
+    GLuint staging;
+    driver.genBuffers(1, &staging);
+    driver.bindBuffer(GL_PIXEL_UNPACK_BUFFER, staging);
+    driver.bufferData(GL_PIXEL_UNPACK_BUFFER, asset.textureSize, nullptr, GL_STREAM_DRAW);
+    char *mapped = (char *)driver.mapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, asset.textureSize,
+                                                 GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    if (mapped == nullptr)
+    {
+        logError("Could not map {} bytes to stage the textures of {}", asset.textureSize, asset.paths[0]);
+        driver.bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        driver.deleteBuffers(1, &staging);
+        return false;
+    }
+
+    // A texture array level holds the images of every layer in a row: stage level by level
+    long long offset = 0;
+    if (atlas)
+        for (const RgbaImage &level : asset.atlas.levels)
+        {
+            std::memcpy(mapped + offset, level.pixels.data(), level.pixels.size());
+            offset += (long long)level.pixels.size();
+        }
+    else
+    {
+        const TextureImage &first = asset.images[0];
+        for (int level = 0; level < first.levels; ++level)
+        {
+            long long imageSize = compressedImageSize(first.format, first.width >> level, first.height >> level);
+            for (size_t file = 0; file < asset.images.size(); ++file)
+            {
+                const TextureImage &image = asset.images[file];
+                for (int layer = 0; layer < image.layers; ++layer)
+                {
+                    std::memcpy(mapped + offset, asset.contents[file].data() + image.offsets[layer * image.levels + level], (size_t)imageSize);
+                    offset += imageSize;
+                }
+            }
+        }
+    }
+    driver.unmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+
+    // With a pixel unpack buffer bound, the data arguments are offsets into it
+    GLenum format = atlas ? GL_RGBA8 : asset.images[0].format;
+    int levels = atlas ? (int)asset.atlas.levels.size() : asset.images[0].levels;
+    int baseWidth = atlas ? asset.atlas.levels[0].width : asset.images[0].width;
+    int baseHeight = atlas ? asset.atlas.levels[0].height : asset.images[0].height;
+    driver.genTextures(1, &asset.texture);
+    driver.bindTexture(GL_TEXTURE_2D_ARRAY, asset.texture);
+    if (driver.texStorage3D != nullptr)
+        driver.texStorage3D(GL_TEXTURE_2D_ARRAY, levels, format, baseWidth, baseHeight, asset.layerCount);
+    offset = 0;
+    for (int level = 0; level < levels; ++level)
+    {
+        int width = std::max(baseWidth >> level, 1);
+        int height = std::max(baseHeight >> level, 1);
+        const void *data = (const void *)(intptr_t)offset;
+        if (atlas)
+        {
+            // Rows of RGBA8 texels are always 4-byte aligned, as GL_UNPACK_ALIGNMENT expects by default
+            if (driver.texStorage3D != nullptr)
+                driver.texSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, 0, width, height, 1, GL_RGBA, GL_UNSIGNED_BYTE, data);
+            else
+                driver.texImage3D(GL_TEXTURE_2D_ARRAY, level, GL_RGBA8, width, height, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
+            offset += (long long)width * height * 4;
+        }
+        else
+        {
+            long long levelSize = compressedImageSize(format, width, height) * asset.layerCount;
+            if (driver.texStorage3D != nullptr)
+                driver.compressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, 0, width, height, asset.layerCount, format,
+                                               (GLsizei)levelSize, data);
+            else
+                driver.compressedTexImage3D(GL_TEXTURE_2D_ARRAY, level, format, width, height, asset.layerCount, 0,
+                                            (GLsizei)levelSize, data);
+            offset += levelSize;
+        }
+        driver.flush(); // Lets the driver start the copy while the next level is submitted
+    }
+    // An atlas must not wrap into the neighbors of its border textures; its texture coordinates never leave [0, 1]
+    GLint wrap = atlas ? GL_CLAMP_TO_EDGE : GL_REPEAT;
+    driver.texParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, levels - 1); // Complete without a full chain
+    driver.texParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+    driver.texParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    driver.texParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, wrap);
+    driver.texParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, wrap);
+    driver.bindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    driver.bindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    driver.deleteBuffers(1, &staging); // Deleted by the driver once the copies have read it
+
+    asset.fence = driver.fenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    driver.flush();
+
+    std::vector<std::string>().swap(asset.contents); // The images are on the GPU now
+    std::vector<TextureImage>().swap(asset.images);
+    std::vector<RgbaImage>().swap(asset.atlas.levels);
+    return true;
+}
+
+// Function to hand over the meshes and textures whose uploads the GPU has finished, and to drop the failed requests.
+// Never waits: a fence that has not signalled is checked again at the next frame.
+void AssetStreamer::poll()
+{
+    if (callbacks.empty() && materialCallbacks.empty())
+        return; // Nothing in flight; no locking on ordinary frames
+
+    std::unique_lock<std::mutex> lock(mutex);
+    for (int id : failedIds)
+    {
+        callbacks.erase(id);
+        materialCallbacks.erase(id);
+        ++failed;
+    }
+    failedIds.clear();
+
+    for (size_t i = 0; i < fencedUploads.size();)
+    {
+        LoadedAsset &uploaded = fencedUploads[i];
+        GLenum status = driver.clientWaitSync(uploaded.fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+        {
+            ++i;
+            continue;
+        }
+        driver.deleteSync(uploaded.fence);
+        LoadedAsset ready = std::move(uploaded);
+        fencedUploads.erase(fencedUploads.begin() + i);
+        lock.unlock(); // The callback may request more assets
+
+        ++completed;
+        double loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - ready.requestTime).count();
+        longestLoadMs = std::max(longestLoadMs, loadMs);
+        const char *label = ready.paths[0].c_str();
+        if (ready.materials)
+        {
+            PyramidMaterials materials;
+            materials.array = UniqueTexture(ready.texture);
+            materials.layerCount = ready.layerCount;
+            for (const AtlasRect &rect : ready.atlas.rects)
+                materials.atlasRects.push_back(atlasUvTransform(rect, ready.atlas.width, ready.atlas.height));
+            trackGpuAllocation(GpuResourceKind::Texture, materials.array.name(), ready.textureSize, GpuMemoryCategory::Textures, "streamed materials");
+            labelGlObject(GL_TEXTURE, materials.array.name(), label);
+            bytesUploaded += ready.textureSize;
+            if (!ready.atlas.rects.empty())
+                logInfo("Streamed {} textures into a {}x{} atlas from {} in {} ms", ready.atlas.rects.size(), ready.atlas.width,
+                        ready.atlas.height, ready.paths[0], (long long)loadMs);
+            else
+                logInfo("Streamed {} texture layers from {} in {} ms", ready.layerCount, ready.paths[0], (long long)loadMs);
+
+            auto callback = materialCallbacks.find(ready.id);
+            MaterialsReadyCallback onReady = std::move(callback->second);
+            materialCallbacks.erase(callback);
+            onReady(std::move(materials));
+            lock.lock();
+            continue;
+        }
+
+        // Vertex arrays are not shared between contexts, so the layout is recorded here
+        PyramidMesh mesh;
+        mesh.VBO = UniqueBuffer(ready.buffers[0]);
+        mesh.EBO = UniqueBuffer(ready.buffers[1]);
+        mesh.VAO = UniqueVertexArray::create();
+        mesh.indexCount = ready.indexCount;
+        glBindVertexArray(mesh.VAO.name());
+        glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO.name());
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO.name());
+        setPyramidVertexAttributes();
+        glBindVertexArray(0);
+        trackGpuAllocation(GpuResourceKind::Buffer, mesh.VBO.name(), ready.bufferSizes[0], GpuMemoryCategory::Geometry, "streamed mesh", GL_STATIC_DRAW);
+        trackGpuAllocation(GpuResourceKind::Buffer, mesh.EBO.name(), ready.bufferSizes[1], GpuMemoryCategory::Geometry, "streamed mesh", GL_STATIC_DRAW);
+        labelGlObject(GL_VERTEX_ARRAY, mesh.VAO.name(), label);
+        labelGlObject(GL_BUFFER, mesh.VBO.name(), label);
+        labelGlObject(GL_BUFFER, mesh.EBO.name(), label);
+        bytesUploaded += ready.bufferSizes[0] + ready.bufferSizes[1];
+        logInfo("Streamed {} ({} triangles) in {} ms", ready.paths[0], ready.indexCount / 3, (long long)loadMs);
+
+        auto callback = callbacks.find(ready.id);
+        MeshReadyCallback onReady = std::move(callback->second);
+        callbacks.erase(callback);
+        onReady(std::move(mesh));
+        lock.lock();
+    }
+}
+
+// Function to print the counters of the streamer.
+void AssetStreamer::printSummary(std::ostream &out) const
+{
+    out << "Asset streaming: " << completed << " assets loaded, " << failed << " failed, " << pending() << " pending, "
+        << bytesUploaded / (1024 * 1024) << " MiB uploaded, slowest load " << (long long)longestLoadMs << " ms\n";
+    reader.printSummary(out);
+}
@@ -0,0 +1,164 @@
+#ifndef ASSET_STREAMER_H
+#define ASSET_STREAMER_H
+
+// Loading of meshes and textures while the render loop runs, without stalling it.
+// A request goes through four stages:
+// - the file reader (file_reader.h) reads the files, batched with the other requests, or the parse workers
+//   decompress them from the mounted asset pack (asset_pack.h), one job per chunk;
+// - a parse worker turns a mesh (Wavefront OBJ) into interleaved vertices and indices, or locates the images
+//   of compressed texture files (texture_file.h) without touching their blocks. Uncompressed textures (TGA)
+//   are mipmapped and packed into one atlas (texture_processing.h), with the other parse workers helping;
+// - the upload thread copies them through its own OpenGL context, a hidden window that shares objects with
+//   the main context, and puts a fence behind the copies. Meshes go into buffers; textures are staged in a
+//   pixel unpack buffer and copied from there into the immutable storage of a texture array by the driver,
+//   so the thread never waits for the GPU to read client memory;
+// - poll() on the render thread checks the fences without waiting; once one has signalled, it builds the
+//   vertex array (VAOs are not shared between contexts) and hands the mesh or texture to the request's callback.
+// Pending requests are served in priority order at both stages, so a mesh the user is looking at does not
+// queue behind a large one prefetched earlier.
+//
+// The upload thread calls the driver functions loaded when its context was created, not the glad_gl*
+// pointers, so the streamer must be created before the instrumentation, frame statistics or trace hooks
+// are installed (creating the context reloads the pointers and would drop them), and its calls stay out of
+// the statistics and traces. A trace recorded while meshes stream in does not contain their uploads.
+#include "glad.h"               // GLsync and the OpenGL function pointers.
+#include <GLFW/glfw3.h>         // The shared upload context.
+#include "gl_debug.h"           // Debug output of the upload context.
+#include "scene.h"              // PyramidMesh and PyramidMaterials.
+#include "texture_file.h"       // Compressed texture files.
+#include "texture_processing.h" // Mipmaps and atlases of uncompressed textures.
+#include "file_reader.h"        // Batched file reads.
+#include "worker_pool.h"        // Parse threads.
+#include <chrono>               // Load times.
+#include <condition_variable>   // Wakes the upload thread.
+#include <cstdint>              // Index type.
+#include <functional>           // Completion callbacks.
+#include <memory>               // Shares a request with the reader's callbacks.
+#include <mutex>                // Protects the queues between the stages.
+#include <ostream>              // Summary output.
+#include <string>               // File paths.
+#include <thread>               // The upload thread.
+#include <unordered_map>        // Callbacks by request id.
+#include <vector>               // Queues and parsed geometry.
+
+// Called on the render thread with the uploaded mesh or textures, from poll().
+using MeshReadyCallback = std::function<void(PyramidMesh mesh)>;
+using MaterialsReadyCallback = std::function<void(PyramidMaterials materials)>;
+
+class AssetStreamer
+{
+public:
+    // Creates the upload context sharing objects with mainWindow, and starts the threads. mainWindow's
+    // context is current again afterwards. Call on the main thread (GLFW creates windows only there).
+    // mipFilter: Downsampling filter of the atlas mipmaps.
+    AssetStreamer(GLFWwindow *mainWindow, GlDebugLevel debugOutput, FileReaderBackend ioBackend = FileReaderBackend::Auto,
+                  MipFilter mipFilter = MipFilter::Kaiser, int parseThreads = 2);
+    ~AssetStreamer(); // Abandons the queued requests and deletes what was uploaded but not handed over. Needs the main context current.
+
+    AssetStreamer(const AssetStreamer &) = delete;
+    AssetStreamer &operator=(const AssetStreamer &) = delete;
+
+    bool valid() const { return uploadWindow != nullptr; } // False if the upload context could not be created.
+
+    // Queues the loading of an OBJ file. Higher priorities are served first; equal ones in request order.
+    // onReady runs on the render thread inside a later poll(); it is not called if loading fails.
+    void requestMesh(const std::string &path, int priority, MeshReadyCallback onReady);
+    // Queues the loading of DDS or KTX files into one texture array, the layers of every file in order. The files
+    // must share their compressed format, size and number of mipmap levels. Served like the meshes.
+    // TGA files of any sizes are packed into an atlas instead: one layer, with a texture coordinate transform per file.
+    void requestMaterials(const std::vector<std::string> &paths, int priority, MaterialsReadyCallback onReady);
+    void poll();                                // Hands over the uploads whose fence has signalled. Render thread, once per frame.
+    int pending() const { return (int)(callbacks.size() + materialCallbacks.size()); } // Requests not handed over yet.
+    void printSummary(std::ostream &out) const; // Loads, failures, uploaded bytes and the slowest load, and the file reads.
+
+private:
+    // A request between the stages: a mesh, or the files of a texture array.
+    struct LoadedAsset
+    {
+        int id = 0;
+        int priority = 0;
+        long long sequence = 0; // Request order, to break priority ties.
+        bool materials = false; // A texture array rather than a mesh.
+        std::vector<std::string> paths;    // One file for a mesh.
+        std::vector<std::string> contents; // File contents by path, until uploaded (the images point into them).
+        std::chrono::steady_clock::time_point requestTime;
+        GLsync fence = nullptr; // Behind the uploads.
+
+        // Mesh. vertices: 6 floats (position, color) per vertex.
+        std::vector<float> vertices;
+        std::vector<uint32_t> indices;
+        GLuint buffers[2] = {0, 0};        // VBO and EBO, once uploaded.
+        long long bufferSizes[2] = {0, 0}; // In bytes.
+        int indexCount = 0;                // indices is freed after the upload.
+
+        // Texture array
+        std::vector<TextureImage> images; // By path.
+        GLuint texture = 0;               // Once uploaded.
+        long long textureSize = 0;        // In bytes, every level and layer.
+        int layerCount = 0;
+        TextureAtlas atlas;               // Uncompressed textures: the atlas levels, uploaded instead of the images.
+    };
+
+    // Driver functions used outside the hooks: taken before any hook replaces the glad_gl* pointers.
+    struct DriverFunctions
+    {
+        PFNGLGENBUFFERSPROC genBuffers;
+        PFNGLBINDBUFFERPROC bindBuffer;
+        PFNGLBUFFERDATAPROC bufferData;
+        PFNGLBUFFERSUBDATAPROC bufferSubData;
+        PFNGLMAPBUFFERRANGEPROC mapBufferRange;
+        PFNGLUNMAPBUFFERPROC unmapBuffer;
+        PFNGLGENTEXTURESPROC genTextures;
+        PFNGLBINDTEXTUREPROC bindTexture;
+        PFNGLTEXPARAMETERIPROC texParameteri;
+        PFNGLTEXSTORAGE3DPROC texStorage3D; // nullptr without ARB_texture_storage: the levels are then allocated one by one.
+        PFNGLCOMPRESSEDTEXIMAGE3DPROC compressedTexImage3D;
+        PFNGLCOMPRESSEDTEXSUBIMAGE3DPROC compressedTexSubImage3D;
+        PFNGLTEXIMAGE3DPROC texImage3D;
+        PFNGLTEXSUBIMAGE3DPROC texSubImage3D;
+        PFNGLFENCESYNCPROC fenceSync;
+        PFNGLCLIENTWAITSYNCPROC clientWaitSync; // The fences are checked and deleted on the render thread, also unhooked,
+        PFNGLDELETESYNCPROC deleteSync;         // so a trace never sees fences it did not record being created.
+        PFNGLDELETEBUFFERSPROC deleteBuffers;
+        PFNGLDELETETEXTURESPROC deleteTextures;
+        PFNGLFLUSHPROC flush;
+    };
+
+    void readFiles(const std::shared_ptr<LoadedAsset> &asset); // Reads or extracts every file of a request.
+    void contentsReady(LoadedAsset &asset, bool ok); // The files are read (or extracted from the pack): queues them for parsing.
+    void parseNext();                                // Parse worker job: parses the most urgent read request.
+    bool parseMaterials(LoadedAsset &asset);
+    bool parseAtlas(LoadedAsset &asset);
+    void uploadMain(); // Loop of the upload thread.
+    void uploadMesh(LoadedAsset &mesh);
+    bool uploadMaterials(LoadedAsset &asset);
+
+    WorkerPool parseWorkers;
+    FileReader reader; // After parseWorkers: its callbacks submit parse jobs, so it must stop first.
+    GLFWwindow *uploadWindow = nullptr;
+    DriverFunctions driver = {};
+    int maxTextureSize = 0; // Limits of the driver, checked before a texture array is uploaded.
+    int maxArrayLayers = 0;
+    MipFilter mipFilter;
+    std::thread uploadThread;
+
+    mutable std::mutex mutex;
+    std::condition_variable uploadAvailable; // Signalled when parsed geometry arrives or the streamer stops.
+    std::vector<LoadedAsset> parseQueue;     // Read, not parsed yet. Heaps ordered by priority, then sequence.
+    std::vector<LoadedAsset> uploadQueue;    // Parsed, not uploaded yet.
+    std::vector<LoadedAsset> fencedUploads;  // Uploaded, waiting for their fence on the render thread.
+    std::vector<int> failedIds;              // Requests whose files could not be loaded.
+    bool stopping = false;
+
+    // Render thread only
+    long long nextSequence = 0;
+    std::unordered_map<int, MeshReadyCallback> callbacks; // By request id; removed when the request completes or fails.
+    std::unordered_map<int, MaterialsReadyCallback> materialCallbacks;
+    int nextId = 1;
+    int completed = 0;
+    int failed = 0;
+    long long bytesUploaded = 0;
+    double longestLoadMs = 0; // From the request to the hand-off, including the time in the queues.
+};
+
+#endif
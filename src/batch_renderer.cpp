@@ -0,0 +1,183 @@
+#include "batch_renderer.h"
+#include "gl_context.h"                 // Hidden window providing the context.
+#include "gl_debug.h"                   // Object labels and debug groups for frame captures.
+#include "gl_objects.h"                 // Owner of the shader program.
+#include "gpu_memory.h"                 // GPU memory budgets.
+#include "image_io.h"                   // TGA output.
+#include "logger.h"                     // Status and error messages.
+#include "offscreen.h"                  // Offscreen framebuffer.
+#include "readback.h"                   // PBO readback ring.
+#include "render_farm.h"                // Multi-process rendering.
+#include "scene.h"                      // The pyramid scene.
+#include "shader.h"                     // Shader loading.
+#include "worker_pool.h"                // Image writer threads.
+#include <glm/gtc/matrix_transform.hpp> // Provides glm::perspective.
+#include <chrono>                       // Throughput measurement.
+#include <cstdio>                       // snprintf, builds the image file names.
+#include <filesystem>                   // Creates the output directory.
+#include <string>                       // Output directory.
+#include <thread>                       // std::thread::hardware_concurrency.
+
+// Function to pick the number of image writer threads.
+int defaultWriterThreads()
+{
+    int cores = (int)std::thread::hardware_concurrency();
+    return cores > 1 ? cores - 1 : 1;
+}
+
+// Function to render camera path frames into image files.
+// path: Camera of every frame.
+// options: Image size, output directory and writer thread count.
+// claimFrame: Hands out the frame indices to render, so several processes can share one path.
+// stats: Receives the timing of the run.
+bool renderCameraPathFrames(const std::vector<CameraKey> &path, const AppOptions &options,
+                            const FrameClaimFunction &claimFrame, BatchStats &stats)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    UniqueProgram shaderProgram(createShaderProgram(readFile("vertex_shader.glsl"), readFile("fragment_shader.glsl")));
+    if (!shaderProgram)
+        return false;
+    labelGlObject(GL_PROGRAM, shaderProgram.name(), "pyramid program");
+
+    OffscreenTarget target;
+    if (!createOffscreenTarget(target, options.outputWidth, options.outputHeight))
+        return false;
+    PyramidMesh pyramid = createPyramidMesh();
+
+    std::error_code error;
+    std::filesystem::create_directories(options.outputDirectory, error);
+
+    {
+        // The ring has a couple of slots more than writers, so the GPU copy of the next frames overlaps the writes.
+        int writerCount = options.writerThreads > 0 ? options.writerThreads : defaultWriterThreads();
+        WorkerPool writers(writerCount);
+        FrameReadback readback(writers, writerCount + 2);
+
+        glm::mat4 projection = glm::perspective(glm::radians(45.0f), (float)target.width / (float)target.height, 0.1f, 100.0f);
+        const std::string *directory = &options.outputDirectory;
+
+        for (int frame = claimFrame(); frame >= 0; frame = claimFrame())
+        {
+            auto frameStart = std::chrono::steady_clock::now();
+            GlDebugGroup group("batch frame");
+
+            // Draw the frame exactly like the interactive view, but into the offscreen framebuffer
+            bindOffscreenTarget(target);
+            glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            drawPyramids(shaderProgram.name(), pyramid, cameraKeyViewMatrix(path[frame]), projection);
+
+            // Writers behind: wait here rather than dropping frames
+            auto waitStart = std::chrono::steady_clock::now();
+            if (!readback.hasFreeSlot())
+                readback.waitForFreeSlot();
+            auto waitEnd = std::chrono::steady_clock::now();
+
+            readback.request(0, 0, target.width, target.height, frame, [directory](const ReadbackImage &image)
+                             {
+                                 char path[1024];
+                                 std::snprintf(path, sizeof(path), "%s/frame_%06lld.tga", directory->c_str(), image.frameIndex);
+                                 if (image.pixels == nullptr || !writeTga(path, image.pixels, image.width, image.height))
+                                     logError("Failed to write {}", path);
+                             });
+            readback.poll();
+            enforceGpuMemoryBudgets();
+            ++stats.framesRendered;
+
+            auto frameEnd = std::chrono::steady_clock::now();
+            stats.waitSeconds += std::chrono::duration<double>(waitEnd - waitStart).count();
+            stats.renderSeconds += std::chrono::duration<double>(frameEnd - frameStart).count() -
+                                   std::chrono::duration<double>(waitEnd - waitStart).count();
+        }
+        readback.finish(); // Every image is on disk once this returns.
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    destroyPyramidMesh(pyramid);
+    destroyOffscreenTarget(target);
+
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return true;
+}
+
+// Function to render frames in a hidden context of this process.
+// Initializes and terminates GLFW around the work, so it can run in a freshly forked farm worker as well.
+static bool renderWithHiddenContext(const std::vector<CameraKey> &path, const AppOptions &options,
+                                    const FrameClaimFunction &claimFrame, BatchStats &stats)
+{
+    if (!glfwInit())
+        return false;
+
+    // A hidden 1x1 window only provides the context; all drawing goes to the offscreen framebuffer.
+    ContextSettings contextSettings;
+    contextSettings.width = 1;
+    contextSettings.height = 1;
+    contextSettings.title = "Batch renderer";
+    contextSettings.visible = false;
+    contextSettings.debugOutput = options.glDebug;
+    GLFWwindow *window = createContextWindow(contextSettings);
+    bool ok = window != nullptr;
+    if (ok)
+    {
+        glfwSwapInterval(0); // Never wait for a display refresh.
+        ok = renderCameraPathFrames(path, options, claimFrame, stats);
+        destroyDeferredGlObjects(); // The mesh and program released by the render function
+        glfwDestroyWindow(window);
+    }
+    glfwTerminate();
+    return ok;
+}
+
+// Function to run the --batch mode.
+int runBatchRenderer(const AppOptions &options)
+{
+    std::vector<CameraKey> path;
+    if (!loadCameraPath(options.batchPath.c_str(), path))
+        return -1;
+    int frameCount = (int)path.size();
+
+    if (options.farmWorkers > 1)
+    {
+        // Share the cores between the workers: each renders on one and writes images on the rest of its share.
+        AppOptions workerOptions = options;
+        if (workerOptions.writerThreads <= 0)
+        {
+            int cores = defaultWriterThreads() + 1;
+            workerOptions.writerThreads = cores / options.farmWorkers > 1 ? cores / options.farmWorkers - 1 : 1;
+        }
+
+        int failed = runRenderFarm(options.farmWorkers, frameCount, [&](int, const FarmClaimFunction &claim)
+                                   {
+                                       BatchStats stats;
+                                       return renderWithHiddenContext(path, workerOptions, claim, stats);
+                                   });
+
+        // Collect the outputs: every frame must have produced its image.
+        int missing = 0;
+        for (int frame = 0; frame < frameCount; ++frame)
+        {
+            char file[1024];
+            std::snprintf(file, sizeof(file), "%s/frame_%06d.tga", options.outputDirectory.c_str(), frame);
+            std::error_code error;
+            if (!std::filesystem::exists(file, error))
+                ++missing;
+        }
+        if (missing > 0)
+            logError("{} of {} images are missing", missing, frameCount);
+        return failed == 0 && missing == 0 ? 0 : -1;
+    }
+
+    // Frames are handed out in path order.
+    int nextFrame = 0;
+    FrameClaimFunction claimFrame = [&nextFrame, frameCount]
+    { return nextFrame < frameCount ? nextFrame++ : -1; };
+
+    BatchStats stats;
+    if (!renderWithHiddenContext(path, options, claimFrame, stats))
+        return -1;
+
+    logInfo("Rendered {} frames in {} s ({} images/s), render {} s, waiting for writers {} s", stats.framesRendered, stats.seconds,
+            stats.seconds > 0.0 ? stats.framesRendered / stats.seconds : 0.0, stats.renderSeconds, stats.waitSeconds);
+    return 0;
+}
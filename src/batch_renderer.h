@@ -0,0 +1,37 @@
+#ifndef BATCH_RENDERER_H
+#define BATCH_RENDERER_H
+
+// Headless rendering of camera paths into numbered image files.
+// Frames are rendered into an offscreen framebuffer and read back through the PBO ring; a pool of writer
+// threads encodes the images while the render thread already draws the next frames.
+#include "camera_path.h" // Camera path frames.
+#include "options.h"     // Output size, directory and thread count.
+#include <functional>    // std::function for the frame source.
+#include <vector>        // The camera path.
+
+// Statistics of one batch run.
+struct BatchStats
+{
+    int framesRendered = 0;    // Images written.
+    double seconds = 0.0;      // Wall-clock time from the first frame to the last image on disk.
+    double renderSeconds = 0.0; // Time spent issuing the draw calls and readbacks.
+    double waitSeconds = 0.0;   // Time spent waiting for a free readback slot (writers behind).
+};
+
+// Returns the index of the next frame to render, or -1 once there are no frames left.
+using FrameClaimFunction = std::function<int()>;
+
+// Renders the frames handed out by claimFrame into <outputDirectory>/frame_<index>.tga.
+// Needs a current OpenGL context. Returns false if the GPU resources could not be created.
+bool renderCameraPathFrames(const std::vector<CameraKey> &path, const AppOptions &options,
+                            const FrameClaimFunction &claimFrame, BatchStats &stats);
+
+// Entry point of --batch: renders every frame of the path in this process, or with --farm across worker
+// processes, and prints the throughput. Initializes GLFW itself, so it must be called before glfwInit.
+// Returns the process exit code.
+int runBatchRenderer(const AppOptions &options);
+
+// Image writer threads used when --threads is not given: one per core not used by the render thread.
+int defaultWriterThreads();
+
+#endif
@@ -0,0 +1,50 @@
+#include "camera_path.h"
+#include "logger.h"                     // Error messages.
+#include <glm/gtc/matrix_transform.hpp> // Provides glm::lookAt.
+#include <cstdio>                       // std::sscanf, parses the numbers of a line.
+#include <fstream>                      // File stream, used for reading the path file.
+#include <string>                       // Used for the lines of the file.
+
+// Function to read a camera path file.
+// filePath: Path to the camera path file.
+// frames: Receives one entry per frame, in file order.
+bool loadCameraPath(const char *filePath, std::vector<CameraKey> &frames)
+{
+    std::ifstream fileStream(filePath, std::ios::in);
+    if (!fileStream.is_open())
+    {
+        logError("Could not read camera path {}. File does not exist.", filePath);
+        return false;
+    }
+
+    frames.clear();
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(fileStream, line))
+    {
+        ++lineNumber;
+        std::string::size_type first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#')
+            continue; // Empty line or comment.
+
+        CameraKey key;
+        key.up = glm::vec3(0.0f, 1.0f, 0.0f);
+        int count = std::sscanf(line.c_str(), "%f %f %f %f %f %f %f %f %f",
+                                &key.position.x, &key.position.y, &key.position.z,
+                                &key.target.x, &key.target.y, &key.target.z,
+                                &key.up.x, &key.up.y, &key.up.z);
+        if (count != 6 && count != 9)
+        {
+            logError("{}:{}: expected 6 or 9 numbers", filePath, lineNumber);
+            return false;
+        }
+        frames.push_back(key);
+    }
+    return true;
+}
+
+// Function to build the view matrix of a camera path frame.
+glm::mat4 cameraKeyViewMatrix(const CameraKey &key)
+{
+    return glm::lookAt(key.position, key.target, key.up);
+}
@@ -0,0 +1,20 @@
+#ifndef CAMERA_PATH_H
+#define CAMERA_PATH_H
+
+// Scripted camera paths for the offline render modes.
+// A camera path file has one frame per line: "px py pz tx ty tz [ux uy uz]", the camera position, the point
+// it looks at and an optional up vector (default +Y). Empty lines and lines starting with '#' are ignored.
+#include <glm/glm.hpp> // GLM provides the vector types.
+#include <vector>      // Storage for the frames.
+
+struct CameraKey
+{
+    glm::vec3 position; // Camera position.
+    glm::vec3 target;   // Point the camera looks at.
+    glm::vec3 up;       // Up direction of the camera.
+};
+
+bool loadCameraPath(const char *filePath, std::vector<CameraKey> &frames); // Parses a camera path file; prints the first error and returns false if it is malformed.
+glm::mat4 cameraKeyViewMatrix(const CameraKey &key);                      // View matrix of a camera path frame.
+
+#endif
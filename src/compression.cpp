@@ -0,0 +1,147 @@
+#include "compression.h"
+#include <cstdint> // Hash table entries.
+#include <cstring> // std::memcpy.
+
+static const int minMatch = 4;         // Shortest match worth a sequence.
+static const int lastLiterals = 5;     // The format ends every block with at least this many literals,
+static const int matchStartLimit = 12; // and no match may start closer than this to the end.
+static const int hashBits = 12;        // 4096 entries: fits in L1, good enough for assets.
+static const int maxOffset = 65535;
+
+static uint32_t read32(const char *p)
+{
+    uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static uint32_t hashSequence(uint32_t sequence)
+{
+    return (sequence * 2654435761u) >> (32 - hashBits);
+}
+
+// Function to append a length that does not fit into its 4 bits of the token: 255 per byte, then the rest.
+static char *writeLength(char *out, int length)
+{
+    for (; length >= 255; length -= 255)
+        *out++ = (char)255;
+    *out++ = (char)length;
+    return out;
+}
+
+// Function to write one sequence: token, literals and, unless it is the last sequence, the match.
+static char *writeSequence(char *out, const char *literals, int literalLength, int offset, int matchLength)
+{
+    char *token = out++;
+    int matchCode = matchLength - minMatch;
+    *token = (char)(((literalLength < 15 ? literalLength : 15) << 4) | (matchLength == 0 ? 0 : (matchCode < 15 ? matchCode : 15)));
+    if (literalLength >= 15)
+        out = writeLength(out, literalLength - 15);
+    if (literalLength > 0)
+        std::memcpy(out, literals, literalLength);
+    out += literalLength;
+    if (matchLength == 0)
+        return out; // Last sequence: literals only
+    *out++ = (char)(offset & 0xFF);
+    *out++ = (char)(offset >> 8);
+    if (matchCode >= 15)
+        out = writeLength(out, matchCode - 15);
+    return out;
+}
+
+int compressBoundLz4(int size)
+{
+    return size + size / 255 + 16;
+}
+
+// Function to compress a block: greedy matching against the last position of every hashed 4-byte sequence.
+int compressLz4(const char *source, int size, char *destination)
+{
+    char *out = destination;
+    int anchor = 0; // Start of the literals not written yet.
+    if (size > matchStartLimit)
+    {
+        int table[1 << hashBits];
+        for (int &entry : table)
+            entry = -1;
+        int matchEnd = size - lastLiterals; // Matches may extend up to here
+        int position = 0;
+        while (position < size - matchStartLimit)
+        {
+            uint32_t sequence = read32(source + position);
+            int &slot = table[hashSequence(sequence)];
+            int candidate = slot;
+            slot = position;
+            if (candidate < 0 || position - candidate > maxOffset || read32(source + candidate) != sequence)
+            {
+                ++position;
+                continue;
+            }
+            int length = minMatch;
+            while (position + length < matchEnd && source[candidate + length] == source[position + length])
+                ++length;
+            out = writeSequence(out, source + anchor, position - anchor, position - candidate, length);
+            position += length;
+            anchor = position;
+        }
+    }
+    out = writeSequence(out, source + anchor, size - anchor, 0, 0);
+    return (int)(out - destination);
+}
+
+// Function to read a length continued in extra bytes. Returns false if the input ends first.
+static bool readLength(const unsigned char *&in, const unsigned char *end, int &length)
+{
+    unsigned char byte;
+    do
+    {
+        if (in >= end)
+            return false;
+        byte = *in++;
+        length += byte;
+        if (length > (1 << 30))
+            return false; // Longer than any block; damaged input
+    } while (byte == 255);
+    return true;
+}
+
+bool decompressLz4(const char *source, int compressedSize, char *destination, int rawSize)
+{
+    const unsigned char *in = (const unsigned char *)source;
+    const unsigned char *inEnd = in + compressedSize;
+    char *out = destination;
+    char *outEnd = destination + rawSize;
+    while (in < inEnd)
+    {
+        unsigned char token = *in++;
+        int literalLength = token >> 4;
+        if (literalLength == 15 && !readLength(in, inEnd, literalLength))
+            return false;
+        if (literalLength > inEnd - in || literalLength > outEnd - out)
+            return false;
+        std::memcpy(out, in, literalLength);
+        in += literalLength;
+        out += literalLength;
+        if (in == inEnd)
+            break; // The last sequence has no match
+
+        if (inEnd - in < 2)
+            return false;
+        int offset = in[0] | (in[1] << 8);
+        in += 2;
+        int matchLength = token & 15;
+        if (matchLength == 15 && !readLength(in, inEnd, matchLength))
+            return false;
+        matchLength += minMatch;
+        if (offset == 0 || offset > out - destination || matchLength > outEnd - out)
+            return false;
+        const char *match = out - offset;
+        if (offset >= matchLength)
+            std::memcpy(out, match, matchLength);
+        else
+            for (int i = 0; i < matchLength; ++i) // Overlapping: repeats the last offset bytes
+                out[i] = match[i];
+        out += matchLength;
+    }
+    return out == outEnd;
+}
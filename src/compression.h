@@ -0,0 +1,22 @@
+#ifndef COMPRESSION_H
+#define COMPRESSION_H
+
+// Fast block compression for the asset packs, in the LZ4 block format: a sequence is a token byte (literal
+// length and match length, 4 bits each), the literals, and a 2-byte offset back into the output. Decoding
+// is a loop of copies, roughly memory bandwidth on one core, which is what matters for loading; the
+// compressor is a simple greedy one, since it only runs in pack_builder.
+// Blocks are independent, so the chunks of a pack can be decompressed in parallel.
+
+const int lz4MaxInputSize = 0x7E000000; // Largest block the format takes; its compressed bound still fits in an int.
+
+int compressBoundLz4(int size); // Largest compressed size of size input bytes, for size up to lz4MaxInputSize.
+
+// Compresses size bytes of source into destination (at least compressBoundLz4(size) bytes).
+// Returns the compressed size.
+int compressLz4(const char *source, int size, char *destination);
+
+// Decompresses a block that must expand to exactly rawSize bytes. Checks every length and offset against
+// the buffers, so damaged input fails instead of reading or writing out of bounds. Returns false if it does.
+bool decompressLz4(const char *source, int compressedSize, char *destination, int rawSize);
+
+#endif
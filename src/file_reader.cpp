@@ -0,0 +1,507 @@
+#include "file_reader.h"
+#include "logger.h"     // Setup failures.
+#include <algorithm>    // Heap operations on the request queue.
+#include <cstring>      // std::strcmp, std::memcpy, std::memset.
+#include <fcntl.h>      // open.
+#include <sys/stat.h>   // fstat.
+#include <unistd.h>     // pread, close.
+#ifdef __linux__
+#include <linux/io_uring.h> // Ring layout and opcodes; the system calls are made directly, without liburing.
+#include <sys/mman.h>       // Mapping the rings and the buffers.
+#include <sys/syscall.h>    // __NR_io_uring_*.
+#include <sys/uio.h>        // iovec for the buffer registration.
+#endif
+
+bool parseFileReaderBackend(const char *name, FileReaderBackend &backend)
+{
+    static const char *const backendNames[] = {"auto", "uring", "threads"};
+    for (int i = 0; i < 3; ++i)
+        if (std::strcmp(name, backendNames[i]) == 0)
+        {
+            backend = (FileReaderBackend)i;
+            return true;
+        }
+    return false;
+}
+
+#ifdef __linux__
+
+// State of the io_uring: the mapped submission and completion rings, the registered buffers and one slot per
+// file in flight. Every slot has at most one operation in the ring, so user_data is simply the slot index.
+struct FileReader::Ring
+{
+    enum class Stage
+    {
+        Open,
+        Read,
+        Close
+    };
+
+    struct Slot
+    {
+        Request request;
+        Stage stage = Stage::Open;
+        int fd = -1;
+        char *buffer = nullptr;  // Registered buffer of the slot.
+        std::vector<char> large; // Contents of files that did not fit into the buffer.
+        long long size = 0;      // Bytes read so far.
+        unsigned requested = 0;  // Length of the read in flight.
+        bool failed = false;
+    };
+
+    int fd = -1;
+    unsigned *sqHead = nullptr, *sqTail = nullptr, *sqMask = nullptr, *sqArray = nullptr;
+    unsigned *cqHead = nullptr, *cqTail = nullptr, *cqMask = nullptr;
+    io_uring_sqe *sqes = nullptr;
+    io_uring_cqe *cqes = nullptr;
+    void *sqRing = MAP_FAILED, *cqRing = MAP_FAILED;
+    size_t sqRingSize = 0, cqRingSize = 0, sqesSize = 0;
+    char *bufferMemory = (char *)MAP_FAILED;
+    size_t bufferMemorySize = 0;
+    int bufferSize = 0;
+    bool registeredBuffers = false;
+
+    std::vector<Slot> slots;
+    std::vector<int> freeSlots;
+    unsigned toSubmit = 0; // Prepared entries not passed to the kernel yet.
+    int inFlight = 0;      // Operations submitted or prepared, not completed.
+
+    ~Ring()
+    {
+        if (sqes != nullptr)
+            munmap(sqes, sqesSize);
+        if (cqRing != MAP_FAILED && cqRing != sqRing)
+            munmap(cqRing, cqRingSize);
+        if (sqRing != MAP_FAILED)
+            munmap(sqRing, sqRingSize);
+        if (bufferMemory != MAP_FAILED)
+            munmap(bufferMemory, bufferMemorySize);
+        if (fd >= 0)
+            close(fd); // Also unregisters the buffers
+    }
+
+    // Function to fill the next submission queue entry. The ring never holds more entries than slots, so it cannot overflow.
+    io_uring_sqe &prepare(int slot, uint8_t opcode, int fileDescriptor)
+    {
+        unsigned tail = *sqTail;
+        unsigned index = tail & *sqMask;
+        io_uring_sqe &sqe = sqes[index];
+        std::memset(&sqe, 0, sizeof(sqe));
+        sqe.opcode = opcode;
+        sqe.fd = fileDescriptor;
+        sqe.user_data = (uint64_t)slot;
+        sqArray[index] = index;
+        __atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE); // The kernel may read the entry once it sees the tail
+        ++toSubmit;
+        ++inFlight;
+        return sqe;
+    }
+
+    void prepareOpen(int index)
+    {
+        Slot &slot = slots[index];
+        slot.stage = Stage::Open;
+        io_uring_sqe &sqe = prepare(index, IORING_OP_OPENAT, AT_FDCWD);
+        sqe.addr = (uint64_t)(uintptr_t)slot.request.path.c_str();
+        sqe.open_flags = O_RDONLY | O_CLOEXEC;
+    }
+
+    // Function to read the next part of the file: into the registered buffer first, into the heap buffer after that.
+    void prepareRead(int index)
+    {
+        Slot &slot = slots[index];
+        slot.stage = Stage::Read;
+        bool fixed = slot.large.empty() && registeredBuffers;
+        io_uring_sqe &sqe = prepare(index, fixed ? IORING_OP_READ_FIXED : IORING_OP_READ, slot.fd);
+        char *target = slot.large.empty() ? slot.buffer : slot.large.data();
+        long long capacity = slot.large.empty() ? bufferSize : (long long)slot.large.size();
+        slot.requested = (unsigned)std::min(capacity - slot.size, (long long)1 << 30);
+        sqe.addr = (uint64_t)(uintptr_t)(target + slot.size);
+        sqe.len = slot.requested;
+        sqe.off = (uint64_t)slot.size;
+        if (fixed)
+            sqe.buf_index = (uint16_t)index;
+    }
+
+    void prepareClose(int index)
+    {
+        slots[index].stage = Stage::Close;
+        prepare(index, IORING_OP_CLOSE, slots[index].fd);
+    }
+};
+
+// Function to create the io_uring, map its rings and register one buffer per slot.
+// Returns false, leaving no state behind, if the kernel lacks io_uring or the operations used here (Linux 5.6).
+bool FileReader::startRing(int queueDepth, int bufferSize)
+{
+    std::unique_ptr<Ring> state(new Ring());
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    state->fd = (int)syscall(__NR_io_uring_setup, (unsigned)queueDepth, &params);
+    if (state->fd < 0)
+    {
+        logDebug("io_uring is not available (error {}); reading files with threads", errno);
+        return false;
+    }
+    if ((params.features & IORING_FEAT_RW_CUR_POS) == 0) // Arrived with IORING_OP_OPENAT, IORING_OP_READ and IORING_OP_CLOSE
+    {
+        logDebug("The kernel's io_uring lacks the file operations; reading files with threads");
+        return false;
+    }
+
+    // Map the submission ring, the completion ring (the same mapping on most kernels) and the entries
+    state->sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    state->cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (singleMap)
+        state->sqRingSize = state->cqRingSize = std::max(state->sqRingSize, state->cqRingSize);
+    state->sqRing = mmap(nullptr, state->sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, state->fd, IORING_OFF_SQ_RING);
+    state->cqRing = singleMap ? state->sqRing
+                              : mmap(nullptr, state->cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, state->fd, IORING_OFF_CQ_RING);
+    state->sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+    void *sqes = mmap(nullptr, state->sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, state->fd, IORING_OFF_SQES);
+    if (state->sqRing == MAP_FAILED || state->cqRing == MAP_FAILED || sqes == MAP_FAILED)
+    {
+        logWarning("Could not map the io_uring (error {}); reading files with threads", errno);
+        return false;
+    }
+    state->sqes = (io_uring_sqe *)sqes;
+    char *sq = (char *)state->sqRing;
+    char *cq = (char *)state->cqRing;
+    state->sqHead = (unsigned *)(sq + params.sq_off.head);
+    state->sqTail = (unsigned *)(sq + params.sq_off.tail);
+    state->sqMask = (unsigned *)(sq + params.sq_off.ring_mask);
+    state->sqArray = (unsigned *)(sq + params.sq_off.array);
+    state->cqHead = (unsigned *)(cq + params.cq_off.head);
+    state->cqTail = (unsigned *)(cq + params.cq_off.tail);
+    state->cqMask = (unsigned *)(cq + params.cq_off.ring_mask);
+    state->cqes = (io_uring_cqe *)(cq + params.cq_off.cqes);
+
+    // One page-aligned buffer per slot, registered so the kernel pins it once instead of on every read
+    state->bufferSize = bufferSize;
+    state->bufferMemorySize = (size_t)queueDepth * bufferSize;
+    state->bufferMemory = (char *)mmap(nullptr, state->bufferMemorySize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (state->bufferMemory == MAP_FAILED)
+        return false;
+    std::vector<iovec> buffers(queueDepth);
+    state->slots.resize(queueDepth);
+    for (int i = 0; i < queueDepth; ++i)
+    {
+        state->slots[i].buffer = state->bufferMemory + (size_t)i * bufferSize;
+        buffers[i].iov_base = state->slots[i].buffer;
+        buffers[i].iov_len = bufferSize;
+        state->freeSlots.push_back(queueDepth - 1 - i);
+    }
+    state->registeredBuffers = syscall(__NR_io_uring_register, state->fd, IORING_REGISTER_BUFFERS, buffers.data(), (unsigned)queueDepth) == 0;
+    if (!state->registeredBuffers) // Usually RLIMIT_MEMLOCK; plain reads into the same buffers still batch
+        logDebug("Could not register the io_uring buffers (error {}); using unregistered reads", errno);
+
+    ring = std::move(state);
+    return true;
+}
+
+// Loop of the ring thread: starts queued files in free slots, submits everything prepared and waits for at least
+// one completion in a single io_uring_enter, then advances the files whose operation completed.
+// Exits once the reader is stopping and no file is queued or in flight.
+void FileReader::ringMain()
+{
+    Ring &state = *ring;
+    for (;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            if (state.inFlight == 0)
+            {
+                wake.wait(lock, [this] { return stopping || !queue.empty(); });
+                if (queue.empty())
+                    return; // Only reached when stopping.
+            }
+            Request request;
+            while (!state.freeSlots.empty() && popRequest(request))
+            {
+                int index = state.freeSlots.back();
+                state.freeSlots.pop_back();
+                Ring::Slot &slot = state.slots[index];
+                slot.request = std::move(request);
+                slot.size = 0;
+                slot.failed = false;
+                state.prepareOpen(index);
+            }
+        }
+
+        int entered = (int)syscall(__NR_io_uring_enter, state.fd, state.toSubmit, 1u, IORING_ENTER_GETEVENTS, nullptr, 0);
+        systemCalls.fetch_add(1, std::memory_order_relaxed);
+        if (entered >= 0)
+            state.toSubmit -= (unsigned)entered;
+        else if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+        {
+            // Not a transient error, so retrying would only spin. The files in the slots are read again from the
+            // start with pread; completions the kernel may still post are never reaped, and the ring memory
+            // stays mapped until the reader is destroyed.
+            logError("io_uring_enter failed (error {}); reading the remaining files with pread", errno);
+            ringFailed = true;
+            for (Ring::Slot &slot : state.slots)
+                if (slot.request.done) // Not finished yet; slots that only had their close pending have no callback
+                    readBlocking(slot.request);
+            readWithoutRing();
+            return;
+        }
+
+        // Reap the completions
+        unsigned head = *state.cqHead;
+        unsigned tail = __atomic_load_n(state.cqTail, __ATOMIC_ACQUIRE);
+        for (; head != tail; ++head)
+        {
+            const io_uring_cqe &cqe = state.cqes[head & *state.cqMask];
+            int index = (int)cqe.user_data;
+            int result = cqe.res;
+            __atomic_store_n(state.cqHead, head + 1, __ATOMIC_RELEASE); // The entry is copied; the kernel may reuse it
+            --state.inFlight;
+
+            Ring::Slot &slot = state.slots[index];
+            bool complete = false;
+            switch (slot.stage)
+            {
+            case Ring::Stage::Open:
+                if (result < 0)
+                {
+                    FileReadResult failure;
+                    failure.path = &slot.request.path;
+                    finished(slot.request, failure);
+                    state.freeSlots.push_back(index);
+                    break;
+                }
+                slot.fd = result;
+                state.prepareRead(index);
+                break;
+            case Ring::Stage::Read:
+                if (result < 0)
+                {
+                    slot.failed = true;
+                    complete = true;
+                    break;
+                }
+                slot.size += result;
+                if ((unsigned)result < slot.requested)
+                {
+                    complete = true; // A short read of a regular file is the end of it
+                    break;
+                }
+                // The buffer is full: the file may go on, so continue in a heap buffer of twice the size
+                if (slot.large.empty())
+                {
+                    slot.large.resize((size_t)state.bufferSize * 2);
+                    std::memcpy(slot.large.data(), slot.buffer, (size_t)slot.size);
+                }
+                else if (slot.size == (long long)slot.large.size())
+                    slot.large.resize(slot.large.size() * 2);
+                state.prepareRead(index);
+                break;
+            case Ring::Stage::Close:
+                std::vector<char>().swap(slot.large);
+                state.freeSlots.push_back(index);
+                break;
+            }
+
+            if (complete)
+            {
+                FileReadResult contents;
+                contents.path = &slot.request.path;
+                contents.ok = !slot.failed;
+                if (contents.ok)
+                {
+                    contents.data = slot.large.empty() ? slot.buffer : slot.large.data();
+                    contents.size = slot.size;
+                }
+                finished(slot.request, contents);
+                state.prepareClose(index);
+            }
+        }
+    }
+}
+
+#else
+
+struct FileReader::Ring
+{
+};
+
+bool FileReader::startRing(int, int)
+{
+    return false;
+}
+
+void FileReader::ringMain()
+{
+}
+
+#endif
+
+// Constructor: starts the io_uring backend if requested and available, the thread backend otherwise.
+// backend: Auto, IoUring or Threads; IoUring falls back to threads with a warning when the ring cannot be created.
+// queueDepth, bufferSize: Files in flight at once on the ring, and the size of the registered buffer of each.
+// threadCount: Threads of the fallback backend.
+FileReader::FileReader(FileReaderBackend backend, int queueDepth, int threadCount, int bufferSize)
+{
+    if (backend != FileReaderBackend::Threads && startRing(queueDepth < 1 ? 1 : queueDepth, bufferSize < 4096 ? 4096 : bufferSize))
+    {
+        active = FileReaderBackend::IoUring;
+        ringThread = std::thread(&FileReader::ringMain, this);
+        return;
+    }
+    if (backend == FileReaderBackend::IoUring)
+        logWarning("io_uring is not available; reading files with threads");
+    active = FileReaderBackend::Threads;
+    threads.reset(new WorkerPool(threadCount));
+}
+
+// Destructor: completes the queued reads, then stops the threads.
+FileReader::~FileReader()
+{
+    waitIdle();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    if (ringThread.joinable())
+        ringThread.join();
+    threads.reset();
+}
+
+// Function to queue the read of a file.
+// path: File to read. priority: Higher values start first.
+// done: Receives the contents on the reader's thread.
+void FileReader::read(const std::string &path, int priority, FileReadCallback done)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back({path, priority, nextSequence++, std::move(done)});
+        std::push_heap(queue.begin(), queue.end(), [](const Request &a, const Request &b)
+                       { return a.priority != b.priority ? a.priority < b.priority : a.sequence > b.sequence; });
+        ++outstanding;
+    }
+    if (active == FileReaderBackend::IoUring)
+        wake.notify_one();
+    else
+        threads->submit([this] // One job per request; each takes whichever request is most urgent by then
+                        {
+                            Request request;
+                            {
+                                std::lock_guard<std::mutex> lock(mutex);
+                                if (!popRequest(request))
+                                    return;
+                            }
+                            readBlocking(request);
+                        });
+}
+
+// Function to wait until every queued read has completed and its callback has returned.
+void FileReader::waitIdle()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return outstanding == 0; });
+}
+
+// Function to take the most urgent request off the queue. The caller holds the lock.
+bool FileReader::popRequest(Request &request)
+{
+    if (queue.empty())
+        return false;
+    std::pop_heap(queue.begin(), queue.end(), [](const Request &a, const Request &b)
+                  { return a.priority != b.priority ? a.priority < b.priority : a.sequence > b.sequence; });
+    request = std::move(queue.back());
+    queue.pop_back();
+    return true;
+}
+
+// Function to pass the contents to the callback of a request and count the read as complete.
+void FileReader::finished(Request &request, const FileReadResult &result)
+{
+    if (result.ok)
+    {
+        filesRead.fetch_add(1, std::memory_order_relaxed);
+        bytesRead.fetch_add(result.size, std::memory_order_relaxed);
+    }
+    else
+    {
+        filesFailed.fetch_add(1, std::memory_order_relaxed);
+        logError("Could not read the file {}", request.path);
+    }
+    request.done(result);
+    request.done = nullptr; // Releases what the callback captured
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (--outstanding == 0)
+        idle.notify_all();
+}
+
+// Function to read a whole file with blocking calls, on a thread of the fallback backend.
+void FileReader::readBlocking(Request &request)
+{
+    FileReadResult result;
+    result.path = &request.path;
+    std::vector<char> contents;
+    int fd = open(request.path.c_str(), O_RDONLY | O_CLOEXEC);
+    long long calls = 1;
+    if (fd >= 0)
+    {
+        struct stat status;
+        ++calls;
+        if (fstat(fd, &status) == 0)
+        {
+            contents.resize((size_t)status.st_size + 1); // One more byte, so a file that grew is noticed
+            long long size = 0;
+            for (;;)
+            {
+                ssize_t count = pread(fd, contents.data() + size, contents.size() - size, size);
+                ++calls;
+                if (count <= 0)
+                {
+                    result.ok = count == 0;
+                    break;
+                }
+                size += count;
+                if (size == (long long)contents.size())
+                    contents.resize(contents.size() * 2);
+            }
+            result.data = result.ok ? contents.data() : nullptr;
+            result.size = result.ok ? size : 0;
+        }
+        close(fd);
+        ++calls;
+    }
+    systemCalls.fetch_add(calls, std::memory_order_relaxed);
+    finished(request, result);
+}
+
+// Function to read the queued files with blocking calls on the ring thread, once the ring has failed.
+// Exits once the reader is stopping and no file is queued, as the ring loop does.
+void FileReader::readWithoutRing()
+{
+    for (;;)
+    {
+        Request request;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this] { return stopping || !queue.empty(); });
+            if (!popRequest(request))
+                return; // Only reached when stopping.
+        }
+        readBlocking(request);
+    }
+}
+
+// Function to print the backend and the counters of the reader.
+void FileReader::printSummary(std::ostream &out) const
+{
+    const char *backendName = "threads (pread)";
+#ifdef __linux__
+    if (active == FileReaderBackend::IoUring)
+        backendName = ringFailed ? "io_uring, then pread after a failure"
+                      : ring->registeredBuffers ? "io_uring, registered buffers" : "io_uring";
+#endif
+    out << "File reads (" << backendName << "): " << filesRead.load() << " files, " << filesFailed.load() << " failed, "
+        << bytesRead.load() / 1024 << " KiB, " << systemCalls.load() << " system calls\n"
+        << std::flush;
+}
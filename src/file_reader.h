@@ -0,0 +1,102 @@
+#ifndef FILE_READER_H
+#define FILE_READER_H
+
+// Batched whole-file reads for the asset pipeline.
+// Loading thousands of small files one blocking open/read/close at a time is bound by system calls and
+// thread hand-offs rather than by the disk. On Linux the reader drives an io_uring from a single thread:
+// the opens, reads and closes of all queued files are submitted in batches with one io_uring_enter call,
+// and reads land in buffers registered with the kernel once, so they are not mapped and unmapped per read.
+// Files larger than such a buffer continue in a heap buffer. Where io_uring is missing or refused (older
+// kernels, containers that filter it, other systems), a few threads do blocking pread calls instead.
+//
+// Completion callbacks run on the reader's thread (the ring thread or a fallback thread) and must not block
+// it: hand parsing and other heavy work to another thread.
+#include "worker_pool.h"       // Threads of the fallback backend.
+#include <atomic>              // Counters read by the summary.
+#include <condition_variable>  // Wakes the ring thread; waitIdle.
+#include <functional>          // Completion callbacks.
+#include <memory>              // Owns the ring state.
+#include <mutex>               // Protects the request queue.
+#include <ostream>             // Summary output.
+#include <string>              // File paths.
+#include <thread>              // The ring thread.
+#include <vector>              // Request queue.
+
+enum class FileReaderBackend
+{
+    Auto,    // io_uring when the kernel allows it, threads otherwise.
+    IoUring,
+    Threads
+};
+
+bool parseFileReaderBackend(const char *name, FileReaderBackend &backend); // auto, uring or threads.
+
+// Contents of one file, valid only during the callback. data is null and ok false if the file could not be read.
+struct FileReadResult
+{
+    const std::string *path = nullptr;
+    const char *data = nullptr;
+    long long size = 0;
+    bool ok = false;
+};
+
+using FileReadCallback = std::function<void(const FileReadResult &result)>;
+
+class FileReader
+{
+public:
+    // queueDepth: files in flight at once on the io_uring backend, each with a registered buffer of bufferSize bytes.
+    // threads: threads of the fallback backend.
+    explicit FileReader(FileReaderBackend backend = FileReaderBackend::Auto, int queueDepth = 32, int threads = 4,
+                        int bufferSize = 64 * 1024);
+    ~FileReader(); // Completes the queued reads.
+
+    FileReader(const FileReader &) = delete;
+    FileReader &operator=(const FileReader &) = delete;
+
+    // Queues the read of a whole file. Higher priorities are started first; equal ones in request order.
+    // Callable from any thread.
+    void read(const std::string &path, int priority, FileReadCallback done);
+    void waitIdle(); // Blocks until every queued read has completed.
+
+    FileReaderBackend backend() const { return active; } // IoUring or Threads.
+    void printSummary(std::ostream &out) const;          // Backend, files, bytes and system calls.
+
+private:
+    struct Request
+    {
+        std::string path;
+        int priority;
+        long long sequence;
+        FileReadCallback done;
+    };
+    struct Ring; // io_uring state, Linux only.
+
+    bool startRing(int queueDepth, int bufferSize);
+    void ringMain();                     // Loop of the ring thread.
+    void readWithoutRing();              // Rest of the ring thread after io_uring_enter failed for good.
+    void readBlocking(Request &request); // Fallback: open, pread until the end, close.
+    bool popRequest(Request &request);   // Most urgent queued request; false if none. Needs the lock.
+    void finished(Request &request, const FileReadResult &result);
+
+    FileReaderBackend active = FileReaderBackend::Threads;
+    std::unique_ptr<Ring> ring;
+    std::unique_ptr<WorkerPool> threads;
+    std::thread ringThread;
+
+    std::mutex mutex;
+    std::condition_variable wake; // Signalled when a request is queued or the reader stops.
+    std::condition_variable idle; // Signalled when the last outstanding read completes.
+    std::vector<Request> queue;   // Heap ordered by priority, then sequence.
+    long long nextSequence = 0;
+    int outstanding = 0;          // Queued or in flight.
+    bool stopping = false;
+
+    std::atomic<long long> filesRead{0};
+    std::atomic<long long> filesFailed{0};
+    std::atomic<long long> bytesRead{0};
+    std::atomic<long long> systemCalls{0}; // io_uring_enter calls, or open/pread/fstat/close calls of the fallback.
+    std::atomic<bool> ringFailed{false};   // The ring thread gave up on io_uring and reads with pread.
+};
+
+#endif
@@ -0,0 +1,247 @@
+#include "frame_stats.h"
+#include "alloc_audit.h"   // Heap allocations of the audit build.
+#include "gl_instrument.h" // OpenGL call totals of the instrumented build.
+#include "glad.h"          // The glad_gl* function pointers that are wrapped.
+#include "gpu_memory.h"    // Tracked GPU memory.
+#include <chrono>          // Frame time.
+
+// Entry points that change pipeline state, and those that upload uniforms.
+#define FRAME_STATS_STATE_CALLS(X)                                                                      \
+    X(UseProgram) X(BindVertexArray) X(BindBuffer) X(BindBufferBase) X(BindFramebuffer) X(BindTexture) \
+    X(ActiveTexture) X(Enable) X(Disable) X(BlendFunc) X(Viewport) X(ViewportArrayv)
+#define FRAME_STATS_UNIFORM_CALLS(X) \
+    X(Uniform1i) X(Uniform1f) X(Uniform2f) X(Uniform4f) X(UniformMatrix4fv)
+
+static FrameStats current;  // Counters of the frame being drawn.
+static FrameStats finished; // Last completed frame.
+static bool installed = false;
+static std::chrono::steady_clock::time_point lastFrameEnd;
+
+// Function to count the triangles a draw produces.
+static long long trianglesOf(GLenum mode, GLsizei count, GLsizei instances)
+{
+    long long perInstance = 0;
+    if (mode == GL_TRIANGLES)
+        perInstance = count / 3;
+    else if ((mode == GL_TRIANGLE_STRIP || mode == GL_TRIANGLE_FAN) && count >= 3)
+        perInstance = count - 2;
+    return perInstance * instances;
+}
+
+static void countDraw(GLenum mode, GLsizei count, GLsizei instances)
+{
+    ++current.drawCalls;
+    current.triangles += trianglesOf(mode, count, instances);
+}
+
+// Wrapper that counts a call of a state or uniform entry point; the signature comes from the glad pointer type.
+enum CounterKind
+{
+    StateCounter,
+    UniformCounter
+};
+
+enum CountedEntry
+{
+#define FRAME_STATS_ENUM(name) Counted##name,
+    FRAME_STATS_STATE_CALLS(FRAME_STATS_ENUM) FRAME_STATS_UNIFORM_CALLS(FRAME_STATS_ENUM)
+#undef FRAME_STATS_ENUM
+};
+
+template <int Entry, int Kind, typename Function>
+struct CounterHook;
+
+template <int Entry, int Kind, typename Result, typename... Args>
+struct CounterHook<Entry, Kind, Result(APIENTRYP)(Args...)>
+{
+    static Result(APIENTRYP real)(Args...);
+
+    static Result APIENTRY call(Args... args)
+    {
+        if (Kind == StateCounter)
+            ++current.stateChanges;
+        else
+            ++current.uniformUpdates;
+        return real(args...);
+    }
+};
+
+template <int Entry, int Kind, typename Result, typename... Args>
+Result(APIENTRYP CounterHook<Entry, Kind, Result(APIENTRYP)(Args...)>::real)(Args...) = nullptr;
+
+// Draw wrappers.
+static PFNGLDRAWARRAYSPROC realDrawArrays = nullptr;
+static PFNGLDRAWELEMENTSPROC realDrawElements = nullptr;
+static PFNGLDRAWARRAYSINSTANCEDPROC realDrawArraysInstanced = nullptr;
+static PFNGLDRAWELEMENTSINSTANCEDPROC realDrawElementsInstanced = nullptr;
+static PFNGLDRAWRANGEELEMENTSPROC realDrawRangeElements = nullptr;
+static PFNGLDRAWELEMENTSBASEVERTEXPROC realDrawElementsBaseVertex = nullptr;
+static PFNGLDRAWELEMENTSINSTANCEDBASEVERTEXPROC realDrawElementsInstancedBaseVertex = nullptr;
+
+static void APIENTRY countDrawArrays(GLenum mode, GLint first, GLsizei count)
+{
+    countDraw(mode, count, 1);
+    realDrawArrays(mode, first, count);
+}
+
+static void APIENTRY countDrawElements(GLenum mode, GLsizei count, GLenum type, const void *indices)
+{
+    countDraw(mode, count, 1);
+    realDrawElements(mode, count, type, indices);
+}
+
+static void APIENTRY countDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei instances)
+{
+    countDraw(mode, count, instances);
+    realDrawArraysInstanced(mode, first, count, instances);
+}
+
+static void APIENTRY countDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void *indices, GLsizei instances)
+{
+    countDraw(mode, count, instances);
+    realDrawElementsInstanced(mode, count, type, indices, instances);
+}
+
+static void APIENTRY countDrawRangeElements(GLenum mode, GLuint start, GLuint end, GLsizei count, GLenum type, const void *indices)
+{
+    countDraw(mode, count, 1);
+    realDrawRangeElements(mode, start, end, count, type, indices);
+}
+
+static void APIENTRY countDrawElementsBaseVertex(GLenum mode, GLsizei count, GLenum type, const void *indices, GLint baseVertex)
+{
+    countDraw(mode, count, 1);
+    realDrawElementsBaseVertex(mode, count, type, indices, baseVertex);
+}
+
+static void APIENTRY countDrawElementsInstancedBaseVertex(GLenum mode, GLsizei count, GLenum type, const void *indices,
+                                                          GLsizei instances, GLint baseVertex)
+{
+    countDraw(mode, count, instances);
+    realDrawElementsInstancedBaseVertex(mode, count, type, indices, instances, baseVertex);
+}
+
+#define FRAME_STATS_DRAW_CALLS(X)                                                                    \
+    X(DrawArrays) X(DrawElements) X(DrawArraysInstanced) X(DrawElementsInstanced) X(DrawRangeElements) \
+    X(DrawElementsBaseVertex) X(DrawElementsInstancedBaseVertex)
+
+// Function to wrap the counted entry points. Functions the driver does not provide stay null.
+bool installFrameStatsCounters()
+{
+    if (installed)
+        return true;
+#define FRAME_STATS_INSTALL_DRAW(name) \
+    real##name = glad_gl##name;        \
+    if (glad_gl##name != nullptr)      \
+        glad_gl##name = count##name;
+#define FRAME_STATS_INSTALL(name, kind)                                          \
+    if (glad_gl##name != nullptr)                                                \
+    {                                                                            \
+        using Hook = CounterHook<Counted##name, kind, decltype(glad_gl##name)>;  \
+        Hook::real = glad_gl##name;                                              \
+        glad_gl##name = Hook::call;                                              \
+    }
+#define FRAME_STATS_INSTALL_STATE(name) FRAME_STATS_INSTALL(name, StateCounter)
+#define FRAME_STATS_INSTALL_UNIFORM(name) FRAME_STATS_INSTALL(name, UniformCounter)
+    FRAME_STATS_DRAW_CALLS(FRAME_STATS_INSTALL_DRAW)
+    FRAME_STATS_STATE_CALLS(FRAME_STATS_INSTALL_STATE)
+    FRAME_STATS_UNIFORM_CALLS(FRAME_STATS_INSTALL_UNIFORM)
+#undef FRAME_STATS_INSTALL_DRAW
+#undef FRAME_STATS_INSTALL
+#undef FRAME_STATS_INSTALL_STATE
+#undef FRAME_STATS_INSTALL_UNIFORM
+    installed = true;
+    lastFrameEnd = std::chrono::steady_clock::now();
+    return true;
+}
+
+// Function to put the previous functions back.
+void removeFrameStatsCounters()
+{
+    if (!installed)
+        return;
+#define FRAME_STATS_REMOVE_DRAW(name) \
+    if (real##name != nullptr)        \
+        glad_gl##name = real##name;
+#define FRAME_STATS_REMOVE(name, kind)                                           \
+    {                                                                            \
+        using Hook = CounterHook<Counted##name, kind, decltype(glad_gl##name)>;  \
+        if (Hook::real != nullptr)                                               \
+            glad_gl##name = Hook::real;                                          \
+    }
+#define FRAME_STATS_REMOVE_STATE(name) FRAME_STATS_REMOVE(name, StateCounter)
+#define FRAME_STATS_REMOVE_UNIFORM(name) FRAME_STATS_REMOVE(name, UniformCounter)
+    FRAME_STATS_DRAW_CALLS(FRAME_STATS_REMOVE_DRAW)
+    FRAME_STATS_STATE_CALLS(FRAME_STATS_REMOVE_STATE)
+    FRAME_STATS_UNIFORM_CALLS(FRAME_STATS_REMOVE_UNIFORM)
+#undef FRAME_STATS_REMOVE_DRAW
+#undef FRAME_STATS_REMOVE
+#undef FRAME_STATS_REMOVE_STATE
+#undef FRAME_STATS_REMOVE_UNIFORM
+    installed = false;
+}
+
+// Function to close the current frame.
+// frameIndex: Number of the frame, stored with the statistics.
+const FrameStats &endFrameStats(long long frameIndex)
+{
+    auto now = std::chrono::steady_clock::now();
+    current.frameIndex = frameIndex;
+    current.frameMs = std::chrono::duration<double, std::milli>(now - lastFrameEnd).count();
+    lastFrameEnd = now;
+
+    // The instrumented and audit builds count every call and allocation; their frames must be closed before this one.
+    GlCallFrameStats glCalls = lastFrameGlCalls();
+    current.glCalls = glCalls.calls;
+    current.glMs = glCalls.milliseconds;
+    current.gpuMemoryMiB = gpuMemoryTotal().bytes / 1048576.0;
+    current.allocations = (int)lastFrameAllocations().allocations;
+
+    finished = current;
+    current = FrameStats();
+    return finished;
+}
+
+const FrameStats &lastFrameStats() { return finished; }
+
+FrameStatsExporter::~FrameStatsExporter() { close(); }
+
+// Function to open the export stream and write the CSV header.
+bool FrameStatsExporter::open(const std::string &path)
+{
+    close();
+    json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+    ownsFile = path != "-";
+    file = ownsFile ? std::fopen(path.c_str(), "w") : stdout;
+    if (file == nullptr)
+        return false;
+    if (!json)
+        std::fprintf(file, "frame,frame_ms,draw_calls,triangles,state_changes,uniform_updates,gl_calls,gl_ms,gpu_memory_mib,allocations\n");
+    return true;
+}
+
+// Function to write the statistics of one frame as one line.
+// Each line is flushed, so the stream can be followed live (tail -f, or a pipe when writing to the standard output).
+void FrameStatsExporter::write(const FrameStats &stats)
+{
+    if (file == nullptr)
+        return;
+    if (json)
+        std::fprintf(file,
+                     "{\"frame\":%lld,\"frame_ms\":%.3f,\"draw_calls\":%d,\"triangles\":%lld,\"state_changes\":%d,"
+                     "\"uniform_updates\":%d,\"gl_calls\":%d,\"gl_ms\":%.3f,\"gpu_memory_mib\":%.3f,\"allocations\":%d}\n",
+                     stats.frameIndex, stats.frameMs, stats.drawCalls, stats.triangles, stats.stateChanges,
+                     stats.uniformUpdates, stats.glCalls, stats.glMs, stats.gpuMemoryMiB, stats.allocations);
+    else
+        std::fprintf(file, "%lld,%.3f,%d,%lld,%d,%d,%d,%.3f,%.3f,%d\n", stats.frameIndex, stats.frameMs, stats.drawCalls,
+                     stats.triangles, stats.stateChanges, stats.uniformUpdates, stats.glCalls, stats.glMs, stats.gpuMemoryMiB,
+                     stats.allocations);
+    std::fflush(file);
+}
+
+void FrameStatsExporter::close()
+{
+    if (file != nullptr && ownsFile)
+        std::fclose(file);
+    file = nullptr;
+}
@@ -0,0 +1,46 @@
+#ifndef FRAME_STATS_H
+#define FRAME_STATS_H
+
+// Per-frame rendering statistics: draw calls, triangles, state changes and frame time.
+// The counters are collected by wrapping the glad pointers of the draw and state entry points, so every
+// draw of every subsystem is counted without touching the call sites. The finished frame is shown by the
+// HUD and can be streamed one line per frame as CSV or JSON lines.
+#include <cstdio> // FILE of the export stream.
+#include <string> // Export path.
+
+struct FrameStats
+{
+    long long frameIndex = 0;
+    double frameMs = 0.0;     // Time since the previous frame ended (present to present).
+    int drawCalls = 0;
+    long long triangles = 0;  // Including every instance of instanced draws.
+    int stateChanges = 0;     // Program, vertex array, buffer, framebuffer, texture and fixed-function state changes.
+    int uniformUpdates = 0;
+    int glCalls = 0;          // All OpenGL calls; only counted in builds with GL_INSTRUMENTED.
+    double glMs = 0.0;        // Time in the driver; only with --gl-calls time.
+    double gpuMemoryMiB = 0.0; // Tracked GPU memory at the end of the frame.
+    int allocations = 0;       // Heap allocations of the render thread; only counted in builds with ALLOC_AUDIT.
+};
+
+bool installFrameStatsCounters();                  // Wraps the draw and state entry points; call after the instrumentation, before a trace.
+void removeFrameStatsCounters();
+const FrameStats &endFrameStats(long long frameIndex); // Closes the frame (before swapping) and returns its statistics.
+const FrameStats &lastFrameStats();
+
+// Writes one line per frame. The format follows the extension: .json writes JSON lines, anything else CSV.
+// The path "-" writes to the standard output.
+class FrameStatsExporter
+{
+public:
+    ~FrameStatsExporter();
+    bool open(const std::string &path);
+    void write(const FrameStats &stats);
+    void close();
+
+private:
+    FILE *file = nullptr;
+    bool json = false;
+    bool ownsFile = false; // False for the standard output.
+};
+
+#endif
@@ -0,0 +1,181 @@
+#include "frame_timing.h"
+#include "glad.h"        // Timer queries.
+#include "memory_arena.h" // Sort buffer of the summary.
+#include <algorithm>     // std::sort.
+#include <iomanip>       // Summary formatting.
+#include <string>        // Histogram bars.
+
+// Upper edges of the histogram buckets in milliseconds; the last bucket takes everything longer.
+// The edges around 16.7 and 33.3 ms separate frames that made a 60 Hz refresh from those that missed one or two.
+static const double histogramEdges[] = {4.0, 8.0, 12.0, 16.7, 20.0, 25.0, 33.4, 50.0, 100.0};
+static const int refreshInterval = 60; // Frames between updates of the rolling summary.
+
+static double millisecondsBetween(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end)
+{
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+void FrameTimer::Ring::push(double value)
+{
+    values[next] = value;
+    next = (next + 1) % (int)values.size();
+    if (count < (int)values.size())
+        ++count;
+}
+
+// Function to compute the percentiles of the samples in the ring (nearest rank).
+// scratch: Sort buffer with room for count values.
+FrameTimePercentiles FrameTimer::Ring::percentiles(double *scratch) const
+{
+    FrameTimePercentiles result;
+    if (count == 0)
+        return result;
+    std::copy(values.begin(), values.begin() + count, scratch);
+    std::sort(scratch, scratch + count);
+    auto rank = [&](double fraction)
+    { return scratch[std::min(count - 1, (int)(fraction * count))]; };
+    result.p50 = rank(0.50);
+    result.p95 = rank(0.95);
+    result.p99 = rank(0.99);
+    result.max = scratch[count - 1];
+    return result;
+}
+
+// Constructor: allocates the rings and the timer queries.
+FrameTimer::FrameTimer(int windowSize)
+{
+    int size = windowSize < 16 ? 16 : windowSize;
+    cpuTimes.values.resize(size);
+    gpuTimes.values.resize(size);
+    presentIntervals.values.resize(size);
+    glGenQueries(queryCount, queries);
+}
+
+FrameTimer::~FrameTimer()
+{
+    if (queryActive)
+        glEndQuery(GL_TIME_ELAPSED);
+    glDeleteQueries(queryCount, queries);
+}
+
+// Function to start timing a frame.
+void FrameTimer::beginFrame()
+{
+    frameStart = std::chrono::steady_clock::now();
+
+    // The query of this slot is still unread if the GPU is more than queryCount frames behind: skip the GPU
+    // sample of this frame rather than wait.
+    if (queryPending[nextQuery])
+        collectGpuTimes();
+    queryActive = !queryPending[nextQuery];
+    if (queryActive)
+        glBeginQuery(GL_TIME_ELAPSED, queries[nextQuery]);
+}
+
+// Function to stop timing the frame on the CPU and the GPU.
+void FrameTimer::endFrame()
+{
+    cpuTimes.push(millisecondsBetween(frameStart, std::chrono::steady_clock::now()));
+    if (queryActive)
+    {
+        glEndQuery(GL_TIME_ELAPSED);
+        queryPending[nextQuery] = true;
+        nextQuery = (nextQuery + 1) % queryCount;
+        queryActive = false;
+    }
+    collectGpuTimes();
+}
+
+// Function to record the present interval; also counts stutters and refreshes the rolling summary.
+void FrameTimer::framePresented()
+{
+    auto now = std::chrono::steady_clock::now();
+    if (framesPresented++ > 0)
+    {
+        double interval = millisecondsBetween(lastPresent, now);
+        presentIntervals.push(interval);
+
+        int bucket = 0;
+        while (bucket < histogramBuckets - 1 && interval > histogramEdges[bucket])
+            ++bucket;
+        ++histogram[bucket];
+
+        // Compared with the median of the last refresh, so the check costs nothing per frame.
+        if (rolling.present.p50 > 0.0 && interval > 2.0 * rolling.present.p50)
+            ++sessionStutters;
+    }
+    lastPresent = now;
+
+    if (framesPresented % refreshInterval == 0)
+        rolling = summary();
+}
+
+// Function to read the results of the finished queries. Never waits: unfinished queries are tried again later.
+void FrameTimer::collectGpuTimes()
+{
+    for (int i = 0; i < queryCount; ++i)
+    {
+        int slot = (nextQuery + i) % queryCount; // Oldest first.
+        if (!queryPending[slot])
+            continue;
+        GLint available = 0;
+        glGetQueryObjectiv(queries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            break; // Queries finish in order; the newer ones are not done either.
+        GLuint64 nanoseconds = 0;
+        glGetQueryObjectui64v(queries[slot], GL_QUERY_RESULT, &nanoseconds);
+        gpuTimes.push(nanoseconds / 1e6);
+        queryPending[slot] = false;
+    }
+}
+
+// Function to compute the percentiles and the stutters of the current window.
+// Sorts in the frame arena, so the refresh in the render loop does not touch the heap.
+FrameTimingSummary FrameTimer::summary() const
+{
+    FrameTimingSummary result;
+    double *scratch = frameArena().allocateArray<double>(presentIntervals.values.size());
+    result.samples = presentIntervals.count;
+    result.cpu = cpuTimes.percentiles(scratch);
+    result.gpu = gpuTimes.percentiles(scratch);
+    result.present = presentIntervals.percentiles(scratch);
+    for (int i = 0; i < presentIntervals.count; ++i)
+        if (presentIntervals.values[i] > 2.0 * result.present.p50)
+            ++result.stutters;
+    return result;
+}
+
+// Function to print the frame pacing of the session.
+void FrameTimer::printSummary(std::ostream &out) const
+{
+    FrameTimingSummary window = summary();
+    if (window.samples == 0)
+        return;
+
+    out << std::fixed << std::setprecision(2) << "Frame timing over the last " << window.samples << " frames (ms):\n"
+        << "            p50      p95      p99      max\n";
+    auto row = [&](const char *name, const FrameTimePercentiles &p)
+    {
+        out << "  " << std::left << std::setw(8) << name << std::right << std::setw(7) << p.p50 << std::setw(9) << p.p95
+            << std::setw(9) << p.p99 << std::setw(9) << p.max << "\n";
+    };
+    row("cpu", window.cpu);
+    row("gpu", window.gpu);
+    row("present", window.present);
+    out << "  stutters (> 2x median): " << window.stutters << " in the window, " << sessionStutters << " of "
+        << framesPresented - 1 << " frames in the session\n";
+
+    // Present intervals of the whole session.
+    long long largest = 1;
+    for (long long count : histogram)
+        largest = std::max(largest, count);
+    for (int i = 0; i < histogramBuckets; ++i)
+    {
+        if (i < histogramBuckets - 1)
+            out << "  <= " << std::setw(6) << histogramEdges[i];
+        else
+            out << "   > " << std::setw(6) << histogramEdges[i - 1];
+        out << " ms " << std::setw(8) << histogram[i] << " " << std::string((size_t)(40 * histogram[i] / largest), '#') << "\n";
+    }
+    out << std::defaultfloat << std::flush;
+}
@@ -0,0 +1,80 @@
+#ifndef FRAME_TIMING_H
+#define FRAME_TIMING_H
+
+// Frame pacing analysis: CPU frame time, GPU frame time and present-to-present interval of the last frames,
+// kept in fixed-size rings, with percentiles, a stutter count and a histogram of the present intervals.
+// An average frame rate hides hitches; the tail percentiles and the stutters show whether the frames are smooth.
+// The GPU time comes from GL_TIME_ELAPSED queries that are read back a few frames later, so the render
+// thread never waits for them.
+#include <chrono>  // CPU and present timestamps.
+#include <ostream> // Summary output.
+#include <vector>  // Sample rings.
+
+// Milliseconds.
+struct FrameTimePercentiles
+{
+    double p50 = 0.0;
+    double p95 = 0.0;
+    double p99 = 0.0;
+    double max = 0.0;
+};
+
+struct FrameTimingSummary
+{
+    int samples = 0;              // Present intervals in the window.
+    FrameTimePercentiles cpu;     // From beginFrame to endFrame: building and submitting the frame.
+    FrameTimePercentiles gpu;     // GPU time of the same span; lags a few frames behind.
+    FrameTimePercentiles present; // From one swap to the next: what the viewer sees.
+    int stutters = 0;             // Present intervals in the window longer than twice the median.
+};
+
+class FrameTimer
+{
+public:
+    explicit FrameTimer(int windowSize = 1024); // windowSize: frames kept for the percentiles. Needs the GL context current.
+    ~FrameTimer();                              // Needs the GL context current.
+
+    FrameTimer(const FrameTimer &) = delete;
+    FrameTimer &operator=(const FrameTimer &) = delete;
+
+    void beginFrame();     // Call before the first command of the frame.
+    void endFrame();       // Call after the last command of the frame, before swapping.
+    void framePresented(); // Call right after swapping.
+
+    FrameTimingSummary summary() const;                                  // Percentiles over the whole window; sorts copies of the rings.
+    const FrameTimingSummary &rollingSummary() const { return rolling; } // summary() as of the last refresh, every 60 frames.
+    void printSummary(std::ostream &out) const;                          // Window percentiles, session stutters and histogram.
+
+private:
+    // Fixed-size ring of samples in milliseconds; the oldest sample is overwritten when full.
+    struct Ring
+    {
+        std::vector<double> values;
+        int next = 0;
+        int count = 0;
+
+        void push(double value);
+        FrameTimePercentiles percentiles(double *scratch) const;
+    };
+
+    void collectGpuTimes(); // Reads the finished queries without waiting.
+
+    static const int queryCount = 4; // Frames the GPU may lag behind before GPU samples are skipped.
+    static const int histogramBuckets = 10;
+
+    Ring cpuTimes;
+    Ring gpuTimes;
+    Ring presentIntervals;
+    unsigned int queries[queryCount] = {};
+    bool queryPending[queryCount] = {}; // Ended but not yet read.
+    int nextQuery = 0;
+    bool queryActive = false;           // A query was begun for the current frame.
+    std::chrono::steady_clock::time_point frameStart;
+    std::chrono::steady_clock::time_point lastPresent;
+    long long framesPresented = 0;
+    long long sessionStutters = 0;      // Present intervals longer than twice the rolling median, over the session.
+    long long histogram[histogramBuckets] = {};
+    FrameTimingSummary rolling;
+};
+
+#endif
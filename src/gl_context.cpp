@@ -0,0 +1,41 @@
+#include "gl_context.h"
+#include "logger.h" // Error messages.
+
+// Function to create a window and its OpenGL context.
+// settings: Size, title, visibility and the optional context to share objects with.
+GLFWwindow *createContextWindow(const ContextSettings &settings)
+{
+    // Set GLFW to use OpenGL version 3.3, ensuring forward compatibility and core profile features
+    glfwDefaultWindowHints();
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, settings.visible ? GLFW_TRUE : GLFW_FALSE);
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, settings.debugOutput != GlDebugLevel::Off ? GLFW_TRUE : GLFW_FALSE);
+
+    // Additional hint for macOS compatibility: Enables features from newer OpenGL versions
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+#endif
+
+    // Create the window and its OpenGL context
+    GLFWwindow *window = glfwCreateWindow(settings.width, settings.height, settings.title, nullptr, settings.shareWith);
+    if (window == nullptr) // Check if the GLFW window failed to create
+    {
+        logError("Failed to create GLFW window");
+        return nullptr;
+    }
+    glfwMakeContextCurrent(window); // Make the window's context current
+
+    // Initialize GLAD before calling any OpenGL function
+    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
+    {
+        logError("Failed to initialize GLAD");
+        glfwDestroyWindow(window);
+        return nullptr;
+    }
+
+    // Route the driver's errors and warnings to the log
+    installGlDebugOutput(settings.debugOutput);
+    return window;
+}
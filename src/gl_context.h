@@ -0,0 +1,24 @@
+#ifndef GL_CONTEXT_H
+#define GL_CONTEXT_H
+
+// Creation of GLFW windows with an OpenGL 3.3 core context, for the interactive window as well as the
+// hidden windows used by the headless render modes.
+#include "glad.h"        // GLAD must be included before GLFW.
+#include <GLFW/glfw3.h>  // GLFW provides the window and the context.
+#include "gl_debug.h"    // Debug output level.
+
+struct ContextSettings
+{
+    int width = 800;                              // Window size in screen coordinates.
+    int height = 600;
+    const char *title = "OpenGL Pyramid";
+    bool visible = true;                          // Hidden windows only provide a context for offscreen rendering.
+    GLFWwindow *shareWith = nullptr;              // Window whose objects (buffers, textures) the new context shares.
+    GlDebugLevel debugOutput = GlDebugLevel::Off; // Anything but Off creates a debug context and logs the driver's messages.
+};
+
+// Creates the window, makes its context current and loads the OpenGL functions.
+// GLFW must be initialized. Returns nullptr (after printing the reason) on failure.
+GLFWwindow *createContextWindow(const ContextSettings &settings);
+
+#endif
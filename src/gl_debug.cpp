@@ -0,0 +1,168 @@
+#include "gl_debug.h"
+#include "logger.h" // Messages go to the log.
+#include <atomic>   // Counters updated from the driver's threads.
+#include <cstring>  // strcmp, strncpy.
+#include <mutex>    // Protects the performance warning table.
+
+static const int maxPerformanceWarnings = 64; // Distinct performance warnings remembered; later ones are logged every time.
+
+// A performance warning seen before, to log it once and count the repeats. Fixed size: the callback must not allocate.
+struct PerformanceWarning
+{
+    GLenum source;
+    GLuint id;
+    long long count;
+    char text[160]; // First message, for the report.
+};
+
+static GlDebugLevel activeLevel = GlDebugLevel::Off;
+static std::atomic<long long> messageCounts[4]; // Per LogSeverity.
+static std::mutex performanceMutex;
+static PerformanceWarning performanceWarnings[maxPerformanceWarnings];
+static int performanceWarningCount = 0;
+
+static const char *sourceName(GLenum source)
+{
+    switch (source)
+    {
+    case GL_DEBUG_SOURCE_API: return "api";
+    case GL_DEBUG_SOURCE_WINDOW_SYSTEM: return "window system";
+    case GL_DEBUG_SOURCE_SHADER_COMPILER: return "shader compiler";
+    case GL_DEBUG_SOURCE_THIRD_PARTY: return "third party";
+    case GL_DEBUG_SOURCE_APPLICATION: return "application";
+    default: return "other";
+    }
+}
+
+static const char *typeName(GLenum type)
+{
+    switch (type)
+    {
+    case GL_DEBUG_TYPE_ERROR: return "error";
+    case GL_DEBUG_TYPE_DEPRECATED_BEHAVIOR: return "deprecated";
+    case GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR: return "undefined behavior";
+    case GL_DEBUG_TYPE_PORTABILITY: return "portability";
+    case GL_DEBUG_TYPE_PERFORMANCE: return "performance";
+    case GL_DEBUG_TYPE_MARKER: return "marker";
+    default: return "other";
+    }
+}
+
+// Function to count a performance warning. Returns true if it was seen before and should not be logged again.
+static bool repeatedPerformanceWarning(GLenum source, GLuint id, const char *message)
+{
+    std::lock_guard<std::mutex> lock(performanceMutex);
+    for (int i = 0; i < performanceWarningCount; ++i)
+        if (performanceWarnings[i].source == source && performanceWarnings[i].id == id)
+            return ++performanceWarnings[i].count > 1;
+    if (performanceWarningCount == maxPerformanceWarnings)
+        return false;
+    PerformanceWarning &warning = performanceWarnings[performanceWarningCount++];
+    warning.source = source;
+    warning.id = id;
+    warning.count = 1;
+    std::strncpy(warning.text, message, sizeof(warning.text) - 1);
+    warning.text[sizeof(warning.text) - 1] = '\0';
+    return false;
+}
+
+// Callback of the driver. May run on any thread, possibly after the call that caused the message returned.
+static void APIENTRY debugMessageCallback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length,
+                                          const GLchar *message, const void *userParam)
+{
+    (void)length;
+    (void)userParam;
+    LogSeverity logSeverity = LogSeverity::Warning;
+    if (type == GL_DEBUG_TYPE_ERROR || severity == GL_DEBUG_SEVERITY_HIGH)
+        logSeverity = LogSeverity::Error;
+    else if (severity == GL_DEBUG_SEVERITY_NOTIFICATION)
+        logSeverity = LogSeverity::Debug;
+    messageCounts[(int)logSeverity].fetch_add(1, std::memory_order_relaxed);
+
+    if (type == GL_DEBUG_TYPE_PERFORMANCE && activeLevel != GlDebugLevel::All &&
+        repeatedPerformanceWarning(source, id, message))
+        return;
+    logMessage(logSeverity, "OpenGL {} ({}, id {}): {}", typeName(type), sourceName(source), id, message);
+}
+
+bool parseGlDebugLevel(const char *name, GlDebugLevel &level)
+{
+    static const char *const levelNames[] = {"off", "errors", "warnings", "all"};
+    for (int i = 0; i < 4; ++i)
+        if (std::strcmp(name, levelNames[i]) == 0)
+        {
+            level = (GlDebugLevel)i;
+            return true;
+        }
+    return false;
+}
+
+// Function to enable the debug output of the current context and select the messages the driver reports.
+// Filtering happens in the driver through glDebugMessageControl, so disabled messages cost nothing.
+bool installGlDebugOutput(GlDebugLevel level)
+{
+    if (level == GlDebugLevel::Off)
+        return true;
+    if (glad_glDebugMessageCallback == nullptr || glad_glDebugMessageControl == nullptr)
+    {
+        logWarning("--gl-debug needs the KHR_debug extension, which the driver does not provide");
+        return false;
+    }
+    GLint flags = 0;
+    glGetIntegerv(GL_CONTEXT_FLAGS, &flags);
+    if ((flags & GL_CONTEXT_FLAG_DEBUG_BIT) == 0)
+        logWarning("The OpenGL context is not a debug context; the driver may report few messages");
+
+    activeLevel = level;
+    glDebugMessageCallback(debugMessageCallback, nullptr);
+    if (level == GlDebugLevel::All)
+        glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_TRUE);
+    else
+    {
+        glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, nullptr, GL_FALSE);
+        glDebugMessageControl(GL_DONT_CARE, GL_DEBUG_TYPE_ERROR, GL_DONT_CARE, 0, nullptr, GL_TRUE);
+        glDebugMessageControl(GL_DONT_CARE, GL_DEBUG_TYPE_UNDEFINED_BEHAVIOR, GL_DONT_CARE, 0, nullptr, GL_TRUE);
+        if (level == GlDebugLevel::Warnings)
+            for (GLenum severity : {GL_DEBUG_SEVERITY_HIGH, GL_DEBUG_SEVERITY_MEDIUM, GL_DEBUG_SEVERITY_LOW})
+                glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, severity, 0, nullptr, GL_TRUE);
+    }
+    // The groups and labels of this program would echo back as messages
+    glDebugMessageControl(GL_DONT_CARE, GL_DEBUG_TYPE_PUSH_GROUP, GL_DONT_CARE, 0, nullptr, GL_FALSE);
+    glDebugMessageControl(GL_DONT_CARE, GL_DEBUG_TYPE_POP_GROUP, GL_DONT_CARE, 0, nullptr, GL_FALSE);
+    glEnable(GL_DEBUG_OUTPUT);
+    return true;
+}
+
+// Function to name an OpenGL object in captures and debug messages.
+void labelGlObject(GLenum identifier, GLuint name, const char *label)
+{
+    if (glad_glObjectLabel != nullptr && name != 0)
+        glObjectLabel(identifier, name, -1, label);
+}
+
+GlDebugGroup::GlDebugGroup(const char *name) : pushed(glad_glPushDebugGroup != nullptr)
+{
+    if (pushed)
+        glPushDebugGroup(GL_DEBUG_SOURCE_APPLICATION, 0, -1, name);
+}
+
+GlDebugGroup::~GlDebugGroup()
+{
+    if (pushed)
+        glPopDebugGroup();
+}
+
+// Function to print the number of messages the driver sent and the performance warnings with their repeats.
+void printGlDebugReport(std::ostream &out)
+{
+    if (activeLevel == GlDebugLevel::Off)
+        return;
+    out << "OpenGL debug messages: " << messageCounts[(int)LogSeverity::Error].load() << " errors, "
+        << messageCounts[(int)LogSeverity::Warning].load() << " warnings, "
+        << messageCounts[(int)LogSeverity::Debug].load() << " notifications\n";
+    std::lock_guard<std::mutex> lock(performanceMutex);
+    for (int i = 0; i < performanceWarningCount; ++i)
+        out << "  " << performanceWarnings[i].count << "x performance (" << sourceName(performanceWarnings[i].source)
+            << ", id " << performanceWarnings[i].id << "): " << performanceWarnings[i].text << "\n";
+    out << std::flush;
+}
@@ -0,0 +1,47 @@
+#ifndef GL_DEBUG_H
+#define GL_DEBUG_H
+
+// OpenGL debug output (KHR_debug): driver errors, undefined behavior and performance warnings are routed to
+// the logger, and passes and resources are annotated so frame captures (RenderDoc, apitrace, Nsight) show
+// readable names instead of bare object numbers.
+// The callback is asynchronous (GL_DEBUG_OUTPUT_SYNCHRONOUS stays off), so the driver may deliver messages
+// late and from its own threads; the callback only hands the message to the logger's queue. Performance
+// warnings usually repeat every frame, so below the "all" level each one is logged once and then counted.
+// Annotations work whenever the driver exposes KHR_debug, with or without a debug context, and are no-ops
+// otherwise.
+#include "glad.h"  // GLenum, GLuint.
+#include <ostream> // Report output.
+
+enum class GlDebugLevel
+{
+    Off,
+    Errors,   // Errors and undefined behavior.
+    Warnings, // Also deprecated, non-portable and slow usage; repeated performance warnings are counted only.
+    All       // Every message, including notifications and every repeat.
+};
+
+bool parseGlDebugLevel(const char *name, GlDebugLevel &level); // off, errors, warnings or all.
+
+// Enables debug output for the current context at the given level. Returns false when the driver has no
+// KHR_debug. A debug context (ContextSettings::debugOutput) makes drivers report far more.
+bool installGlDebugOutput(GlDebugLevel level);
+
+void labelGlObject(GLenum identifier, GLuint name, const char *label); // identifier: GL_BUFFER, GL_PROGRAM, GL_TEXTURE, ...
+
+// Names the calls between construction and destruction in captures: one pass or step of a frame.
+class GlDebugGroup
+{
+public:
+    explicit GlDebugGroup(const char *name);
+    ~GlDebugGroup();
+
+    GlDebugGroup(const GlDebugGroup &) = delete;
+    GlDebugGroup &operator=(const GlDebugGroup &) = delete;
+
+private:
+    bool pushed;
+};
+
+void printGlDebugReport(std::ostream &out); // Message counts by severity and the performance warnings with their repeats.
+
+#endif
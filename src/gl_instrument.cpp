@@ -0,0 +1,200 @@
+#include "gl_instrument.h"
+
+#ifdef GL_INSTRUMENTED
+
+#include "gl_entry_points.h" // The list of functions to wrap.
+#include "glad.h"            // The glad_gl* function pointers.
+#include <algorithm>         // Sorting of the report.
+#include <chrono>            // Call timing.
+#include <cstdint>           // Counter types.
+#include <iomanip>           // Formatting of the report.
+#include <vector>            // Report rows.
+
+// Index of every wrapped entry point.
+enum GlEntryPoint
+{
+#define GL_INSTRUMENT_ENUM(name) Entry##name,
+    GL_ENTRY_POINTS(GL_INSTRUMENT_ENUM)
+#undef GL_INSTRUMENT_ENUM
+    EntryCount
+};
+
+static const char *const entryNames[EntryCount] = {
+#define GL_INSTRUMENT_NAME(name) "gl" #name,
+    GL_ENTRY_POINTS(GL_INSTRUMENT_NAME)
+#undef GL_INSTRUMENT_NAME
+};
+
+// Counters of one entry point. Only the render thread calls OpenGL, so plain integers suffice.
+struct EntryCounters
+{
+    uint32_t frameCalls = 0;        // Current frame.
+    uint64_t frameNanoseconds = 0;
+    uint64_t reportCalls = 0;       // Frames since the last report.
+    uint64_t reportNanoseconds = 0;
+};
+
+static EntryCounters counters[EntryCount];
+static bool installed = false;
+static bool timingEnabled = false;
+static int reportFrames = 0;
+static GlCallFrameStats lastFrame;
+
+// Post-call step of every wrapper: runs when the wrapper returns, after the driver function.
+struct CallScope
+{
+    int entry;
+    std::chrono::steady_clock::time_point start;
+
+    explicit CallScope(int entry) : entry(entry)
+    {
+        if (timingEnabled)
+            start = std::chrono::steady_clock::now();
+    }
+    ~CallScope()
+    {
+        ++counters[entry].frameCalls;
+        if (timingEnabled)
+            counters[entry].frameNanoseconds += (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                    std::chrono::steady_clock::now() - start)
+                                                    .count();
+    }
+};
+
+// Wrapper for one entry point; the signature is taken from the type of its glad pointer.
+template <int Entry, typename Function>
+struct GlHook;
+
+template <int Entry, typename Result, typename... Args>
+struct GlHook<Entry, Result(APIENTRYP)(Args...)>
+{
+    static Result(APIENTRYP real)(Args...);
+
+    static Result APIENTRY call(Args... args)
+    {
+        CallScope scope(Entry);
+        return real(args...);
+    }
+};
+
+template <int Entry, typename Result, typename... Args>
+Result(APIENTRYP GlHook<Entry, Result(APIENTRYP)(Args...)>::real)(Args...) = nullptr;
+
+// Function to wrap every loaded entry point. Functions the driver does not provide stay null.
+// timeCalls: Also measure the time of every call (two clock reads per call).
+bool installGlInstrumentation(bool timeCalls)
+{
+    if (installed)
+        return true;
+#define GL_INSTRUMENT_INSTALL(name)                                       \
+    if (glad_gl##name != nullptr)                                         \
+    {                                                                     \
+        using Hook = GlHook<Entry##name, decltype(glad_gl##name)>;        \
+        Hook::real = glad_gl##name;                                       \
+        glad_gl##name = Hook::call;                                       \
+    }
+    GL_ENTRY_POINTS(GL_INSTRUMENT_INSTALL)
+#undef GL_INSTRUMENT_INSTALL
+    installed = true;
+    timingEnabled = timeCalls;
+    return true;
+}
+
+// Function to put the driver functions back.
+void removeGlInstrumentation()
+{
+    if (!installed)
+        return;
+#define GL_INSTRUMENT_REMOVE(name)                                        \
+    {                                                                     \
+        using Hook = GlHook<Entry##name, decltype(glad_gl##name)>;        \
+        if (Hook::real != nullptr)                                        \
+            glad_gl##name = Hook::real;                                   \
+    }
+    GL_ENTRY_POINTS(GL_INSTRUMENT_REMOVE)
+#undef GL_INSTRUMENT_REMOVE
+    installed = false;
+}
+
+// Function to move the counters of the finished frame into the report period.
+void glInstrumentEndFrame()
+{
+    if (!installed)
+        return;
+    GlCallFrameStats frame;
+    uint64_t nanoseconds = 0;
+    for (EntryCounters &entry : counters)
+    {
+        frame.calls += (int)entry.frameCalls;
+        nanoseconds += entry.frameNanoseconds;
+        entry.reportCalls += entry.frameCalls;
+        entry.reportNanoseconds += entry.frameNanoseconds;
+        entry.frameCalls = 0;
+        entry.frameNanoseconds = 0;
+    }
+    frame.milliseconds = nanoseconds / 1.0e6;
+    lastFrame = frame;
+    ++reportFrames;
+}
+
+GlCallFrameStats lastFrameGlCalls() { return lastFrame; }
+
+// Function to print the busiest entry points per frame of the report period.
+// out: Stream to print to.
+// top: Number of entry points to list.
+void printGlCallReport(std::ostream &out, int top)
+{
+    if (!installed || reportFrames == 0)
+        return;
+
+    std::vector<int> entries;
+    uint64_t totalCalls = 0, totalNanoseconds = 0;
+    for (int i = 0; i < EntryCount; ++i)
+    {
+        if (counters[i].reportCalls == 0)
+            continue;
+        entries.push_back(i);
+        totalCalls += counters[i].reportCalls;
+        totalNanoseconds += counters[i].reportNanoseconds;
+    }
+    std::sort(entries.begin(), entries.end(), [](int a, int b)
+              { return timingEnabled ? counters[a].reportNanoseconds > counters[b].reportNanoseconds
+                                     : counters[a].reportCalls > counters[b].reportCalls; });
+
+    double frames = (double)reportFrames;
+    out << "OpenGL calls over " << reportFrames << " frames: " << std::fixed << std::setprecision(1) << totalCalls / frames
+        << " calls/frame";
+    if (timingEnabled)
+        out << ", " << std::setprecision(3) << totalNanoseconds / 1.0e6 / frames << " ms/frame in the driver";
+    out << "\n";
+    for (size_t i = 0; i < entries.size() && (int)i < top; ++i)
+    {
+        const EntryCounters &entry = counters[entries[i]];
+        out << "  " << std::left << std::setw(32) << entryNames[entries[i]] << std::right << std::setw(10)
+            << std::setprecision(1) << entry.reportCalls / frames << " calls/frame";
+        if (timingEnabled)
+            out << std::setw(10) << std::setprecision(2) << entry.reportNanoseconds / 1.0e3 / frames << " us/frame"
+                << std::setw(7) << std::setprecision(1)
+                << (totalNanoseconds > 0 ? 100.0 * entry.reportNanoseconds / totalNanoseconds : 0.0) << " %";
+        out << "\n";
+    }
+    out << std::defaultfloat << std::flush;
+
+    for (EntryCounters &entry : counters)
+    {
+        entry.reportCalls = 0;
+        entry.reportNanoseconds = 0;
+    }
+    reportFrames = 0;
+}
+
+#else
+
+// Built without GL_INSTRUMENTED: the OpenGL functions are never wrapped.
+bool installGlInstrumentation(bool) { return false; }
+void removeGlInstrumentation() {}
+void glInstrumentEndFrame() {}
+GlCallFrameStats lastFrameGlCalls() { return GlCallFrameStats(); }
+void printGlCallReport(std::ostream &, int) {}
+
+#endif
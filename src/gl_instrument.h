@@ -0,0 +1,26 @@
+#ifndef GL_INSTRUMENT_H
+#define GL_INSTRUMENT_H
+
+// Counting and timing of the OpenGL calls per entry point, for finding the calls that dominate the CPU time
+// of the render loop. Only available in the instrumented build (cmake -DGL_INSTRUMENTED=ON): like the
+// debug loader glad can generate, every glad_gl* pointer is wrapped, and the wrapper's post-call step
+// counts the call and optionally adds the time spent in the driver. In normal builds nothing is wrapped
+// and installGlInstrumentation returns false, so the render loop pays nothing.
+#include <ostream> // Report output.
+
+// OpenGL calls of one frame, summed over all entry points.
+struct GlCallFrameStats
+{
+    int calls = 0;
+    double milliseconds = 0.0; // Time inside the driver; 0 unless call timing is on.
+};
+
+bool installGlInstrumentation(bool timeCalls); // Wraps the loaded functions; call after gladLoadGLLoader, before any trace.
+void removeGlInstrumentation();                // Restores the driver functions.
+void glInstrumentEndFrame();                   // Once per frame: closes the per-frame counters.
+GlCallFrameStats lastFrameGlCalls();           // Totals of the last completed frame.
+
+// Prints the entry points with the most time (or calls, without timing) per frame since the last report, then starts a new report period.
+void printGlCallReport(std::ostream &out, int top = 15);
+
+#endif
@@ -0,0 +1,194 @@
+#include "gl_objects.h"
+#include "gpu_memory.h" // Deleting tracked buffers, renderbuffers and textures.
+#include <vector>       // Slot arrays and deletion lists.
+
+static const int kindCount = (int)GlObjectKind::Count;
+static const char *const kindNames[kindCount] = {"buffers", "vertex arrays", "textures", "framebuffers", "renderbuffers", "programs"};
+static const int maxFencedBatches = 8; // Frames of releases in flight; more are merged into the newest batch.
+static const uint32_t noSlot = 0xFFFFFFFFu;
+
+struct Slot
+{
+    GLuint name = 0;
+    uint32_t generation = 1; // Bumped on release; never 0, which marks the null handle.
+    uint32_t nextFree = noSlot;
+};
+
+struct SlotArray
+{
+    std::vector<Slot> slots;
+    uint32_t firstFree = noSlot;
+    int live = 0;
+};
+
+struct DeferredDeletion
+{
+    GlObjectKind kind;
+    GLuint name;
+};
+
+// Releases of one or more frames, deleted once the fence placed behind them has signalled.
+struct FencedBatch
+{
+    GLsync fence = nullptr;
+    std::vector<DeferredDeletion> objects; // Cleared, not freed, so the batches stop allocating once warm.
+};
+
+static SlotArray slotArrays[kindCount];
+static std::vector<DeferredDeletion> released; // Releases of the current frame, not fenced yet.
+static FencedBatch batches[maxFencedBatches];  // Ring, oldest first.
+static int firstBatch = 0;
+static int batchCount = 0;
+static long long deletedObjects = 0;
+static long long staleLookups = 0;
+static int peakDeferred = 0;
+
+// Function to register an object in a free slot of its kind.
+void registerGlObject(GlObjectKind kind, GLuint name, uint32_t &index, uint32_t &generation)
+{
+    SlotArray &array = slotArrays[(int)kind];
+    if (array.firstFree == noSlot)
+    {
+        array.slots.emplace_back();
+        array.firstFree = (uint32_t)array.slots.size() - 1;
+    }
+    index = array.firstFree;
+    Slot &slot = array.slots[index];
+    array.firstFree = slot.nextFree;
+    slot.name = name;
+    slot.nextFree = noSlot;
+    generation = slot.generation;
+    ++array.live;
+}
+
+GLuint generateGlObject(GlObjectKind kind)
+{
+    GLuint name = 0;
+    switch (kind)
+    {
+    case GlObjectKind::Buffer: glGenBuffers(1, &name); break;
+    case GlObjectKind::VertexArray: glGenVertexArrays(1, &name); break;
+    case GlObjectKind::Texture: glGenTextures(1, &name); break;
+    case GlObjectKind::Framebuffer: glGenFramebuffers(1, &name); break;
+    case GlObjectKind::Renderbuffer: glGenRenderbuffers(1, &name); break;
+    default: break; // Programs come from createShaderProgram.
+    }
+    return name;
+}
+
+GLuint resolveGlObject(GlObjectKind kind, uint32_t index, uint32_t generation)
+{
+    if (generation == 0)
+        return 0;
+    const SlotArray &array = slotArrays[(int)kind];
+    if (index < array.slots.size() && array.slots[index].generation == generation)
+        return array.slots[index].name;
+    ++staleLookups;
+    return 0;
+}
+
+// Function to free the slot of an object and queue the GL name for deletion after the GPU is done with it.
+void releaseGlObject(GlObjectKind kind, uint32_t index, uint32_t generation)
+{
+    SlotArray &array = slotArrays[(int)kind];
+    if (generation == 0 || index >= array.slots.size() || array.slots[index].generation != generation)
+        return;
+    Slot &slot = array.slots[index];
+    released.push_back({kind, slot.name});
+    slot.name = 0;
+    if (++slot.generation == 0)
+        slot.generation = 1;
+    slot.nextFree = array.firstFree;
+    array.firstFree = index;
+    --array.live;
+}
+
+static void deleteObject(const DeferredDeletion &object)
+{
+    switch (object.kind)
+    {
+    case GlObjectKind::Buffer: trackedDeleteBuffers(1, &object.name); break;
+    case GlObjectKind::VertexArray: glDeleteVertexArrays(1, &object.name); break;
+    case GlObjectKind::Texture:
+        releaseGpuAllocation(GpuResourceKind::Texture, object.name);
+        glDeleteTextures(1, &object.name);
+        break;
+    case GlObjectKind::Framebuffer: glDeleteFramebuffers(1, &object.name); break;
+    case GlObjectKind::Renderbuffer: trackedDeleteRenderbuffers(1, &object.name); break;
+    case GlObjectKind::Program: glDeleteProgram(object.name); break;
+    default: break;
+    }
+    ++deletedObjects;
+}
+
+static void deleteBatch(FencedBatch &batch)
+{
+    for (const DeferredDeletion &object : batch.objects)
+        deleteObject(object);
+    batch.objects.clear();
+    if (batch.fence != nullptr)
+        glDeleteSync(batch.fence);
+    batch.fence = nullptr;
+}
+
+// Function to close the releases of the frame.
+// Deletes the batches whose fence has signalled (polling, never waiting), then fences the releases of this frame.
+void glObjectsEndFrame()
+{
+    while (batchCount > 0)
+    {
+        FencedBatch &oldest = batches[firstBatch];
+        GLenum status = glClientWaitSync(oldest.fence, 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+            break; // Fences signal in order, so the newer batches are not done either.
+        deleteBatch(oldest);
+        firstBatch = (firstBatch + 1) % maxFencedBatches;
+        --batchCount;
+    }
+
+    if (released.empty())
+        return;
+    int deferred = (int)released.size();
+    for (int i = 0; i < batchCount; ++i)
+        deferred += (int)batches[(firstBatch + i) % maxFencedBatches].objects.size();
+    if (deferred > peakDeferred)
+        peakDeferred = deferred;
+
+    // The GPU is far behind: add to the newest batch, whose new fence covers the old one's work as well.
+    FencedBatch *batch;
+    if (batchCount == maxFencedBatches)
+    {
+        batch = &batches[(firstBatch + batchCount - 1) % maxFencedBatches];
+        glDeleteSync(batch->fence);
+    }
+    else
+        batch = &batches[(firstBatch + batchCount++) % maxFencedBatches];
+    batch->objects.insert(batch->objects.end(), released.begin(), released.end());
+    batch->fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    released.clear();
+}
+
+// Function to delete the queued objects without waiting for their fences. The driver still keeps an object
+// alive until the GPU is done with it; this only gives up on avoiding the synchronization.
+void destroyDeferredGlObjects()
+{
+    for (; batchCount > 0; --batchCount)
+    {
+        deleteBatch(batches[firstBatch]);
+        firstBatch = (firstBatch + 1) % maxFencedBatches;
+    }
+    for (const DeferredDeletion &object : released)
+        deleteObject(object);
+    released.clear();
+}
+
+// Function to print the live objects per kind and the statistics of the deferred deletions.
+void printGlObjectReport(std::ostream &out)
+{
+    out << "OpenGL objects:";
+    for (int kind = 0; kind < kindCount; ++kind)
+        out << (kind == 0 ? " " : ", ") << slotArrays[kind].live << " " << kindNames[kind];
+    out << "\n  " << deletedObjects << " deferred deletions, at most " << peakDeferred << " waiting at once, "
+        << staleLookups << " stale handle lookups\n"
+        << std::flush;
+}
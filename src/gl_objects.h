@@ -0,0 +1,111 @@
+#ifndef GL_OBJECTS_H
+#define GL_OBJECTS_H
+
+// Typed, generational handles for OpenGL objects, with owners that destroy them only once the GPU is done.
+// Every object lives in a slot of a dense array per kind; a handle is the slot index plus the generation the
+// slot had when the object was registered. Releasing an object bumps the generation, so stale copies of
+// the handle resolve to 0 instead of to whatever object reuses the slot (or the GL name) later.
+//
+// Deleting an object the GPU may still read (a buffer drawn from earlier in the frame) can make the driver
+// wait for the GPU or keep shadow copies. Released objects are therefore queued: glObjectsEndFrame puts
+// a fence behind the releases of the frame, and the objects are deleted at a later frame boundary once
+// that fence has signalled. Nothing ever waits for a fence.
+// All functions must be called on the thread that owns the OpenGL context.
+#include "glad.h"  // GLuint.
+#include <cstdint> // Handle fields.
+#include <ostream> // Report output.
+
+enum class GlObjectKind : uint8_t
+{
+    Buffer,
+    VertexArray,
+    Texture,
+    Framebuffer,
+    Renderbuffer,
+    Program,
+    Count
+};
+
+template <GlObjectKind Kind>
+struct GlHandle
+{
+    uint32_t index = 0;      // Slot in the array of the kind.
+    uint32_t generation = 0; // 0: the null handle.
+
+    explicit operator bool() const { return generation != 0; }
+    bool operator==(const GlHandle &other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const GlHandle &other) const { return !(*this == other); }
+};
+
+using BufferHandle = GlHandle<GlObjectKind::Buffer>;
+using VertexArrayHandle = GlHandle<GlObjectKind::VertexArray>;
+using TextureHandle = GlHandle<GlObjectKind::Texture>;
+using FramebufferHandle = GlHandle<GlObjectKind::Framebuffer>;
+using RenderbufferHandle = GlHandle<GlObjectKind::Renderbuffer>;
+using ProgramHandle = GlHandle<GlObjectKind::Program>;
+
+// Untyped registry functions behind the handles and owners.
+void registerGlObject(GlObjectKind kind, GLuint name, uint32_t &index, uint32_t &generation); // Takes over a GL name.
+GLuint generateGlObject(GlObjectKind kind);                                                   // glGen* for one object; 0 for programs.
+GLuint resolveGlObject(GlObjectKind kind, uint32_t index, uint32_t generation);               // 0 for null and stale handles.
+void releaseGlObject(GlObjectKind kind, uint32_t index, uint32_t generation);                 // Queues the deletion; stale handles are ignored.
+
+template <GlObjectKind Kind>
+GLuint glName(GlHandle<Kind> handle) { return resolveGlObject(Kind, handle.index, handle.generation); }
+
+// Move-only owner of one object: releasing it (destructor, reset or assignment) queues the deletion.
+template <GlObjectKind Kind>
+class GlObject
+{
+public:
+    GlObject() = default;
+    explicit GlObject(GLuint name) // Takes over an object created elsewhere, e.g. by createShaderProgram. Name 0 stays null.
+    {
+        if (name != 0)
+            registerGlObject(Kind, name, owned.index, owned.generation);
+    }
+    ~GlObject() { reset(); }
+
+    GlObject(GlObject &&other) noexcept : owned(other.owned) { other.owned = GlHandle<Kind>(); }
+    GlObject &operator=(GlObject &&other) noexcept
+    {
+        if (this != &other)
+        {
+            reset();
+            owned = other.owned;
+            other.owned = GlHandle<Kind>();
+        }
+        return *this;
+    }
+    GlObject(const GlObject &) = delete;
+    GlObject &operator=(const GlObject &) = delete;
+
+    static GlObject create() { return GlObject(generateGlObject(Kind)); } // glGen* a new object.
+
+    GLuint name() const { return glName(owned); } // For the OpenGL calls.
+    GlHandle<Kind> handle() const { return owned; } // Non-owning reference; resolves to 0 once the owner released it.
+    explicit operator bool() const { return (bool)owned; }
+
+    void reset()
+    {
+        if (owned)
+            releaseGlObject(Kind, owned.index, owned.generation);
+        owned = GlHandle<Kind>();
+    }
+
+private:
+    GlHandle<Kind> owned;
+};
+
+using UniqueBuffer = GlObject<GlObjectKind::Buffer>;
+using UniqueVertexArray = GlObject<GlObjectKind::VertexArray>;
+using UniqueTexture = GlObject<GlObjectKind::Texture>;
+using UniqueFramebuffer = GlObject<GlObjectKind::Framebuffer>;
+using UniqueRenderbuffer = GlObject<GlObjectKind::Renderbuffer>;
+using UniqueProgram = GlObject<GlObjectKind::Program>;
+
+void glObjectsEndFrame();        // Once per frame after the last draw: fences this frame's releases, deletes the ones the GPU finished.
+void destroyDeferredGlObjects(); // Deletes every queued object now; call before the context goes away.
+void printGlObjectReport(std::ostream &out); // Live objects per kind, deferred deletions and stale lookups.
+
+#endif
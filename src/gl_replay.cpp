@@ -0,0 +1,769 @@
+// gl_replay: plays back an OpenGL trace recorded with --trace in a hidden window, as fast as possible,
+// and reports how long every frame takes, so driver cost can be measured without the application.
+//
+// Usage: gl_replay <trace file> [--repeat <n>] [--no-finish]
+//   --repeat <n>  Play the recorded frames n times (the first frame, which creates the resources, only once).
+//   --no-finish   Do not wait for the GPU after each frame; only the CPU submission time is measured then.
+#include "gl_context.h" // Hidden window providing the context.
+#include "gl_trace.h"   // Trace file format.
+#include <algorithm>    // std::max.
+#include <chrono>       // Frame timing.
+#include <cstdio>       // printf for the timing table.
+#include <cstdlib>      // atoi.
+#include <cstring>      // memcpy, strcmp.
+#include <fstream>      // Reads the trace file.
+#include <iostream>     // Included for error output.
+#include <map>          // Translation of uniform locations.
+#include <string>       // Uniform names.
+#include <unordered_map> // Translation of object names.
+#include <utility>      // std::pair.
+#include <vector>       // Trace contents and timings.
+
+// Reads the arguments of one call; any read past the end of the chunk marks the chunk as broken.
+struct TraceReader
+{
+    const unsigned char *position;
+    const unsigned char *end;
+    bool ok = true;
+
+    template <typename T>
+    T get()
+    {
+        T value{};
+        if (end - position < (long)sizeof(T))
+        {
+            ok = false;
+            position = end;
+            return value;
+        }
+        std::memcpy(&value, position, sizeof(T));
+        position += sizeof(T);
+        return value;
+    }
+
+    // Returns a pointer to size bytes of call data inside the trace.
+    const unsigned char *bytes(size_t size)
+    {
+        if ((size_t)(end - position) < size)
+        {
+            ok = false;
+            position = end;
+            return nullptr;
+        }
+        const unsigned char *data = position;
+        position += size;
+        return data;
+    }
+
+    std::string string()
+    {
+        uint32_t size = get<uint32_t>();
+        const unsigned char *data = bytes(size);
+        return data != nullptr ? std::string((const char *)data, size) : std::string();
+    }
+};
+
+// Object names and locations of the recording session mapped to the ones created during the replay.
+struct ReplayState
+{
+    std::unordered_map<GLuint, GLuint> buffers, vertexArrays, framebuffers, renderbuffers, textures, shaders, programs;
+    std::unordered_map<uint64_t, GLsync> syncs;
+    std::map<std::pair<GLuint, GLint>, GLint> uniformLocations;   // (recorded program, recorded location).
+    std::map<std::pair<GLuint, GLuint>, GLuint> uniformBlocks;    // (recorded program, recorded index).
+    GLuint currentProgram = 0;                                     // Recorded name of the program in use.
+    std::vector<unsigned char> scratch;                           // Destination of reads into client memory.
+};
+
+// Function to translate a recorded object name. Name 0 (no object) stays 0.
+static GLuint mapName(const std::unordered_map<GLuint, GLuint> &names, GLuint recorded)
+{
+    auto found = names.find(recorded);
+    return found != names.end() ? found->second : recorded;
+}
+
+// Function to replay glGen*: create the same number of objects and remember their names.
+static void replayGen(TraceReader &reader, std::unordered_map<GLuint, GLuint> &names, PFNGLGENBUFFERSPROC gen)
+{
+    GLsizei count = reader.get<GLsizei>();
+    const unsigned char *recorded = reader.bytes(sizeof(GLuint) * count);
+    if (recorded == nullptr || count <= 0)
+        return;
+    std::vector<GLuint> created(count);
+    gen(count, created.data());
+    for (GLsizei i = 0; i < count; ++i)
+    {
+        GLuint name;
+        std::memcpy(&name, recorded + sizeof(GLuint) * i, sizeof(GLuint));
+        names[name] = created[i];
+    }
+}
+
+// Function to replay glDelete*.
+static void replayDelete(TraceReader &reader, std::unordered_map<GLuint, GLuint> &names, PFNGLDELETEBUFFERSPROC del)
+{
+    GLsizei count = reader.get<GLsizei>();
+    const unsigned char *recorded = reader.bytes(sizeof(GLuint) * count);
+    if (recorded == nullptr || count <= 0)
+        return;
+    std::vector<GLuint> deleted(count);
+    for (GLsizei i = 0; i < count; ++i)
+    {
+        GLuint name;
+        std::memcpy(&name, recorded + sizeof(GLuint) * i, sizeof(GLuint));
+        deleted[i] = mapName(names, name);
+        names.erase(name);
+    }
+    del(count, deleted.data());
+}
+
+// Function to translate a uniform location of the program in use.
+static GLint mapLocation(const ReplayState &state, GLint recorded)
+{
+    auto found = state.uniformLocations.find({state.currentProgram, recorded});
+    return found != state.uniformLocations.end() ? found->second : -1;
+}
+
+// Function to issue the calls of one chunk. Returns the number of calls, or -1 if the chunk is damaged.
+static int replayChunk(const unsigned char *data, size_t size, ReplayState &state)
+{
+    TraceReader reader{data, data + size};
+    int calls = 0;
+    while (reader.ok && reader.position < reader.end)
+    {
+        GlTraceOp op = (GlTraceOp)reader.get<uint16_t>();
+        switch (op)
+        {
+        case GlTraceOp::GenBuffers: replayGen(reader, state.buffers, glad_glGenBuffers); break;
+        case GlTraceOp::DeleteBuffers: replayDelete(reader, state.buffers, glad_glDeleteBuffers); break;
+        case GlTraceOp::GenVertexArrays: replayGen(reader, state.vertexArrays, glad_glGenVertexArrays); break;
+        case GlTraceOp::DeleteVertexArrays: replayDelete(reader, state.vertexArrays, glad_glDeleteVertexArrays); break;
+        case GlTraceOp::GenFramebuffers: replayGen(reader, state.framebuffers, glad_glGenFramebuffers); break;
+        case GlTraceOp::DeleteFramebuffers: replayDelete(reader, state.framebuffers, glad_glDeleteFramebuffers); break;
+        case GlTraceOp::GenRenderbuffers: replayGen(reader, state.renderbuffers, glad_glGenRenderbuffers); break;
+        case GlTraceOp::DeleteRenderbuffers: replayDelete(reader, state.renderbuffers, glad_glDeleteRenderbuffers); break;
+        case GlTraceOp::GenTextures: replayGen(reader, state.textures, glad_glGenTextures); break;
+        case GlTraceOp::DeleteTextures: replayDelete(reader, state.textures, glad_glDeleteTextures); break;
+
+        case GlTraceOp::CreateShader:
+        {
+            GLenum type = reader.get<GLenum>();
+            GLuint recorded = reader.get<GLuint>();
+            state.shaders[recorded] = glCreateShader(type);
+            break;
+        }
+        case GlTraceOp::DeleteShader:
+        {
+            GLuint recorded = reader.get<GLuint>();
+            glDeleteShader(mapName(state.shaders, recorded));
+            state.shaders.erase(recorded);
+            break;
+        }
+        case GlTraceOp::ShaderSource:
+        {
+            GLuint shader = mapName(state.shaders, reader.get<GLuint>());
+            GLsizei count = reader.get<GLsizei>();
+            std::vector<std::string> sources;
+            for (GLsizei i = 0; i < count && reader.ok; ++i)
+                sources.push_back(reader.string());
+            std::vector<const GLchar *> strings;
+            std::vector<GLint> lengths;
+            for (const std::string &source : sources)
+            {
+                strings.push_back(source.data());
+                lengths.push_back((GLint)source.size());
+            }
+            glShaderSource(shader, (GLsizei)sources.size(), strings.data(), lengths.data());
+            break;
+        }
+        case GlTraceOp::CompileShader: glCompileShader(mapName(state.shaders, reader.get<GLuint>())); break;
+
+        case GlTraceOp::CreateProgram: state.programs[reader.get<GLuint>()] = glCreateProgram(); break;
+        case GlTraceOp::DeleteProgram:
+        {
+            GLuint recorded = reader.get<GLuint>();
+            glDeleteProgram(mapName(state.programs, recorded));
+            state.programs.erase(recorded);
+            break;
+        }
+        case GlTraceOp::AttachShader:
+        {
+            GLuint program = mapName(state.programs, reader.get<GLuint>());
+            GLuint shader = mapName(state.shaders, reader.get<GLuint>());
+            glAttachShader(program, shader);
+            break;
+        }
+        case GlTraceOp::LinkProgram: glLinkProgram(mapName(state.programs, reader.get<GLuint>())); break;
+        case GlTraceOp::ValidateProgram: glValidateProgram(mapName(state.programs, reader.get<GLuint>())); break;
+        case GlTraceOp::UseProgram:
+            state.currentProgram = reader.get<GLuint>();
+            glUseProgram(mapName(state.programs, state.currentProgram));
+            break;
+
+        case GlTraceOp::GetUniformLocation:
+        {
+            GLuint program = reader.get<GLuint>();
+            std::string name = reader.string();
+            GLint recorded = reader.get<GLint>();
+            state.uniformLocations[{program, recorded}] = glGetUniformLocation(mapName(state.programs, program), name.c_str());
+            break;
+        }
+        case GlTraceOp::GetUniformBlockIndex:
+        {
+            GLuint program = reader.get<GLuint>();
+            std::string name = reader.string();
+            GLuint recorded = reader.get<GLuint>();
+            state.uniformBlocks[{program, recorded}] = glGetUniformBlockIndex(mapName(state.programs, program), name.c_str());
+            break;
+        }
+        case GlTraceOp::UniformBlockBinding:
+        {
+            GLuint program = reader.get<GLuint>();
+            GLuint index = reader.get<GLuint>();
+            GLuint binding = reader.get<GLuint>();
+            auto found = state.uniformBlocks.find({program, index});
+            glUniformBlockBinding(mapName(state.programs, program), found != state.uniformBlocks.end() ? found->second : index, binding);
+            break;
+        }
+        case GlTraceOp::Uniform1i:
+        {
+            GLint location = reader.get<GLint>();
+            GLint value = reader.get<GLint>();
+            glUniform1i(mapLocation(state, location), value);
+            break;
+        }
+        case GlTraceOp::UniformMatrix4fv:
+        {
+            GLint location = reader.get<GLint>();
+            GLsizei count = reader.get<GLsizei>();
+            GLboolean transpose = reader.get<GLboolean>();
+            const unsigned char *values = reader.bytes(sizeof(GLfloat) * 16 * count);
+            if (values != nullptr)
+                glUniformMatrix4fv(mapLocation(state, location), count, transpose, (const GLfloat *)values);
+            break;
+        }
+
+        case GlTraceOp::BindBuffer:
+        {
+            GLenum target = reader.get<GLenum>();
+            glBindBuffer(target, mapName(state.buffers, reader.get<GLuint>()));
+            break;
+        }
+        case GlTraceOp::BindBufferBase:
+        {
+            GLenum target = reader.get<GLenum>();
+            GLuint index = reader.get<GLuint>();
+            glBindBufferBase(target, index, mapName(state.buffers, reader.get<GLuint>()));
+            break;
+        }
+        case GlTraceOp::BufferData:
+        {
+            GLenum target = reader.get<GLenum>();
+            GLsizeiptr size = reader.get<GLsizeiptr>();
+            GLenum usage = reader.get<GLenum>();
+            bool hasData = reader.get<uint8_t>() != 0;
+            const unsigned char *contents = hasData ? reader.bytes((size_t)size) : nullptr;
+            glBufferData(target, size, contents, usage);
+            break;
+        }
+        case GlTraceOp::BufferSubData:
+        {
+            GLenum target = reader.get<GLenum>();
+            GLintptr offset = reader.get<GLintptr>();
+            GLsizeiptr size = reader.get<GLsizeiptr>();
+            const unsigned char *contents = reader.bytes((size_t)size);
+            if (contents != nullptr)
+                glBufferSubData(target, offset, size, contents);
+            break;
+        }
+        case GlTraceOp::MapBufferRange:
+        {
+            GLenum target = reader.get<GLenum>();
+            GLintptr offset = reader.get<GLintptr>();
+            GLsizeiptr length = reader.get<GLsizeiptr>();
+            GLbitfield access = reader.get<GLbitfield>();
+            glMapBufferRange(target, offset, length, access);
+            break;
+        }
+        case GlTraceOp::UnmapBuffer: glUnmapBuffer(reader.get<GLenum>()); break;
+
+        case GlTraceOp::BindVertexArray: glBindVertexArray(mapName(state.vertexArrays, reader.get<GLuint>())); break;
+        case GlTraceOp::EnableVertexAttribArray: glEnableVertexAttribArray(reader.get<GLuint>()); break;
+        case GlTraceOp::VertexAttribPointer:
+        {
+            GLuint index = reader.get<GLuint>();
+            GLint components = reader.get<GLint>();
+            GLenum type = reader.get<GLenum>();
+            GLboolean normalized = reader.get<GLboolean>();
+            GLsizei stride = reader.get<GLsizei>();
+            uint64_t offset = reader.get<uint64_t>();
+            glVertexAttribPointer(index, components, type, normalized, stride, (const void *)(uintptr_t)offset);
+            break;
+        }
+
+        case GlTraceOp::BindFramebuffer:
+        {
+            GLenum target = reader.get<GLenum>();
+            glBindFramebuffer(target, mapName(state.framebuffers, reader.get<GLuint>()));
+            break;
+        }
+        case GlTraceOp::BindRenderbuffer:
+        {
+            GLenum target = reader.get<GLenum>();
+            glBindRenderbuffer(target, mapName(state.renderbuffers, reader.get<GLuint>()));
+            break;
+        }
+        case GlTraceOp::RenderbufferStorage:
+        {
+            GLenum target = reader.get<GLenum>();
+            GLenum format = reader.get<GLenum>();
+            GLsizei width = reader.get<GLsizei>();
+            GLsizei height = reader.get<GLsizei>();
+            glRenderbufferStorage(target, format, width, height);
+            break;
+        }
+        case GlTraceOp::FramebufferRenderbuffer:
+        {
+            GLenum target = reader.get<GLenum>();
+            GLenum attachment = reader.get<GLenum>();
+            GLenum renderbufferTarget = reader.get<GLenum>();
+            GLuint renderbuffer = mapName(state.renderbuffers, reader.get<GLuint>());
+            glFramebufferRenderbuffer(target, attachment, renderbufferTarget, renderbuffer);
+            break;
+        }
+        case GlTraceOp::ReadBuffer: glReadBuffer(reader.get<GLenum>()); break;
+        case GlTraceOp::PixelStorei:
+        {
+            GLenum pname = reader.get<GLenum>();
+            glPixelStorei(pname, reader.get<GLint>());
+            break;
+        }
+        case GlTraceOp::ReadPixels:
+        {
+            GLint x = reader.get<GLint>();
+            GLint y = reader.get<GLint>();
+            GLsizei width = reader.get<GLsizei>();
+            GLsizei height = reader.get<GLsizei>();
+            GLenum format = reader.get<GLenum>();
+            GLenum type = reader.get<GLenum>();
+            bool toBuffer = reader.get<uint8_t>() != 0;
+            uint64_t offset = reader.get<uint64_t>();
+            void *pixels = (void *)(uintptr_t)offset;
+            if (!toBuffer)
+            {
+                state.scratch.resize((size_t)width * height * 16); // Room for the widest pixel format.
+                pixels = state.scratch.data();
+            }
+            glReadPixels(x, y, width, height, format, type, pixels);
+            break;
+        }
+        case GlTraceOp::Viewport:
+        {
+            GLint x = reader.get<GLint>();
+            GLint y = reader.get<GLint>();
+            GLsizei width = reader.get<GLsizei>();
+            GLsizei height = reader.get<GLsizei>();
+            glViewport(x, y, width, height);
+            break;
+        }
+        case GlTraceOp::ViewportArrayv:
+        {
+            GLuint first = reader.get<GLuint>();
+            GLsizei count = reader.get<GLsizei>();
+            const unsigned char *viewports = reader.bytes(sizeof(GLfloat) * 4 * count);
+            if (viewports != nullptr && glad_glViewportArrayv != nullptr)
+                glViewportArrayv(first, count, (const GLfloat *)viewports);
+            break;
+        }
+        case GlTraceOp::ClearColor:
+        {
+            GLfloat red = reader.get<GLfloat>();
+            GLfloat green = reader.get<GLfloat>();
+            GLfloat blue = reader.get<GLfloat>();
+            GLfloat alpha = reader.get<GLfloat>();
+            glClearColor(red, green, blue, alpha);
+            break;
+        }
+        case GlTraceOp::Clear: glClear(reader.get<GLbitfield>()); break;
+
+        case GlTraceOp::DrawElements:
+        {
+            GLenum mode = reader.get<GLenum>();
+            GLsizei count = reader.get<GLsizei>();
+            GLenum type = reader.get<GLenum>();
+            uint64_t offset = reader.get<uint64_t>();
+            glDrawElements(mode, count, type, (const void *)(uintptr_t)offset);
+            break;
+        }
+        case GlTraceOp::DrawElementsInstanced:
+        {
+            GLenum mode = reader.get<GLenum>();
+            GLsizei count = reader.get<GLsizei>();
+            GLenum type = reader.get<GLenum>();
+            uint64_t offset = reader.get<uint64_t>();
+            GLsizei instanceCount = reader.get<GLsizei>();
+            glDrawElementsInstanced(mode, count, type, (const void *)(uintptr_t)offset, instanceCount);
+            break;
+        }
+
+        case GlTraceOp::FenceSync:
+        {
+            GLenum condition = reader.get<GLenum>();
+            GLbitfield flags = reader.get<GLbitfield>();
+            state.syncs[reader.get<uint64_t>()] = glFenceSync(condition, flags);
+            break;
+        }
+        case GlTraceOp::ClientWaitSync:
+        {
+            auto found = state.syncs.find(reader.get<uint64_t>());
+            GLbitfield flags = reader.get<GLbitfield>();
+            GLuint64 timeout = reader.get<GLuint64>();
+            if (found != state.syncs.end())
+                glClientWaitSync(found->second, flags, timeout);
+            break;
+        }
+        case GlTraceOp::DeleteSync:
+        {
+            auto found = state.syncs.find(reader.get<uint64_t>());
+            if (found != state.syncs.end())
+            {
+                glDeleteSync(found->second);
+                state.syncs.erase(found);
+            }
+            break;
+        }
+
+        case GlTraceOp::BindTexture:
+        {
+            GLenum target = reader.get<GLenum>();
+            glBindTexture(target, mapName(state.textures, reader.get<GLuint>()));
+            break;
+        }
+        case GlTraceOp::ActiveTexture: glActiveTexture(reader.get<GLenum>()); break;
+        case GlTraceOp::TexImage2D:
+        {
+            GLenum target = reader.get<GLenum>();
+            GLint level = reader.get<GLint>();
+            GLint internalFormat = reader.get<GLint>();
+            GLsizei width = reader.get<GLsizei>();
+            GLsizei height = reader.get<GLsizei>();
+            GLint border = reader.get<GLint>();
+            GLenum format = reader.get<GLenum>();
+            GLenum type = reader.get<GLenum>();
+            bool hasData = reader.get<uint8_t>() != 0;
+            const void *pixels = (const void *)(uintptr_t)reader.get<uint64_t>();
+            if (hasData)
+                pixels = reader.bytes((size_t)reader.get<uint64_t>());
+            glTexImage2D(target, level, internalFormat, width, height, border, format, type, pixels);
+            break;
+        }
+        case GlTraceOp::TexParameteri:
+        {
+            GLenum target = reader.get<GLenum>();
+            GLenum pname = reader.get<GLenum>();
+            glTexParameteri(target, pname, reader.get<GLint>());
+            break;
+        }
+        case GlTraceOp::VertexAttribDivisor:
+        {
+            GLuint index = reader.get<GLuint>();
+            glVertexAttribDivisor(index, reader.get<GLuint>());
+            break;
+        }
+        case GlTraceOp::DrawArraysInstanced:
+        {
+            GLenum mode = reader.get<GLenum>();
+            GLint first = reader.get<GLint>();
+            GLsizei count = reader.get<GLsizei>();
+            GLsizei instanceCount = reader.get<GLsizei>();
+            glDrawArraysInstanced(mode, first, count, instanceCount);
+            break;
+        }
+        case GlTraceOp::Enable: glEnable(reader.get<GLenum>()); break;
+        case GlTraceOp::Disable: glDisable(reader.get<GLenum>()); break;
+        case GlTraceOp::BlendFunc:
+        {
+            GLenum source = reader.get<GLenum>();
+            glBlendFunc(source, reader.get<GLenum>());
+            break;
+        }
+        case GlTraceOp::Uniform2f:
+        {
+            GLint location = reader.get<GLint>();
+            GLfloat v0 = reader.get<GLfloat>();
+            GLfloat v1 = reader.get<GLfloat>();
+            glUniform2f(mapLocation(state, location), v0, v1);
+            break;
+        }
+        case GlTraceOp::Uniform4f:
+        {
+            GLint location = reader.get<GLint>();
+            GLfloat v0 = reader.get<GLfloat>();
+            GLfloat v1 = reader.get<GLfloat>();
+            GLfloat v2 = reader.get<GLfloat>();
+            GLfloat v3 = reader.get<GLfloat>();
+            glUniform4f(mapLocation(state, location), v0, v1, v2, v3);
+            break;
+        }
+        case GlTraceOp::TexBuffer:
+        {
+            GLenum target = reader.get<GLenum>();
+            GLenum internalformat = reader.get<GLenum>();
+            glTexBuffer(target, internalformat, mapName(state.buffers, reader.get<GLuint>()));
+            break;
+        }
+        case GlTraceOp::DrawArrays:
+        {
+            GLenum mode = reader.get<GLenum>();
+            GLint first = reader.get<GLint>();
+            GLsizei count = reader.get<GLsizei>();
+            glDrawArrays(mode, first, count);
+            break;
+        }
+        case GlTraceOp::FramebufferTexture2D:
+        {
+            GLenum target = reader.get<GLenum>();
+            GLenum attachment = reader.get<GLenum>();
+            GLenum textureTarget = reader.get<GLenum>();
+            GLuint texture = mapName(state.textures, reader.get<GLuint>());
+            GLint level = reader.get<GLint>();
+            glFramebufferTexture2D(target, attachment, textureTarget, texture, level);
+            break;
+        }
+        case GlTraceOp::GenerateMipmap: glGenerateMipmap(reader.get<GLenum>()); break;
+        case GlTraceOp::PushDebugGroup:
+        {
+            GLenum source = reader.get<GLenum>();
+            GLuint id = reader.get<GLuint>();
+            std::string message = reader.string();
+            if (glad_glPushDebugGroup != nullptr)
+                glPushDebugGroup(source, id, (GLsizei)message.size(), message.data());
+            break;
+        }
+        case GlTraceOp::PopDebugGroup:
+            if (glad_glPopDebugGroup != nullptr)
+                glPopDebugGroup();
+            break;
+        case GlTraceOp::ObjectLabel:
+        {
+            GLenum identifier = reader.get<GLenum>();
+            GLuint recorded = reader.get<GLuint>();
+            std::string label = reader.string();
+            const std::unordered_map<GLuint, GLuint> *names = nullptr;
+            switch (identifier)
+            {
+            case GL_BUFFER: names = &state.buffers; break;
+            case GL_VERTEX_ARRAY: names = &state.vertexArrays; break;
+            case GL_FRAMEBUFFER: names = &state.framebuffers; break;
+            case GL_RENDERBUFFER: names = &state.renderbuffers; break;
+            case GL_TEXTURE: names = &state.textures; break;
+            case GL_SHADER: names = &state.shaders; break;
+            case GL_PROGRAM: names = &state.programs; break;
+            }
+            // Objects the trace does not record (queries) have no counterpart in the replay
+            if (names != nullptr && glad_glObjectLabel != nullptr)
+                glObjectLabel(identifier, mapName(*names, recorded), (GLsizei)label.size(), label.data());
+            break;
+        }
+        case GlTraceOp::TexStorage3D:
+        {
+            GLenum target = reader.get<GLenum>();
+            GLsizei levels = reader.get<GLsizei>();
+            GLenum internalFormat = reader.get<GLenum>();
+            GLsizei width = reader.get<GLsizei>();
+            GLsizei height = reader.get<GLsizei>();
+            GLsizei depth = reader.get<GLsizei>();
+            if (glad_glTexStorage3D != nullptr)
+                glTexStorage3D(target, levels, internalFormat, width, height, depth);
+            break;
+        }
+        case GlTraceOp::TexPageCommitmentARB:
+        {
+            GLenum target = reader.get<GLenum>();
+            GLint level = reader.get<GLint>();
+            GLint x = reader.get<GLint>();
+            GLint y = reader.get<GLint>();
+            GLint z = reader.get<GLint>();
+            GLsizei width = reader.get<GLsizei>();
+            GLsizei height = reader.get<GLsizei>();
+            GLsizei depth = reader.get<GLsizei>();
+            GLboolean commit = reader.get<GLboolean>();
+            if (glad_glTexPageCommitmentARB != nullptr)
+                glTexPageCommitmentARB(target, level, x, y, z, width, height, depth, commit);
+            break;
+        }
+        case GlTraceOp::CompressedTexSubImage3D:
+        {
+            GLenum target = reader.get<GLenum>();
+            GLint level = reader.get<GLint>();
+            GLint x = reader.get<GLint>();
+            GLint y = reader.get<GLint>();
+            GLint z = reader.get<GLint>();
+            GLsizei width = reader.get<GLsizei>();
+            GLsizei height = reader.get<GLsizei>();
+            GLsizei depth = reader.get<GLsizei>();
+            GLenum format = reader.get<GLenum>();
+            GLsizei imageSize = reader.get<GLsizei>();
+            bool hasData = reader.get<uint8_t>() != 0;
+            const void *data = (const void *)(uintptr_t)reader.get<uint64_t>();
+            if (hasData)
+                data = reader.bytes((size_t)imageSize);
+            glCompressedTexSubImage3D(target, level, x, y, z, width, height, depth, format, imageSize, data);
+            break;
+        }
+        case GlTraceOp::TexSubImage3D:
+        {
+            GLenum target = reader.get<GLenum>();
+            GLint level = reader.get<GLint>();
+            GLint x = reader.get<GLint>();
+            GLint y = reader.get<GLint>();
+            GLint z = reader.get<GLint>();
+            GLsizei width = reader.get<GLsizei>();
+            GLsizei height = reader.get<GLsizei>();
+            GLsizei depth = reader.get<GLsizei>();
+            GLenum format = reader.get<GLenum>();
+            GLenum type = reader.get<GLenum>();
+            bool hasData = reader.get<uint8_t>() != 0;
+            const void *pixels = (const void *)(uintptr_t)reader.get<uint64_t>();
+            if (hasData)
+                pixels = reader.bytes((size_t)reader.get<uint64_t>());
+            glTexSubImage3D(target, level, x, y, z, width, height, depth, format, type, pixels);
+            break;
+        }
+
+        default:
+            return -1; // Unknown call: the rest of the chunk cannot be decoded.
+        }
+        ++calls;
+    }
+    return reader.ok ? calls : -1;
+}
+
+// Timing of one replayed frame.
+struct ReplayFrame
+{
+    int calls = 0;
+    double submitMs = 0.0; // Issuing the calls (driver CPU time).
+    double finishMs = 0.0; // Waiting for the GPU afterwards.
+};
+
+int main(int argc, char **argv)
+{
+    if (argc < 2)
+    {
+        std::cerr << "Usage: gl_replay <trace file> [--repeat <n>] [--no-finish]" << std::endl;
+        return -1;
+    }
+    int repeat = 1;
+    bool finishFrames = true;
+    for (int i = 2; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+            repeat = std::atoi(argv[++i]);
+        else if (std::strcmp(argv[i], "--no-finish") == 0)
+            finishFrames = false;
+        else
+        {
+            std::cerr << "Unknown option: " << argv[i] << std::endl;
+            return -1;
+        }
+    }
+
+    // Load the whole trace first so file reads do not show up in the timings
+    std::ifstream file(argv[1], std::ios::binary);
+    std::vector<unsigned char> trace((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    GlTraceHeader header;
+    if (trace.size() < sizeof(header))
+    {
+        std::cerr << "Could not read the trace " << argv[1] << std::endl;
+        return -1;
+    }
+    std::memcpy(&header, trace.data(), sizeof(header));
+    if (std::memcmp(header.magic, glTraceMagic, sizeof(header.magic)) != 0 || header.opCount > (uint32_t)GlTraceOp::Count)
+    {
+        std::cerr << argv[1] << " is not a trace this replayer understands" << std::endl;
+        return -1;
+    }
+
+    // Split the trace into its frame chunks
+    std::vector<std::pair<size_t, size_t>> chunks; // Offset and size of the calls of every frame.
+    size_t offset = sizeof(header);
+    while (offset + sizeof(uint32_t) <= trace.size())
+    {
+        uint32_t size;
+        std::memcpy(&size, trace.data() + offset, sizeof(size));
+        offset += sizeof(size);
+        if (offset + size > trace.size())
+            break;
+        chunks.push_back({offset, size});
+        offset += size;
+    }
+    if (chunks.empty())
+    {
+        std::cerr << "The trace contains no frames" << std::endl;
+        return -1;
+    }
+
+    if (!glfwInit())
+        return -1;
+    ContextSettings contextSettings;
+    contextSettings.width = header.width > 0 ? header.width : 800;
+    contextSettings.height = header.height > 0 ? header.height : 600;
+    contextSettings.title = "gl_replay";
+    contextSettings.visible = false;
+    GLFWwindow *window = createContextWindow(contextSettings);
+    if (window == nullptr)
+    {
+        glfwTerminate();
+        return -1;
+    }
+    glfwSwapInterval(0);
+
+    // The first chunk creates the resources; it is timed separately and never repeated.
+    ReplayState state;
+    std::vector<ReplayFrame> frames;
+    int result = 0;
+    for (int pass = 0; pass < repeat && result == 0; ++pass)
+    {
+        for (size_t chunk = pass == 0 ? 0 : 1; chunk < chunks.size(); ++chunk)
+        {
+            ReplayFrame frame;
+            auto start = std::chrono::steady_clock::now();
+            frame.calls = replayChunk(trace.data() + chunks[chunk].first, chunks[chunk].second, state);
+            auto submitted = std::chrono::steady_clock::now();
+            if (finishFrames)
+                glFinish();
+            auto finished = std::chrono::steady_clock::now();
+            if (frame.calls < 0)
+            {
+                std::cerr << "Frame " << chunk << " of the trace is damaged" << std::endl;
+                result = -1;
+                break;
+            }
+            frame.submitMs = std::chrono::duration<double, std::milli>(submitted - start).count();
+            frame.finishMs = std::chrono::duration<double, std::milli>(finished - submitted).count();
+            frames.push_back(frame);
+        }
+    }
+
+    // Per-frame table, then a summary of the steady-state frames
+    std::printf("%6s %7s %11s %11s\n", "frame", "calls", "submit ms", "finish ms");
+    for (size_t i = 0; i < frames.size(); ++i)
+        std::printf("%6zu %7d %11.3f %11.3f%s\n", i, frames[i].calls, frames[i].submitMs, frames[i].finishMs, i == 0 ? "  (setup)" : "");
+    if (frames.size() > 1)
+    {
+        double submitTotal = 0.0, finishTotal = 0.0, submitMax = 0.0;
+        for (size_t i = 1; i < frames.size(); ++i)
+        {
+            submitTotal += frames[i].submitMs;
+            finishTotal += frames[i].finishMs;
+            submitMax = std::max(submitMax, frames[i].submitMs);
+        }
+        double count = (double)(frames.size() - 1);
+        std::printf("%zu frames: submit %.3f ms avg (%.3f max), finish %.3f ms avg, %.1f frames/s\n", frames.size() - 1,
+                    submitTotal / count, submitMax, finishTotal / count, 1000.0 * count / (submitTotal + finishTotal));
+    }
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return result;
+}
@@ -0,0 +1,510 @@
+#include "gl_trace.h"
+#include "glad.h"   // The glad_gl* function pointers that are swapped for the recording wrappers.
+#include "logger.h" // Status and error messages.
+#include <condition_variable> // Wakes the writer thread and a render thread that waits for it.
+#include <cstdio>             // FILE output of the trace.
+#include <cstring>            // memcpy and strlen.
+#include <deque>              // Frames waiting for the writer.
+#include <mutex>              // Protects the frame queue.
+#include <thread>             // The writer thread.
+#include <vector>             // Call buffer of the current frame.
+
+// Frames the render thread may get ahead of the writer; beyond that it waits, since a trace cannot drop frames.
+static const size_t maxPendingFrames = 8;
+
+// State of the running trace. All recorded calls come from the render thread, so the call buffer needs no locking;
+// finished frames go to a writer thread, so the file writes (a megabyte or more per frame) stay out of the frame time.
+static FILE *traceFile = nullptr;
+static std::vector<unsigned char> frameCalls; // Calls of the current frame, handed to the writer by glTraceEndFrame.
+static int framesLeft = 0;
+static int framesWritten = 0;
+static long long bytesWritten = 0;
+
+// Writer thread and its queue, guarded by traceMutex. Written buffers come back as spares, so a long trace reuses them.
+static std::thread traceWriter;
+static std::mutex traceMutex;
+static std::condition_variable frameQueued;  // Signalled when a frame is queued or the trace stops.
+static std::condition_variable frameWritten; // Signalled when the writer took a frame off the queue.
+static std::deque<std::vector<unsigned char>> pendingFrames;
+static std::vector<std::vector<unsigned char>> spareFrames;
+static bool writerStopping = false;
+
+// Function to append raw bytes to the current frame.
+static void putBytes(const void *data, size_t size)
+{
+    size_t offset = frameCalls.size();
+    frameCalls.resize(offset + size);
+    if (size > 0)
+        std::memcpy(frameCalls.data() + offset, data, size);
+}
+
+// Function to append scalar arguments in their native size.
+static void putAll() {}
+template <typename T, typename... Rest>
+static void putAll(T value, Rest... rest)
+{
+    putBytes(&value, sizeof(value));
+    putAll(rest...);
+}
+
+static void putOp(GlTraceOp op) { putAll((uint16_t)op); }
+
+// Function to append a string with its length.
+static void putString(const char *text, int length)
+{
+    uint32_t size = (uint32_t)(length >= 0 ? length : (int)std::strlen(text));
+    putAll(size);
+    putBytes(text, size);
+}
+
+// Pointers are stored as 64-bit numbers: buffer offsets for the calls that source from a bound buffer,
+// and the opaque handle for sync objects.
+static uint64_t pointerValue(const void *pointer) { return (uint64_t)(uintptr_t)pointer; }
+
+// Driver function of every recorded call, saved while the wrappers are installed.
+#define GL_TRACE_REAL(name) static decltype(glad_gl##name) real##name = nullptr;
+GL_TRACE_OPS(GL_TRACE_REAL)
+#undef GL_TRACE_REAL
+
+// Wrapper for calls whose arguments are all plain numbers (enums, names, sizes, values).
+#define GL_TRACE_SCALAR_CALL(name, params, args) \
+    static void APIENTRY trace##name params      \
+    {                                            \
+        putOp(GlTraceOp::name);                  \
+        putAll args;                             \
+        real##name args;                         \
+    }
+
+// Wrapper for glGen* calls: the names are recorded after the driver created them.
+#define GL_TRACE_GEN_CALL(name)                            \
+    static void APIENTRY trace##name(GLsizei n, GLuint *names) \
+    {                                                      \
+        real##name(n, names);                              \
+        putOp(GlTraceOp::name);                            \
+        putAll(n);                                         \
+        putBytes(names, sizeof(GLuint) * n);               \
+    }
+
+// Wrapper for glDelete* calls.
+#define GL_TRACE_DELETE_CALL(name)                                 \
+    static void APIENTRY trace##name(GLsizei n, const GLuint *names) \
+    {                                                              \
+        putOp(GlTraceOp::name);                                    \
+        putAll(n);                                                 \
+        putBytes(names, sizeof(GLuint) * n);                       \
+        real##name(n, names);                                      \
+    }
+
+GL_TRACE_GEN_CALL(GenBuffers)
+GL_TRACE_DELETE_CALL(DeleteBuffers)
+GL_TRACE_GEN_CALL(GenVertexArrays)
+GL_TRACE_DELETE_CALL(DeleteVertexArrays)
+GL_TRACE_GEN_CALL(GenFramebuffers)
+GL_TRACE_DELETE_CALL(DeleteFramebuffers)
+GL_TRACE_GEN_CALL(GenRenderbuffers)
+GL_TRACE_DELETE_CALL(DeleteRenderbuffers)
+GL_TRACE_GEN_CALL(GenTextures)
+GL_TRACE_DELETE_CALL(DeleteTextures)
+
+GL_TRACE_SCALAR_CALL(DeleteShader, (GLuint shader), (shader))
+GL_TRACE_SCALAR_CALL(CompileShader, (GLuint shader), (shader))
+GL_TRACE_SCALAR_CALL(DeleteProgram, (GLuint program), (program))
+GL_TRACE_SCALAR_CALL(AttachShader, (GLuint program, GLuint shader), (program, shader))
+GL_TRACE_SCALAR_CALL(LinkProgram, (GLuint program), (program))
+GL_TRACE_SCALAR_CALL(ValidateProgram, (GLuint program), (program))
+GL_TRACE_SCALAR_CALL(UseProgram, (GLuint program), (program))
+GL_TRACE_SCALAR_CALL(UniformBlockBinding, (GLuint program, GLuint index, GLuint binding), (program, index, binding))
+GL_TRACE_SCALAR_CALL(Uniform1i, (GLint location, GLint v0), (location, v0))
+GL_TRACE_SCALAR_CALL(BindBuffer, (GLenum target, GLuint buffer), (target, buffer))
+GL_TRACE_SCALAR_CALL(BindBufferBase, (GLenum target, GLuint index, GLuint buffer), (target, index, buffer))
+GL_TRACE_SCALAR_CALL(BindVertexArray, (GLuint array), (array))
+GL_TRACE_SCALAR_CALL(EnableVertexAttribArray, (GLuint index), (index))
+GL_TRACE_SCALAR_CALL(BindFramebuffer, (GLenum target, GLuint framebuffer), (target, framebuffer))
+GL_TRACE_SCALAR_CALL(BindRenderbuffer, (GLenum target, GLuint renderbuffer), (target, renderbuffer))
+GL_TRACE_SCALAR_CALL(RenderbufferStorage, (GLenum target, GLenum format, GLsizei width, GLsizei height),
+                     (target, format, width, height))
+GL_TRACE_SCALAR_CALL(FramebufferRenderbuffer, (GLenum target, GLenum attachment, GLenum renderbufferTarget, GLuint renderbuffer),
+                     (target, attachment, renderbufferTarget, renderbuffer))
+GL_TRACE_SCALAR_CALL(ReadBuffer, (GLenum mode), (mode))
+GL_TRACE_SCALAR_CALL(PixelStorei, (GLenum pname, GLint param), (pname, param))
+GL_TRACE_SCALAR_CALL(Viewport, (GLint x, GLint y, GLsizei width, GLsizei height), (x, y, width, height))
+GL_TRACE_SCALAR_CALL(ClearColor, (GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha), (red, green, blue, alpha))
+GL_TRACE_SCALAR_CALL(Clear, (GLbitfield mask), (mask))
+GL_TRACE_SCALAR_CALL(BindTexture, (GLenum target, GLuint texture), (target, texture))
+GL_TRACE_SCALAR_CALL(ActiveTexture, (GLenum texture), (texture))
+GL_TRACE_SCALAR_CALL(TexParameteri, (GLenum target, GLenum pname, GLint param), (target, pname, param))
+GL_TRACE_SCALAR_CALL(VertexAttribDivisor, (GLuint index, GLuint divisor), (index, divisor))
+GL_TRACE_SCALAR_CALL(DrawArraysInstanced, (GLenum mode, GLint first, GLsizei count, GLsizei instanceCount),
+                     (mode, first, count, instanceCount))
+GL_TRACE_SCALAR_CALL(Enable, (GLenum capability), (capability))
+GL_TRACE_SCALAR_CALL(Disable, (GLenum capability), (capability))
+GL_TRACE_SCALAR_CALL(BlendFunc, (GLenum source, GLenum destination), (source, destination))
+GL_TRACE_SCALAR_CALL(Uniform2f, (GLint location, GLfloat v0, GLfloat v1), (location, v0, v1))
+GL_TRACE_SCALAR_CALL(Uniform4f, (GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3), (location, v0, v1, v2, v3))
+GL_TRACE_SCALAR_CALL(TexBuffer, (GLenum target, GLenum internalformat, GLuint buffer), (target, internalformat, buffer))
+GL_TRACE_SCALAR_CALL(DrawArrays, (GLenum mode, GLint first, GLsizei count), (mode, first, count))
+GL_TRACE_SCALAR_CALL(FramebufferTexture2D, (GLenum target, GLenum attachment, GLenum textureTarget, GLuint texture, GLint level),
+                     (target, attachment, textureTarget, texture, level))
+GL_TRACE_SCALAR_CALL(GenerateMipmap, (GLenum target), (target))
+GL_TRACE_SCALAR_CALL(PopDebugGroup, (), ())
+GL_TRACE_SCALAR_CALL(TexStorage3D, (GLenum target, GLsizei levels, GLenum internalFormat, GLsizei width, GLsizei height, GLsizei depth),
+                     (target, levels, internalFormat, width, height, depth))
+GL_TRACE_SCALAR_CALL(TexPageCommitmentARB, (GLenum target, GLint level, GLint x, GLint y, GLint z, GLsizei width, GLsizei height,
+                                            GLsizei depth, GLboolean commit),
+                     (target, level, x, y, z, width, height, depth, commit))
+
+static GLuint APIENTRY traceCreateShader(GLenum type)
+{
+    GLuint shader = realCreateShader(type);
+    putOp(GlTraceOp::CreateShader);
+    putAll(type, shader);
+    return shader;
+}
+
+static GLuint APIENTRY traceCreateProgram()
+{
+    GLuint program = realCreateProgram();
+    putOp(GlTraceOp::CreateProgram);
+    putAll(program);
+    return program;
+}
+
+static void APIENTRY traceShaderSource(GLuint shader, GLsizei count, const GLchar *const *strings, const GLint *lengths)
+{
+    putOp(GlTraceOp::ShaderSource);
+    putAll(shader, count);
+    for (GLsizei i = 0; i < count; ++i)
+        putString(strings[i], lengths != nullptr ? lengths[i] : -1);
+    realShaderSource(shader, count, strings, lengths);
+}
+
+// Debug groups and labels keep their names, so captures of the replay read like captures of the application.
+static void APIENTRY tracePushDebugGroup(GLenum source, GLuint id, GLsizei length, const GLchar *message)
+{
+    putOp(GlTraceOp::PushDebugGroup);
+    putAll(source, id);
+    putString(message, length);
+    realPushDebugGroup(source, id, length, message);
+}
+
+static void APIENTRY traceObjectLabel(GLenum identifier, GLuint name, GLsizei length, const GLchar *label)
+{
+    putOp(GlTraceOp::ObjectLabel);
+    putAll(identifier, name);
+    putString(label != nullptr ? label : "", label != nullptr ? length : 0);
+    realObjectLabel(identifier, name, length, label);
+}
+
+// Uniform locations and block indices are recorded with their result, so the replay can translate them.
+static GLint APIENTRY traceGetUniformLocation(GLuint program, const GLchar *name)
+{
+    GLint location = realGetUniformLocation(program, name);
+    putOp(GlTraceOp::GetUniformLocation);
+    putAll(program);
+    putString(name, -1);
+    putAll(location);
+    return location;
+}
+
+static GLuint APIENTRY traceGetUniformBlockIndex(GLuint program, const GLchar *name)
+{
+    GLuint index = realGetUniformBlockIndex(program, name);
+    putOp(GlTraceOp::GetUniformBlockIndex);
+    putAll(program);
+    putString(name, -1);
+    putAll(index);
+    return index;
+}
+
+static void APIENTRY traceUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat *value)
+{
+    putOp(GlTraceOp::UniformMatrix4fv);
+    putAll(location, count, transpose);
+    putBytes(value, sizeof(GLfloat) * 16 * count);
+    realUniformMatrix4fv(location, count, transpose, value);
+}
+
+static void APIENTRY traceBufferData(GLenum target, GLsizeiptr size, const void *data, GLenum usage)
+{
+    putOp(GlTraceOp::BufferData);
+    putAll(target, size, usage, (uint8_t)(data != nullptr));
+    if (data != nullptr)
+        putBytes(data, (size_t)size);
+    realBufferData(target, size, data, usage);
+}
+
+static void APIENTRY traceBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void *data)
+{
+    putOp(GlTraceOp::BufferSubData);
+    putAll(target, offset, size);
+    putBytes(data, (size_t)size);
+    realBufferSubData(target, offset, size, data);
+}
+
+// Writes through mapped pointers are not recorded; the renderer maps buffers for reading, except the page
+// staging buffer of the virtual texture (virtual_texture.h), whose pages therefore replay blank.
+static void *APIENTRY traceMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+{
+    putOp(GlTraceOp::MapBufferRange);
+    putAll(target, offset, length, access);
+    return realMapBufferRange(target, offset, length, access);
+}
+
+static GLboolean APIENTRY traceUnmapBuffer(GLenum target)
+{
+    putOp(GlTraceOp::UnmapBuffer);
+    putAll(target);
+    return realUnmapBuffer(target);
+}
+
+// Function to compute the size of client pixel data as glTexImage2D reads it, rows padded to GL_UNPACK_ALIGNMENT.
+static size_t unpackedImageSize(GLsizei width, GLsizei height, GLenum format, GLenum type)
+{
+    int components = format == GL_RED || format == GL_RED_INTEGER ? 1 : format == GL_RG ? 2 : format == GL_RGB || format == GL_BGR ? 3 : 4;
+    int componentBytes = type == GL_FLOAT ? 4 : type == GL_HALF_FLOAT || type == GL_UNSIGNED_SHORT ? 2 : 1;
+    GLint alignment = 4;
+    glad_glGetIntegerv(GL_UNPACK_ALIGNMENT, &alignment);
+    size_t row = (size_t)width * components * componentBytes;
+    row = (row + alignment - 1) / alignment * alignment;
+    return row * height;
+}
+
+// The pixels are recorded when they come from client memory; with a pixel unpack buffer bound the pointer is an offset.
+static void APIENTRY traceTexImage2D(GLenum target, GLint level, GLint internalFormat, GLsizei width, GLsizei height,
+                                     GLint border, GLenum format, GLenum type, const void *pixels)
+{
+    GLint unpackBuffer = 0;
+    glad_glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &unpackBuffer);
+    bool hasData = unpackBuffer == 0 && pixels != nullptr;
+    putOp(GlTraceOp::TexImage2D);
+    putAll(target, level, internalFormat, width, height, border, format, type, (uint8_t)hasData, pointerValue(hasData ? nullptr : pixels));
+    if (hasData)
+    {
+        size_t size = unpackedImageSize(width, height, format, type);
+        putAll((uint64_t)size);
+        putBytes(pixels, size);
+    }
+    realTexImage2D(target, level, internalFormat, width, height, border, format, type, pixels);
+}
+
+static void APIENTRY traceTexSubImage3D(GLenum target, GLint level, GLint x, GLint y, GLint z, GLsizei width, GLsizei height,
+                                        GLsizei depth, GLenum format, GLenum type, const void *pixels)
+{
+    GLint unpackBuffer = 0;
+    glad_glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &unpackBuffer);
+    bool hasData = unpackBuffer == 0 && pixels != nullptr;
+    putOp(GlTraceOp::TexSubImage3D);
+    putAll(target, level, x, y, z, width, height, depth, format, type, (uint8_t)hasData, pointerValue(hasData ? nullptr : pixels));
+    if (hasData)
+    {
+        size_t size = unpackedImageSize(width, height, format, type) * depth;
+        putAll((uint64_t)size);
+        putBytes(pixels, size);
+    }
+    realTexSubImage3D(target, level, x, y, z, width, height, depth, format, type, pixels);
+}
+
+// Compressed images carry their size, so client data needs no unpack state.
+static void APIENTRY traceCompressedTexSubImage3D(GLenum target, GLint level, GLint x, GLint y, GLint z, GLsizei width,
+                                                  GLsizei height, GLsizei depth, GLenum format, GLsizei imageSize, const void *data)
+{
+    GLint unpackBuffer = 0;
+    glad_glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &unpackBuffer);
+    bool hasData = unpackBuffer == 0 && data != nullptr;
+    putOp(GlTraceOp::CompressedTexSubImage3D);
+    putAll(target, level, x, y, z, width, height, depth, format, imageSize, (uint8_t)hasData, pointerValue(hasData ? nullptr : data));
+    if (hasData)
+        putBytes(data, (size_t)imageSize);
+    realCompressedTexSubImage3D(target, level, x, y, z, width, height, depth, format, imageSize, data);
+}
+
+static void APIENTRY traceVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void *pointer)
+{
+    putOp(GlTraceOp::VertexAttribPointer);
+    putAll(index, size, type, normalized, stride, pointerValue(pointer));
+    realVertexAttribPointer(index, size, type, normalized, stride, pointer);
+}
+
+// The pixels must go to a pixel pack buffer; reads into client memory are replayed into a scratch buffer.
+static void APIENTRY traceReadPixels(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void *pixels)
+{
+    GLint packBuffer = 0;
+    glad_glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &packBuffer);
+    putOp(GlTraceOp::ReadPixels);
+    putAll(x, y, width, height, format, type, (uint8_t)(packBuffer != 0), pointerValue(packBuffer != 0 ? pixels : nullptr));
+    realReadPixels(x, y, width, height, format, type, pixels);
+}
+
+static void APIENTRY traceViewportArrayv(GLuint first, GLsizei count, const GLfloat *v)
+{
+    putOp(GlTraceOp::ViewportArrayv);
+    putAll(first, count);
+    putBytes(v, sizeof(GLfloat) * 4 * count);
+    realViewportArrayv(first, count, v);
+}
+
+// Index data always comes from the bound element buffer, so the pointer is an offset.
+static void APIENTRY traceDrawElements(GLenum mode, GLsizei count, GLenum type, const void *indices)
+{
+    putOp(GlTraceOp::DrawElements);
+    putAll(mode, count, type, pointerValue(indices));
+    realDrawElements(mode, count, type, indices);
+}
+
+static void APIENTRY traceDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const void *indices, GLsizei instanceCount)
+{
+    putOp(GlTraceOp::DrawElementsInstanced);
+    putAll(mode, count, type, pointerValue(indices), instanceCount);
+    realDrawElementsInstanced(mode, count, type, indices, instanceCount);
+}
+
+static GLsync APIENTRY traceFenceSync(GLenum condition, GLbitfield flags)
+{
+    GLsync sync = realFenceSync(condition, flags);
+    putOp(GlTraceOp::FenceSync);
+    putAll(condition, flags, pointerValue(sync));
+    return sync;
+}
+
+static GLenum APIENTRY traceClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout)
+{
+    putOp(GlTraceOp::ClientWaitSync);
+    putAll(pointerValue(sync), flags, timeout);
+    return realClientWaitSync(sync, flags, timeout);
+}
+
+static void APIENTRY traceDeleteSync(GLsync sync)
+{
+    putOp(GlTraceOp::DeleteSync);
+    putAll(pointerValue(sync));
+    realDeleteSync(sync);
+}
+
+// Function to swap the glad pointers for the wrappers. Entry points the driver does not provide stay null.
+static void installTraceHooks()
+{
+#define GL_TRACE_INSTALL(name)              \
+    real##name = glad_gl##name;             \
+    if (glad_gl##name != nullptr)           \
+        glad_gl##name = trace##name;
+    GL_TRACE_OPS(GL_TRACE_INSTALL)
+#undef GL_TRACE_INSTALL
+}
+
+// Function to put the driver functions back.
+static void removeTraceHooks()
+{
+#define GL_TRACE_REMOVE(name) glad_gl##name = real##name;
+    GL_TRACE_OPS(GL_TRACE_REMOVE)
+#undef GL_TRACE_REMOVE
+}
+
+// Function run by the writer thread: writes the queued frames as chunks, in order, until the trace stops.
+static void traceWriterMain()
+{
+    std::unique_lock<std::mutex> lock(traceMutex);
+    for (;;)
+    {
+        frameQueued.wait(lock, [] { return writerStopping || !pendingFrames.empty(); });
+        if (pendingFrames.empty())
+            return; // Only reached when stopping, with every frame written.
+        std::vector<unsigned char> calls = std::move(pendingFrames.front());
+        pendingFrames.pop_front();
+        frameWritten.notify_one();
+        lock.unlock();
+
+        uint32_t size = (uint32_t)calls.size();
+        std::fwrite(&size, sizeof(size), 1, traceFile);
+        std::fwrite(calls.data(), 1, calls.size(), traceFile);
+        calls.clear();
+
+        lock.lock();
+        spareFrames.push_back(std::move(calls));
+    }
+}
+
+// Function to start recording.
+// path: Trace file to create.
+// frameCount: Number of frames to record; the trace stops by itself after the last one.
+// framebufferWidth, framebufferHeight: Size of the default framebuffer, recreated by the replay.
+bool startGlTrace(const char *path, int frameCount, int framebufferWidth, int framebufferHeight)
+{
+    if (traceFile != nullptr || frameCount <= 0)
+        return false;
+    traceFile = std::fopen(path, "wb");
+    if (traceFile == nullptr)
+    {
+        logError("Could not create the trace file {}", path);
+        return false;
+    }
+
+    GlTraceHeader header;
+    std::memcpy(header.magic, glTraceMagic, sizeof(header.magic));
+    header.opCount = (uint32_t)GlTraceOp::Count;
+    header.width = framebufferWidth;
+    header.height = framebufferHeight;
+    std::fwrite(&header, sizeof(header), 1, traceFile);
+
+    frameCalls.clear();
+    frameCalls.reserve(1 << 20);
+    framesLeft = frameCount;
+    framesWritten = 0;
+    bytesWritten = sizeof(header);
+    writerStopping = false;
+    traceWriter = std::thread(traceWriterMain);
+    installTraceHooks();
+    logInfo("Tracing OpenGL calls of {} frames to {}", frameCount, path);
+    return true;
+}
+
+// Function to hand the calls of the finished frame to the writer, which writes them as one chunk.
+// Only waits if the writer is maxPendingFrames behind.
+void glTraceEndFrame()
+{
+    if (traceFile == nullptr)
+        return;
+    bytesWritten += sizeof(uint32_t) + frameCalls.size();
+    {
+        std::unique_lock<std::mutex> lock(traceMutex);
+        frameWritten.wait(lock, [] { return pendingFrames.size() < maxPendingFrames; });
+        pendingFrames.push_back(std::move(frameCalls));
+        frameCalls = std::vector<unsigned char>();
+        if (!spareFrames.empty())
+        {
+            frameCalls = std::move(spareFrames.back());
+            spareFrames.pop_back();
+        }
+        else
+            frameCalls.reserve(1 << 20);
+    }
+    frameQueued.notify_one();
+    ++framesWritten;
+
+    if (--framesLeft == 0)
+        stopGlTrace();
+}
+
+// Function to stop recording. Calls of an unfinished frame are dropped, so the trace always ends on a frame boundary.
+void stopGlTrace()
+{
+    if (traceFile == nullptr)
+        return;
+    removeTraceHooks();
+    {
+        std::lock_guard<std::mutex> lock(traceMutex);
+        writerStopping = true;
+    }
+    frameQueued.notify_one();
+    traceWriter.join(); // Writes the frames still queued
+    bool ok = std::ferror(traceFile) == 0;
+    ok = std::fclose(traceFile) == 0 && ok;
+    traceFile = nullptr;
+    std::vector<unsigned char>().swap(frameCalls);
+    spareFrames.clear();
+    if (ok)
+        logInfo("Trace complete: {} frames, {} bytes", framesWritten, bytesWritten);
+    else
+        logError("Could not write the trace file");
+}
+
+bool glTraceActive() { return traceFile != nullptr; }
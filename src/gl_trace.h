@@ -0,0 +1,63 @@
+#ifndef GL_TRACE_H
+#define GL_TRACE_H
+
+// Recording of the OpenGL calls of the application into a binary trace, for replay by gl_replay.
+// glad calls OpenGL through the glad_gl* function pointers it loads in gladLoadGLLoader. While a trace is
+// running those pointers are replaced by recording wrappers that append the call and its data (buffer
+// contents, shader sources, uniform values) to the trace and then call the driver.
+//
+// File layout: a GlTraceHeader, then one chunk per frame: a uint32 byte count followed by the calls of the
+// frame. A call is a uint16 GlTraceOp followed by its arguments in parameter order, stored in their native
+// size; arrays are preceded by their element count and strings by their byte length. The first chunk also
+// holds every call made between the start of the trace and the first glTraceEndFrame (resource creation).
+//
+// Only the entry points listed in GL_TRACE_OPS are recorded; a call to any other function goes straight to
+// the driver and is missing from the replay, so new OpenGL calls in the renderer must be added here.
+//
+// Recording costs the render thread a copy of every call's data; the file writes happen on a writer thread,
+// which the render thread only waits for when it falls several frames behind.
+#include <cstdint> // Fixed size fields of the file format.
+
+#define GL_TRACE_OPS(X)                                                                                 \
+    X(GenBuffers) X(DeleteBuffers) X(GenVertexArrays) X(DeleteVertexArrays)                             \
+    X(GenFramebuffers) X(DeleteFramebuffers) X(GenRenderbuffers) X(DeleteRenderbuffers)                 \
+    X(CreateShader) X(DeleteShader) X(ShaderSource) X(CompileShader)                                    \
+    X(CreateProgram) X(DeleteProgram) X(AttachShader) X(LinkProgram) X(ValidateProgram) X(UseProgram)   \
+    X(GetUniformLocation) X(GetUniformBlockIndex) X(UniformBlockBinding) X(Uniform1i) X(UniformMatrix4fv) \
+    X(BindBuffer) X(BindBufferBase) X(BufferData) X(BufferSubData) X(MapBufferRange) X(UnmapBuffer)     \
+    X(BindVertexArray) X(EnableVertexAttribArray) X(VertexAttribPointer)                                \
+    X(BindFramebuffer) X(BindRenderbuffer) X(RenderbufferStorage) X(FramebufferRenderbuffer)            \
+    X(ReadBuffer) X(PixelStorei) X(ReadPixels) X(Viewport) X(ViewportArrayv) X(ClearColor) X(Clear)     \
+    X(DrawElements) X(DrawElementsInstanced) X(FenceSync) X(ClientWaitSync) X(DeleteSync)               \
+    X(GenTextures) X(DeleteTextures) X(BindTexture) X(ActiveTexture) X(TexImage2D) X(TexParameteri)     \
+    X(VertexAttribDivisor) X(DrawArraysInstanced) X(Enable) X(Disable) X(BlendFunc) X(Uniform2f)     \
+    X(PushDebugGroup) X(PopDebugGroup) X(ObjectLabel) X(TexStorage3D) X(TexPageCommitmentARB)           \
+    X(CompressedTexSubImage3D) X(TexSubImage3D) X(Uniform4f) X(TexBuffer) X(DrawArrays)                 \
+    X(FramebufferTexture2D) X(GenerateMipmap)
+
+// Identifies a recorded call; the value is the position in GL_TRACE_OPS, so only append new entries.
+enum class GlTraceOp : uint16_t
+{
+#define GL_TRACE_ENUM(name) name,
+    GL_TRACE_OPS(GL_TRACE_ENUM)
+#undef GL_TRACE_ENUM
+    Count
+};
+
+const char glTraceMagic[8] = {'G', 'L', 'T', 'R', 'A', 'C', 'E', '1'};
+
+struct GlTraceHeader
+{
+    char magic[8];          // glTraceMagic.
+    uint32_t opCount;       // GlTraceOp::Count of the writer; a replayer that knows fewer calls rejects the file.
+    int32_t width;          // Framebuffer size when the trace started.
+    int32_t height;
+};
+
+// Starts recording into path for frameCount frames. Needs a current context with the functions loaded.
+bool startGlTrace(const char *path, int frameCount, int framebufferWidth, int framebufferHeight);
+void glTraceEndFrame(); // Call once per frame before swapping buffers; stops the trace after the last frame.
+void stopGlTrace();     // Restores the driver functions and closes the file. Safe to call when not tracing.
+bool glTraceActive();
+
+#endif
@@ -0,0 +1,238 @@
+#include "gpu_memory.h"
+#include "logger.h"      // Budget warnings.
+#include "memory_pool.h" // Pooled nodes of the registry.
+#include <cstdlib>       // strtod, parses the budget sizes.
+#include <iomanip>       // Formatting of the report.
+#include <map>           // Per-owner totals of the report.
+#include <unordered_map> // The registry of live objects.
+#include <vector>        // Eviction handlers.
+
+// One live object.
+struct GpuAllocation
+{
+    long long bytes = 0;
+    GpuMemoryCategory category = GpuMemoryCategory::Geometry;
+    const char *owner = "";
+    GLenum usage = 0;
+};
+
+struct EvictionEntry
+{
+    int id;
+    GpuMemoryCategory category;
+    GpuEvictionHandler handler;
+};
+
+static const int categoryCount = (int)GpuMemoryCategory::Count;
+static const char *const categoryNames[categoryCount] = {"geometry", "uniforms", "readback", "rendertargets", "textures"};
+
+// Registry of the live objects, keyed by kind and name. Objects are created and deleted one at a time for the
+// whole session, so the nodes come from a pool and the buckets are reserved up front.
+struct GpuRegistryPool
+{
+    static constexpr const char *name = "gpu memory registry";
+};
+using GpuAllocationMap = std::unordered_map<unsigned long long, GpuAllocation, std::hash<unsigned long long>, std::equal_to<unsigned long long>,
+                                            PoolAllocator<std::pair<const unsigned long long, GpuAllocation>, GpuRegistryPool>>;
+static GpuAllocationMap allocations(256);
+static GpuMemoryUsage categories[categoryCount];
+static GpuMemoryUsage total;
+static bool overBudget[categoryCount + 1] = {}; // Last slot: total. A warning is printed once per excursion.
+static std::vector<EvictionEntry> evictionHandlers;
+static int nextHandlerId = 1;
+
+static unsigned long long allocationKey(GpuResourceKind kind, unsigned int name)
+{
+    return ((unsigned long long)kind << 32) | name;
+}
+
+// Function to add a signed amount to a usage record and update its high-water mark.
+static void account(GpuMemoryUsage &usage, long long bytes, int allocationDelta)
+{
+    usage.bytes += bytes;
+    usage.allocations += allocationDelta;
+    if (usage.bytes > usage.highWater)
+        usage.highWater = usage.bytes;
+}
+
+// Function to warn when a usage record crosses its budget.
+static void checkBudget(const GpuMemoryUsage &usage, int slot, const char *name)
+{
+    bool over = usage.budget > 0 && usage.bytes > usage.budget;
+    if (over && !overBudget[slot])
+        logWarning("GPU memory budget exceeded: {} uses {} KiB of {} KiB", name, usage.bytes / 1024, usage.budget / 1024);
+    overBudget[slot] = over;
+}
+
+// Function to record an allocation, replacing an earlier record of the same object (re-specified storage).
+void trackGpuAllocation(GpuResourceKind kind, unsigned int name, long long bytes, GpuMemoryCategory category,
+                        const char *owner, GLenum usage)
+{
+    releaseGpuAllocation(kind, name);
+    if (bytes <= 0)
+        return; // Zero-sized storage holds no memory.
+
+    GpuAllocation &allocation = allocations[allocationKey(kind, name)];
+    allocation.bytes = bytes;
+    allocation.category = category;
+    allocation.owner = owner;
+    allocation.usage = usage;
+
+    account(categories[(int)category], bytes, 1);
+    account(total, bytes, 1);
+    checkBudget(categories[(int)category], (int)category, categoryNames[(int)category]);
+    checkBudget(total, categoryCount, "total");
+}
+
+// Function to forget an object. Unknown objects are ignored, so deleting untracked names is harmless.
+void releaseGpuAllocation(GpuResourceKind kind, unsigned int name)
+{
+    auto found = allocations.find(allocationKey(kind, name));
+    if (found == allocations.end())
+        return;
+    const GpuAllocation &allocation = found->second;
+    account(categories[(int)allocation.category], -allocation.bytes, -1);
+    account(total, -allocation.bytes, -1);
+    checkBudget(categories[(int)allocation.category], (int)allocation.category, categoryNames[(int)allocation.category]);
+    checkBudget(total, categoryCount, "total");
+    allocations.erase(found);
+}
+
+// Function to allocate buffer storage and record it.
+void trackedBufferData(GLenum target, unsigned int buffer, long long size, const void *data, GLenum usage,
+                       GpuMemoryCategory category, const char *owner)
+{
+    glBufferData(target, (GLsizeiptr)size, data, usage);
+    trackGpuAllocation(GpuResourceKind::Buffer, buffer, size, category, owner, usage);
+}
+
+// Function to estimate the bytes per pixel of a renderbuffer format.
+static int renderbufferBytesPerPixel(GLenum format)
+{
+    switch (format)
+    {
+    case GL_RGBA16F:
+        return 8;
+    case GL_RGBA32F:
+        return 16;
+    case GL_R8:
+        return 1;
+    default:
+        return 4; // RGBA8, DEPTH_COMPONENT24 (padded), DEPTH24_STENCIL8, DEPTH_COMPONENT32F.
+    }
+}
+
+// Function to allocate renderbuffer storage and record it.
+void trackedRenderbufferStorage(unsigned int renderbuffer, GLenum format, int width, int height,
+                                GpuMemoryCategory category, const char *owner)
+{
+    glRenderbufferStorage(GL_RENDERBUFFER, format, width, height);
+    trackGpuAllocation(GpuResourceKind::Renderbuffer, renderbuffer, (long long)width * height * renderbufferBytesPerPixel(format),
+                       category, owner, format);
+}
+
+void trackedDeleteBuffers(int count, const unsigned int *buffers)
+{
+    for (int i = 0; i < count; ++i)
+        releaseGpuAllocation(GpuResourceKind::Buffer, buffers[i]);
+    glDeleteBuffers(count, buffers);
+}
+
+void trackedDeleteRenderbuffers(int count, const unsigned int *renderbuffers)
+{
+    for (int i = 0; i < count; ++i)
+        releaseGpuAllocation(GpuResourceKind::Renderbuffer, renderbuffers[i]);
+    glDeleteRenderbuffers(count, renderbuffers);
+}
+
+// Function to set a budget from the command line.
+// spec: "<category>=<MiB>"; fractional sizes are allowed, 0 removes the budget.
+bool setGpuMemoryBudget(const std::string &spec)
+{
+    size_t separator = spec.find('=');
+    if (separator == std::string::npos)
+        return false;
+    std::string name = spec.substr(0, separator);
+    char *end = nullptr;
+    double megabytes = std::strtod(spec.c_str() + separator + 1, &end);
+    if (end == spec.c_str() + separator + 1 || *end != '\0' || megabytes < 0.0)
+        return false;
+    long long bytes = (long long)(megabytes * 1024.0 * 1024.0);
+
+    if (name == "total")
+    {
+        total.budget = bytes;
+        return true;
+    }
+    for (int i = 0; i < categoryCount; ++i)
+        if (name == categoryNames[i])
+        {
+            categories[i].budget = bytes;
+            return true;
+        }
+    return false;
+}
+
+int addGpuEvictionHandler(GpuMemoryCategory category, GpuEvictionHandler handler)
+{
+    evictionHandlers.push_back({nextHandlerId, category, std::move(handler)});
+    return nextHandlerId++;
+}
+
+void removeGpuEvictionHandler(int id)
+{
+    for (size_t i = 0; i < evictionHandlers.size(); ++i)
+        if (evictionHandlers[i].id == id)
+        {
+            evictionHandlers.erase(evictionHandlers.begin() + i);
+            return;
+        }
+}
+
+// Function to ask the eviction handlers to bring the categories back under budget.
+// Runs at the frame boundary rather than inside the allocation, so handlers never free an object its owner is still setting up.
+// A category over budget is evicted from first; if the total is over budget every category is asked in turn.
+void enforceGpuMemoryBudgets()
+{
+    for (const EvictionEntry &entry : evictionHandlers)
+    {
+        const GpuMemoryUsage &usage = categories[(int)entry.category];
+        long long over = usage.budget > 0 ? usage.bytes - usage.budget : 0;
+        if (total.budget > 0 && total.bytes - total.budget > over)
+            over = total.bytes - total.budget;
+        if (over > 0)
+            entry.handler(over);
+    }
+}
+
+GpuMemoryUsage gpuMemoryUsage(GpuMemoryCategory category) { return categories[(int)category]; }
+GpuMemoryUsage gpuMemoryTotal() { return total; }
+
+// Function to print the usage per category and the live bytes per owning subsystem.
+void printGpuMemoryReport(std::ostream &out)
+{
+    out << std::fixed << std::setprecision(2) << "GPU memory: " << total.bytes / 1048576.0 << " MiB in "
+        << total.allocations << " objects, high-water " << total.highWater / 1048576.0 << " MiB";
+    if (total.budget > 0)
+        out << ", budget " << total.budget / 1048576.0 << " MiB";
+    out << "\n";
+
+    for (int i = 0; i < categoryCount; ++i)
+    {
+        const GpuMemoryUsage &usage = categories[i];
+        if (usage.highWater == 0 && usage.budget == 0)
+            continue;
+        out << "  " << std::left << std::setw(14) << categoryNames[i] << std::right << std::setw(10) << usage.bytes / 1048576.0
+            << " MiB " << std::setw(5) << usage.allocations << " objects, high-water " << usage.highWater / 1048576.0 << " MiB";
+        if (usage.budget > 0)
+            out << ", budget " << usage.budget / 1048576.0 << " MiB";
+        out << "\n";
+    }
+
+    std::map<std::string, long long> owners;
+    for (const auto &entry : allocations)
+        owners[entry.second.owner] += entry.second.bytes;
+    for (const auto &owner : owners)
+        out << "    " << std::left << std::setw(24) << owner.first << std::right << std::setw(10) << owner.second / 1024.0 << " KiB\n";
+    out << std::defaultfloat << std::flush;
+}
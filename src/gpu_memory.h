@@ -0,0 +1,68 @@
+#ifndef GPU_MEMORY_H
+#define GPU_MEMORY_H
+
+// Tracking of the GPU memory the program allocates through OpenGL.
+// Buffers, renderbuffers and textures are allocated through the tracked* functions below, which issue the
+// OpenGL call and record the size, usage and owning subsystem of the object. The registry keeps totals and
+// high-water marks per category and checks them against configurable budgets: exceeding a budget prints a
+// warning, and at the next frame boundary the eviction handlers of the category are asked to free memory.
+// All functions must be called on the thread that owns the OpenGL context.
+#include "glad.h"     // GLenum.
+#include <functional> // std::function for the eviction handlers.
+#include <ostream>    // Report output.
+#include <string>     // Budget specifications.
+
+enum class GpuMemoryCategory
+{
+    Geometry,      // Vertex and index buffers.
+    Uniforms,      // Uniform buffers.
+    Readback,      // Pixel pack buffers of the capture paths.
+    RenderTargets, // Offscreen framebuffer attachments.
+    Textures,
+    Count
+};
+
+enum class GpuResourceKind
+{
+    Buffer,
+    Renderbuffer,
+    Texture
+};
+
+// Usage of one category (or of all of them).
+struct GpuMemoryUsage
+{
+    long long bytes = 0;      // Currently allocated.
+    long long highWater = 0;  // Largest value of bytes so far.
+    int allocations = 0;      // Live objects.
+    long long budget = 0;     // 0: no budget.
+};
+
+// Frees memory of a category when its budget is exceeded. bytesOver: how far the category is over its
+// budget. Returns the number of bytes freed (through the tracked* functions).
+using GpuEvictionHandler = std::function<long long(long long bytesOver)>;
+
+// Allocation wrappers: issue the OpenGL call on the bound object and record it.
+void trackedBufferData(GLenum target, unsigned int buffer, long long size, const void *data, GLenum usage,
+                       GpuMemoryCategory category, const char *owner); // buffer: the name bound to target.
+void trackedRenderbufferStorage(unsigned int renderbuffer, GLenum format, int width, int height,
+                                GpuMemoryCategory category, const char *owner); // renderbuffer: the bound renderbuffer.
+void trackedDeleteBuffers(int count, const unsigned int *buffers);
+void trackedDeleteRenderbuffers(int count, const unsigned int *renderbuffers);
+
+// Records an allocation made by other OpenGL calls (textures), replacing an earlier record of the same object.
+void trackGpuAllocation(GpuResourceKind kind, unsigned int name, long long bytes, GpuMemoryCategory category,
+                        const char *owner, GLenum usage = 0);
+void releaseGpuAllocation(GpuResourceKind kind, unsigned int name); // Forgets the object; call when deleting it.
+
+// Budgets. spec: "<category>=<MiB>", where category is total, geometry, uniforms, readback, rendertargets or textures.
+bool setGpuMemoryBudget(const std::string &spec);
+int addGpuEvictionHandler(GpuMemoryCategory category, GpuEvictionHandler handler); // Returns an id for removal.
+void removeGpuEvictionHandler(int id);
+void enforceGpuMemoryBudgets(); // Runs the eviction handlers of categories over budget; call once per frame.
+
+GpuMemoryUsage gpuMemoryUsage(GpuMemoryCategory category);
+GpuMemoryUsage gpuMemoryTotal();
+void printGpuMemoryReport(std::ostream &out); // Per category and per owner.
+
+#endif
@@ -0,0 +1,248 @@
+#include "hud.h"
+#include "alloc_audit.h" // Whether heap allocations are counted.
+#include "gl_debug.h"    // Object labels and debug groups for frame captures.
+#include "glad.h"        // GLAD provides the OpenGL function pointers.
+#include "gpu_memory.h"  // Tracked buffer and texture allocation.
+#include "shader.h"      // Shader loading.
+#include <cctype>        // toupper.
+#include <cstdio>        // snprintf, formats the statistics.
+
+// Glyph cell of the font texture: 5x7 pixel glyphs plus one pixel of spacing to the right and below.
+static const int glyphColumns = 6;
+static const int glyphRows = 8;
+static const int glyphCount = 96; // Characters 32 to 126, then the solid block.
+static const int solidGlyph = glyphCount - 1;
+
+// Bitmap font: one byte per glyph row from the top, bit 4 is the leftmost pixel.
+// Characters missing from the table are drawn as '?'.
+struct GlyphBitmap
+{
+    char character;
+    unsigned char rows[7];
+};
+
+static const GlyphBitmap glyphBitmaps[] = {
+    {' ', {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00}}, {'!', {0x04, 0x04, 0x04, 0x04, 0x00, 0x00, 0x04}},
+    {'"', {0x0A, 0x0A, 0x0A, 0x00, 0x00, 0x00, 0x00}}, {'#', {0x0A, 0x0A, 0x1F, 0x0A, 0x1F, 0x0A, 0x0A}},
+    {'%', {0x18, 0x19, 0x02, 0x04, 0x08, 0x13, 0x03}}, {'\'', {0x0C, 0x04, 0x08, 0x00, 0x00, 0x00, 0x00}},
+    {'(', {0x02, 0x04, 0x08, 0x08, 0x08, 0x04, 0x02}}, {')', {0x08, 0x04, 0x02, 0x02, 0x02, 0x04, 0x08}},
+    {'*', {0x00, 0x04, 0x15, 0x0E, 0x15, 0x04, 0x00}}, {'+', {0x00, 0x04, 0x04, 0x1F, 0x04, 0x04, 0x00}},
+    {',', {0x00, 0x00, 0x00, 0x00, 0x0C, 0x04, 0x08}}, {'-', {0x00, 0x00, 0x00, 0x1F, 0x00, 0x00, 0x00}},
+    {'.', {0x00, 0x00, 0x00, 0x00, 0x00, 0x0C, 0x0C}}, {'/', {0x00, 0x01, 0x02, 0x04, 0x08, 0x10, 0x00}},
+    {'0', {0x0E, 0x11, 0x13, 0x15, 0x19, 0x11, 0x0E}}, {'1', {0x04, 0x0C, 0x04, 0x04, 0x04, 0x04, 0x0E}},
+    {'2', {0x0E, 0x11, 0x01, 0x02, 0x04, 0x08, 0x1F}}, {'3', {0x1F, 0x02, 0x04, 0x02, 0x01, 0x11, 0x0E}},
+    {'4', {0x02, 0x06, 0x0A, 0x12, 0x1F, 0x02, 0x02}}, {'5', {0x1F, 0x10, 0x1E, 0x01, 0x01, 0x11, 0x0E}},
+    {'6', {0x06, 0x08, 0x10, 0x1E, 0x11, 0x11, 0x0E}}, {'7', {0x1F, 0x01, 0x02, 0x04, 0x08, 0x08, 0x08}},
+    {'8', {0x0E, 0x11, 0x11, 0x0E, 0x11, 0x11, 0x0E}}, {'9', {0x0E, 0x11, 0x11, 0x0F, 0x01, 0x02, 0x0C}},
+    {':', {0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x0C, 0x00}}, {';', {0x00, 0x0C, 0x0C, 0x00, 0x0C, 0x04, 0x08}},
+    {'<', {0x02, 0x04, 0x08, 0x10, 0x08, 0x04, 0x02}}, {'=', {0x00, 0x00, 0x1F, 0x00, 0x1F, 0x00, 0x00}},
+    {'>', {0x08, 0x04, 0x02, 0x01, 0x02, 0x04, 0x08}}, {'?', {0x0E, 0x11, 0x01, 0x02, 0x04, 0x00, 0x04}},
+    {'A', {0x0E, 0x11, 0x11, 0x11, 0x1F, 0x11, 0x11}}, {'B', {0x1E, 0x11, 0x11, 0x1E, 0x11, 0x11, 0x1E}},
+    {'C', {0x0E, 0x11, 0x10, 0x10, 0x10, 0x11, 0x0E}}, {'D', {0x1C, 0x12, 0x11, 0x11, 0x11, 0x12, 0x1C}},
+    {'E', {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x1F}}, {'F', {0x1F, 0x10, 0x10, 0x1E, 0x10, 0x10, 0x10}},
+    {'G', {0x0E, 0x11, 0x10, 0x17, 0x11, 0x11, 0x0F}}, {'H', {0x11, 0x11, 0x11, 0x1F, 0x11, 0x11, 0x11}},
+    {'I', {0x0E, 0x04, 0x04, 0x04, 0x04, 0x04, 0x0E}}, {'J', {0x07, 0x02, 0x02, 0x02, 0x02, 0x12, 0x0C}},
+    {'K', {0x11, 0x12, 0x14, 0x18, 0x14, 0x12, 0x11}}, {'L', {0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x1F}},
+    {'M', {0x11, 0x1B, 0x15, 0x15, 0x11, 0x11, 0x11}}, {'N', {0x11, 0x11, 0x19, 0x15, 0x13, 0x11, 0x11}},
+    {'O', {0x0E, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}}, {'P', {0x1E, 0x11, 0x11, 0x1E, 0x10, 0x10, 0x10}},
+    {'Q', {0x0E, 0x11, 0x11, 0x11, 0x15, 0x12, 0x0D}}, {'R', {0x1E, 0x11, 0x11, 0x1E, 0x14, 0x12, 0x11}},
+    {'S', {0x0F, 0x10, 0x10, 0x0E, 0x01, 0x01, 0x1E}}, {'T', {0x1F, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04}},
+    {'U', {0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x0E}}, {'V', {0x11, 0x11, 0x11, 0x11, 0x11, 0x0A, 0x04}},
+    {'W', {0x11, 0x11, 0x11, 0x15, 0x15, 0x15, 0x0A}}, {'X', {0x11, 0x11, 0x0A, 0x04, 0x0A, 0x11, 0x11}},
+    {'Y', {0x11, 0x11, 0x11, 0x0A, 0x04, 0x04, 0x04}}, {'Z', {0x1F, 0x01, 0x02, 0x04, 0x08, 0x10, 0x1F}},
+    {'[', {0x0E, 0x08, 0x08, 0x08, 0x08, 0x08, 0x0E}}, {'\\', {0x00, 0x10, 0x08, 0x04, 0x02, 0x01, 0x00}},
+    {']', {0x0E, 0x02, 0x02, 0x02, 0x02, 0x02, 0x0E}}, {'_', {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x1F}},
+    {'|', {0x04, 0x04, 0x04, 0x04, 0x04, 0x04, 0x04}},
+};
+
+// Function to find the bitmap of a character, falling back to '?'.
+static const GlyphBitmap &findGlyph(char character)
+{
+    const GlyphBitmap *fallback = nullptr;
+    for (const GlyphBitmap &glyph : glyphBitmaps)
+    {
+        if (glyph.character == character)
+            return glyph;
+        if (glyph.character == '?')
+            fallback = &glyph;
+    }
+    return *fallback;
+}
+
+// Function to create the font texture: all glyph cells side by side in one row, one byte per pixel.
+static unsigned int createFontTexture()
+{
+    const int width = glyphColumns * glyphCount;
+    std::vector<unsigned char> pixels(width * glyphRows, 0);
+    for (int glyph = 0; glyph < glyphCount; ++glyph)
+        for (int y = 0; y < 7; ++y)
+        {
+            unsigned char bits = glyph == solidGlyph ? 0x1F : findGlyph((char)(glyph + 32)).rows[y];
+            for (int x = 0; x < 5; ++x)
+                if (bits & (0x10 >> x))
+                    pixels[y * width + glyph * glyphColumns + x] = 255;
+        }
+    // The solid block also covers the spacing, so adjacent panel cells join.
+    for (int y = 0; y < glyphRows; ++y)
+        for (int x = 0; x < glyphColumns; ++x)
+            pixels[y * width + solidGlyph * glyphColumns + x] = 255;
+
+    unsigned int texture = 0;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, width, glyphRows, 0, GL_RED, GL_UNSIGNED_BYTE, pixels.data());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    trackGpuAllocation(GpuResourceKind::Texture, texture, (long long)width * glyphRows, GpuMemoryCategory::Textures, "hud");
+    labelGlObject(GL_TEXTURE, texture, "hud font");
+    return texture;
+}
+
+// Function to create the overlay renderer.
+// capacity: Maximum number of characters and panels per frame; more are ignored.
+bool createHudRenderer(HudRenderer &hud, int capacity)
+{
+    hud.program = createShaderProgram(readFile("hud_vertex_shader.glsl"), readFile("hud_fragment_shader.glsl"));
+    if (hud.program == 0)
+        return false;
+    hud.screenSizeLocation = glGetUniformLocation(hud.program, "screenSize");
+    glUseProgram(hud.program);
+    glUniform1i(glGetUniformLocation(hud.program, "font"), 0);
+    glUseProgram(0);
+
+    hud.fontTexture = createFontTexture();
+    hud.capacity = capacity;
+    hud.quads.reserve(capacity);
+
+    // No vertex buffer: the four corners of each quad come from gl_VertexID, everything else is per instance.
+    glGenVertexArrays(1, &hud.vertexArray);
+    glGenBuffers(1, &hud.instanceBuffer);
+    glBindVertexArray(hud.vertexArray);
+    glBindBuffer(GL_ARRAY_BUFFER, hud.instanceBuffer);
+    trackedBufferData(GL_ARRAY_BUFFER, hud.instanceBuffer, (long long)sizeof(HudQuad) * capacity, nullptr, GL_STREAM_DRAW,
+                      GpuMemoryCategory::Geometry, "hud");
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(HudQuad), (void *)0);                         // Rectangle
+    glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, sizeof(HudQuad), (void *)(4 * sizeof(float)));       // Glyph
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, sizeof(HudQuad), (void *)(5 * sizeof(float)));       // Color
+    for (unsigned int attribute = 0; attribute < 3; ++attribute)
+    {
+        glEnableVertexAttribArray(attribute);
+        glVertexAttribDivisor(attribute, 1); // Advance once per quad, not per corner.
+    }
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    labelGlObject(GL_PROGRAM, hud.program, "hud program");
+    labelGlObject(GL_VERTEX_ARRAY, hud.vertexArray, "hud quads");
+    labelGlObject(GL_BUFFER, hud.instanceBuffer, "hud quads");
+    return true;
+}
+
+// Function to delete the GPU objects of the overlay.
+void destroyHudRenderer(HudRenderer &hud)
+{
+    glDeleteVertexArrays(1, &hud.vertexArray);
+    trackedDeleteBuffers(1, &hud.instanceBuffer);
+    releaseGpuAllocation(GpuResourceKind::Texture, hud.fontTexture);
+    glDeleteTextures(1, &hud.fontTexture);
+    glDeleteProgram(hud.program);
+    hud = HudRenderer();
+}
+
+// Function to lay out a line of text.
+// column, row: Character cell of the first character.
+// text: Printable ASCII; lower case letters are shown as upper case.
+void hudText(HudRenderer &hud, int column, int row, const char *text, const glm::vec4 &color)
+{
+    float cellWidth = (float)(glyphColumns * hud.scale), cellHeight = (float)(glyphRows * hud.scale);
+    for (int i = 0; text[i] != '\0' && (int)hud.quads.size() < hud.capacity; ++i)
+    {
+        int character = std::toupper((unsigned char)text[i]);
+        if (character == ' ')
+            continue; // Nothing to draw.
+        int glyph = character >= 32 && character < 127 ? character - 32 : '?' - 32;
+        hud.quads.push_back({(column + i) * cellWidth, row * cellHeight, cellWidth, cellHeight, (float)glyph,
+                             color.r, color.g, color.b, color.a});
+    }
+}
+
+// Function to add a filled rectangle.
+void hudPanel(HudRenderer &hud, int column, int row, int columns, int rows, const glm::vec4 &color)
+{
+    if ((int)hud.quads.size() >= hud.capacity)
+        return;
+    float cellWidth = (float)(glyphColumns * hud.scale), cellHeight = (float)(glyphRows * hud.scale);
+    hud.quads.push_back({column * cellWidth, row * cellHeight, columns * cellWidth, rows * cellHeight, (float)solidGlyph,
+                         color.r, color.g, color.b, color.a});
+}
+
+// Function to draw the overlay. Leaves blending disabled, as the rest of the renderer expects.
+void drawHud(HudRenderer &hud, int framebufferWidth, int framebufferHeight)
+{
+    if (hud.quads.empty())
+        return;
+
+    GlDebugGroup group("hud");
+    glBindBuffer(GL_ARRAY_BUFFER, hud.instanceBuffer);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, sizeof(HudQuad) * hud.quads.size(), hud.quads.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+
+    glViewport(0, 0, framebufferWidth, framebufferHeight);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    glUseProgram(hud.program);
+    glUniform2f(hud.screenSizeLocation, (float)framebufferWidth, (float)framebufferHeight);
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, hud.fontTexture);
+    glBindVertexArray(hud.vertexArray);
+
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, (GLsizei)hud.quads.size()); // The whole overlay in one draw call
+
+    glBindVertexArray(0);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    glDisable(GL_BLEND);
+    hud.quads.clear(); // Keeps the capacity.
+}
+
+// Function to lay out and draw the statistics panel.
+// Formats into a stack buffer, so drawing the overlay allocates nothing.
+void drawFrameStatsOverlay(HudRenderer &hud, const FrameStats &stats, const FrameTimingSummary &timing,
+                           int framebufferWidth, int framebufferHeight)
+{
+    const glm::vec4 label(0.7f, 0.9f, 1.0f, 1.0f);
+    int rows = 6 + (stats.glCalls > 0 ? 1 : 0) + (allocationAuditAvailable() ? 1 : 0);
+    hudPanel(hud, 0, 0, 36, rows + 2, glm::vec4(0.0f, 0.0f, 0.0f, 0.6f));
+
+    char line[64];
+    int row = 1;
+    std::snprintf(line, sizeof(line), "FRAME %lld  %.2f MS  %.1f FPS", stats.frameIndex, stats.frameMs,
+                  stats.frameMs > 0.0 ? 1000.0 / stats.frameMs : 0.0);
+    hudText(hud, 1, row++, line, label);
+    std::snprintf(line, sizeof(line), "DRAWS %d  TRIANGLES %lld", stats.drawCalls, stats.triangles);
+    hudText(hud, 1, row++, line);
+    std::snprintf(line, sizeof(line), "STATE %d  UNIFORMS %d", stats.stateChanges, stats.uniformUpdates);
+    hudText(hud, 1, row++, line);
+    if (stats.glCalls > 0)
+    {
+        std::snprintf(line, sizeof(line), "GL CALLS %d  %.3f MS", stats.glCalls, stats.glMs);
+        hudText(hud, 1, row++, line);
+    }
+    std::snprintf(line, sizeof(line), "GPU MEMORY %.2f MIB", stats.gpuMemoryMiB);
+    hudText(hud, 1, row++, line);
+    if (allocationAuditAvailable())
+    {
+        std::snprintf(line, sizeof(line), "HEAP ALLOCATIONS %d", stats.allocations);
+        hudText(hud, 1, row++, line, stats.allocations > 0 ? glm::vec4(1.0f, 0.4f, 0.3f, 1.0f) : glm::vec4(1.0f));
+    }
+    std::snprintf(line, sizeof(line), "P50 %.1f  P99 %.1f  MAX %.1f MS", timing.present.p50, timing.present.p99,
+                  timing.present.max);
+    hudText(hud, 1, row++, line, label);
+    std::snprintf(line, sizeof(line), "GPU P99 %.2f MS  STUTTERS %d", timing.gpu.p99, timing.stutters);
+    hudText(hud, 1, row++, line);
+
+    drawHud(hud, framebufferWidth, framebufferHeight);
+}
@@ -0,0 +1,47 @@
+#ifndef HUD_H
+#define HUD_H
+
+// On-screen text overlay.
+// Text is laid out on the CPU as one quad per character; all quads of a frame are uploaded into one
+// instance buffer and drawn with a single instanced draw call that reads the glyphs from a small built-in
+// bitmap font (5x7 pixel glyphs for the printable ASCII characters, lower case shown as upper case).
+#include "frame_stats.h"  // Statistics shown by the overlay.
+#include "frame_timing.h" // Frame time percentiles shown by the overlay.
+#include <glm/glm.hpp>    // Colors.
+#include <vector>         // Quads of the current frame.
+
+// One character (or panel) of the overlay. Matches the instance attributes of hud_vertex_shader.glsl.
+struct HudQuad
+{
+    float x, y, width, height; // Pixels, origin at the top left of the framebuffer.
+    float glyph;               // Index into the font: character code - 32; the last glyph is a solid block.
+    float r, g, b, a;
+};
+
+struct HudRenderer
+{
+    unsigned int program = 0;
+    unsigned int vertexArray = 0;
+    unsigned int instanceBuffer = 0; // Room for capacity quads.
+    unsigned int fontTexture = 0;
+    int screenSizeLocation = -1;
+    int capacity = 0;
+    int scale = 2;                   // Font pixels per screen pixel.
+    std::vector<HudQuad> quads;      // Reserved up front, so laying out text never allocates.
+};
+
+bool createHudRenderer(HudRenderer &hud, int capacity = 4096); // Needs the shaders in the working directory; false on failure.
+void destroyHudRenderer(HudRenderer &hud);
+
+// Adds text in character cells: column and row count from the top left, in units of one glyph.
+void hudText(HudRenderer &hud, int column, int row, const char *text, const glm::vec4 &color = glm::vec4(1.0f));
+// Adds a filled rectangle in character cells, drawn below text added after it.
+void hudPanel(HudRenderer &hud, int column, int row, int columns, int rows, const glm::vec4 &color);
+// Draws everything added since the last call into the bound framebuffer with one draw call, then clears the list.
+void drawHud(HudRenderer &hud, int framebufferWidth, int framebufferHeight);
+
+// Draws the frame statistics panel in the top left corner.
+void drawFrameStatsOverlay(HudRenderer &hud, const FrameStats &stats, const FrameTimingSummary &timing,
+                           int framebufferWidth, int framebufferHeight);
+
+#endif
@@ -0,0 +1,121 @@
+#include "image_io.h"
+#include "logger.h"       // Error messages.
+#include "memory_arena.h" // Row buffer for the channel swizzle.
+#include <algorithm>      // std::swap_ranges flips top-first images.
+#include <cstdio>         // FILE based output keeps the row writes buffered and cheap.
+
+// Function to write a TGA image.
+// TGA stores BGRA and its default origin is the bottom left, so OpenGL rows can be written as they are
+// and only the red and blue channels need to be swapped.
+// filePath: Output file.
+// rgbaPixels: width * height tightly packed RGBA8 pixels, bottom row first.
+bool writeTga(const char *filePath, const unsigned char *rgbaPixels, int width, int height)
+{
+    FILE *file = std::fopen(filePath, "wb");
+    if (file == nullptr)
+    {
+        logError("Could not write image {}", filePath);
+        return false;
+    }
+
+    // 18 byte header: uncompressed true-color image, 32 bits per pixel, 8 alpha bits, bottom-left origin.
+    unsigned char header[18] = {};
+    header[2] = 2;
+    header[12] = (unsigned char)(width & 0xFF);
+    header[13] = (unsigned char)((width >> 8) & 0xFF);
+    header[14] = (unsigned char)(height & 0xFF);
+    header[15] = (unsigned char)((height >> 8) & 0xFF);
+    header[16] = 32;
+    header[17] = 8;
+    std::fwrite(header, 1, sizeof(header), file);
+
+    ArenaScope scope(threadArena());
+    size_t rowSize = (size_t)width * 4;
+    unsigned char *row = threadArena().allocateArray<unsigned char>(rowSize);
+    for (int y = 0; y < height; ++y)
+    {
+        const unsigned char *source = rgbaPixels + (size_t)y * width * 4;
+        for (int x = 0; x < width; ++x)
+        {
+            row[x * 4 + 0] = source[x * 4 + 2];
+            row[x * 4 + 1] = source[x * 4 + 1];
+            row[x * 4 + 2] = source[x * 4 + 0];
+            row[x * 4 + 3] = source[x * 4 + 3];
+        }
+        std::fwrite(row, 1, rowSize, file);
+    }
+
+    bool ok = std::ferror(file) == 0;
+    std::fclose(file);
+    return ok;
+}
+
+// Function to decode a TGA image.
+// Pixels are stored BGR(A) or gray; run-length encoded files (types 10 and 11) repeat or copy up to 128 pixels
+// per packet. Images whose origin is the top left are flipped, so the rows always come out bottom first.
+// contents: The whole file. rgbaPixels, width, height: Receive the image.
+bool decodeTga(const std::string &name, const std::string &contents, std::vector<unsigned char> &rgbaPixels, int &width, int &height)
+{
+    const unsigned char *data = (const unsigned char *)contents.data();
+    if (contents.size() < 18)
+    {
+        logError("{} is too short for a TGA file", name);
+        return false;
+    }
+    int type = data[2];
+    int bits = data[16];
+    width = data[12] | data[13] << 8;
+    height = data[14] | data[15] << 8;
+    bool gray = type == 3 || type == 11;
+    bool encoded = type == 10 || type == 11;
+    if (data[1] != 0 || (type != 2 && type != 3 && type != 10 && type != 11) || (gray ? bits != 8 : bits != 24 && bits != 32) ||
+        width == 0 || height == 0)
+    {
+        logError("{}: only true-color (24 or 32 bits) and 8-bit gray TGA files without a color map are supported", name);
+        return false;
+    }
+
+    int bytes = bits / 8;
+    size_t count = (size_t)width * height;
+    size_t offset = 18 + data[0]; // The image ID comes before the pixels
+    rgbaPixels.resize(count * 4);
+    auto store = [&](size_t pixel, const unsigned char *source)
+    {
+        unsigned char *target = &rgbaPixels[pixel * 4];
+        target[0] = source[gray ? 0 : 2];
+        target[1] = source[gray ? 0 : 1];
+        target[2] = source[0];
+        target[3] = bytes == 4 ? source[3] : 255;
+    };
+    for (size_t pixel = 0; pixel < count;)
+    {
+        size_t run = 1;
+        bool repeat = false;
+        if (encoded)
+        {
+            if (offset >= contents.size())
+                break;
+            run = (data[offset] & 0x7F) + 1;
+            repeat = (data[offset] & 0x80) != 0;
+            ++offset;
+        }
+        size_t needed = repeat ? bytes : run * bytes;
+        if (offset + needed > contents.size() || pixel + run > count)
+            break;
+        for (size_t i = 0; i < run; ++i)
+            store(pixel + i, data + offset + (repeat ? 0 : i * bytes));
+        offset += needed;
+        pixel += run;
+        if (pixel == count)
+        {
+            // Bit 5 of the descriptor: the first row is the top one
+            if (data[17] & 0x20)
+                for (int y = 0; y < height / 2; ++y)
+                    std::swap_ranges(&rgbaPixels[(size_t)y * width * 4], &rgbaPixels[(size_t)(y + 1) * width * 4],
+                                     &rgbaPixels[(size_t)(height - 1 - y) * width * 4]);
+            return true;
+        }
+    }
+    logError("{} is truncated or damaged", name);
+    return false;
+}
@@ -0,0 +1,15 @@
+#ifndef IMAGE_IO_H
+#define IMAGE_IO_H
+
+// Writing captured pixels to image files, and reading the uncompressed textures.
+#include <string> // File contents.
+#include <vector> // Decoded pixels.
+
+// Writes RGBA8 pixels (bottom row first, as read from OpenGL) to an uncompressed 32-bit TGA file.
+bool writeTga(const char *filePath, const unsigned char *rgbaPixels, int width, int height);
+
+// Decodes a true-color or grayscale TGA file (uncompressed or RLE, 8, 24 or 32 bits) into RGBA8 pixels, bottom row
+// first. name: For the error messages.
+bool decodeTga(const std::string &name, const std::string &contents, std::vector<unsigned char> &rgbaPixels, int &width, int &height);
+
+#endif
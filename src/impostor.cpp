@@ -0,0 +1,134 @@
+#include "impostor.h"
+#include "glad.h"                       // GLAD provides the OpenGL function pointers.
+#include "gl_debug.h"                   // Object labels and debug groups for frame captures.
+#include "gpu_memory.h"                 // Tracked atlas and depth buffer allocation.
+#include "logger.h"                     // Error messages.
+#include <glm/gtc/matrix_transform.hpp> // glm::lookAt and glm::ortho for the bake cameras.
+#include <cmath>                        // std::abs.
+
+// Function to get the sign of a value, with +1 for zero so folded coordinates never collapse.
+static float signNotZero(float value)
+{
+    return value >= 0.0f ? 1.0f : -1.0f;
+}
+
+// Function to map a direction to its place in an octahedral atlas.
+// direction: Unit vector. Returns coordinates in [0, 1]^2; the lower hemisphere lands in the corners.
+glm::vec2 octahedralEncode(const glm::vec3 &direction)
+{
+    glm::vec3 d = direction / (std::abs(direction.x) + std::abs(direction.y) + std::abs(direction.z));
+    glm::vec2 p(d.x, d.z);
+    if (d.y < 0.0f)
+        p = glm::vec2((1.0f - std::abs(d.z)) * signNotZero(d.x), (1.0f - std::abs(d.x)) * signNotZero(d.z));
+    return p * 0.5f + glm::vec2(0.5f);
+}
+
+// Function to map atlas coordinates back to their direction.
+// coordinates: In [0, 1]^2. Returns a unit vector.
+glm::vec3 octahedralDecode(const glm::vec2 &coordinates)
+{
+    glm::vec2 p = coordinates * 2.0f - glm::vec2(1.0f);
+    glm::vec3 d(p.x, 1.0f - std::abs(p.x) - std::abs(p.y), p.y);
+    if (d.y < 0.0f)
+    {
+        float x = d.x, z = d.z;
+        d.x = (1.0f - std::abs(z)) * signNotZero(x);
+        d.z = (1.0f - std::abs(x)) * signNotZero(z);
+    }
+    return glm::normalize(d);
+}
+
+// Function to compute the orientation of an impostor quad.
+// direction: Unit vector from the object towards the viewer. right, up: Receive the unit axes of the quad.
+void impostorBasis(const glm::vec3 &direction, glm::vec3 &right, glm::vec3 &up)
+{
+    right = glm::cross(glm::vec3(0.0f, 1.0f, 0.0f), direction);
+    float length = glm::length(right);
+    right = length > 1e-4f ? right / length : glm::vec3(1.0f, 0.0f, 0.0f); // Straight above or below: any right will do
+    up = glm::cross(direction, right);
+}
+
+// Function to bake an impostor atlas.
+// gridSize: Directions per side, gridSize^2 in all. cellSize: Pixels per cell side; a power of two, so the cells
+// stay apart down to the mipmap level with one texel per cell.
+bool bakeImpostorAtlas(ImpostorAtlas &atlas, int gridSize, int cellSize, float radius,
+                       const std::function<void(const glm::mat4 &viewProjection)> &drawObject, int framebufferWidth,
+                       int framebufferHeight)
+{
+    GlDebugGroup group("impostor bake");
+    int size = gridSize * cellSize;
+    GLint maxSize = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+    if (size > maxSize)
+    {
+        logError("An impostor atlas of {}x{} exceeds the maximum texture size {}", size, size, maxSize);
+        return false;
+    }
+
+    // Color into the atlas itself, depth into a buffer that only lives for the bake
+    int levels = 1;
+    while ((cellSize >> levels) > 0)
+        ++levels;
+    UniqueTexture texture = UniqueTexture::create();
+    glBindTexture(GL_TEXTURE_2D, texture.name());
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    UniqueRenderbuffer depth = UniqueRenderbuffer::create();
+    glBindRenderbuffer(GL_RENDERBUFFER, depth.name());
+    trackedRenderbufferStorage(depth.name(), GL_DEPTH_COMPONENT24, size, size, GpuMemoryCategory::RenderTargets, "impostor bake");
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    UniqueFramebuffer framebuffer = UniqueFramebuffer::create();
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer.name());
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture.name(), 0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depth.name());
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        logError("Impostor bake framebuffer is incomplete (status {x})", status);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        return false;
+    }
+
+    // Transparent background, so the impostor shader can cut the object out
+    glViewport(0, 0, size, size);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    glEnable(GL_DEPTH_TEST);
+
+    // One orthographic view per cell, from the direction at the cell center, framing the bounding sphere
+    glm::mat4 projection = glm::ortho(-radius, radius, -radius, radius, 0.5f * radius, 3.5f * radius);
+    for (int y = 0; y < gridSize; ++y)
+        for (int x = 0; x < gridSize; ++x)
+        {
+            glm::vec3 direction = octahedralDecode(glm::vec2((x + 0.5f) / gridSize, (y + 0.5f) / gridSize));
+            glm::vec3 right, up;
+            impostorBasis(direction, right, up);
+            glm::mat4 view = glm::lookAt(direction * (2.0f * radius), glm::vec3(0.0f), up);
+            glViewport(x * cellSize, y * cellSize, cellSize, cellSize);
+            drawObject(projection * view);
+        }
+    glDisable(GL_DEPTH_TEST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, framebufferWidth, framebufferHeight);
+
+    // The mipmaps average in the transparent background; the shader divides it out again
+    glBindTexture(GL_TEXTURE_2D, texture.name());
+    glGenerateMipmap(GL_TEXTURE_2D);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    trackGpuAllocation(GpuResourceKind::Texture, texture.name(), (long long)size * size * 4 * 4 / 3, GpuMemoryCategory::Textures,
+                       "impostor atlas");
+    labelGlObject(GL_TEXTURE, texture.name(), "impostor atlas");
+
+    atlas.texture = std::move(texture);
+    atlas.gridSize = gridSize;
+    atlas.cellSize = cellSize;
+    atlas.radius = radius;
+    return true;
+}
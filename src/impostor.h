@@ -0,0 +1,39 @@
+#ifndef IMPOSTOR_H
+#define IMPOSTOR_H
+
+// Impostors: pre-rendered images of an object from many directions, drawn as a camera-facing quad once the
+// object covers only a few pixels. The directions are the cell centers of an octahedral map: the unit sphere
+// is projected onto an octahedron (|x| + |y| + |z| = 1) whose upper half unfolds into a diamond and whose
+// lower half folds over the corners, filling a square. A grid of N x N cells then covers every direction with
+// roughly equal area, and the cell of a direction is found with a few arithmetic operations, with no table.
+// The y axis is the pole, so the cells near the center of the atlas look down on the object.
+// All functions must be called on the thread that owns the OpenGL context.
+#include "gl_objects.h" // Owner of the atlas texture.
+#include <functional>   // The object drawing callback.
+#include <glm/glm.hpp>  // Directions and the bake transforms.
+
+// Images of one object, one cell per direction.
+struct ImpostorAtlas
+{
+    UniqueTexture texture; // GL_TEXTURE_2D, RGBA8 with mipmaps; alpha 0 outside the object.
+    int gridSize = 0;      // Cells per side; 0 if the atlas could not be baked.
+    int cellSize = 0;      // Pixels per cell side.
+    float radius = 0.0f;   // Bounding sphere radius of the object; the quads are 2 * radius wide.
+};
+
+glm::vec2 octahedralEncode(const glm::vec3 &direction); // Unit direction to its atlas coordinates in [0, 1]^2.
+glm::vec3 octahedralDecode(const glm::vec2 &coordinates); // Atlas coordinates to the unit direction.
+
+// Right and up vectors of a quad facing along direction (from the object towards the viewer). Used to bake the
+// cells and, in the same form, by the impostor shader, so a baked image lines up with its quad.
+void impostorBasis(const glm::vec3 &direction, glm::vec3 &right, glm::vec3 &up);
+
+// Renders an object centered at the origin into every cell of a new atlas, orthographically and lit as it
+// would be drawn. drawObject: Draws the object with the given view-projection matrix into the bound framebuffer
+// (its viewport and depth test are set up). radius: Bounding sphere radius of the object.
+// Leaves the default framebuffer bound with the viewport of framebufferWidth x framebufferHeight.
+bool bakeImpostorAtlas(ImpostorAtlas &atlas, int gridSize, int cellSize, float radius,
+                       const std::function<void(const glm::mat4 &viewProjection)> &drawObject, int framebufferWidth,
+                       int framebufferHeight);
+
+#endif
@@ -0,0 +1,285 @@
+#include "logger.h"
+#include <atomic>    // Ring positions and the sink state.
+#include <chrono>    // Timestamps and the idle interval of the sink.
+#include <cstdio>    // snprintf and the FILE outputs.
+#include <cstring>   // strcmp, strlen and memcpy.
+#include <memory>    // Shared ownership of the rings between a thread and the sink.
+#include <mutex>     // Protects the ring list; only taken when a thread logs for the first time.
+#include <pthread.h> // pthread_atfork, stops queuing in forked children.
+#include <thread>    // The sink thread.
+#include <vector>    // Ring list.
+
+static const int maxArguments = 8;        // Further arguments are ignored.
+static const int recordTextSize = 400;    // Bytes for the copied string arguments of one record; longer strings are cut.
+static const uint32_t ringCapacity = 256; // Records per thread before messages are dropped.
+
+struct LogRecord
+{
+    const char *format;
+    int64_t nanoseconds; // Since the program started.
+    LogSeverity severity;
+    uint8_t argumentCount;
+    LogArgument arguments[maxArguments]; // String arguments hold an offset into text in unsignedInteger.
+    char text[recordTextSize];
+};
+
+// Records of one thread. head is only written by the thread, tail only by the sink.
+struct LogRing
+{
+    LogRecord records[ringCapacity];
+    alignas(64) std::atomic<uint32_t> head{0};
+    alignas(64) std::atomic<uint32_t> tail{0};
+    std::atomic<bool> abandoned{false}; // The thread has exited; the ring is removed once drained.
+};
+
+// Marks the ring of a thread as abandoned when the thread exits.
+struct ThreadRing
+{
+    std::shared_ptr<LogRing> ring;
+    ~ThreadRing()
+    {
+        if (ring)
+            ring->abandoned.store(true, std::memory_order_release);
+    }
+};
+
+static const char *const severityNames[] = {"DEBUG", "INFO", "WARNING", "ERROR"};
+static const auto programStart = std::chrono::steady_clock::now();
+
+static std::atomic<int> minimumSeverity{(int)LogSeverity::Info};
+static std::atomic<bool> sinkRunning{false};  // Records are queued only while true.
+static std::atomic<bool> stopRequested{false};
+static std::atomic<long long> dropped{0};
+static std::mutex ringsMutex;
+static std::vector<std::shared_ptr<LogRing>> rings;
+static thread_local ThreadRing threadRing;
+static std::thread sinkThread;
+static FILE *logFile = nullptr;
+
+// Function to write a record as one line: timestamp, severity and the message with the arguments in place of {}.
+// Returns the length written into line (without the terminator); the line is cut at size - 1 bytes.
+static int formatRecord(const LogRecord &record, char *line, int size)
+{
+    int length = std::snprintf(line, size, "[%10.3f] %-7s ", record.nanoseconds / 1e9, severityNames[(int)record.severity]);
+    int argument = 0;
+    for (const char *c = record.format; *c != '\0' && length < size - 2; ++c)
+    {
+        bool hex = c[0] == '{' && c[1] == 'x' && c[2] == '}';
+        if ((hex || (c[0] == '{' && c[1] == '}')) && argument < record.argumentCount)
+        {
+            const LogArgument &value = record.arguments[argument++];
+            int room = size - 1 - length;
+            int written = 0;
+            switch (value.type)
+            {
+            case LogArgument::Integer:
+                written = std::snprintf(line + length, room, hex ? "0x%llx" : "%lld", value.integer);
+                break;
+            case LogArgument::Unsigned:
+                written = std::snprintf(line + length, room, hex ? "0x%llx" : "%llu", value.unsignedInteger);
+                break;
+            case LogArgument::Real:
+                written = std::snprintf(line + length, room, "%g", value.real);
+                break;
+            case LogArgument::String:
+                written = std::snprintf(line + length, room, "%s", record.text + value.unsignedInteger);
+                break;
+            }
+            length += written < room ? written : room - 1;
+            c += hex ? 2 : 1; // Skip the rest of the placeholder.
+        }
+        else
+            line[length++] = *c;
+    }
+    line[length++] = '\n';
+    line[length] = '\0';
+    return length;
+}
+
+// Function to copy the format and the arguments into a record. Strings are copied, the rest is stored as is.
+static void fillRecord(LogRecord &record, LogSeverity severity, const char *format, const LogArgument *arguments, int argumentCount)
+{
+    record.format = format;
+    record.nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - programStart).count();
+    record.severity = severity;
+    record.argumentCount = (uint8_t)(argumentCount < maxArguments ? argumentCount : maxArguments);
+    size_t textUsed = 0;
+    for (int i = 0; i < record.argumentCount; ++i)
+    {
+        record.arguments[i] = arguments[i];
+        if (arguments[i].type != LogArgument::String)
+            continue;
+        size_t length = std::strlen(arguments[i].string);
+        size_t room = textUsed < recordTextSize ? recordTextSize - textUsed - 1 : 0;
+        if (length > room)
+            length = room;
+        std::memcpy(record.text + textUsed, arguments[i].string, length);
+        record.arguments[i].unsignedInteger = textUsed < recordTextSize ? textUsed : recordTextSize - 1;
+        textUsed += length;
+        if (textUsed < recordTextSize)
+            record.text[textUsed++] = '\0';
+    }
+    record.text[recordTextSize - 1] = '\0';
+}
+
+// Function to format and write a message on the calling thread, when no sink thread is available.
+static void writeDirect(LogSeverity severity, const char *format, const LogArgument *arguments, int argumentCount)
+{
+    LogRecord record;
+    fillRecord(record, severity, format, arguments, argumentCount);
+    char line[1024];
+    int length = formatRecord(record, line, sizeof(line));
+    std::fwrite(line, 1, length, stderr);
+}
+
+static LogRing *registerThreadRing()
+{
+    threadRing.ring = std::make_shared<LogRing>();
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    rings.push_back(threadRing.ring);
+    return threadRing.ring.get();
+}
+
+// Function to queue a message. Never waits: a full ring drops the message.
+void submitLogRecord(LogSeverity severity, const char *format, const LogArgument *arguments, int argumentCount)
+{
+    if (!sinkRunning.load(std::memory_order_acquire))
+    {
+        writeDirect(severity, format, arguments, argumentCount);
+        return;
+    }
+
+    LogRing *ring = threadRing.ring ? threadRing.ring.get() : registerThreadRing();
+    uint32_t head = ring->head.load(std::memory_order_relaxed);
+    if (head - ring->tail.load(std::memory_order_acquire) >= ringCapacity)
+    {
+        dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    fillRecord(ring->records[head % ringCapacity], severity, format, arguments, argumentCount);
+    ring->head.store(head + 1, std::memory_order_release); // Publishes the record to the sink.
+}
+
+// Function to write the queued records of every thread. Returns the number of records written.
+// The ring list is only locked to copy it, so a thread registering its ring never waits for the output.
+static int drainRings()
+{
+    static std::vector<std::shared_ptr<LogRing>> active; // Only used by the sink thread.
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        active = rings;
+    }
+
+    char line[1024];
+    int written = 0;
+    bool removeAbandoned = false;
+    for (const std::shared_ptr<LogRing> &ring : active)
+    {
+        bool abandoned = ring->abandoned.load(std::memory_order_acquire); // Read first: the last records of the thread are then visible.
+        uint32_t tail = ring->tail.load(std::memory_order_relaxed);
+        uint32_t head = ring->head.load(std::memory_order_acquire);
+        for (; tail != head; ++tail, ++written)
+        {
+            int length = formatRecord(ring->records[tail % ringCapacity], line, sizeof(line));
+            std::fwrite(line, 1, length, stderr);
+            if (logFile != nullptr)
+                std::fwrite(line, 1, length, logFile);
+        }
+        ring->tail.store(tail, std::memory_order_release); // Hands the slots back to the thread.
+        removeAbandoned = removeAbandoned || abandoned;
+    }
+    if (written > 0)
+    {
+        std::fflush(stderr);
+        if (logFile != nullptr)
+            std::fflush(logFile);
+    }
+
+    // Rings of exited threads are drained now and can go.
+    if (removeAbandoned)
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        for (size_t i = 0; i < rings.size();)
+            if (rings[i]->abandoned.load(std::memory_order_acquire) &&
+                rings[i]->tail.load(std::memory_order_relaxed) == rings[i]->head.load(std::memory_order_acquire))
+                rings.erase(rings.begin() + i);
+            else
+                ++i;
+    }
+    return written;
+}
+
+// Loop of the sink thread: drain, and sleep briefly when there was nothing to write.
+static void sinkMain()
+{
+    for (;;)
+    {
+        bool stopping = stopRequested.load(std::memory_order_acquire);
+        if (drainRings() == 0)
+        {
+            if (stopping)
+                return;
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+    }
+}
+
+// Function to start the sink thread.
+// filePath: Log file that receives every message in addition to the standard error; empty for none.
+// minimum: Least severe messages that are kept.
+bool startLogger(const char *filePath, LogSeverity minimum)
+{
+    setLogLevel(minimum);
+    if (sinkRunning.load())
+        return true;
+    if (filePath != nullptr && filePath[0] != '\0')
+    {
+        logFile = std::fopen(filePath, "w");
+        if (logFile == nullptr)
+            return false;
+    }
+
+    // A forked child has no sink thread; it writes directly.
+    static bool forkHandlerInstalled = false;
+    if (!forkHandlerInstalled)
+        pthread_atfork(nullptr, nullptr, []
+                       { sinkRunning.store(false); });
+    forkHandlerInstalled = true;
+
+    stopRequested.store(false);
+    sinkThread = std::thread(sinkMain);
+    sinkRunning.store(true, std::memory_order_release);
+    return true;
+}
+
+void stopLogger()
+{
+    if (!sinkRunning.load())
+        return;
+    sinkRunning.store(false, std::memory_order_release); // New messages are written directly from here on.
+    stopRequested.store(true, std::memory_order_release);
+    sinkThread.join();
+
+    long long lost = dropped.exchange(0);
+    if (lost > 0)
+        logWarning("{} log messages were dropped because a log ring was full", lost);
+    if (logFile != nullptr)
+        std::fclose(logFile);
+    logFile = nullptr;
+}
+
+void setLogLevel(LogSeverity minimum) { minimumSeverity.store((int)minimum, std::memory_order_relaxed); }
+bool logEnabled(LogSeverity severity) { return (int)severity >= minimumSeverity.load(std::memory_order_relaxed); }
+long long droppedLogMessages() { return dropped.load(std::memory_order_relaxed); }
+
+bool parseLogSeverity(const char *name, LogSeverity &severity)
+{
+    static const char *const optionNames[] = {"debug", "info", "warning", "error"};
+    for (int i = 0; i < 4; ++i)
+        if (std::strcmp(name, optionNames[i]) == 0)
+        {
+            severity = (LogSeverity)i;
+            return true;
+        }
+    return false;
+}
@@ -0,0 +1,112 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+// Asynchronous logging that never blocks the calling thread.
+// A log call checks the severity, copies the format pointer and the arguments into a fixed-size record and
+// pushes it into a ring that belongs to the calling thread (single producer, single consumer, no locks).
+// A background sink thread collects the records of all threads, formats them and writes them to the
+// standard error and an optional log file. Formatting and I/O therefore happen off the render thread, and a
+// log call costs a few stores. When a ring is full the record is dropped and counted rather than waited for.
+//
+// Formats use {} as the placeholder for the next argument ({x} for an integer in hexadecimal) and must be
+// string literals (only the pointer is kept). Arguments can be integers, floating point numbers, C strings
+// and std::string; strings are copied.
+// Before startLogger, after stopLogger and in forked child processes (render farm workers), where no sink
+// thread runs, messages are formatted and written to the standard error directly.
+#include <cstdint>     // Fixed size record fields.
+#include <string>      // std::string arguments.
+#include <type_traits> // Argument type dispatch.
+
+enum class LogSeverity : uint8_t
+{
+    Debug,
+    Info,
+    Warning,
+    Error
+};
+
+bool startLogger(const char *filePath, LogSeverity minimum);    // Starts the sink thread; filePath may be empty. False if the file cannot be opened.
+void stopLogger();                                              // Writes the pending messages and stops the sink thread.
+void setLogLevel(LogSeverity minimum);
+bool logEnabled(LogSeverity severity);
+long long droppedLogMessages();                                 // Messages lost to full rings.
+bool parseLogSeverity(const char *name, LogSeverity &severity); // debug, info, warning or error.
+
+// One captured argument. Strings point to the caller's memory until the record is submitted.
+struct LogArgument
+{
+    enum Type : uint8_t
+    {
+        Integer,
+        Unsigned,
+        Real,
+        String
+    };
+    Type type;
+    union
+    {
+        long long integer;
+        unsigned long long unsignedInteger;
+        double real;
+        const char *string;
+    };
+};
+
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value, LogArgument>::type makeLogArgument(T value)
+{
+    LogArgument argument;
+    argument.type = LogArgument::Integer;
+    argument.integer = value;
+    return argument;
+}
+
+template <typename T>
+typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value, LogArgument>::type makeLogArgument(T value)
+{
+    LogArgument argument;
+    argument.type = LogArgument::Unsigned;
+    argument.unsignedInteger = value;
+    return argument;
+}
+
+template <typename T>
+typename std::enable_if<std::is_floating_point<T>::value, LogArgument>::type makeLogArgument(T value)
+{
+    LogArgument argument;
+    argument.type = LogArgument::Real;
+    argument.real = value;
+    return argument;
+}
+
+inline LogArgument makeLogArgument(const char *value)
+{
+    LogArgument argument;
+    argument.type = LogArgument::String;
+    argument.string = value != nullptr ? value : "(null)";
+    return argument;
+}
+
+inline LogArgument makeLogArgument(const std::string &value) { return makeLogArgument(value.c_str()); }
+
+void submitLogRecord(LogSeverity severity, const char *format, const LogArgument *arguments, int argumentCount);
+
+template <typename... Args>
+void logMessage(LogSeverity severity, const char *format, const Args &...args)
+{
+    if (!logEnabled(severity))
+        return;
+    const LogArgument arguments[sizeof...(Args) + 1] = {makeLogArgument(args)...};
+    submitLogRecord(severity, format, arguments, (int)sizeof...(Args));
+}
+
+template <typename... Args>
+void logDebug(const char *format, const Args &...args) { logMessage(LogSeverity::Debug, format, args...); }
+template <typename... Args>
+void logInfo(const char *format, const Args &...args) { logMessage(LogSeverity::Info, format, args...); }
+template <typename... Args>
+void logWarning(const char *format, const Args &...args) { logMessage(LogSeverity::Warning, format, args...); }
+template <typename... Args>
+void logError(const char *format, const Args &...args) { logMessage(LogSeverity::Error, format, args...); }
+
+#endif
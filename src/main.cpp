@@ -1,164 +1,419 @@
 // Include the necessary headers for OpenGL functionality, window management, and math operations.
 #include "glad.h"                       // GLAD manages function pointers for OpenGL so we can use all the OpenGL functions.
 #include <GLFW/glfw3.h>                 // GLFW provides a simple API for creating windows, contexts and managing input.
+#include "gl_context.h"                 // Creates the window and its OpenGL context.
 #include <glm/glm.hpp>                  // GLM is a mathematics library for graphics software based on the OpenGL Shading Language (GLSL) specifications.
 #include <glm/gtc/matrix_transform.hpp> // Provides functions for generating common transformation matrices.
 #include <glm/gtc/type_ptr.hpp>         // Provides functions to convert GLM types to plain C++ types.
 #include <iostream>                     // Included for input/output operations.
-#include <fstream>                      // File stream, used for reading shader files.
-#include <sstream>                      // String stream, used for buffering string data read from files.
 #include <string>                       // Used for string operations.
+#include <cstdio>                       // snprintf, used to build the screenshot file names.
+#include <cstdlib>                      // std::atexit, stops the logger.
+#include <memory>                       // std::unique_ptr, controls when the GL-owning helpers are destroyed.
+#include "shader.h"                     // Reading, compiling and linking the shader programs.
+#include "scene.h"                      // The pyramid mesh and its model matrices.
+#include "multiview.h"                  // Drawing the camera presets into several viewports at once.
+#include "worker_pool.h"                // Background threads for work that must stay off the render thread.
+#include "readback.h"                   // Non-blocking framebuffer readback.
+#include "image_io.h"                   // Writing captured pixels to image files.
+#include "video_recorder.h"             // Recording the session to a video file.
+#include "options.h"                    // Command line options.
+#include "batch_renderer.h"             // Headless rendering of camera paths.
+#include "tiled_render.h"               // Posters larger than the framebuffer limit.
+#include "gl_trace.h"                   // Recording the OpenGL calls for gl_replay.
+#include "gl_instrument.h"              // Per-entry-point OpenGL call statistics.
+#include "gpu_memory.h"                 // GPU memory budgets and usage report.
+#include "frame_stats.h"                // Per-frame draw call, triangle and state change counters.
+#include "hud.h"                        // On-screen statistics.
+#include "frame_timing.h"               // Frame time percentiles and stutters.
+#include "alloc_audit.h"                // Heap allocation checks of the render loop.
+#include "memory_arena.h"               // Scratch memory of the current frame.
+#include "memory_pool.h"                // Pool statistics.
+#include "logger.h"                     // Messages are written by a background thread.
+#include "gl_debug.h"                   // Driver messages, object labels and debug groups.
+#include "gl_objects.h"                 // Owners of GL objects, deleted once the GPU is done with them.
+#include "asset_streamer.h"             // Loading meshes and textures in the background.
+#include "virtual_texture.h"            // Sparse paging of large texture sets.
+#include "asset_pack.h"                 // Shaders and meshes from one compressed file.
+#include "vertex_pulling.h"             // Fetching the pyramid vertices from buffer textures.
+#include "pyramid_field.h"              // Far field of point-expanded pyramids.
 
 // Function declarations. These functions will be defined later in the code.
 void framebuffer_size_callback(GLFWwindow *window, int width, int height);                            // Callback function for when the window size changes.
 void processInput(GLFWwindow *window);                                                                // Processes input from the user.
-std::string readFile(const char *filePath);                                                           // Reads the content of a file and returns it as a string.
-unsigned int compileShader(unsigned int type, const std::string &source);                             // Compiles a shader from source code.
-unsigned int createShaderProgram(const std::string &vertexShader, const std::string &fragmentShader); // Links vertex and fragment shaders into a shader program.
-
-// Scene settings
-glm::vec3 sceneCenter = glm::vec3(0.0f, 0.0f, 0.0f); // Center of the scene, used for camera orientation.
-
-// Camera settings
-glm::vec3 cameraPositions[] = {
-    glm::vec3(0.0f, 0.0f, 10.0f), // Front view position of the camera.
-    glm::vec3(0.0f, 10.0f, 0.0f), // Top view position of the camera.
-    glm::vec3(10.0f, 0.0f, 0.0f)  // Side view position of the camera.
-};
+
+// Camera settings (the scene center and the preset positions live in scene.cpp)
 glm::vec3 cameraFront = glm::vec3(0.0f, 0.0f, -1.0f); // The initial forward direction of the camera.
 glm::vec3 cameraUp = glm::vec3(0.0f, 1.0f, 0.0f);     // The up direction of the camera, used to define the "up" in the world space.
 int currentCameraPosition = 0;                        // Index to track the current camera position from the cameraPositions array.
 
-int main()
+// Window settings
+int framebufferWidth = 800;   // Current width of the framebuffer in pixels.
+int framebufferHeight = 600;  // Current height of the framebuffer in pixels.
+bool multiViewEnabled = false; // When true the front, top and side views and the current camera are shown side by side.
+
+// Capture settings
+bool screenshotRequested = false;   // Set when F12 is pressed, cleared once the readback has been queued.
+bool screenshotKeyDown = false;     // Previous state of F12, so holding the key takes only one screenshot.
+bool recordingToggled = false;      // Set when V is pressed to start or stop a recording.
+bool recordKeyDown = false;         // Previous state of V.
+bool glCallReportRequested = false; // Set when G is pressed; the OpenGL call statistics are printed after the frame.
+bool glCallReportKeyDown = false;   // Previous state of G.
+bool memoryReportRequested = false; // Set when M is pressed; the GPU memory usage is printed after the frame.
+bool memoryReportKeyDown = false;   // Previous state of M.
+bool hudVisible = false;            // Toggled with H: shows the frame statistics on screen.
+bool hudKeyDown = false;            // Previous state of H.
+bool meshReloadRequested = false;   // Set when L is pressed; the streamed mesh is loaded again.
+bool meshReloadKeyDown = false;     // Previous state of L.
+
+const int allocationAuditWarmup = 120; // Frames that may allocate before --alloc-audit checks start (queues, caches and the driver fill up).
+
+int main(int argc, char **argv)
 {
-    // Initialize GLFW library
-    glfwInit();
+    // Read the command line options
+    AppOptions options;
+    if (!parseOptions(argc, argv, options))
+        return -1;
+
+    // From here on messages are queued and written by a background thread; atexit flushes them on every return path
+    if (!startLogger(options.logPath.c_str(), options.logLevel))
+        logError("Could not open the log file {}", options.logPath);
+    std::atexit(stopLogger);
+    if (options.allocAuditFrames > 0 && !allocationAuditAvailable())
+    {
+        logError("--alloc-audit needs a build configured with -DALLOC_AUDIT=ON");
+        return -1;
+    }
+    for (const std::string &budget : options.memoryBudgets)
+        if (!setGpuMemoryBudget(budget))
+        {
+            logError("Invalid GPU memory budget {}, expected <category>=<MiB>", budget);
+            return -1;
+        }
 
-    // Set GLFW to use OpenGL version 3.3, ensuring forward compatibility and core profile features
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    // Assets come from the pack when there is one, from loose files otherwise
+    if (!options.packPath.empty() && !mountAssetPack(options.packPath) && options.packPath != "assets.pack")
+        logWarning("Could not mount the asset pack {}; reading loose files", options.packPath);
 
-    // Additional hint for macOS compatibility: Enables features from newer OpenGL versions
-#ifdef __APPLE__
-    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
-#endif
+    // Offline modes render into offscreen framebuffers and never open the interactive window.
+    // They initialize GLFW themselves because render farm workers must do so after forking.
+    if (!options.batchPath.empty())
+        return runBatchRenderer(options);
+    if (!options.posterPath.empty())
+        return runPosterRenderer(options);
 
-    // Create a windowed mode window and its OpenGL context
-    GLFWwindow *window = glfwCreateWindow(800, 600, "OpenGL Pyramid", nullptr, nullptr);
-    if (window == nullptr) // Check if the GLFW window failed to create
+    // Initialize GLFW library
+    glfwInit();
+
+    // Create a windowed mode window and its OpenGL context, and load the OpenGL functions
+    ContextSettings contextSettings;
+    contextSettings.debugOutput = options.glDebug;
+    GLFWwindow *window = createContextWindow(contextSettings);
+    if (window == nullptr) // Check if the window or GLAD failed to initialize
     {
-        std::cerr << "Failed to create GLFW window" << std::endl;
         glfwTerminate(); // Terminate GLFW, freeing any resources allocated by GLFW.
         return -1;       // Return -1 indicating the program failed to run properly
     }
-    glfwMakeContextCurrent(window); // Make the window's context current
 
     // Set the function to be called when the window size is changed
     glfwSetFramebufferSizeCallback(window, framebuffer_size_callback);
+    glfwGetFramebufferSize(window, &framebufferWidth, &framebufferHeight); // The framebuffer can be larger than the window on high-DPI screens
 
-    // Initialize GLAD before calling any OpenGL function
-    if (!gladLoadGLLoader((GLADloadproc)glfwGetProcAddress))
-    {
-        std::cerr << "Failed to initialize GLAD" << std::endl;
-        return -1; // Return -1 indicating the program failed to run properly
-    }
+    // The streamer's upload context reloads the OpenGL functions, so it must exist before any hook is installed
+    std::unique_ptr<AssetStreamer> streamer;
+    if (!options.streamMeshPath.empty() || !options.texturePaths.empty())
+        streamer.reset(new AssetStreamer(window, options.glDebug, options.ioBackend, options.mipFilter));
+
+    // Wrap the OpenGL functions for call statistics; must happen before a trace wraps them again
+    if (!options.glCalls.empty() && !installGlInstrumentation(options.glCalls == "time"))
+        logWarning("--gl-calls needs a build configured with -DGL_INSTRUMENTED=ON");
+
+    // Count draw calls and state changes for the frame statistics
+    installFrameStatsCounters();
+
+    // Start the OpenGL trace before any resource is created, so the replay can recreate them
+    if (!options.tracePath.empty())
+        startGlTrace(options.tracePath.c_str(), options.traceFrames, framebufferWidth, framebufferHeight);
 
     // Load shaders from files, compile them, and link them into a shader program
     std::string vertexShaderSource = readFile("vertex_shader.glsl");
     std::string fragmentShaderSource = readFile("fragment_shader.glsl");
-    unsigned int shaderProgram = createShaderProgram(vertexShaderSource, fragmentShaderSource);
-
-    // Define the vertices of our pyramid, including position and color data
-    float vertices[] = {
-        // Positions          // Colors
-        0.0f, 0.5f, 0.0f, 1.0f, 0.0f, 0.0f,   // Top vertex
-        -0.5f, -0.5f, 0.5f, 0.0f, 1.0f, 0.0f, // Front-left vertex
-        0.5f, -0.5f, 0.5f, 0.0f, 0.0f, 1.0f,  // Front-right vertex
-        0.5f, -0.5f, -0.5f, 1.0f, 1.0f, 0.0f, // Back-right vertex
-        -0.5f, -0.5f, -0.5f, 1.0f, 0.0f, 1.0f // Back-left vertex
+    if (options.vertexPulling != VertexEncoding::Off) // Every pyramid program fetches its vertices itself
+        vertexShaderSource = addShaderDefines(vertexShaderSource, "#define VERTEX_PULLING\n");
+    UniqueProgram shaderProgram(createShaderProgram(vertexShaderSource, fragmentShaderSource));
+    labelGlObject(GL_PROGRAM, shaderProgram.name(), "pyramid program");
+
+    // The textured variant of the program samples the material array once it has streamed in
+    UniqueProgram texturedProgram;
+    if (!options.texturePaths.empty())
+    {
+        texturedProgram = UniqueProgram(createShaderProgram(addShaderDefines(vertexShaderSource, "#define TEXTURED\n"),
+                                                            addShaderDefines(fragmentShaderSource, "#define TEXTURED\n")));
+        labelGlObject(GL_PROGRAM, texturedProgram.name(), "textured pyramid program");
+    }
+
+    // Upload the pyramid geometry, and with vertex pulling wrap it into buffer textures
+    PyramidMesh pyramid = createPyramidMesh();
+    if (options.vertexPulling != VertexEncoding::Off)
+        createPullingVertexArray();
+    PulledMesh pulled = createPulledMesh(pyramid, options.vertexPulling);
+    const PulledMesh *pulledMesh = options.vertexPulling != VertexEncoding::Off ? &pulled : nullptr;
+
+    // A streamed mesh replaces the pyramid geometry once it is on the GPU; the replaced objects are deleted when the GPU is done with them
+    auto requestStreamedMesh = [&](int priority)
+    {
+        streamer->requestMesh(options.streamMeshPath, priority, [&pyramid, &pulled, &options](PyramidMesh mesh)
+                              {
+                                  pyramid = std::move(mesh);
+                                  pulled = createPulledMesh(pyramid, options.vertexPulling);
+                              });
     };
-    // Define the indices for the pyramid, telling OpenGL which vertices make up each triangle
-    unsigned int indices[] = {
-        0, 1, 2, // Front face triangle
-        0, 2, 3, // Right face triangle
-        0, 3, 4, // Back face triangle
-        0, 4, 1, // Left face triangle
-        1, 2, 3, // Base right triangle
-        1, 3, 4  // Base left triangle
+    if (streamer && !options.streamMeshPath.empty())
+        requestStreamedMesh(0);
+
+    // Material textures of the pyramids; until they arrive the pyramids are drawn with their vertex colors
+    PyramidMaterials materials;
+    auto requestMaterials = [&]()
+    {
+        streamer->requestMaterials(options.texturePaths, 0, [&materials](PyramidMaterials loaded)
+                                   { materials = std::move(loaded); });
     };
+    if (streamer && !options.texturePaths.empty() && options.virtualTexturePages == 0)
+        requestMaterials();
 
-    // Generate and bind the Vertex Array Object (VAO), Vertex Buffer Object (VBO), and Element Buffer Object (EBO)
-    unsigned int VBO, VAO, EBO;
-    glGenVertexArrays(1, &VAO); // Generates one Vertex Array Object
-    glGenBuffers(1, &VBO);      // Generates one Vertex Buffer Object
-    glGenBuffers(1, &EBO);      // Generates one Element Buffer Object
+    // Create the renderer used by the quad-view mode
+    MultiViewRenderer multiView;
+    if (!createMultiViewRenderer(multiView))
+    {
+        glfwTerminate();
+        return -1;
+    }
 
-    // Bind the Vertex Array Object first, then bind and set vertex buffer(s), and then configure vertex attribute(s).
-    glBindVertexArray(VAO);
+    // Far field of pyramids around the scene, drawn from one point record each
+    PyramidFieldRenderer pyramidField;
+    if (options.pyramidField > 0 &&
+        !createPyramidFieldRenderer(pyramidField, options.pyramidField, options.impostorPixels, framebufferWidth, framebufferHeight))
+        logWarning("Drawing the scene without the pyramid field");
 
-    // Copy our vertices array in a buffer for OpenGL to use
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
+    // Overlay for the frame statistics, and their export stream
+    HudRenderer hud;
+    if (!createHudRenderer(hud))
+    {
+        glfwTerminate();
+        return -1;
+    }
+    FrameStatsExporter statsExporter;
+    if (!options.statsPath.empty() && !statsExporter.open(options.statsPath))
+        logError("Could not open the statistics file {}", options.statsPath);
+
+    // CPU, GPU and present times of the recent frames
+    std::unique_ptr<FrameTimer> frameTimer(new FrameTimer());
+
+    // Worker threads and the pixel pack buffer ring used to capture frames without stalling the render loop
+    WorkerPool workers(2);
+    std::unique_ptr<FrameReadback> readback(new FrameReadback(workers));
+    long long frameIndex = 0; // Number of frames rendered so far.
+
+    // With a page budget, the textures are paged in as the feedback pass finds them on screen instead of being
+    // loaded whole; without sparse texture support they are streamed whole after all
+    std::unique_ptr<VirtualTexture> virtualTexture;
+    UniqueProgram virtualProgram, feedbackProgram;
+    if (options.virtualTexturePages > 0 && !options.texturePaths.empty())
+    {
+        virtualTexture.reset(new VirtualTexture(options.texturePaths, options.virtualTexturePages, workers));
+        if (virtualTexture->valid())
+        {
+            std::string defines = "#define TEXTURED\n#define VIRTUAL_TEXTURE\n";
+            virtualProgram = UniqueProgram(createShaderProgram(addShaderDefines(vertexShaderSource, defines),
+                                                               addShaderDefines(fragmentShaderSource, defines)));
+            defines += "#define VIRTUAL_TEXTURE_FEEDBACK\n";
+            feedbackProgram = UniqueProgram(createShaderProgram(addShaderDefines(vertexShaderSource, defines),
+                                                                addShaderDefines(fragmentShaderSource, defines)));
+            labelGlObject(GL_PROGRAM, virtualProgram.name(), "virtual texture program");
+            labelGlObject(GL_PROGRAM, feedbackProgram.name(), "virtual texture feedback program");
+        }
+        else
+        {
+            logWarning("Virtual texturing is not available; loading the textures whole");
+            virtualTexture.reset();
+            requestMaterials();
+        }
+    }
 
-    // Copy our index array in a buffer for OpenGL to use
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+    // Video recording, started right away if requested on the command line
+    std::unique_ptr<VideoRecorder> recorder(new VideoRecorder(*readback));
+    if (!options.recordPipe.empty())
+        recorder->start(options.recordPipe, true, framebufferWidth, framebufferHeight, options.recordFps);
+    else if (!options.recordPath.empty())
+        recorder->start(options.recordPath, false, framebufferWidth, framebufferHeight, options.recordFps);
 
-    // Set our vertex attributes pointers
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void *)0);                   // Position attribute
-    glEnableVertexAttribArray(0);                                                                    // Enable the position attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void *)(3 * sizeof(float))); // Color attribute
-    glEnableVertexAttribArray(1);                                                                    // Enable the color attribute
+    // From here on, frames after the warm-up must not allocate
+    if (options.allocAuditFrames > 0)
+        startAllocationAudit(allocationAuditWarmup);
 
     // The render loop
     while (!glfwWindowShouldClose(window))
     {
         processInput(window); // Check if the user has triggered any input (like pressing the ESC key)
+        frameArena().reset(); // Releases the scratch memory of the previous frame
+        frameTimer->beginFrame(); // Starts the CPU clock and the GPU timer query of the frame
 
-        // Clear the screen to a dark green color
-        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
-        glClear(GL_COLOR_BUFFER_BIT);
+        // Swap in streamed meshes whose upload has finished; a reload asked for by the user goes before prefetches
+        if (streamer)
+        {
+            if (meshReloadRequested && !options.streamMeshPath.empty())
+                requestStreamedMesh(1);
+            streamer->poll();
+        }
+        meshReloadRequested = false;
 
-        // Use the shader program
-        glUseProgram(shaderProgram);
+        // Load the pages the last feedback asked for and evict the ones no longer seen
+        if (virtualTexture)
+            virtualTexture->update();
 
-        // Calculate the view matrix using the camera position, target direction, and up vector
-        glm::vec3 target = cameraPositions[currentCameraPosition] + cameraFront;
-        glm::mat4 view = glm::lookAt(cameraPositions[currentCameraPosition], target, cameraUp);
-        unsigned int viewLoc = glGetUniformLocation(shaderProgram, "view");
-        glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
+        // Clear the screen to a dark green color, and the depth the pyramid field is tested against
+        glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
-        // Calculate the projection matrix for a perspective view
-        glm::mat4 projection = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 100.0f);
-        unsigned int projLoc = glGetUniformLocation(shaderProgram, "projection");
-        glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
+        if (multiViewEnabled)
+        {
+            // Front, top and side presets plus the current camera, all drawn by a single instanced draw call
+            View views[maxViews];
+            layoutViewGrid(views, maxViews, framebufferWidth, framebufferHeight);
+            for (int i = 0; i < maxViews; ++i)
+            {
+                glm::mat4 view;
+                if (i < cameraPresetCount)
+                    view = cameraPresetViewMatrix(i);
+                else
+                    view = glm::lookAt(cameraPositions[currentCameraPosition], cameraPositions[currentCameraPosition] + cameraFront, cameraUp);
+                float aspect = (float)views[i].width / (float)(views[i].height > 0 ? views[i].height : 1);
+                glm::mat4 projection = glm::perspective(glm::radians(45.0f), aspect, 0.1f, 100.0f);
+                views[i].viewProjection = projection * view;
+            }
+            drawMultiView(multiView, pyramid, views, maxViews, framebufferWidth, framebufferHeight);
+        }
+        else
+        {
+            // Calculate the view matrix using the camera position, target direction, and up vector
+            glm::vec3 target = cameraPositions[currentCameraPosition] + cameraFront;
+            glm::mat4 view = glm::lookAt(cameraPositions[currentCameraPosition], target, cameraUp);
+
+            // Calculate the projection matrix for a perspective view
+            glm::mat4 projection = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 100.0f);
+
+            // The field surrounds the scene beyond its pyramids, so it is drawn first and they stay in front
+            drawPyramidField(pyramidField, view, projection, cameraPositions[currentCameraPosition], framebufferHeight);
+
+            // Draw the pyramids; with a virtual texture, every few frames first into its feedback target
+            if (virtualTexture)
+            {
+                if (virtualTexture->beginFeedback(frameIndex, framebufferWidth, framebufferHeight))
+                {
+                    virtualTexture->bindUniforms(feedbackProgram.name(), true);
+                    drawPyramids(feedbackProgram.name(), pyramid, view, projection, &virtualTexture->materials(), pulledMesh);
+                    virtualTexture->endFeedback(frameIndex, framebufferWidth, framebufferHeight);
+                }
+                virtualTexture->bindUniforms(virtualProgram.name(), false);
+                drawPyramids(virtualProgram.name(), pyramid, view, projection, &virtualTexture->materials(), pulledMesh);
+            }
+            else
+                drawPyramids(materials.layerCount > 0 ? texturedProgram.name() : shaderProgram.name(), pyramid, view, projection, &materials,
+                             pulledMesh);
+        }
 
-        // Draw the pyramids
-        for (int i = 0; i < 3; ++i) // Iterate through each pyramid
+        // Queue a screenshot of the finished frame; a worker writes it to disk once the GPU copy is done
+        if (screenshotRequested &&
+            readback->request(0, 0, framebufferWidth, framebufferHeight, frameIndex, [](const ReadbackImage &image)
+                              {
+                                  char path[64];
+                                  std::snprintf(path, sizeof(path), "screenshot_%05lld.tga", image.frameIndex);
+                                  if (image.pixels != nullptr && writeTga(path, image.pixels, image.width, image.height))
+                                      logInfo("Saved {}", path);
+                              }))
+            screenshotRequested = false;
+
+        // Start or stop recording with V; while recording, every frame is queued for the encoder
+        if (recordingToggled)
+        {
+            if (recorder->isRecording())
+                recorder->stop();
+            else
+            {
+                char path[64];
+                std::snprintf(path, sizeof(path), "capture_%05lld.y4m", frameIndex);
+                recorder->start(path, false, framebufferWidth, framebufferHeight, options.recordFps);
+            }
+            recordingToggled = false;
+        }
+        recorder->captureFrame(framebufferWidth, framebufferHeight, frameIndex);
+
+        readback->poll(); // Hand finished readbacks to the workers and recycle consumed buffers
+
+        // Show the statistics of the previous frame; drawn after the captures were queued, so screenshots and videos stay clean
+        if (hudVisible)
+            drawFrameStatsOverlay(hud, lastFrameStats(), frameTimer->rollingSummary(), framebufferWidth, framebufferHeight);
+        frameTimer->endFrame(); // Everything of the frame is submitted
+
+        glTraceEndFrame();                              // Closes the frame of a running trace
+        glInstrumentEndFrame();                         // Closes the per-frame call counters
+        allocationAuditEndFrame(frameIndex);            // Closes the per-frame heap counters and checks the frame
+        statsExporter.write(endFrameStats(frameIndex)); // Closes the frame statistics and streams them
+        enforceGpuMemoryBudgets();                      // Lets subsystems over budget release memory between frames
+        glObjectsEndFrame();                            // Fences this frame's releases, deletes the objects the GPU is done with
+        ++frameIndex;
+        if (options.allocAuditFrames > 0 && frameIndex >= allocationAuditWarmup + options.allocAuditFrames)
+            glfwSetWindowShouldClose(window, true); // The audit is complete
+        if (glCallReportRequested)
         {
-            // Calculate the model matrix for each pyramid and pass it to shader before drawing
-            glm::mat4 model = glm::mat4(1.0f);                                     // Start with the identity matrix
-            model = glm::translate(model, glm::vec3(i * 2.0f - 2.0f, 0.0f, 0.0f)); // Move pyramids along x-axis
-            unsigned int modelLoc = glGetUniformLocation(shaderProgram, "model");
-            glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
-
-            glBindVertexArray(VAO);                               // Bind the VAO (it was already bound, but doing so in case it changed)
-            glDrawElements(GL_TRIANGLES, 18, GL_UNSIGNED_INT, 0); // Draw the pyramid
+            printGlCallReport(std::cout);
+            glCallReportRequested = false;
+        }
+        if (memoryReportRequested)
+        {
+            printGpuMemoryReport(std::cout);
+            memoryReportRequested = false;
         }
 
-        glfwSwapBuffers(window); // Swap the front and back buffers
-        glfwPollEvents();        // Poll for and process events
+        glfwSwapBuffers(window);      // Swap the front and back buffers
+        frameTimer->framePresented(); // Present-to-present interval
+        glfwPollEvents();             // Poll for and process events
     }
 
     // Clean up
-    glDeleteVertexArrays(1, &VAO);
-    glDeleteBuffers(1, &VBO);
-    glDeleteBuffers(1, &EBO);
-    glDeleteProgram(shaderProgram);
+    stopGlTrace();                       // Ends a trace shorter than the session
+    printGlCallReport(std::cout);
+    printGpuMemoryReport(std::cout);     // Includes the high-water marks of the session
+    frameTimer->printSummary(std::cout); // Percentiles, stutters and histogram of the frame times
+    frameTimer.reset();                  // Deletes the timer queries while the context still exists
+    printAllocationAuditReport(std::cout);
+    printArenaReport(std::cout);         // Scratch memory high-water marks, to size the arenas
+    printPoolReport(std::cout);
+    printGlDebugReport(std::cout);       // Driver messages of the session, with the repeats of each performance warning
+    printGlObjectReport(std::cout);      // Live objects and deferred deletions
+    if (streamer)
+        streamer->printSummary(std::cout);
+    if (virtualTexture)
+        virtualTexture->printSummary(std::cout);
+    virtualTexture.reset();              // Completes its page copies and feedback readbacks while the workers and the context exist
+    streamer.reset();                    // Stops the loads and the upload thread while the context still exists
+    recorder.reset();                    // Flushes a running recording
+    readback.reset();                    // Waits for outstanding captures while the context still exists
+    destroyHudRenderer(hud);
+    destroyMultiViewRenderer(multiView);
+    destroyPyramidFieldRenderer(pyramidField);
+    pulled = PulledMesh(); // Views the pyramid's buffers
+    destroyPullingVertexArray();
+    destroyPyramidMesh(pyramid);
+    materials = PyramidMaterials();
+    shaderProgram.reset();
+    texturedProgram.reset();
+    virtualProgram.reset();
+    feedbackProgram.reset();
+    destroyDeferredGlObjects(); // Deletes the released objects while the context still exists
 
     glfwTerminate(); // Clean all the GLFW resources.
-    return 0;
+    return allocationAuditViolations() > 0 ? 1 : 0; // A failed allocation audit fails the run
 }
 
 // Callback function to adjust the viewport when the window size is changed.
@@ -169,6 +424,10 @@ void framebuffer_size_callback(GLFWwindow *window, int width, int height)
     // Sets the size of the rendering viewport. This should match the new window size.
     // Parameters are the lower left corner (x, y) followed by width and height.
     glViewport(0, 0, width, height);
+
+    // Remember the size for the render paths that split the window into several viewports.
+    framebufferWidth = width;
+    framebufferHeight = height;
 }
 
 // Function to process user input. It checks for specific key presses and reacts accordingly.
@@ -185,6 +444,7 @@ void processInput(GLFWwindow *window)
     if (glfwGetKey(window, GLFW_KEY_1) == GLFW_PRESS)
     {
         currentCameraPosition = 0;                                                          // Sets the index for the front view position from the cameraPositions array.
+        multiViewEnabled = false;                                                           // Returns to the single view.
         cameraFront = glm::normalize(sceneCenter - cameraPositions[currentCameraPosition]); // Recalculates the camera's front vector.
     }
 
@@ -192,6 +452,7 @@ void processInput(GLFWwindow *window)
     if (glfwGetKey(window, GLFW_KEY_2) == GLFW_PRESS)
     {
         currentCameraPosition = 1;                                                          // Sets the index for the top view position.
+        multiViewEnabled = false;                                                           // Returns to the single view.
         cameraFront = glm::normalize(sceneCenter - cameraPositions[currentCameraPosition]); // Recalculates the camera's front vector.
         cameraUp = glm::vec3(0.0f, 0.0f, -1.0f);                                            // Adjusts the camera's up vector for the top view to maintain the correct orientation.
     }
@@ -200,90 +461,47 @@ void processInput(GLFWwindow *window)
     if (glfwGetKey(window, GLFW_KEY_3) == GLFW_PRESS)
     {
         currentCameraPosition = 2;                                                          // Sets the index for the side view position.
+        multiViewEnabled = false;                                                           // Returns to the single view.
         cameraFront = glm::normalize(sceneCenter - cameraPositions[currentCameraPosition]); // Recalculates the camera's front vector.
     }
-}
-
-// Function to read shader source code from a file.
-// filePath: Path to the shader file.
-std::string readFile(const char *filePath)
-{
-    // Create an input file stream for reading the file.
-    std::ifstream fileStream(filePath, std::ios::in);
-    std::string content; // String to hold the contents of the file.
-
-    // Check if the file stream was successfully opened.
-    if (!fileStream.is_open())
-    {
-        // If the file cannot be opened (e.g., does not exist), print an error message.
-        std::cerr << "Could not read file " << filePath << ". File does not exist." << std::endl;
-        return ""; // Return an empty string as an error indication.
-    }
 
-    // Use a string stream to read the entire contents of the file into the 'content' string.
-    std::stringstream sstr;
-    sstr << fileStream.rdbuf();
-    content = sstr.str();
-    fileStream.close(); // Close the file stream.
-
-    return content; // Return the contents of the file as a string.
+    // Checks if the '4' key is pressed to show the front, top and side views and the current camera at the same time.
+    if (glfwGetKey(window, GLFW_KEY_4) == GLFW_PRESS)
+        multiViewEnabled = true;
+
+    // Checks if F12 was just pressed to capture the next frame to a file.
+    bool screenshotKeyPressed = glfwGetKey(window, GLFW_KEY_F12) == GLFW_PRESS;
+    if (screenshotKeyPressed && !screenshotKeyDown)
+        screenshotRequested = true;
+    screenshotKeyDown = screenshotKeyPressed;
+
+    // Checks if V was just pressed to start or stop recording.
+    bool recordKeyPressed = glfwGetKey(window, GLFW_KEY_V) == GLFW_PRESS;
+    if (recordKeyPressed && !recordKeyDown)
+        recordingToggled = true;
+    recordKeyDown = recordKeyPressed;
+
+    // Checks if G was just pressed to print the OpenGL call statistics.
+    bool glCallReportKeyPressed = glfwGetKey(window, GLFW_KEY_G) == GLFW_PRESS;
+    if (glCallReportKeyPressed && !glCallReportKeyDown)
+        glCallReportRequested = true;
+    glCallReportKeyDown = glCallReportKeyPressed;
+
+    // Checks if M was just pressed to print the GPU memory usage.
+    bool memoryReportKeyPressed = glfwGetKey(window, GLFW_KEY_M) == GLFW_PRESS;
+    if (memoryReportKeyPressed && !memoryReportKeyDown)
+        memoryReportRequested = true;
+    memoryReportKeyDown = memoryReportKeyPressed;
+
+    // Checks if H was just pressed to show or hide the statistics overlay.
+    bool hudKeyPressed = glfwGetKey(window, GLFW_KEY_H) == GLFW_PRESS;
+    if (hudKeyPressed && !hudKeyDown)
+        hudVisible = !hudVisible;
+    hudKeyDown = hudKeyPressed;
+
+    // Checks if L was just pressed to load the streamed mesh again.
+    bool meshReloadKeyPressed = glfwGetKey(window, GLFW_KEY_L) == GLFW_PRESS;
+    if (meshReloadKeyPressed && !meshReloadKeyDown)
+        meshReloadRequested = true;
+    meshReloadKeyDown = meshReloadKeyPressed;
 }
-
-// Function to compile a shader from source code.
-// type: The type of shader (GL_VERTEX_SHADER or GL_FRAGMENT_SHADER).
-// source: The shader source code as a string.
-unsigned int compileShader(unsigned int type, const std::string &source)
-{
-    // Create a shader object.
-    unsigned int id = glCreateShader(type);
-    const char *src = source.c_str();     // Convert the source string to a C-style string.
-    glShaderSource(id, 1, &src, nullptr); // Attach the shader source code to the shader object.
-    glCompileShader(id);                  // Compile the shader.
-
-    // Check for compilation errors.
-    int result;
-    glGetShaderiv(id, GL_COMPILE_STATUS, &result);
-    if (!result)
-    {
-        // If an error occurred during compilation, query the error message length.
-        int length;
-        glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length);
-        // Allocate memory on the stack for the error message.
-        char *message = (char *)alloca(length * sizeof(char));
-        // Retrieve the error message.
-        glGetShaderInfoLog(id, length, &length, message);
-        // Print the error message.
-        std::cerr << "Failed to compile " << (type == GL_VERTEX_SHADER ? "vertex" : "fragment") << " shader!\n"
-                  << message << std::endl;
-        glDeleteShader(id); // Delete the shader object to free resources.
-        return 0;           // Return 0 as an error indication.
-    }
-
-    return id; // Return the shader object ID.
-}
-
-// Function to create a shader program by linking a vertex and a fragment shader.
-// vertexShader: The vertex shader source code as a string.
-// fragmentShader: The fragment shader source code as a string.
-unsigned int createShaderProgram(const std::string &vertexShader, const std::string &fragmentShader)
-{
-    // Create a shader program object.
-    unsigned int program = glCreateProgram();
-    // Compile the vertex and fragment shaders from their source code.
-    unsigned int vs = compileShader(GL_VERTEX_SHADER, vertexShader);
-    unsigned int fs = compileShader(GL_FRAGMENT_SHADER, fragmentShader);
-
-    // Attach the compiled shaders to the shader program.
-    glAttachShader(program, vs);
-    glAttachShader(program, fs);
-    // Link the shader program to create an executable for the GPU.
-    glLinkProgram(program);
-    // Perform validation on the shader program.
-    glValidateProgram(program);
-
-    // Delete the shader objects now that they are linked into the program; they are no longer needed.
-    glDeleteShader(vs);
-    glDeleteShader(fs);
-
-    return program; // Return the shader program object ID.
-}
\ No newline at end of file
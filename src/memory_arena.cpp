@@ -0,0 +1,103 @@
+#include "memory_arena.h"
+#include <algorithm> // std::find.
+#include <cstdint>   // uintptr_t for the alignment.
+#include <iomanip>   // Formatting of the report.
+#include <mutex>     // Protects the list of live arenas.
+
+static const size_t frameArenaCapacity = 1 << 20;   // 1 MiB: far above what one frame needs today.
+static const size_t threadArenaCapacity = 256 << 10; // 256 KiB: row buffers of the image writers.
+
+// Every live arena, for the report. Thread arenas come and go with their threads.
+static std::mutex registryMutex;
+static std::vector<const LinearArena *> &arenaRegistry()
+{
+    static std::vector<const LinearArena *> arenas;
+    return arenas;
+}
+
+static uintptr_t alignUp(uintptr_t address, size_t alignment)
+{
+    return (address + alignment - 1) & ~(uintptr_t)(alignment - 1);
+}
+
+// Constructor: reserves the block and registers the arena for the report.
+LinearArena::LinearArena(const char *name, size_t capacity) : arenaName(name), block(new unsigned char[capacity]), size(capacity)
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    arenaRegistry().push_back(this);
+}
+
+LinearArena::~LinearArena()
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::vector<const LinearArena *> &arenas = arenaRegistry();
+    arenas.erase(std::find(arenas.begin(), arenas.end(), this));
+}
+
+void LinearArena::updatePeak()
+{
+    size_t inUse = offset + overflowBytes;
+    if (inUse > peak.load(std::memory_order_relaxed))
+        peak.store(inUse, std::memory_order_relaxed); // Only the owner thread writes.
+}
+
+// Function to take bytes from the arena.
+// alignment: Power of two the returned address is a multiple of.
+void *LinearArena::allocate(size_t bytes, size_t alignment)
+{
+    uintptr_t base = (uintptr_t)block.get();
+    size_t aligned = (size_t)(alignUp(base + offset, alignment) - base);
+    if (aligned + bytes <= size)
+    {
+        offset = aligned + bytes;
+        updatePeak();
+        return block.get() + aligned;
+    }
+
+    // Out of space: a heap block of its own, over-allocated so it can be aligned.
+    overflowCount.store(overflowCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    overflowBytes += bytes;
+    updatePeak();
+    overflowBlocks.emplace_back(new unsigned char[bytes + alignment]);
+    return (void *)alignUp((uintptr_t)overflowBlocks.back().get(), alignment);
+}
+
+void LinearArena::reset()
+{
+    offset = 0;
+    overflowBytes = 0;
+    overflowBlocks.clear();
+    resetCount.store(resetCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+// Function to release everything allocated after position was taken.
+void LinearArena::rewind(const Mark &position)
+{
+    offset = position.offset;
+    overflowBytes = position.overflowBytes;
+    overflowBlocks.resize(position.overflowBlocks); // Frees the newer overflow blocks; never grows.
+}
+
+LinearArena &frameArena()
+{
+    static LinearArena arena("frame", frameArenaCapacity);
+    return arena;
+}
+
+LinearArena &threadArena()
+{
+    thread_local LinearArena arena("thread", threadArenaCapacity);
+    return arena;
+}
+
+// Function to print the statistics of the live arenas.
+void printArenaReport(std::ostream &out)
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    out << std::fixed << std::setprecision(1) << "Arenas:\n";
+    for (const LinearArena *arena : arenaRegistry())
+        out << "  " << std::left << std::setw(8) << arena->name() << std::right << std::setw(8) << arena->capacity() / 1024
+            << " KiB, high-water " << std::setw(8) << arena->highWater() / 1024.0 << " KiB, " << arena->overflows()
+            << " overflows, " << arena->resets() << " resets\n";
+    out << std::defaultfloat << std::flush;
+}
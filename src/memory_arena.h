@@ -0,0 +1,86 @@
+#ifndef MEMORY_ARENA_H
+#define MEMORY_ARENA_H
+
+// Linear (bump) allocators for transient data.
+// Allocating moves a pointer through one block reserved up front, and reset() releases everything at once,
+// so scratch memory costs a pointer bump instead of heap traffic. Two kinds are used:
+// - the frame arena of the render thread, reset at the start of every frame;
+// - one arena per thread for the jobs of the worker threads, reset by the worker pool after every job.
+// Code that may run on any thread brackets its use with an ArenaScope, which gives the memory back on exit.
+// When a block is full, further allocations fall back to separate heap blocks that are freed on reset; the
+// arena counts them, and in audit builds the allocation audit reports the frames, so the capacity can be raised.
+#include <atomic>  // Statistics read by the report while the owner thread allocates.
+#include <cstddef> // size_t, max_align_t.
+#include <memory>  // Owns the blocks.
+#include <ostream> // Report output.
+#include <vector>  // Overflow blocks.
+
+// Not thread-safe: an arena belongs to one thread. Only the statistics may be read from other threads.
+class LinearArena
+{
+public:
+    LinearArena(const char *name, size_t capacity); // Reserves the block; name appears in the report.
+    ~LinearArena();
+
+    LinearArena(const LinearArena &) = delete;
+    LinearArena &operator=(const LinearArena &) = delete;
+
+    void *allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)); // Never returns null.
+    void reset();                                                              // Releases every allocation.
+
+    // Uninitialized storage for count objects; only for types that need no destructor.
+    template <typename T>
+    T *allocateArray(size_t count) { return static_cast<T *>(allocate(sizeof(T) * count, alignof(T))); }
+
+    // Position to return to with rewind(): releases everything allocated after mark() and nothing before.
+    struct Mark
+    {
+        size_t offset;
+        size_t overflowBlocks;
+        size_t overflowBytes;
+    };
+    Mark mark() const { return {offset, overflowBlocks.size(), overflowBytes}; }
+    void rewind(const Mark &position);
+
+    const char *name() const { return arenaName; }
+    size_t capacity() const { return size; }
+    size_t used() const { return offset; }
+    size_t highWater() const { return peak.load(std::memory_order_relaxed); } // Most bytes in use at once, including overflow.
+    long long overflows() const { return overflowCount.load(std::memory_order_relaxed); } // Allocations that did not fit.
+    long long resets() const { return resetCount.load(std::memory_order_relaxed); }
+
+private:
+    void updatePeak();
+
+    const char *arenaName;
+    std::unique_ptr<unsigned char[]> block;
+    size_t size = 0;
+    size_t offset = 0;
+    size_t overflowBytes = 0; // Bytes in overflow blocks since the last reset.
+    std::vector<std::unique_ptr<unsigned char[]>> overflowBlocks;
+    std::atomic<size_t> peak{0};
+    std::atomic<long long> overflowCount{0};
+    std::atomic<long long> resetCount{0};
+};
+
+// Returns the arena to its state at construction when it goes out of scope.
+class ArenaScope
+{
+public:
+    explicit ArenaScope(LinearArena &arena) : arena(arena), position(arena.mark()) {}
+    ~ArenaScope() { arena.rewind(position); }
+
+    ArenaScope(const ArenaScope &) = delete;
+    ArenaScope &operator=(const ArenaScope &) = delete;
+
+private:
+    LinearArena &arena;
+    LinearArena::Mark position;
+};
+
+LinearArena &frameArena();  // Scratch memory of the render thread, reset at the start of every frame.
+LinearArena &threadArena(); // Scratch memory of the calling thread; created on first use, reset after every worker job.
+
+void printArenaReport(std::ostream &out); // Capacity, high-water mark and overflows of every live arena.
+
+#endif
@@ -0,0 +1,75 @@
+#include "memory_pool.h"
+#include <algorithm> // std::find, std::max.
+#include <mutex>     // Protects the list of live pools.
+
+// Every live pool, for the report.
+static std::mutex registryMutex;
+static std::vector<const FixedPool *> &poolRegistry()
+{
+    static std::vector<const FixedPool *> pools;
+    return pools;
+}
+
+// Constructor: no memory is taken until the first allocation.
+// blockAlignment: Power of two, at most alignof(std::max_align_t).
+FixedPool::FixedPool(const char *name, size_t blockSize, size_t blockAlignment, size_t blocksPerChunk)
+    : poolName(name), chunkBlocks(blocksPerChunk < 1 ? 1 : blocksPerChunk)
+{
+    size_t alignment = std::max(blockAlignment, alignof(FreeBlock));
+    stride = (std::max(blockSize, sizeof(FreeBlock)) + alignment - 1) / alignment * alignment;
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    poolRegistry().push_back(this);
+}
+
+FixedPool::~FixedPool()
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    std::vector<const FixedPool *> &pools = poolRegistry();
+    pools.erase(std::find(pools.begin(), pools.end(), this));
+}
+
+// Function to add a chunk and thread its blocks onto the free list.
+void FixedPool::grow()
+{
+    chunks.emplace_back(new unsigned char[stride * chunkBlocks]);
+    unsigned char *chunk = chunks.back().get();
+    for (size_t i = chunkBlocks; i-- > 0;) // Backwards, so blocks are handed out in address order.
+    {
+        FreeBlock *block = reinterpret_cast<FreeBlock *>(chunk + i * stride);
+        block->next = freeList;
+        freeList = block;
+    }
+}
+
+void *FixedPool::allocate()
+{
+    if (freeList == nullptr)
+        grow();
+    FreeBlock *block = freeList;
+    freeList = block->next;
+    if (++liveBlocks > peakBlocks)
+        peakBlocks = liveBlocks;
+    return block;
+}
+
+void FixedPool::release(void *block)
+{
+    if (block == nullptr)
+        return;
+    FreeBlock *freed = static_cast<FreeBlock *>(block);
+    freed->next = freeList;
+    freeList = freed;
+    --liveBlocks;
+}
+
+// Function to print the statistics of the live pools.
+void printPoolReport(std::ostream &out)
+{
+    std::lock_guard<std::mutex> lock(registryMutex);
+    out << "Pools:\n";
+    for (const FixedPool *pool : poolRegistry())
+        out << "  " << pool->name() << ": " << pool->live() << " of " << pool->capacity() << " blocks of "
+            << pool->blockSize() << " bytes in use, high-water " << pool->highWater() << "\n";
+    out << std::flush;
+}
@@ -0,0 +1,123 @@
+#ifndef MEMORY_POOL_H
+#define MEMORY_POOL_H
+
+// Fixed-size block pools for long-lived objects that are created and destroyed one at a time.
+// A pool carves blocks of one size out of chunks allocated in batches and keeps the free blocks in an
+// intrusive list, so creating and destroying an object is a pointer swap, and the objects of one kind sit
+// next to each other in memory. Chunks are only returned when the pool is destroyed.
+// Pools are not thread-safe; each one belongs to the thread that uses it (the render thread, so far).
+#include <cstddef> // size_t, max_align_t.
+#include <memory>  // Owns the chunks.
+#include <new>     // Placement new.
+#include <ostream> // Report output.
+#include <utility> // std::forward.
+#include <vector>  // Chunk list.
+
+class FixedPool
+{
+public:
+    FixedPool(const char *name, size_t blockSize, size_t blockAlignment = alignof(std::max_align_t),
+              size_t blocksPerChunk = 64); // name appears in the report.
+    ~FixedPool();
+
+    FixedPool(const FixedPool &) = delete;
+    FixedPool &operator=(const FixedPool &) = delete;
+
+    void *allocate();          // One block; grows the pool by a chunk when no block is free.
+    void release(void *block); // Returns a block from allocate().
+
+    const char *name() const { return poolName; }
+    size_t blockSize() const { return stride; }
+    long long live() const { return liveBlocks; }
+    long long highWater() const { return peakBlocks; }
+    long long capacity() const { return (long long)chunks.size() * chunkBlocks; }
+
+private:
+    struct FreeBlock
+    {
+        FreeBlock *next;
+    };
+
+    void grow();
+
+    const char *poolName;
+    size_t stride;      // Block size rounded up to the alignment; at least a pointer.
+    size_t chunkBlocks;
+    std::vector<std::unique_ptr<unsigned char[]>> chunks;
+    FreeBlock *freeList = nullptr;
+    long long liveBlocks = 0;
+    long long peakBlocks = 0;
+};
+
+// Typed front end of a FixedPool: constructs and destroys objects in the pool's blocks.
+template <typename T>
+class ObjectPool
+{
+public:
+    explicit ObjectPool(const char *name, size_t objectsPerChunk = 64) : pool(name, sizeof(T), alignof(T), objectsPerChunk) {}
+
+    template <typename... Args>
+    T *create(Args &&...args) { return new (pool.allocate()) T(std::forward<Args>(args)...); }
+
+    void destroy(T *object)
+    {
+        if (object == nullptr)
+            return;
+        object->~T();
+        pool.release(object);
+    }
+
+    const FixedPool &blocks() const { return pool; }
+
+private:
+    FixedPool pool;
+};
+
+// Standard allocator that takes single objects (the nodes of node-based containers) from a pool shared by
+// every allocator of the same Tag and type; arrays, such as the bucket array of an unordered_map, come from
+// the heap. Tag names the pool in the report: struct MyTag { static constexpr const char *name = "..."; };
+template <typename T, typename Tag>
+struct PoolAllocator
+{
+    using value_type = T;
+    template <typename U>
+    struct rebind
+    {
+        using other = PoolAllocator<U, Tag>;
+    };
+
+    PoolAllocator() = default;
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U, Tag> &) {}
+
+    T *allocate(size_t count)
+    {
+        if (count == 1)
+            return static_cast<T *>(pool().allocate());
+        return static_cast<T *>(::operator new(count * sizeof(T)));
+    }
+
+    void deallocate(T *pointer, size_t count)
+    {
+        if (count == 1)
+            pool().release(pointer);
+        else
+            ::operator delete(pointer);
+    }
+
+    // Never destroyed, so containers with static storage can still free their nodes during exit.
+    static FixedPool &pool()
+    {
+        static FixedPool *blocks = new FixedPool(Tag::name, sizeof(T), alignof(T));
+        return *blocks;
+    }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U, Tag> &) const { return true; }
+    template <typename U>
+    bool operator!=(const PoolAllocator<U, Tag> &) const { return false; }
+};
+
+void printPoolReport(std::ostream &out); // Block size, live objects, high-water mark and capacity of every pool.
+
+#endif
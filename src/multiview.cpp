@@ -0,0 +1,170 @@
+#include "multiview.h"
+#include "glad.h"                // GLAD provides the OpenGL function pointers and the extension flags.
+#include "shader.h"              // Shader loading and compilation helpers.
+#include "gpu_memory.h"          // Tracked buffer allocation.
+#include "gl_debug.h"            // Object labels and debug groups for frame captures.
+#include "logger.h"              // Error messages.
+#include <glm/gtc/type_ptr.hpp>  // Provides glm::value_ptr to upload matrices.
+#include <string>                // Used to assemble the shader defines.
+
+// Binding point of the MultiViewBlock uniform block.
+static const unsigned int multiViewBlockBinding = 0;
+
+// Layout of the MultiViewBlock uniform block (std140). mat4 members need no padding.
+struct MultiViewBlock
+{
+    glm::mat4 viewProjection[maxViews]; // Updated every frame.
+    glm::mat4 model[pyramidCount];      // Uploaded once, the pyramids do not move.
+};
+
+// Function to build the multi-view program for the given path.
+// Returns 0 if the program does not compile or link on this driver.
+static unsigned int buildMultiViewProgram(MultiViewPath path)
+{
+    std::string defines = "#define MAX_VIEWS " + std::to_string(maxViews) + "\n" +
+                          "#define MAX_OBJECTS " + std::to_string(pyramidCount) + "\n";
+
+    std::string vertexSource = readFile("multiview_vertex_shader.glsl");
+    std::string fragmentSource = readFile("fragment_shader.glsl");
+
+    if (path == MultiViewPath::VertexViewportIndex)
+    {
+        // Either extension exposes gl_ViewportIndex as a vertex shader output.
+        std::string extension = GLAD_GL_ARB_shader_viewport_layer_array
+                                    ? "#extension GL_ARB_shader_viewport_layer_array : require\n"
+                                    : "#extension GL_AMD_vertex_shader_viewport_index : require\n";
+        return createShaderProgram(addShaderDefines(vertexSource, extension + defines + "#define VIEWPORT_FROM_VERTEX\n"),
+                                   fragmentSource);
+    }
+    if (path == MultiViewPath::GeometryViewportIndex)
+    {
+        std::string geometrySource = readFile("multiview_geometry_shader.glsl");
+        return createShaderProgram(addShaderDefines(vertexSource, defines + "#define VIEWPORT_FROM_GEOMETRY\n"),
+                                   addShaderDefines(geometrySource, "#extension GL_ARB_viewport_array : require\n"),
+                                   fragmentSource);
+    }
+    return createShaderProgram(addShaderDefines(vertexSource, defines), fragmentSource);
+}
+
+// Function to create the multi-view renderer.
+// Tries the paths from the cheapest to the most compatible and keeps the first one that builds.
+bool createMultiViewRenderer(MultiViewRenderer &renderer)
+{
+    MultiViewPath candidates[3];
+    int candidateCount = 0;
+    if (GLAD_GL_ARB_viewport_array && (GLAD_GL_ARB_shader_viewport_layer_array || GLAD_GL_AMD_vertex_shader_viewport_index))
+        candidates[candidateCount++] = MultiViewPath::VertexViewportIndex;
+    if (GLAD_GL_ARB_viewport_array)
+        candidates[candidateCount++] = MultiViewPath::GeometryViewportIndex;
+    candidates[candidateCount++] = MultiViewPath::PerViewportLoop;
+
+    for (int i = 0; i < candidateCount && renderer.program == 0; ++i)
+    {
+        renderer.program = buildMultiViewProgram(candidates[i]);
+        renderer.path = candidates[i];
+    }
+    if (renderer.program == 0)
+    {
+        logError("Failed to create the multi-view shader program");
+        return false;
+    }
+
+    // Connect the uniform block to its binding point and look up the plain uniforms.
+    unsigned int blockIndex = glGetUniformBlockIndex(renderer.program, "MultiViewBlock");
+    glUniformBlockBinding(renderer.program, blockIndex, multiViewBlockBinding);
+    renderer.viewCountLocation = glGetUniformLocation(renderer.program, "viewCount");
+    renderer.baseViewLocation = glGetUniformLocation(renderer.program, "baseView");
+
+    // Create the uniform buffer. The model matrices never change, so they are uploaded only once here.
+    MultiViewBlock block;
+    for (int i = 0; i < pyramidCount; ++i)
+        block.model[i] = pyramidModelMatrix(i);
+    glGenBuffers(1, &renderer.uniformBuffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, renderer.uniformBuffer);
+    trackedBufferData(GL_UNIFORM_BUFFER, renderer.uniformBuffer, sizeof(block), &block, GL_DYNAMIC_DRAW,
+                      GpuMemoryCategory::Uniforms, "multi-view renderer");
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    labelGlObject(GL_PROGRAM, renderer.program, "multi-view program");
+    labelGlObject(GL_BUFFER, renderer.uniformBuffer, "multi-view uniforms");
+    return true;
+}
+
+// Function to delete the GPU objects of the multi-view renderer.
+void destroyMultiViewRenderer(MultiViewRenderer &renderer)
+{
+    trackedDeleteBuffers(1, &renderer.uniformBuffer);
+    glDeleteProgram(renderer.program);
+    renderer = MultiViewRenderer();
+}
+
+// Function to arrange the views in a grid.
+// One view fills the framebuffer, two to four views are placed in a 2x2 grid starting at the top left.
+void layoutViewGrid(View *views, int viewCount, int framebufferWidth, int framebufferHeight)
+{
+    int columns = viewCount > 1 ? 2 : 1;
+    int rows = (viewCount + columns - 1) / columns;
+    int cellWidth = framebufferWidth / columns;
+    int cellHeight = framebufferHeight / rows;
+
+    for (int i = 0; i < viewCount; ++i)
+    {
+        views[i].x = (i % columns) * cellWidth;
+        views[i].y = (rows - 1 - i / columns) * cellHeight; // OpenGL viewports start at the bottom left.
+        views[i].width = cellWidth;
+        views[i].height = cellHeight;
+    }
+}
+
+// Function to draw every pyramid into every view.
+// With viewport arrays this is one uniform buffer update and one instanced draw call regardless of the number of views;
+// instance i draws pyramid i / viewCount into view i % viewCount.
+void drawMultiView(const MultiViewRenderer &renderer, const PyramidMesh &mesh, const View *views, int viewCount,
+                   int framebufferWidth, int framebufferHeight)
+{
+    GlDebugGroup group("multi-view");
+    if (viewCount > maxViews)
+        viewCount = maxViews;
+
+    // Upload the view matrices; they are the first member of the block so one sub-update covers them.
+    glm::mat4 viewProjection[maxViews];
+    for (int i = 0; i < viewCount; ++i)
+        viewProjection[i] = views[i].viewProjection;
+    glBindBuffer(GL_UNIFORM_BUFFER, renderer.uniformBuffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, viewCount * sizeof(glm::mat4), viewProjection);
+    glBindBufferBase(GL_UNIFORM_BUFFER, multiViewBlockBinding, renderer.uniformBuffer);
+
+    glUseProgram(renderer.program);
+    glBindVertexArray(mesh.VAO.name());
+
+    if (renderer.path != MultiViewPath::PerViewportLoop)
+    {
+        // Set all viewports at once and draw every pyramid into every view with a single call.
+        float viewports[maxViews * 4];
+        for (int i = 0; i < viewCount; ++i)
+        {
+            viewports[i * 4 + 0] = (float)views[i].x;
+            viewports[i * 4 + 1] = (float)views[i].y;
+            viewports[i * 4 + 2] = (float)views[i].width;
+            viewports[i * 4 + 3] = (float)views[i].height;
+        }
+        glViewportArrayv(0, viewCount, viewports);
+        glUniform1i(renderer.viewCountLocation, viewCount);
+        glUniform1i(renderer.baseViewLocation, 0);
+        glDrawElementsInstanced(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT, 0, pyramidCount * viewCount);
+    }
+    else
+    {
+        // Fallback: one instanced draw per view, still covering all pyramids per call.
+        glUniform1i(renderer.viewCountLocation, 1);
+        for (int i = 0; i < viewCount; ++i)
+        {
+            glViewport(views[i].x, views[i].y, views[i].width, views[i].height);
+            glUniform1i(renderer.baseViewLocation, i);
+            glDrawElementsInstanced(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT, 0, pyramidCount);
+        }
+    }
+
+    // Restore the full-window viewport (glViewport resets every viewport of the array) for the other render paths.
+    glViewport(0, 0, framebufferWidth, framebufferHeight);
+}
@@ -0,0 +1,45 @@
+#ifndef MULTIVIEW_H
+#define MULTIVIEW_H
+
+// Draws the pyramid scene into several viewports with a single instanced draw call.
+// Every instance is amplified to all views on the GPU: the vertex shader picks the view matrix
+// from a uniform buffer and routes the primitive to its viewport through gl_ViewportIndex.
+#include <glm/glm.hpp> // GLM provides the matrix types for the per-view transforms.
+#include "scene.h"     // The pyramid mesh and model matrices.
+
+// Maximum number of viewports the multi-view renderer draws into.
+const int maxViews = 4;
+
+// How primitives are routed to their viewport, from fastest to most compatible.
+enum class MultiViewPath
+{
+    VertexViewportIndex,   // The vertex shader writes gl_ViewportIndex (ARB_shader_viewport_layer_array / AMD_vertex_shader_viewport_index).
+    GeometryViewportIndex, // A pass-through geometry shader writes gl_ViewportIndex (ARB_viewport_array).
+    PerViewportLoop        // No viewport arrays: one instanced draw per viewport.
+};
+
+// One view of the scene: its camera transform and the window rectangle it is drawn into.
+struct View
+{
+    glm::mat4 viewProjection = glm::mat4(1.0f); // Projection * view matrix of the camera.
+    int x = 0, y = 0;                           // Lower left corner of the viewport in pixels.
+    int width = 0, height = 0;                  // Size of the viewport in pixels.
+};
+
+// GPU state of the multi-view renderer.
+struct MultiViewRenderer
+{
+    unsigned int program = 0;       // Shader program that amplifies every instance to all views.
+    unsigned int uniformBuffer = 0; // Uniform buffer with the per-view and per-object matrices.
+    int viewCountLocation = -1;     // Location of the 'viewCount' uniform.
+    int baseViewLocation = -1;      // Location of the 'baseView' uniform.
+    MultiViewPath path = MultiViewPath::PerViewportLoop;
+};
+
+bool createMultiViewRenderer(MultiViewRenderer &renderer);                                // Picks the best supported path, builds the program and the uniform buffer.
+void destroyMultiViewRenderer(MultiViewRenderer &renderer);                               // Deletes the program and the uniform buffer.
+void layoutViewGrid(View *views, int viewCount, int framebufferWidth, int framebufferHeight); // Arranges the views in a grid covering the framebuffer.
+void drawMultiView(const MultiViewRenderer &renderer, const PyramidMesh &mesh, const View *views, int viewCount,
+                   int framebufferWidth, int framebufferHeight);                          // Draws all pyramids into all views.
+
+#endif
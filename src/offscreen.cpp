@@ -0,0 +1,65 @@
+#include "offscreen.h"
+#include "glad.h"       // GLAD provides the OpenGL function pointers.
+#include "gl_debug.h"   // Object labels for frame captures.
+#include "gpu_memory.h" // Tracked renderbuffer allocation.
+#include "logger.h"     // Error messages.
+
+// Function to create an offscreen framebuffer.
+// width, height: Size in pixels; must not exceed GL_MAX_RENDERBUFFER_SIZE.
+bool createOffscreenTarget(OffscreenTarget &target, int width, int height)
+{
+    int maxSize = 0;
+    glGetIntegerv(GL_MAX_RENDERBUFFER_SIZE, &maxSize);
+    if (width > maxSize || height > maxSize)
+    {
+        logError("Offscreen size {}x{} exceeds the maximum renderbuffer size {}", width, height, maxSize);
+        return false;
+    }
+
+    target.width = width;
+    target.height = height;
+
+    glGenRenderbuffers(1, &target.colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, target.colorBuffer);
+    trackedRenderbufferStorage(target.colorBuffer, GL_RGBA8, width, height, GpuMemoryCategory::RenderTargets, "offscreen target");
+
+    glGenRenderbuffers(1, &target.depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, target.depthBuffer);
+    trackedRenderbufferStorage(target.depthBuffer, GL_DEPTH_COMPONENT24, width, height, GpuMemoryCategory::RenderTargets, "offscreen target");
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &target.framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, target.framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, target.colorBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, target.depthBuffer);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    labelGlObject(GL_FRAMEBUFFER, target.framebuffer, "offscreen target");
+    labelGlObject(GL_RENDERBUFFER, target.colorBuffer, "offscreen color");
+    labelGlObject(GL_RENDERBUFFER, target.depthBuffer, "offscreen depth");
+
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        logError("Offscreen framebuffer is incomplete (status {x})", status);
+        destroyOffscreenTarget(target);
+        return false;
+    }
+    return true;
+}
+
+// Function to delete an offscreen framebuffer.
+void destroyOffscreenTarget(OffscreenTarget &target)
+{
+    glDeleteFramebuffers(1, &target.framebuffer);
+    trackedDeleteRenderbuffers(1, &target.colorBuffer);
+    trackedDeleteRenderbuffers(1, &target.depthBuffer);
+    target = OffscreenTarget();
+}
+
+// Function to make the offscreen framebuffer the target of drawing and of glReadPixels.
+void bindOffscreenTarget(const OffscreenTarget &target)
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, target.framebuffer);
+    glReadBuffer(GL_COLOR_ATTACHMENT0);
+    glViewport(0, 0, target.width, target.height);
+}
@@ -0,0 +1,19 @@
+#ifndef OFFSCREEN_H
+#define OFFSCREEN_H
+
+// Framebuffer objects for rendering without a visible window.
+
+struct OffscreenTarget
+{
+    unsigned int framebuffer = 0;  // Framebuffer object.
+    unsigned int colorBuffer = 0;  // RGBA8 color renderbuffer.
+    unsigned int depthBuffer = 0;  // 24-bit depth renderbuffer.
+    int width = 0;
+    int height = 0;
+};
+
+bool createOffscreenTarget(OffscreenTarget &target, int width, int height); // Creates a complete framebuffer of the given size; false if the size is not supported.
+void destroyOffscreenTarget(OffscreenTarget &target);                       // Deletes the framebuffer and its renderbuffers.
+void bindOffscreenTarget(const OffscreenTarget &target);                    // Binds the target for drawing and reading and sets the viewport to cover it.
+
+#endif
@@ -0,0 +1,209 @@
+#include "options.h"
+#include <cstdio>   // std::sscanf, parses the image size.
+#include <cstdlib>  // std::atoi and std::atof, convert the numeric options.
+#include <cstring>  // std::strcmp, compares the option names.
+#include <iostream> // Included for the usage output.
+
+// Function to print the supported options.
+static void printUsage(const char *program)
+{
+    std::cerr << "Usage: " << program << " [options]\n"
+              << "  --record <file>           Record the session to a .y4m or raw .yuv file\n"
+              << "  --record-pipe <command>   Pipe the recording as Y4M into an encoder, e.g. \"ffmpeg -i - out.mp4\"\n"
+              << "  --record-fps <n>          Frame rate of the recording (default 60)\n"
+              << "  --batch <file>            Render every frame of a camera path file headless and exit\n"
+              << "  --output-dir <dir>        Directory for the images of the offline modes (default .)\n"
+              << "  --size <w>x<h>            Image size of the offline modes (default 800x600)\n"
+              << "  --threads <n>             Image writer threads (default: one per spare core)\n"
+              << "  --farm <n>                Split the offline job across n worker processes\n"
+              << "  --poster <file.ppm>       Render one image of --size in tiles (any size) and exit\n"
+              << "  --tile <n>                Poster tile size in pixels (default 2048)\n"
+              << "  --camera <0|1|2>          Poster camera: front, top or side (default 0)\n"
+              << "  --stream-mesh <file.obj>  Load an OBJ mesh in the background and draw it in place of the\n"
+              << "                            pyramids once uploaded; L loads it again\n"
+              << "  --texture <file>          Compressed DDS or KTX texture (BC1 to BC7), streamed into a texture\n"
+              << "                            array; repeatable, pyramid i uses the layer i modulo the layer count.\n"
+              << "                            TGA files instead are mipmapped at load and packed into one atlas\n"
+              << "  --mip-filter <filter>     Filter of the TGA mipmaps: box or kaiser (default kaiser, sharper)\n"
+              << "  --virtual-texture <pages> Page the --texture files (one layer each) through a sparse texture,\n"
+              << "                            with at most <pages> pages of 64 KiB resident (default 0: off)\n"
+              << "  --pyramid-field <count>   Surround the scene with a far field of <count> pyramids, each drawn\n"
+              << "                            from a 16-byte point record (default 0: off)\n"
+              << "  --impostor-pixels <n>     Draw the field pyramids smaller than <n> pixels as impostor quads\n"
+              << "                            (default 16; 0 draws them all as geometry)\n"
+              << "  --vertex-pulling <mode>   Fetch the pyramid vertices in the vertex shader from buffer textures:\n"
+              << "                            off, float (the vertex buffer as is) or quantized (8 bytes per vertex)\n"
+              << "  --pack <file>             Asset pack searched before the loose files (default assets.pack,\n"
+              << "                            used if present; \"\" for none)\n"
+              << "  --io-backend <backend>    How asset files are read: auto, uring (Linux io_uring) or threads\n"
+              << "                            (default auto: io_uring when the kernel allows it)\n"
+              << "  --trace <file>            Record the OpenGL calls of the session for gl_replay\n"
+              << "  --trace-frames <n>        Number of frames to record (default 300)\n"
+              << "  --gl-calls <count|time>   Count or also time the OpenGL calls per entry point (G prints them)\n"
+              << "  --memory-budget <c>=<MiB> GPU memory budget of a category (total, geometry, uniforms, readback,\n"
+              << "                            rendertargets, textures); repeatable, M prints the usage\n"
+              << "  --stats <file>            Write the statistics of every frame as CSV, or JSON lines for .json;\n"
+              << "                            - writes to the standard output (H shows them on screen)\n"
+              << "  --alloc-audit <n>         Run n frames after the warm-up and exit with status 1 if any of them\n"
+              << "                            allocated on the heap; audit builds only (-DALLOC_AUDIT=ON)\n"
+              << "  --log-file <file>         Also write the log messages to a file\n"
+              << "  --log-level <level>       Least severe messages kept: debug, info, warning or error (default info)\n"
+              << "  --gl-debug <level>        Create a debug context and log the driver's messages: off, errors,\n"
+              << "                            warnings (performance warnings once each) or all (default off)\n"
+              << std::endl;
+}
+
+// Function to parse the command line.
+// argc, argv: Arguments as passed to main().
+// options: Receives the parsed values; options not given keep their defaults.
+bool parseOptions(int argc, char **argv, AppOptions &options)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        const char *name = argv[i];
+        bool hasValue = i + 1 < argc; // Every option takes exactly one value.
+
+        if (std::strcmp(name, "--record") == 0 && hasValue)
+            options.recordPath = argv[++i];
+        else if (std::strcmp(name, "--record-pipe") == 0 && hasValue)
+            options.recordPipe = argv[++i];
+        else if (std::strcmp(name, "--record-fps") == 0 && hasValue)
+            options.recordFps = std::atoi(argv[++i]);
+        else if (std::strcmp(name, "--batch") == 0 && hasValue)
+            options.batchPath = argv[++i];
+        else if (std::strcmp(name, "--output-dir") == 0 && hasValue)
+            options.outputDirectory = argv[++i];
+        else if (std::strcmp(name, "--size") == 0 && hasValue)
+        {
+            if (std::sscanf(argv[++i], "%dx%d", &options.outputWidth, &options.outputHeight) != 2)
+            {
+                std::cerr << "Expected the size as <width>x<height>, got " << argv[i] << std::endl;
+                return false;
+            }
+        }
+        else if (std::strcmp(name, "--threads") == 0 && hasValue)
+            options.writerThreads = std::atoi(argv[++i]);
+        else if (std::strcmp(name, "--farm") == 0 && hasValue)
+            options.farmWorkers = std::atoi(argv[++i]);
+        else if (std::strcmp(name, "--poster") == 0 && hasValue)
+            options.posterPath = argv[++i];
+        else if (std::strcmp(name, "--tile") == 0 && hasValue)
+            options.tileSize = std::atoi(argv[++i]);
+        else if (std::strcmp(name, "--camera") == 0 && hasValue)
+            options.cameraPreset = std::atoi(argv[++i]);
+        else if (std::strcmp(name, "--stream-mesh") == 0 && hasValue)
+            options.streamMeshPath = argv[++i];
+        else if (std::strcmp(name, "--texture") == 0 && hasValue)
+            options.texturePaths.push_back(argv[++i]);
+        else if (std::strcmp(name, "--virtual-texture") == 0 && hasValue)
+            options.virtualTexturePages = std::atoi(argv[++i]);
+        else if (std::strcmp(name, "--mip-filter") == 0 && hasValue)
+        {
+            if (!parseMipFilter(argv[++i], options.mipFilter))
+            {
+                std::cerr << "--mip-filter expects box or kaiser" << std::endl;
+                return false;
+            }
+        }
+        else if (std::strcmp(name, "--pyramid-field") == 0 && hasValue)
+            options.pyramidField = std::atoi(argv[++i]);
+        else if (std::strcmp(name, "--impostor-pixels") == 0 && hasValue)
+            options.impostorPixels = (float)std::atof(argv[++i]);
+        else if (std::strcmp(name, "--vertex-pulling") == 0 && hasValue)
+        {
+            if (!parseVertexEncoding(argv[++i], options.vertexPulling))
+            {
+                std::cerr << "--vertex-pulling expects off, float or quantized" << std::endl;
+                return false;
+            }
+        }
+        else if (std::strcmp(name, "--pack") == 0 && hasValue)
+            options.packPath = argv[++i];
+        else if (std::strcmp(name, "--io-backend") == 0 && hasValue)
+        {
+            if (!parseFileReaderBackend(argv[++i], options.ioBackend))
+            {
+                std::cerr << "--io-backend expects auto, uring or threads" << std::endl;
+                return false;
+            }
+        }
+        else if (std::strcmp(name, "--trace") == 0 && hasValue)
+            options.tracePath = argv[++i];
+        else if (std::strcmp(name, "--trace-frames") == 0 && hasValue)
+            options.traceFrames = std::atoi(argv[++i]);
+        else if (std::strcmp(name, "--gl-calls") == 0 && hasValue)
+            options.glCalls = argv[++i];
+        else if (std::strcmp(name, "--memory-budget") == 0 && hasValue)
+            options.memoryBudgets.push_back(argv[++i]);
+        else if (std::strcmp(name, "--stats") == 0 && hasValue)
+            options.statsPath = argv[++i];
+        else if (std::strcmp(name, "--alloc-audit") == 0 && hasValue)
+            options.allocAuditFrames = std::atoi(argv[++i]);
+        else if (std::strcmp(name, "--log-file") == 0 && hasValue)
+            options.logPath = argv[++i];
+        else if (std::strcmp(name, "--log-level") == 0 && hasValue)
+        {
+            if (!parseLogSeverity(argv[++i], options.logLevel))
+            {
+                std::cerr << "--log-level expects debug, info, warning or error" << std::endl;
+                return false;
+            }
+        }
+        else if (std::strcmp(name, "--gl-debug") == 0 && hasValue)
+        {
+            if (!parseGlDebugLevel(argv[++i], options.glDebug))
+            {
+                std::cerr << "--gl-debug expects off, errors, warnings or all" << std::endl;
+                return false;
+            }
+        }
+        else
+        {
+            std::cerr << "Unknown or incomplete option " << name << std::endl;
+            printUsage(argv[0]);
+            return false;
+        }
+    }
+
+    if (options.recordFps <= 0)
+    {
+        std::cerr << "The recording frame rate must be positive" << std::endl;
+        return false;
+    }
+    if (options.outputWidth <= 0 || options.outputHeight <= 0)
+    {
+        std::cerr << "The image size must be positive" << std::endl;
+        return false;
+    }
+    if (!options.glCalls.empty() && options.glCalls != "count" && options.glCalls != "time")
+    {
+        std::cerr << "--gl-calls expects count or time" << std::endl;
+        return false;
+    }
+    if (options.allocAuditFrames < 0)
+    {
+        std::cerr << "The number of audited frames must not be negative" << std::endl;
+        return false;
+    }
+    if (options.pyramidField < 0)
+    {
+        std::cerr << "The pyramid field size must not be negative" << std::endl;
+        return false;
+    }
+    if (options.impostorPixels < 0.0f)
+    {
+        std::cerr << "The impostor size must not be negative" << std::endl;
+        return false;
+    }
+    if (options.virtualTexturePages < 0)
+    {
+        std::cerr << "The virtual texture page budget must not be negative" << std::endl;
+        return false;
+    }
+    if (options.tileSize <= 0 || options.cameraPreset < 0 || options.cameraPreset > 2)
+    {
+        std::cerr << "The tile size must be positive and the camera 0, 1 or 2" << std::endl;
+        return false;
+    }
+    return true;
+}
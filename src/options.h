@@ -0,0 +1,56 @@
+#ifndef OPTIONS_H
+#define OPTIONS_H
+
+// Command line options of the application.
+#include "file_reader.h"        // FileReaderBackend.
+#include "gl_debug.h"           // GlDebugLevel.
+#include "logger.h"             // LogSeverity.
+#include "texture_processing.h" // MipFilter.
+#include "vertex_pulling.h"     // VertexEncoding.
+#include <string>               // Used for the file name options.
+#include <vector>               // Repeatable options.
+
+struct AppOptions
+{
+    // Video capture
+    std::string recordPath; // --record <file>: record from the first frame to a .y4m (or raw .yuv) file.
+    std::string recordPipe; // --record-pipe <command>: stream Y4M to the standard input of an encoder process.
+    int recordFps = 60;     // --record-fps <n>: frame rate written into the Y4M header.
+
+    // Offline rendering
+    std::string batchPath;             // --batch <file>: render every frame of a camera path file headless, then exit.
+    std::string outputDirectory = "."; // --output-dir <dir>: where the offline modes write their images.
+    int outputWidth = 800;             // --size <w>x<h>: image size of the offline modes.
+    int outputHeight = 600;
+    int writerThreads = 0;             // --threads <n>: image writer threads; 0 picks one per spare core.
+    int farmWorkers = 0;               // --farm <n>: split the offline job across n worker processes.
+    std::string posterPath;            // --poster <file.ppm>: render one image of --size in tiles, then exit.
+    int tileSize = 2048;               // --tile <n>: edge length of the poster tiles in pixels.
+    int cameraPreset = 0;              // --camera <0|1|2>: front, top or side camera of the poster.
+
+    // Assets
+    std::string streamMeshPath;                            // --stream-mesh <file.obj>: load a mesh in the background and draw it in place of the pyramids.
+    std::vector<std::string> texturePaths;                 // --texture <file.dds|file.ktx|file.tga>, repeatable: layers of the pyramids' texture array, or textures of an atlas.
+    MipFilter mipFilter = MipFilter::Kaiser;               // --mip-filter <box|kaiser>: downsampling filter of the TGA mipmaps.
+    int virtualTexturePages = 0;                           // --virtual-texture <pages>: page the --texture files through a sparse texture; 0 for off.
+    int pyramidField = 0;                                  // --pyramid-field <count>: draw a far field of count point-expanded pyramids; 0 for off.
+    float impostorPixels = 16.0f;                          // --impostor-pixels <n>: field pyramids smaller than n pixels are drawn as impostors; 0 for off.
+    VertexEncoding vertexPulling = VertexEncoding::Off;    // --vertex-pulling <off|float|quantized>: fetch the pyramid vertices from buffer textures.
+    FileReaderBackend ioBackend = FileReaderBackend::Auto; // --io-backend <auto|uring|threads>: how asset files are read.
+    std::string packPath = "assets.pack";                  // --pack <file>: asset pack searched before loose files; "" for none.
+
+    // Diagnostics
+    std::string tracePath;                    // --trace <file>: record the OpenGL calls of the interactive session for gl_replay.
+    int traceFrames = 300;                    // --trace-frames <n>: number of frames to record.
+    std::string glCalls;                      // --gl-calls <count|time>: count (and time) the OpenGL calls per entry point; instrumented builds only.
+    std::vector<std::string> memoryBudgets;   // --memory-budget <category>=<MiB>, repeatable: GPU memory budgets.
+    std::string statsPath;                    // --stats <file>: stream the frame statistics, CSV or JSON lines (.json); - for stdout.
+    int allocAuditFrames = 0;                 // --alloc-audit <n>: check n frames after the warm-up for heap allocations, then exit.
+    std::string logPath;                      // --log-file <file>: also write the log messages to a file.
+    LogSeverity logLevel = LogSeverity::Info; // --log-level <debug|info|warning|error>: least severe messages kept.
+    GlDebugLevel glDebug = GlDebugLevel::Off; // --gl-debug <off|errors|warnings|all>: debug context, driver messages to the log.
+};
+
+bool parseOptions(int argc, char **argv, AppOptions &options); // Fills options from the command line; prints the usage and returns false on errors.
+
+#endif
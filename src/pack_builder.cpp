@@ -0,0 +1,127 @@
+// pack_builder: packs asset files into one compressed asset pack (asset_pack.h) for my_opengl_project.
+// Files are stored under their name without the directory, which is how readFile looks them up.
+//
+// Usage: pack_builder <output.pack> [--chunk <KiB>] <file>...
+//   --chunk <KiB>  Raw size of the compressed chunks (default 64). Smaller chunks decompress in parallel
+//                  sooner; larger ones compress a little better.
+#include "asset_pack.h"  // File format.
+#include "compression.h" // Chunk compression.
+#include <algorithm>     // std::sort.
+#include <cstdlib>       // atoi.
+#include <cstring>       // strcmp.
+#include <fstream>       // Reads the assets and writes the pack.
+#include <iostream>      // Included for the summary and error output.
+#include <string>        // File names.
+#include <vector>        // File contents and records.
+
+struct PackedFile
+{
+    std::string name;
+    std::vector<char> contents;
+};
+
+int main(int argc, char **argv)
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: pack_builder <output.pack> [--chunk <KiB>] <file>..." << std::endl;
+        return -1;
+    }
+    int chunkSize = 64 * 1024;
+    std::vector<PackedFile> files;
+    for (int i = 2; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--chunk") == 0 && i + 1 < argc)
+        {
+            int kibibytes = std::atoi(argv[++i]);
+            if (kibibytes <= 0 || kibibytes > lz4MaxInputSize / 1024) // Larger chunks are rejected by AssetPack::open
+            {
+                std::cerr << "The chunk size must be 1 to " << lz4MaxInputSize / 1024 << " KiB" << std::endl;
+                return -1;
+            }
+            chunkSize = kibibytes * 1024;
+            continue;
+        }
+        std::ifstream file(argv[i], std::ios::binary);
+        if (!file)
+        {
+            std::cerr << "Could not read " << argv[i] << std::endl;
+            return -1;
+        }
+        PackedFile packed;
+        packed.name = argv[i];
+        std::string::size_type slash = packed.name.find_last_of("/\\");
+        if (slash != std::string::npos)
+            packed.name.erase(0, slash + 1);
+        packed.contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        files.push_back(std::move(packed));
+    }
+
+    // The reader finds files by binary search, so the entries are sorted by name
+    std::sort(files.begin(), files.end(), [](const PackedFile &a, const PackedFile &b) { return a.name < b.name; });
+    for (size_t i = 1; i < files.size(); ++i)
+        if (files[i].name == files[i - 1].name)
+        {
+            std::cerr << "Two files are named " << files[i].name << std::endl;
+            return -1;
+        }
+
+    // Compress every chunk; a chunk that does not shrink is stored as it is
+    std::vector<AssetPackEntry> entries;
+    std::vector<AssetPackChunk> chunks;
+    std::string names;
+    std::vector<char> chunkData;
+    std::vector<char> compressed(compressBoundLz4(chunkSize));
+    long long rawTotal = 0;
+    for (const PackedFile &file : files)
+    {
+        AssetPackEntry entry;
+        entry.nameOffset = (uint32_t)names.size();
+        entry.nameLength = (uint32_t)file.name.size();
+        entry.size = file.contents.size();
+        entry.firstChunk = (uint32_t)chunks.size();
+        entry.chunkCount = 0;
+        names += file.name;
+        for (size_t offset = 0; offset < file.contents.size(); offset += chunkSize)
+        {
+            int rawSize = (int)std::min<size_t>(chunkSize, file.contents.size() - offset);
+            int storedSize = compressLz4(file.contents.data() + offset, rawSize, compressed.data());
+            const char *stored = compressed.data();
+            if (storedSize >= rawSize)
+            {
+                storedSize = rawSize;
+                stored = file.contents.data() + offset;
+            }
+            chunks.push_back({(uint64_t)chunkData.size(), (uint32_t)storedSize, (uint32_t)rawSize}); // Offset fixed below
+            chunkData.insert(chunkData.end(), stored, stored + storedSize);
+            ++entry.chunkCount;
+        }
+        entries.push_back(entry);
+        rawTotal += (long long)file.contents.size();
+    }
+
+    AssetPackHeader header;
+    std::memcpy(header.magic, assetPackMagic, sizeof(header.magic));
+    header.entryCount = (uint32_t)entries.size();
+    header.chunkCount = (uint32_t)chunks.size();
+    header.chunkSize = (uint32_t)chunkSize;
+    header.namesSize = (uint32_t)names.size();
+    uint64_t dataOffset = sizeof(header) + entries.size() * sizeof(AssetPackEntry) + chunks.size() * sizeof(AssetPackChunk) + names.size();
+    for (AssetPackChunk &chunk : chunks)
+        chunk.offset += dataOffset;
+
+    std::ofstream out(argv[1], std::ios::binary | std::ios::trunc);
+    out.write((const char *)&header, sizeof(header));
+    out.write((const char *)entries.data(), entries.size() * sizeof(AssetPackEntry));
+    out.write((const char *)chunks.data(), chunks.size() * sizeof(AssetPackChunk));
+    out.write(names.data(), names.size());
+    out.write(chunkData.data(), chunkData.size());
+    if (!out)
+    {
+        std::cerr << "Could not write " << argv[1] << std::endl;
+        return -1;
+    }
+    std::cout << argv[1] << ": " << files.size() << " files, " << rawTotal << " bytes packed into "
+              << dataOffset + chunkData.size() << std::endl;
+    return 0;
+}
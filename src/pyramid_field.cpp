@@ -0,0 +1,250 @@
+#include "pyramid_field.h"
+#include "glad.h"               // GLAD provides the OpenGL function pointers.
+#include "shader.h"             // Shader loading and compilation helpers.
+#include "gpu_memory.h"         // Tracked buffer allocation.
+#include "gl_debug.h"           // Object labels and debug groups for frame captures.
+#include "logger.h"             // Error messages.
+#include <glm/gtc/type_ptr.hpp> // Provides glm::value_ptr to upload matrices.
+#include <algorithm>            // std::min, std::max, std::sort and the record range searches.
+#include <climits>              // INT_MAX.
+#include <cmath>                // std::sqrt, std::cos, std::sin, std::lround.
+#include <random>               // The field layout.
+
+// Texture units of the point records and the impostor atlas.
+static const int pointUnit = 0;
+static const int atlasUnit = 1;
+
+// Ring of the scene's ground the field covers, around the three pyramids of the scene and out to the far plane.
+static const float fieldInnerRadius = 12.0f;
+static const float fieldOuterRadius = 90.0f;
+static const float fieldGround = -0.5f; // The base of the scene's pyramids.
+static const float fieldMinScale = 0.25f;
+static const float fieldMaxScale = 1.5f;
+
+// Impostor atlas: 8 x 8 directions of 64 x 64 pixels. The pyramid of edge 1 fits in a sphere of radius sqrt(3) / 2.
+static const int impostorGrid = 8;
+static const int impostorCell = 64;
+static const float pyramidRadius = 0.8660254f;
+
+// Function to pack a pyramid into its point record.
+// center: Center of the pyramid. scale: Edge length. color: Linear RGB in [0, 1].
+PyramidPoint packPyramidPoint(const glm::vec3 &center, float scale, const glm::vec3 &color)
+{
+    auto channel = [](float value, float maximum)
+    { return (uint32_t)std::lround(std::min(std::max(value, 0.0f), 1.0f) * maximum); };
+    PyramidPoint point;
+    point.x = center.x;
+    point.y = center.y;
+    point.z = center.z;
+    point.packed = channel(color.x, 255.0f) | channel(color.y, 255.0f) << 8 | channel(color.z, 255.0f) << 16 |
+                   channel(scale * 64.0f / 255.0f, 255.0f) << 24;
+    return point;
+}
+
+// Function to generate the pyramids of the field.
+// Spread evenly over the area of the ring with a fixed seed, so every run, batch frame and replay shows the same field.
+// Sorted by the distance from the vertical axis through the scene center, so a band of distances is one record range.
+void generatePyramidField(int count, std::vector<PyramidPoint> &points)
+{
+    std::mt19937 random(20240601u);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    const float inner = fieldInnerRadius * fieldInnerRadius, outer = fieldOuterRadius * fieldOuterRadius;
+
+    points.resize(count);
+    for (int i = 0; i < count; ++i)
+    {
+        float radius = std::sqrt(inner + unit(random) * (outer - inner)); // Uniform over the area, not the radius
+        float angle = unit(random) * 6.28318531f;
+        float scale = fieldMinScale + unit(random) * (fieldMaxScale - fieldMinScale);
+        glm::vec3 color(0.3f + 0.7f * unit(random), 0.3f + 0.7f * unit(random), 0.3f + 0.7f * unit(random));
+        glm::vec3 center(radius * std::cos(angle), fieldGround + 0.5f * scale, radius * std::sin(angle));
+        points[i] = packPyramidPoint(center, scale, color);
+    }
+    std::sort(points.begin(), points.end(), [](const PyramidPoint &a, const PyramidPoint &b)
+              { return a.x * a.x + a.z * a.z < b.x * b.x + b.z * b.z; });
+}
+
+// Function to bake the impostor atlas of the field's pyramid and build the program that draws the quads.
+// The bake draws a white pyramid of edge 1 with the field program, so the atlas holds the face shading and the
+// quads only tint it.
+static bool createImpostors(PyramidFieldRenderer &renderer, int framebufferWidth, int framebufferHeight)
+{
+    renderer.impostorProgram = UniqueProgram(createShaderProgram(readFile("impostor_vertex_shader.glsl"),
+                                                                 readFile("impostor_fragment_shader.glsl")));
+    if (!renderer.impostorProgram)
+    {
+        logError("Failed to create the impostor shader program");
+        return false;
+    }
+
+    // A field of one pyramid for the bake
+    PyramidPoint unitPyramid = packPyramidPoint(glm::vec3(0.0f), 1.0f, glm::vec3(1.0f));
+    UniqueBuffer bakeBuffer = UniqueBuffer::create();
+    glBindBuffer(GL_TEXTURE_BUFFER, bakeBuffer.name());
+    trackedBufferData(GL_TEXTURE_BUFFER, bakeBuffer.name(), sizeof(unitPyramid), &unitPyramid, GL_STATIC_DRAW,
+                      GpuMemoryCategory::Geometry, "impostor bake");
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    UniqueTexture bakeTexture = UniqueTexture::create();
+    glActiveTexture(GL_TEXTURE0 + pointUnit);
+    glBindTexture(GL_TEXTURE_BUFFER, bakeTexture.name());
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32UI, bakeBuffer.name());
+
+    glUseProgram(renderer.program.name());
+    glUniform4f(renderer.impostorCameraLocation, 0.0f, 0.0f, 0.0f, 0.0f); // Geometry for every pyramid
+    glBindVertexArray(renderer.VAO.name());
+    bool baked = bakeImpostorAtlas(renderer.impostors, impostorGrid, impostorCell, pyramidRadius,
+                                   [&renderer](const glm::mat4 &viewProjection)
+                                   {
+                                       glUniformMatrix4fv(renderer.viewProjectionLocation, 1, GL_FALSE, glm::value_ptr(viewProjection));
+                                       glDrawArrays(GL_TRIANGLES, 0, pyramidFieldVertices);
+                                   },
+                                   framebufferWidth, framebufferHeight);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    if (!baked)
+        return false;
+
+    GLuint program = renderer.impostorProgram.name();
+    glUseProgram(program);
+    glUniform1i(glGetUniformLocation(program, "points"), pointUnit);
+    glUniform1i(glGetUniformLocation(program, "impostorAtlas"), atlasUnit);
+    glUniform2f(glGetUniformLocation(program, "impostorGrid"), (float)renderer.impostors.gridSize, renderer.impostors.radius);
+    renderer.quadViewProjectionLocation = glGetUniformLocation(program, "viewProjection");
+    renderer.quadCameraLocation = glGetUniformLocation(program, "impostorCamera");
+    renderer.firstRecordLocation = glGetUniformLocation(program, "firstRecord");
+    labelGlObject(GL_PROGRAM, program, "impostor program");
+    return true;
+}
+
+// Function to create the field renderer.
+// count: Pyramids of the field; limited by the size of a buffer texture on this driver.
+// impostorPixels: Pyramids smaller than this on screen are drawn as impostors; 0 draws every pyramid as geometry.
+bool createPyramidFieldRenderer(PyramidFieldRenderer &renderer, int count, float impostorPixels, int framebufferWidth,
+                                int framebufferHeight)
+{
+    GLint maxTexels = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+    int limit = std::min((int)maxTexels, INT_MAX / pyramidFieldVertices); // The draw counts vertices in a GLsizei
+    if (count > limit)
+    {
+        logWarning("The pyramid field is limited to {} pyramids on this driver; {} were asked for", limit, count);
+        count = limit;
+    }
+
+    renderer.program = UniqueProgram(createShaderProgram(readFile("pyramid_field_vertex_shader.glsl"),
+                                                         readFile("fragment_shader.glsl")));
+    if (!renderer.program)
+    {
+        logError("Failed to create the pyramid field shader program");
+        return false;
+    }
+    glUseProgram(renderer.program.name());
+    glUniform1i(glGetUniformLocation(renderer.program.name(), "points"), pointUnit);
+    renderer.viewProjectionLocation = glGetUniformLocation(renderer.program.name(), "viewProjection");
+    renderer.impostorCameraLocation = glGetUniformLocation(renderer.program.name(), "impostorCamera");
+
+    std::vector<PyramidPoint> points;
+    generatePyramidField(count, points);
+    renderer.points = UniqueBuffer::create();
+    glBindBuffer(GL_TEXTURE_BUFFER, renderer.points.name());
+    trackedBufferData(GL_TEXTURE_BUFFER, renderer.points.name(), (long long)points.size() * sizeof(PyramidPoint), points.data(),
+                      GL_STATIC_DRAW, GpuMemoryCategory::Geometry, "pyramid field");
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+    renderer.pointTexture = UniqueTexture::create();
+    glBindTexture(GL_TEXTURE_BUFFER, renderer.pointTexture.name());
+    glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32UI, renderer.points.name());
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    renderer.VAO = UniqueVertexArray::create();
+    renderer.pointCount = count;
+    renderer.radii.resize(count);
+    for (int i = 0; i < count; ++i)
+        renderer.radii[i] = std::sqrt(points[i].x * points[i].x + points[i].z * points[i].z);
+
+    labelGlObject(GL_PROGRAM, renderer.program.name(), "pyramid field program");
+    labelGlObject(GL_BUFFER, renderer.points.name(), "pyramid field points");
+    labelGlObject(GL_TEXTURE, renderer.pointTexture.name(), "pyramid field points");
+    labelGlObject(GL_VERTEX_ARRAY, renderer.VAO.name(), "pyramid field");
+    logInfo("Pyramid field of {} pyramids in {} KiB", count, (long long)count * (long long)sizeof(PyramidPoint) / 1024);
+
+    // Without impostors the field is still drawn, as geometry only
+    if (impostorPixels > 0.0f)
+    {
+        if (createImpostors(renderer, framebufferWidth, framebufferHeight))
+            renderer.impostorPixels = impostorPixels;
+        else
+        {
+            logWarning("Drawing the pyramid field without impostors");
+            renderer.impostors = ImpostorAtlas();
+            renderer.impostorProgram.reset();
+        }
+    }
+    return true;
+}
+
+// Function to release the GPU objects of the field renderer.
+void destroyPyramidFieldRenderer(PyramidFieldRenderer &renderer)
+{
+    renderer = PyramidFieldRenderer(); // The owners queue the deletions
+}
+
+// Function to draw the field.
+// view, projection: Camera of the frame; the points are in world space. cameraPosition: Where the camera is.
+// framebufferHeight: Height of the viewport in pixels, which converts the impostor threshold into a distance.
+void drawPyramidField(const PyramidFieldRenderer &renderer, const glm::mat4 &view, const glm::mat4 &projection,
+                      const glm::vec3 &cameraPosition, int framebufferHeight)
+{
+    if (renderer.pointCount <= 0)
+        return;
+    GlDebugGroup group("pyramid field");
+    glm::mat4 viewProjection = projection * view;
+
+    // A pyramid of edge s at distance d covers 2 * radius * s * pixelsPerUnit / d pixels; it becomes an impostor
+    // once d > s * impostorDistance. Both shaders test exactly that, so a pyramid is drawn by one of them.
+    float impostorDistance = 0.0f;
+    int geometryBegin = 0, geometryEnd = renderer.pointCount, quadBegin = renderer.pointCount;
+    if (renderer.impostorPixels > 0.0f)
+    {
+        float pixelsPerUnit = 0.5f * (float)framebufferHeight * projection[1][1];
+        impostorDistance = 2.0f * renderer.impostors.radius * pixelsPerUnit / renderer.impostorPixels;
+
+        // Bounds of the camera distance of the records at radius r: at least |r - c| and at most
+        // sqrt((r + c)^2 + h^2), with c the camera's distance from the axis and h its largest height over a center
+        float c = std::sqrt(cameraPosition.x * cameraPosition.x + cameraPosition.z * cameraPosition.z);
+        float h = std::max(std::abs(cameraPosition.y - (fieldGround + 0.5f * fieldMinScale)),
+                           std::abs(cameraPosition.y - (fieldGround + 0.5f * fieldMaxScale)));
+        float nearest = fieldMaxScale * impostorDistance;  // Beyond it, even the largest pyramid is an impostor
+        float farthest = fieldMinScale * impostorDistance; // Within it, even the smallest pyramid is geometry
+        geometryBegin = (int)(std::lower_bound(renderer.radii.begin(), renderer.radii.end(), c - nearest) - renderer.radii.begin());
+        geometryEnd = (int)(std::upper_bound(renderer.radii.begin(), renderer.radii.end(), c + nearest) - renderer.radii.begin());
+        float allGeometry = farthest * farthest > h * h ? std::sqrt(farthest * farthest - h * h) - c : -1.0f;
+        quadBegin = (int)(std::upper_bound(renderer.radii.begin(), renderer.radii.end(), allGeometry) - renderer.radii.begin());
+    }
+
+    // Thousands of pyramids overlap, and each one's base overlaps its sides: the depth test sorts them out, as in the
+    // impostor bake, so the geometry and the quads of a pyramid look alike. The caller clears the depth buffer.
+    glEnable(GL_DEPTH_TEST);
+    glActiveTexture(GL_TEXTURE0 + pointUnit);
+    glBindTexture(GL_TEXTURE_BUFFER, renderer.pointTexture.name());
+    glBindVertexArray(renderer.VAO.name());
+    if (geometryEnd > geometryBegin)
+    {
+        glUseProgram(renderer.program.name());
+        glUniformMatrix4fv(renderer.viewProjectionLocation, 1, GL_FALSE, glm::value_ptr(viewProjection));
+        glUniform4f(renderer.impostorCameraLocation, cameraPosition.x, cameraPosition.y, cameraPosition.z, impostorDistance);
+        glDrawArrays(GL_TRIANGLES, geometryBegin * pyramidFieldVertices, (geometryEnd - geometryBegin) * pyramidFieldVertices);
+    }
+    if (renderer.pointCount > quadBegin)
+    {
+        // One quad of 4 strip vertices per pyramid; the instance index is relative to firstRecord, 3.3 has no base instance
+        glUseProgram(renderer.impostorProgram.name());
+        glUniformMatrix4fv(renderer.quadViewProjectionLocation, 1, GL_FALSE, glm::value_ptr(viewProjection));
+        glUniform4f(renderer.quadCameraLocation, cameraPosition.x, cameraPosition.y, cameraPosition.z, impostorDistance);
+        glUniform1i(renderer.firstRecordLocation, quadBegin);
+        glActiveTexture(GL_TEXTURE0 + atlasUnit);
+        glBindTexture(GL_TEXTURE_2D, renderer.impostors.texture.name());
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, renderer.pointCount - quadBegin);
+        glBindTexture(GL_TEXTURE_2D, 0);
+        glActiveTexture(GL_TEXTURE0);
+    }
+    glDisable(GL_DEPTH_TEST); // The rest of the frame draws in submission order
+}
@@ -0,0 +1,64 @@
+#ifndef PYRAMID_FIELD_H
+#define PYRAMID_FIELD_H
+
+// Far-field mass rendering of pyramids: every pyramid is one 16-byte point record (center, scale, color)
+// instead of a model matrix and a mesh draw. A single glDrawArrays of 18 vertices per pyramid runs the
+// pyramid_field vertex shader, which finds the record at gl_VertexID / 18 in a buffer texture and the
+// corner at gl_VertexID % 18 in a constant table of the unrolled pyramid mesh. A million pyramids take
+// 16 MB and one draw call, with no index buffer and no per-instance vertex attributes.
+// Pyramids that would cover fewer than a given number of pixels are drawn as impostors instead (impostor.h):
+// one instanced camera-facing quad each, textured from an octahedral atlas of the pyramid baked at startup
+// and tinted with the pyramid's color. The records are sorted by their distance from the scene center, so
+// the CPU narrows each frame down to one record range that may need geometry and one that may need quads;
+// the vertex shaders decide per pyramid within them, with the same test, so every pyramid is drawn once.
+// All functions must be called on the thread that owns the OpenGL context.
+#include "gl_objects.h" // Owners of the program, VAO, buffer and buffer texture.
+#include "impostor.h"   // The impostor atlas.
+#include <cstdint>      // Packed record fields.
+#include <glm/glm.hpp>  // Positions, colors and the camera transform.
+#include <vector>       // Generated records.
+
+// Vertices drawn per pyramid: the 18 corners of its 6 triangles, as in pyramidIndexCount.
+const int pyramidFieldVertices = 18;
+
+// One pyramid of the field, as the shader reads it (one GL_RGBA32UI texel).
+struct PyramidPoint
+{
+    float x, y, z;     // Center.
+    uint32_t packed;   // r | g << 8 | b << 16 | scale << 24; the edge length is scale / 64.
+};
+static_assert(sizeof(PyramidPoint) == 16, "the shader reads one 16-byte texel per pyramid");
+
+PyramidPoint packPyramidPoint(const glm::vec3 &center, float scale, const glm::vec3 &color); // Clamps scale to [0, 255 / 64].
+void generatePyramidField(int count, std::vector<PyramidPoint> &points); // A fixed pseudo-random field around the scene, nearest to the center first.
+
+// GPU state of the field.
+struct PyramidFieldRenderer
+{
+    UniqueProgram program;
+    UniqueVertexArray VAO;      // Without attributes; the shader pulls everything.
+    UniqueBuffer points;        // The PyramidPoint records.
+    UniqueTexture pointTexture; // GL_TEXTURE_BUFFER over points.
+    std::vector<float> radii;   // Distance of every record from the scene's vertical axis, ascending.
+    int viewProjectionLocation = -1;
+    int impostorCameraLocation = -1;
+    int pointCount = 0;         // 0 if the field could not be created.
+
+    // Impostors; the atlas is empty if they are off
+    ImpostorAtlas impostors;
+    UniqueProgram impostorProgram;
+    int quadViewProjectionLocation = -1;
+    int quadCameraLocation = -1;
+    int firstRecordLocation = -1;
+    float impostorPixels = 0.0f; // Screen size in pixels below which a pyramid becomes an impostor.
+};
+
+// Builds the programs, uploads a generated field of count pyramids and, if impostorPixels > 0, bakes the
+// impostor atlas. framebufferWidth, framebufferHeight: Viewport restored after the bake.
+bool createPyramidFieldRenderer(PyramidFieldRenderer &renderer, int count, float impostorPixels, int framebufferWidth,
+                                int framebufferHeight);
+void destroyPyramidFieldRenderer(PyramidFieldRenderer &renderer); // Releases the GPU objects.
+void drawPyramidField(const PyramidFieldRenderer &renderer, const glm::mat4 &view, const glm::mat4 &projection,
+                      const glm::vec3 &cameraPosition, int framebufferHeight); // Draws every pyramid, depth tested; clear the depth first.
+
+#endif
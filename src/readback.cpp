@@ -0,0 +1,185 @@
+#include "readback.h"
+#include "gl_debug.h"   // Object labels and debug groups for frame captures.
+#include "gpu_memory.h" // Tracked buffer allocation and eviction.
+#include <chrono>       // Sleep interval while finishing.
+#include <thread>       // std::this_thread::sleep_for.
+
+// Constructor: creates the pixel pack buffers of the ring. Needs the GL context current.
+FrameReadback::FrameReadback(WorkerPool &workers, int ringSize)
+    : workers(workers), slots(new Slot[ringSize < 1 ? 1 : ringSize]), slotCount(ringSize < 1 ? 1 : ringSize)
+{
+    for (int i = 0; i < slotCount; ++i)
+        glGenBuffers(1, &slots[i].buffer);
+
+    // Over the readback budget, idle buffers are released; they are reallocated by the next request that needs them.
+    evictionHandler = addGpuEvictionHandler(GpuMemoryCategory::Readback, [this](long long)
+                                            { return releaseIdleBuffers(); });
+}
+
+// Destructor: waits for the outstanding readbacks, then deletes the buffers.
+FrameReadback::~FrameReadback()
+{
+    finish();
+    removeGpuEvictionHandler(evictionHandler);
+    for (int i = 0; i < slotCount; ++i)
+        trackedDeleteBuffers(1, &slots[i].buffer);
+}
+
+// Function to queue the read of a framebuffer rectangle.
+// x, y, width, height: Rectangle of the current read framebuffer, in pixels.
+// frameIndex: Frame number passed through to the handler.
+// handler: Called on a worker thread with the pixels.
+bool FrameReadback::request(int x, int y, int width, int height, long long frameIndex, ReadbackHandler handler)
+{
+    Slot &slot = slots[nextSlot];
+    if (slot.state != SlotState::Free)
+    {
+        ++dropped; // The oldest readback has not been consumed yet; never wait for it.
+        return false;
+    }
+
+    GlDebugGroup group("readback");
+    long long size = (long long)width * height * 4;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    if (slot.capacity < size)
+    {
+        // Grow the buffer; GL_STREAM_READ tells the driver the CPU reads it back once.
+        trackedBufferData(GL_PIXEL_PACK_BUFFER, slot.buffer, size, nullptr, GL_STREAM_READ, GpuMemoryCategory::Readback, "frame readback");
+        labelGlObject(GL_BUFFER, slot.buffer, "frame readback"); // The buffer exists only once it has been bound.
+        slot.capacity = size;
+    }
+
+    // With a pack buffer bound, glReadPixels returns immediately and the last argument is an offset into the buffer.
+    glPixelStorei(GL_PACK_ALIGNMENT, 1);
+    glReadPixels(x, y, width, height, GL_RGBA, GL_UNSIGNED_BYTE, (void *)0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.image.width = width;
+    slot.image.height = height;
+    slot.image.frameIndex = frameIndex;
+    slot.handler = std::move(handler);
+    slot.consumed.store(false);
+    slot.state = SlotState::Pending;
+
+    nextSlot = (nextSlot + 1) % slotCount;
+    return true;
+}
+
+// Function to advance the slots of the ring without blocking.
+// Copies whose fence has signalled are mapped and dispatched; slots whose worker is done are unmapped.
+void FrameReadback::poll()
+{
+    for (int i = 0; i < slotCount; ++i)
+    {
+        Slot &slot = slots[i];
+        if (slot.state == SlotState::Pending)
+        {
+            // A zero timeout only queries the fence, it never waits.
+            GLenum status = glClientWaitSync(slot.fence, 0, 0);
+            if (status == GL_ALREADY_SIGNALED || status == GL_CONDITION_SATISFIED)
+                dispatch(slot);
+        }
+        else if (slot.state == SlotState::Mapped && slot.consumed.load(std::memory_order_acquire))
+        {
+            if (slot.image.pixels != nullptr)
+            {
+                glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+                glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+                glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+            }
+            slot.image.pixels = nullptr;
+            slot.handler = nullptr;
+            slot.state = SlotState::Free;
+        }
+    }
+}
+
+// Function to map a completed slot and run its handler on a worker.
+// The buffer stays mapped while the worker reads it; poll() unmaps it afterwards on the render thread.
+void FrameReadback::dispatch(Slot &slot)
+{
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+
+    long long size = (long long)slot.image.width * slot.image.height * 4;
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+    slot.image.pixels = (const unsigned char *)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    slot.state = SlotState::Mapped;
+
+    // If mapping failed the handler still runs, with null pixels, so consumers waiting for this frame are not left hanging.
+    Slot *target = &slot;
+    workers.submit([target]
+                   {
+                       target->handler(target->image);
+                       target->consumed.store(true, std::memory_order_release);
+                   });
+}
+
+// Function to wait until the next slot of the ring is free.
+// Waits for the GPU copy of that slot if needed, then for its worker to release the pixels.
+void FrameReadback::waitForFreeSlot()
+{
+    Slot &slot = slots[nextSlot];
+    if (slot.state == SlotState::Pending)
+        glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, ~0ull);
+
+    poll();
+    while (slot.state != SlotState::Free)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        poll();
+    }
+}
+
+// Function to block until every readback has been handled.
+// Only meant for shutdown: it waits on the fences and on the workers.
+void FrameReadback::finish()
+{
+    for (int i = 0; i < slotCount; ++i)
+        if (slots[i].state == SlotState::Pending)
+            glClientWaitSync(slots[i].fence, GL_SYNC_FLUSH_COMMANDS_BIT, ~0ull);
+
+    while (inFlight() > 0)
+    {
+        poll();
+        if (inFlight() > 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+}
+
+// Function to check if a request can be queued right now.
+bool FrameReadback::hasFreeSlot() const
+{
+    return slots[nextSlot].state == SlotState::Free;
+}
+
+// Function to count the readbacks that are queued or still being handled.
+int FrameReadback::inFlight() const
+{
+    int count = 0;
+    for (int i = 0; i < slotCount; ++i)
+        if (slots[i].state != SlotState::Free)
+            ++count;
+    return count;
+}
+
+// Function to free the storage of the buffers no readback is using.
+// Returns the number of bytes released.
+long long FrameReadback::releaseIdleBuffers()
+{
+    long long released = 0;
+    for (int i = 0; i < slotCount; ++i)
+    {
+        Slot &slot = slots[i];
+        if (slot.state != SlotState::Free || slot.capacity == 0)
+            continue;
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.buffer);
+        trackedBufferData(GL_PIXEL_PACK_BUFFER, slot.buffer, 0, nullptr, GL_STREAM_READ, GpuMemoryCategory::Readback, "frame readback");
+        released += slot.capacity;
+        slot.capacity = 0;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return released;
+}
@@ -0,0 +1,76 @@
+#ifndef READBACK_H
+#define READBACK_H
+
+// Asynchronous framebuffer readback through a ring of pixel pack buffers.
+// glReadPixels into a pixel pack buffer only queues a copy on the GPU; a fence marks when the copy is done.
+// Frames later, once the fence has signalled, the buffer is mapped and the pixels are handed to a worker
+// thread. The render thread never waits for the GPU and never touches the pixels itself.
+#include "glad.h"        // GLsync and the OpenGL function pointers.
+#include "worker_pool.h" // Worker threads that consume the pixels.
+#include <atomic>        // Hand-off flag between the worker and the render thread.
+#include <functional>    // std::function holds the pixel handlers.
+#include <memory>        // Owns the slot array.
+
+// Pixels of one readback: tightly packed RGBA8 rows, bottom row first (OpenGL order).
+// The memory is only valid during the handler call; pixels is null if the buffer could not be mapped.
+struct ReadbackImage
+{
+    const unsigned char *pixels = nullptr;
+    int width = 0;
+    int height = 0;
+    long long frameIndex = 0; // Frame number given to FrameReadback::request.
+};
+
+// Called on a worker thread once the pixels are available.
+using ReadbackHandler = std::function<void(const ReadbackImage &image)>;
+
+class FrameReadback
+{
+public:
+    FrameReadback(WorkerPool &workers, int ringSize = 3); // ringSize: number of readbacks that can be in flight at once.
+    ~FrameReadback();                                     // Completes all pending readbacks. Needs the GL context current.
+
+    FrameReadback(const FrameReadback &) = delete;
+    FrameReadback &operator=(const FrameReadback &) = delete;
+
+    bool request(int x, int y, int width, int height, long long frameIndex,
+                 ReadbackHandler handler); // Queues a read of the bound read framebuffer; false if every slot is busy.
+    void poll();                           // Dispatches finished copies and recycles consumed slots. Call once per frame.
+    void waitForFreeSlot();                // Blocks until request() can succeed; for offline modes that must not skip frames.
+    void finish();                         // Blocks until every queued readback has been handled (shutdown only).
+
+    bool hasFreeSlot() const;                                  // True if request() would succeed.
+    int inFlight() const;                                      // Number of readbacks not yet consumed.
+    long long droppedRequests() const { return dropped; }      // Requests refused because the ring was full.
+    long long releaseIdleBuffers();                            // Frees the storage of unused slots; returns the bytes released.
+
+private:
+    enum class SlotState
+    {
+        Free,    // Available for a new request.
+        Pending, // Copy queued on the GPU, waiting for the fence.
+        Mapped   // Pixels mapped and handed to a worker.
+    };
+
+    struct Slot
+    {
+        unsigned int buffer = 0;        // Pixel pack buffer.
+        long long capacity = 0;         // Allocated size of the buffer in bytes.
+        GLsync fence = nullptr;         // Signals when the copy into the buffer is complete.
+        SlotState state = SlotState::Free;
+        std::atomic<bool> consumed{false}; // Set by the worker when it no longer reads the mapped memory.
+        ReadbackImage image;
+        ReadbackHandler handler;
+    };
+
+    void dispatch(Slot &slot); // Maps a completed slot and passes it to a worker.
+
+    WorkerPool &workers;
+    std::unique_ptr<Slot[]> slots;
+    int slotCount;
+    int nextSlot = 0;       // Slot used by the next request; slots are used in ring order.
+    long long dropped = 0;
+    int evictionHandler = 0; // Registration with the GPU memory budgets.
+};
+
+#endif
@@ -0,0 +1,207 @@
+#include "render_farm.h"
+#include "logger.h"     // Error messages.
+#include <atomic>       // Lock-free work ranges shared between the processes.
+#include <chrono>       // Per-worker timing.
+#include <cstdio>       // fflush before forking.
+#include <cstdint>      // uint64_t packing of the work ranges.
+#include <iomanip>      // Formatting of the report.
+#include <iostream>     // Included for the report.
+#include <new>          // Placement new constructs the queue in the shared mapping.
+#include <sys/mman.h>   // mmap, the shared memory holding the queue.
+#include <sys/wait.h>   // waitpid, collects the workers.
+#include <unistd.h>     // fork and _exit.
+#include <vector>       // Process ids.
+
+// The remaining items of a worker, [begin, end), packed into one 64-bit word so the owner (taking from
+// the front) and thieves (taking from the back) can both update it with a single compare-and-swap.
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "the work queue needs lock-free 64-bit atomics across processes");
+
+static inline uint64_t packRange(uint32_t begin, uint32_t end) { return ((uint64_t)begin << 32) | end; }
+static inline uint32_t rangeBegin(uint64_t range) { return (uint32_t)(range >> 32); }
+static inline uint32_t rangeEnd(uint64_t range) { return (uint32_t)range; }
+
+// Per-worker state in shared memory. One cache line each, so the workers do not slow each other down.
+struct alignas(64) FarmWorkerState
+{
+    std::atomic<uint64_t> range;  // Items this worker has not started yet.
+    int itemsDone;                // Written by the worker before it exits.
+    int itemsStolen;
+    double wallSeconds;           // From fork to exit.
+    double busySeconds;           // Time spent on items (between claims).
+    int succeeded;
+};
+
+// Function to take the next item of a worker's own range, from the front.
+static int popOwnItem(FarmWorkerState &state)
+{
+    uint64_t range = state.range.load(std::memory_order_acquire);
+    while (rangeBegin(range) < rangeEnd(range))
+    {
+        uint64_t next = packRange(rangeBegin(range) + 1, rangeEnd(range));
+        if (state.range.compare_exchange_weak(range, next, std::memory_order_acq_rel))
+            return (int)rangeBegin(range);
+    }
+    return -1;
+}
+
+// Function to steal the back half of the largest remaining range of another worker into the thief's own range.
+// Returns false once no other worker has anything left.
+static bool stealItems(FarmWorkerState *states, int workerCount, int thief)
+{
+    for (;;)
+    {
+        int victim = -1;
+        uint32_t victimRemaining = 0;
+        uint64_t victimRange = 0;
+        for (int i = 0; i < workerCount; ++i)
+        {
+            if (i == thief)
+                continue;
+            uint64_t range = states[i].range.load(std::memory_order_acquire);
+            uint32_t remaining = rangeEnd(range) - rangeBegin(range);
+            if (rangeBegin(range) < rangeEnd(range) && remaining > victimRemaining)
+            {
+                victim = i;
+                victimRemaining = remaining;
+                victimRange = range;
+            }
+        }
+        if (victim < 0)
+            return false;
+
+        // The victim keeps [begin, middle), the thief takes [middle, end); a single remaining item goes to the thief.
+        uint32_t middle = rangeBegin(victimRange) + victimRemaining / 2;
+        if (states[victim].range.compare_exchange_strong(victimRange, packRange(rangeBegin(victimRange), middle),
+                                                         std::memory_order_acq_rel))
+        {
+            // The thief's own range is empty, so nobody else modifies it while it is replaced.
+            states[thief].range.store(packRange(middle, rangeEnd(victimRange)), std::memory_order_release);
+            states[thief].itemsStolen += (int)(rangeEnd(victimRange) - middle);
+            return true;
+        }
+        // Lost a race with the victim or another thief; look again.
+    }
+}
+
+// Function to run the body of one worker process and record its timings.
+static bool runWorker(FarmWorkerState *states, int workerCount, int workerIndex, const FarmWorkerFunction &work)
+{
+    FarmWorkerState &self = states[workerIndex];
+    auto start = std::chrono::steady_clock::now();
+    auto lastClaim = start;
+    bool working = false;
+
+    FarmClaimFunction claim = [&]() -> int
+    {
+        auto now = std::chrono::steady_clock::now();
+        if (working)
+            self.busySeconds += std::chrono::duration<double>(now - lastClaim).count();
+        lastClaim = now;
+
+        int item = popOwnItem(self);
+        while (item < 0 && stealItems(states, workerCount, workerIndex))
+            item = popOwnItem(self);
+
+        working = item >= 0;
+        if (working)
+            ++self.itemsDone;
+        return item;
+    };
+
+    bool ok = work(workerIndex, claim);
+    self.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    self.succeeded = ok ? 1 : 0;
+    return ok;
+}
+
+// Function to fork the workers, wait for them and report their timings.
+// workerCount: Number of processes, clamped to the number of items.
+// itemCount: Items are numbered 0 to itemCount - 1.
+// work: Body of each worker process.
+int runRenderFarm(int workerCount, int itemCount, const FarmWorkerFunction &work)
+{
+    if (itemCount <= 0)
+        return 0;
+    if (workerCount > itemCount)
+        workerCount = itemCount;
+    if (workerCount < 1)
+        workerCount = 1;
+
+    // Anonymous shared mapping: created before the fork, so every worker sees the same queue.
+    size_t sharedSize = sizeof(FarmWorkerState) * workerCount;
+    void *shared = mmap(nullptr, sharedSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if (shared == MAP_FAILED)
+    {
+        logError("Could not map the render farm queue");
+        return workerCount;
+    }
+    FarmWorkerState *states = new (shared) FarmWorkerState[workerCount];
+
+    // Contiguous initial shares keep neighbouring frames (similar cameras) in the same process.
+    for (int i = 0; i < workerCount; ++i)
+    {
+        uint32_t begin = (uint32_t)((long long)itemCount * i / workerCount);
+        uint32_t end = (uint32_t)((long long)itemCount * (i + 1) / workerCount);
+        states[i].range.store(packRange(begin, end));
+        states[i].itemsDone = 0;
+        states[i].itemsStolen = 0;
+        states[i].wallSeconds = 0.0;
+        states[i].busySeconds = 0.0;
+        states[i].succeeded = 0;
+    }
+
+    // Flush buffered output so the children do not print it a second time.
+    std::cout << std::flush;
+    std::fflush(nullptr);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<pid_t> workers;
+    for (int i = 0; i < workerCount; ++i)
+    {
+        pid_t pid = fork();
+        if (pid == 0)
+        {
+            // Child: _exit skips the parent's atexit handlers and static destructors.
+            bool ok = runWorker(states, workerCount, i, work);
+            std::cout << std::flush;
+            std::fflush(nullptr);
+            _exit(ok ? 0 : 1);
+        }
+        if (pid < 0)
+        {
+            logError("Could not start render farm worker {}", i);
+            break;
+        }
+        workers.push_back(pid);
+    }
+
+    // A worker that failed to start leaves its items to be stolen by the others.
+    int failed = workerCount - (int)workers.size();
+    for (pid_t pid : workers)
+    {
+        int status = 0;
+        waitpid(pid, &status, 0);
+        if (!WIFEXITED(status) || WEXITSTATUS(status) != 0)
+            ++failed;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    int itemsDone = 0;
+    std::cout << "Render farm: " << workerCount << " workers, " << itemCount << " items in " << seconds << " s ("
+              << (seconds > 0.0 ? itemCount / seconds : 0.0) << " items/s)\n";
+    for (int i = 0; i < workerCount; ++i)
+    {
+        const FarmWorkerState &state = states[i];
+        itemsDone += state.itemsDone;
+        std::cout << "  worker " << i << ": " << state.itemsDone << " items (" << state.itemsStolen << " stolen), "
+                  << std::fixed << std::setprecision(3) << state.busySeconds << " s busy of " << state.wallSeconds << " s, "
+                  << (state.itemsDone > 0 ? state.busySeconds * 1000.0 / state.itemsDone : 0.0) << " ms/item"
+                  << (state.succeeded ? "" : "  FAILED") << std::defaultfloat << "\n";
+    }
+    std::cout << std::flush;
+    if (itemsDone < itemCount)
+        logError("{} items were not rendered", itemCount - itemsDone);
+
+    munmap(shared, sharedSize);
+    return failed;
+}
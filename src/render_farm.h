@@ -0,0 +1,22 @@
+#ifndef RENDER_FARM_H
+#define RENDER_FARM_H
+
+// Local render farm: splits a range of work items (frames, tiles) across forked worker processes.
+// Every worker starts with a contiguous share of the items in a shared-memory queue and takes them from
+// the front; a worker that runs dry steals the back half of the largest remaining share of another worker,
+// so uneven frames never leave cores idle. Each worker creates its own OpenGL context after the fork.
+#include <functional> // std::function for the worker body.
+
+// Returns the next item for the calling worker, or -1 once every item has been taken.
+using FarmClaimFunction = std::function<int()>;
+
+// Body of a worker process: set up a context, then render items until claim() returns -1.
+// workerIndex: 0 to workerCount - 1. Returns false if the worker failed.
+using FarmWorkerFunction = std::function<bool(int workerIndex, const FarmClaimFunction &claim)>;
+
+// Forks workerCount processes that share items 0 to itemCount - 1, waits for them and prints the
+// per-worker timings. Must be called before GLFW is initialized: the children must not inherit the
+// parent's display connection. Returns the number of workers that failed.
+int runRenderFarm(int workerCount, int itemCount, const FarmWorkerFunction &work);
+
+#endif
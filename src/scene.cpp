@@ -0,0 +1,171 @@
+#include "scene.h"
+#include "glad.h"                       // GLAD provides the OpenGL function pointers.
+#include "gl_debug.h"                   // Object labels and debug groups for frame captures.
+#include "gpu_memory.h"                 // Tracked buffer allocation.
+#include "vertex_pulling.h"             // Buffer textures of pulled meshes.
+#include <glm/gtc/matrix_transform.hpp> // Provides glm::translate for the model matrices.
+#include <glm/gtc/type_ptr.hpp>         // Provides glm::value_ptr to upload matrices.
+
+// Scene settings
+glm::vec3 sceneCenter = glm::vec3(0.0f, 0.0f, 0.0f); // Center of the scene, used for camera orientation.
+
+// Camera settings
+glm::vec3 cameraPositions[cameraPresetCount] = {
+    glm::vec3(0.0f, 0.0f, 10.0f), // Front view position of the camera.
+    glm::vec3(0.0f, 10.0f, 0.0f), // Top view position of the camera.
+    glm::vec3(10.0f, 0.0f, 0.0f)  // Side view position of the camera.
+};
+glm::vec3 cameraUpVectors[cameraPresetCount] = {
+    glm::vec3(0.0f, 1.0f, 0.0f),  // Up vector of the front view.
+    glm::vec3(0.0f, 0.0f, -1.0f), // Up vector of the top view, which looks straight down.
+    glm::vec3(0.0f, 1.0f, 0.0f)   // Up vector of the side view.
+};
+
+// Function to create the pyramid mesh.
+// Uploads the vertex and index data into GPU buffers and records the vertex layout in a VAO.
+PyramidMesh createPyramidMesh()
+{
+    // Define the vertices of our pyramid, including position and color data
+    float vertices[] = {
+        // Positions          // Colors
+        0.0f, 0.5f, 0.0f, 1.0f, 0.0f, 0.0f,   // Top vertex
+        -0.5f, -0.5f, 0.5f, 0.0f, 1.0f, 0.0f, // Front-left vertex
+        0.5f, -0.5f, 0.5f, 0.0f, 0.0f, 1.0f,  // Front-right vertex
+        0.5f, -0.5f, -0.5f, 1.0f, 1.0f, 0.0f, // Back-right vertex
+        -0.5f, -0.5f, -0.5f, 1.0f, 0.0f, 1.0f // Back-left vertex
+    };
+    // Define the indices for the pyramid, telling OpenGL which vertices make up each triangle
+    unsigned int indices[] = {
+        0, 1, 2, // Front face triangle
+        0, 2, 3, // Right face triangle
+        0, 3, 4, // Back face triangle
+        0, 4, 1, // Left face triangle
+        1, 2, 3, // Base right triangle
+        1, 3, 4  // Base left triangle
+    };
+
+    // Generate and bind the Vertex Array Object (VAO), Vertex Buffer Object (VBO), and Element Buffer Object (EBO)
+    PyramidMesh mesh;
+    mesh.VAO = UniqueVertexArray::create(); // Generates one Vertex Array Object
+    mesh.VBO = UniqueBuffer::create();      // Generates one Vertex Buffer Object
+    mesh.EBO = UniqueBuffer::create();      // Generates one Element Buffer Object
+
+    // Bind the Vertex Array Object first, then bind and set vertex buffer(s), and then configure vertex attribute(s).
+    glBindVertexArray(mesh.VAO.name());
+
+    // Copy our vertices array in a buffer for OpenGL to use
+    glBindBuffer(GL_ARRAY_BUFFER, mesh.VBO.name());
+    trackedBufferData(GL_ARRAY_BUFFER, mesh.VBO.name(), sizeof(vertices), vertices, GL_STATIC_DRAW, GpuMemoryCategory::Geometry, "pyramid mesh");
+
+    // Copy our index array in a buffer for OpenGL to use
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO.name());
+    trackedBufferData(GL_ELEMENT_ARRAY_BUFFER, mesh.EBO.name(), sizeof(indices), indices, GL_STATIC_DRAW, GpuMemoryCategory::Geometry, "pyramid mesh");
+
+    // Set our vertex attributes pointers
+    setPyramidVertexAttributes();
+
+    // Name the objects for frame captures and debug messages
+    labelGlObject(GL_VERTEX_ARRAY, mesh.VAO.name(), "pyramid mesh");
+    labelGlObject(GL_BUFFER, mesh.VBO.name(), "pyramid vertices");
+    labelGlObject(GL_BUFFER, mesh.EBO.name(), "pyramid indices");
+    return mesh;
+}
+
+// Function to describe the vertex layout of the pyramid geometry: interleaved positions and colors, 6 floats per vertex.
+// Expects the VAO and the VBO to be bound; streamed meshes use the same layout.
+void setPyramidVertexAttributes()
+{
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void *)0);                   // Position attribute
+    glEnableVertexAttribArray(0);                                                                    // Enable the position attribute
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), (void *)(3 * sizeof(float))); // Color attribute
+    glEnableVertexAttribArray(1);                                                                    // Enable the color attribute
+}
+
+// Function to release the GPU objects of the pyramid mesh.
+// They are deleted at a later frame boundary, once the GPU has finished the draws that use them.
+void destroyPyramidMesh(PyramidMesh &mesh)
+{
+    mesh = PyramidMesh(); // The owners release their objects; the handles become null, so the mesh cannot be released twice.
+}
+
+// Function to calculate the model matrix of a pyramid.
+// index: Which pyramid of the scene, from 0 to pyramidCount - 1.
+glm::mat4 pyramidModelMatrix(int index)
+{
+    glm::mat4 model = glm::mat4(1.0f);                                         // Start with the identity matrix
+    model = glm::translate(model, glm::vec3(index * 2.0f - 2.0f, 0.0f, 0.0f)); // Move pyramids along x-axis
+    return model;
+}
+
+// Function to calculate the view matrix of a camera preset.
+// preset: 0 for the front, 1 for the top and 2 for the side view.
+glm::mat4 cameraPresetViewMatrix(int preset)
+{
+    return glm::lookAt(cameraPositions[preset], sceneCenter, cameraUpVectors[preset]);
+}
+
+// Function to draw every pyramid of the scene.
+// shaderProgram: Program built from vertex_shader.glsl and fragment_shader.glsl.
+// view, projection: Camera matrices of the view being rendered.
+// materials: Texture array sampled by a program built with TEXTURED defined; nullptr or empty for plain colors.
+// pulled: Buffer textures of the mesh, read by a program built with VERTEX_PULLING defined; nullptr or empty to
+// draw the mesh's VAO.
+void drawPyramids(unsigned int shaderProgram, const PyramidMesh &mesh, const glm::mat4 &view, const glm::mat4 &projection,
+                  const PyramidMaterials *materials, const PulledMesh *pulled)
+{
+    GlDebugGroup group("pyramids");
+
+    // Use the shader program
+    glUseProgram(shaderProgram);
+
+    // Pass the camera matrices to the shader
+    unsigned int viewLoc = glGetUniformLocation(shaderProgram, "view");
+    glUniformMatrix4fv(viewLoc, 1, GL_FALSE, glm::value_ptr(view));
+    unsigned int projLoc = glGetUniformLocation(shaderProgram, "projection");
+    glUniformMatrix4fv(projLoc, 1, GL_FALSE, glm::value_ptr(projection));
+
+    // Bind the material array once; the pyramids only differ in the layer (or atlas rectangle) they sample
+    bool textured = materials != nullptr && materials->layerCount > 0;
+    bool atlas = textured && !materials->atlasRects.empty();
+    unsigned int layerLoc = 0;
+    unsigned int rectLoc = 0;
+    if (textured)
+    {
+        layerLoc = glGetUniformLocation(shaderProgram, "materialLayer");
+        rectLoc = glGetUniformLocation(shaderProgram, "materialRect");
+        glActiveTexture(GL_TEXTURE0);
+        glBindTexture(GL_TEXTURE_2D_ARRAY, materials->array.name());
+        glUniform1i(glGetUniformLocation(shaderProgram, "materials"), 0);
+        if (!atlas)
+            glUniform4f(rectLoc, 1.0f, 1.0f, 0.0f, 0.0f); // The whole layer
+    }
+
+    // A pulled mesh has no index buffer to draw from: vertex i of the draw fetches index i itself
+    bool pulling = pulled != nullptr && pulled->indexCount > 0;
+    if (pulled != nullptr)
+        bindPulledMesh(shaderProgram, *pulled);
+
+    for (int i = 0; i < pyramidCount; ++i) // Iterate through each pyramid
+    {
+        // Calculate the model matrix for each pyramid and pass it to shader before drawing
+        glm::mat4 model = pyramidModelMatrix(i);
+        unsigned int modelLoc = glGetUniformLocation(shaderProgram, "model");
+        glUniformMatrix4fv(modelLoc, 1, GL_FALSE, glm::value_ptr(model));
+        if (atlas)
+        {
+            const glm::vec4 &rect = materials->atlasRects[i % materials->atlasRects.size()];
+            glUniform1i(layerLoc, 0);
+            glUniform4f(rectLoc, rect.x, rect.y, rect.z, rect.w);
+        }
+        else if (textured)
+            glUniform1i(layerLoc, i % materials->layerCount);
+
+        if (pulling)
+            glDrawArrays(GL_TRIANGLES, 0, pulled->indexCount);                // Draw the pyramid from the buffer textures
+        else
+        {
+            glBindVertexArray(mesh.VAO.name());                                // Bind the VAO (it was already bound, but doing so in case it changed)
+            glDrawElements(GL_TRIANGLES, mesh.indexCount, GL_UNSIGNED_INT, 0); // Draw the pyramid
+        }
+    }
+}
@@ -0,0 +1,52 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+// The pyramid scene shared by every rendering path (interactive, multi-view and offline).
+#include "gl_objects.h" // Owners of the mesh's GPU objects.
+#include <glm/glm.hpp>  // GLM provides the vector and matrix types used for the scene transforms.
+#include <vector>       // Atlas rectangles.
+
+// Scene settings
+extern glm::vec3 sceneCenter; // Center of the scene, used for camera orientation.
+
+// Camera presets: front, top and side view
+const int cameraPresetCount = 3;
+extern glm::vec3 cameraPositions[cameraPresetCount]; // Position of the camera for each preset.
+extern glm::vec3 cameraUpVectors[cameraPresetCount]; // Up vector of the camera for each preset.
+
+// Number of pyramids drawn in the scene.
+const int pyramidCount = 3;
+
+// Number of indices needed to draw one pyramid (four side faces and a base made of two triangles).
+const int pyramidIndexCount = 18;
+
+// GPU objects holding the pyramid geometry. Move-only; the objects are deleted when the mesh goes away.
+struct PyramidMesh
+{
+    UniqueVertexArray VAO; // Vertex Array Object describing the vertex layout.
+    UniqueBuffer VBO;      // Vertex Buffer Object holding positions and colors.
+    UniqueBuffer EBO;      // Element Buffer Object holding the triangle indices.
+    int indexCount = pyramidIndexCount; // Indices drawn per pyramid; streamed meshes (asset_streamer.h) have more.
+};
+
+struct PulledMesh; // vertex_pulling.h
+
+// Material textures of the pyramids: a 2D texture array with one material per layer, so every pyramid gets its own
+// without a texture bind between the draws. Loaded by the asset streamer (asset_streamer.h).
+struct PyramidMaterials
+{
+    UniqueTexture array; // GL_TEXTURE_2D_ARRAY of compressed images.
+    int layerCount = 0;  // Pyramid i uses layer i % layerCount; 0 while nothing is loaded.
+    std::vector<glm::vec4> atlasRects; // If not empty, layer 0 is an atlas and pyramid i uses rect i % size (atlasUvTransform).
+};
+
+PyramidMesh createPyramidMesh();              // Uploads the pyramid vertices and indices and configures the vertex attributes.
+void setPyramidVertexAttributes();            // Position and color attributes of the bound VBO, recorded in the bound VAO.
+void destroyPyramidMesh(PyramidMesh &mesh);   // Releases the GPU objects of the pyramid mesh before the mesh goes away.
+glm::mat4 pyramidModelMatrix(int index);      // Returns the model matrix of the pyramid with the given index.
+glm::mat4 cameraPresetViewMatrix(int preset); // Returns the view matrix of a camera preset looking at the scene center.
+void drawPyramids(unsigned int shaderProgram, const PyramidMesh &mesh, const glm::mat4 &view, const glm::mat4 &projection,
+                  const PyramidMaterials *materials = nullptr, // Draws every pyramid with the basic shader program, textured if materials are given,
+                  const PulledMesh *pulled = nullptr);         // pulled from buffer textures by a VERTEX_PULLING program if pulled is given.
+
+#endif
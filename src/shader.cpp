@@ -0,0 +1,165 @@
+#include "shader.h"
+#include "glad.h"       // GLAD provides the OpenGL function pointers.
+#include "logger.h"     // Error messages.
+#include "asset_pack.h" // Files of the mounted asset pack.
+#include <fstream>      // File stream, used for reading shader files.
+#include <sstream>      // String stream, used for buffering string data read from files.
+#include <alloca.h>     // alloca, used for the temporary info log buffers.
+
+// Function to read shader source code from a file.
+// filePath: Path to the shader file; looked up in the mounted asset pack first.
+std::string readFile(const char *filePath)
+{
+    // Files of the mounted asset pack are decompressed from memory, without touching the disk
+    if (const AssetPack *pack = mountedAssetPack())
+        if (const AssetPackEntry *entry = pack->find(filePath))
+        {
+            std::string packed(entry->size, '\0');
+            if (pack->extract(*entry, &packed[0]))
+                return packed;
+        }
+
+    // Create an input file stream for reading the file.
+    std::ifstream fileStream(filePath, std::ios::in);
+    std::string content; // String to hold the contents of the file.
+
+    // Check if the file stream was successfully opened.
+    if (!fileStream.is_open())
+    {
+        // If the file cannot be opened (e.g., does not exist), print an error message.
+        logError("Could not read file {}. File does not exist.", filePath);
+        return ""; // Return an empty string as an error indication.
+    }
+
+    // Use a string stream to read the entire contents of the file into the 'content' string.
+    std::stringstream sstr;
+    sstr << fileStream.rdbuf();
+    content = sstr.str();
+    fileStream.close(); // Close the file stream.
+
+    return content; // Return the contents of the file as a string.
+}
+
+// Function to insert preprocessor definitions into a shader source.
+// GLSL requires #version to be the first statement, so the definitions are placed on the line after it.
+// source: The shader source code as a string.
+// defines: One or more complete preprocessor lines, e.g. "#define MAX_VIEWS 4\n".
+std::string addShaderDefines(const std::string &source, const std::string &defines)
+{
+    std::string::size_type versionPos = source.find("#version");
+    if (versionPos == std::string::npos)
+        return defines + source; // No version directive, the definitions can simply go first.
+
+    std::string::size_type lineEnd = source.find('\n', versionPos);
+    if (lineEnd == std::string::npos)
+        return source + "\n" + defines;
+
+    return source.substr(0, lineEnd + 1) + defines + source.substr(lineEnd + 1);
+}
+
+// Function to compile a shader from source code.
+// type: The type of shader (GL_VERTEX_SHADER, GL_GEOMETRY_SHADER or GL_FRAGMENT_SHADER).
+// source: The shader source code as a string.
+unsigned int compileShader(unsigned int type, const std::string &source)
+{
+    // Create a shader object.
+    unsigned int id = glCreateShader(type);
+    const char *src = source.c_str();     // Convert the source string to a C-style string.
+    glShaderSource(id, 1, &src, nullptr); // Attach the shader source code to the shader object.
+    glCompileShader(id);                  // Compile the shader.
+
+    // Check for compilation errors.
+    int result;
+    glGetShaderiv(id, GL_COMPILE_STATUS, &result);
+    if (!result)
+    {
+        // If an error occurred during compilation, query the error message length.
+        int length;
+        glGetShaderiv(id, GL_INFO_LOG_LENGTH, &length);
+        // Allocate memory on the stack for the error message.
+        char *message = (char *)alloca(length * sizeof(char));
+        // Retrieve the error message.
+        glGetShaderInfoLog(id, length, &length, message);
+        // Print the error message.
+        const char *typeName = type == GL_VERTEX_SHADER ? "vertex" : (type == GL_GEOMETRY_SHADER ? "geometry" : "fragment");
+        logError("Failed to compile {} shader!\n{}", typeName, message);
+        glDeleteShader(id); // Delete the shader object to free resources.
+        return 0;           // Return 0 as an error indication.
+    }
+
+    return id; // Return the shader object ID.
+}
+
+// Function to link the shaders attached to a program and report link errors.
+// Returns the program on success, or 0 after deleting the program if linking failed.
+static unsigned int linkShaderProgram(unsigned int program)
+{
+    // Link the shader program to create an executable for the GPU.
+    glLinkProgram(program);
+
+    // Check for link errors, e.g. mismatched interfaces between the stages.
+    int result;
+    glGetProgramiv(program, GL_LINK_STATUS, &result);
+    if (!result)
+    {
+        int length;
+        glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+        char *message = (char *)alloca((length + 1) * sizeof(char));
+        message[0] = '\0';
+        glGetProgramInfoLog(program, length, &length, message);
+        logError("Failed to link shader program!\n{}", message);
+        glDeleteProgram(program);
+        return 0;
+    }
+
+    // Perform validation on the shader program.
+    glValidateProgram(program);
+    return program;
+}
+
+// Function to create a shader program by linking a vertex and a fragment shader.
+// vertexShader: The vertex shader source code as a string.
+// fragmentShader: The fragment shader source code as a string.
+unsigned int createShaderProgram(const std::string &vertexShader, const std::string &fragmentShader)
+{
+    // Create a shader program object.
+    unsigned int program = glCreateProgram();
+    // Compile the vertex and fragment shaders from their source code.
+    unsigned int vs = compileShader(GL_VERTEX_SHADER, vertexShader);
+    unsigned int fs = compileShader(GL_FRAGMENT_SHADER, fragmentShader);
+
+    // Attach the compiled shaders to the shader program.
+    glAttachShader(program, vs);
+    glAttachShader(program, fs);
+    program = linkShaderProgram(program);
+
+    // Delete the shader objects now that they are linked into the program; they are no longer needed.
+    glDeleteShader(vs);
+    glDeleteShader(fs);
+
+    return program; // Return the shader program object ID.
+}
+
+// Function to create a shader program by linking a vertex, a geometry and a fragment shader.
+// vertexShader: The vertex shader source code as a string.
+// geometryShader: The geometry shader source code as a string.
+// fragmentShader: The fragment shader source code as a string.
+unsigned int createShaderProgram(const std::string &vertexShader, const std::string &geometryShader,
+                                 const std::string &fragmentShader)
+{
+    unsigned int program = glCreateProgram();
+    unsigned int vs = compileShader(GL_VERTEX_SHADER, vertexShader);
+    unsigned int gs = compileShader(GL_GEOMETRY_SHADER, geometryShader);
+    unsigned int fs = compileShader(GL_FRAGMENT_SHADER, fragmentShader);
+
+    glAttachShader(program, vs);
+    glAttachShader(program, gs);
+    glAttachShader(program, fs);
+    program = linkShaderProgram(program);
+
+    glDeleteShader(vs);
+    glDeleteShader(gs);
+    glDeleteShader(fs);
+
+    return program;
+}
@@ -0,0 +1,14 @@
+#ifndef SHADER_H
+#define SHADER_H
+
+// Helpers for loading, compiling and linking GLSL shader programs.
+#include <string> // Used for string operations.
+
+std::string readFile(const char *filePath);                                                           // Reads the content of a file and returns it as a string.
+std::string addShaderDefines(const std::string &source, const std::string &defines);                  // Inserts preprocessor lines right after the #version directive.
+unsigned int compileShader(unsigned int type, const std::string &source);                             // Compiles a shader from source code.
+unsigned int createShaderProgram(const std::string &vertexShader, const std::string &fragmentShader); // Links vertex and fragment shaders into a shader program.
+unsigned int createShaderProgram(const std::string &vertexShader, const std::string &geometryShader,
+                                 const std::string &fragmentShader);                                  // Links vertex, geometry and fragment shaders into a shader program.
+
+#endif
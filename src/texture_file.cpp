@@ -0,0 +1,290 @@
+#include "texture_file.h"
+#include "logger.h" // Rejected files.
+#include <cstdint>  // Header fields.
+#include <cstring>  // std::memcpy, std::memcmp.
+
+// What a compressed format needs from the driver beyond OpenGL 3.3, which only has RGTC (BC4 and BC5) in core.
+enum class FormatRequirement
+{
+    Core,
+    S3tc,     // EXT_texture_compression_s3tc: BC1 to BC3.
+    S3tcSrgb, // And EXT_texture_sRGB for their sRGB variants.
+    Bptc      // ARB_texture_compression_bptc: BC6H and BC7.
+};
+
+struct CompressedFormat
+{
+    GLenum format;
+    const char *name;
+    int blockBytes; // Per 4x4 block.
+    FormatRequirement requirement;
+};
+
+static const CompressedFormat compressedFormats[] = {
+    {GL_COMPRESSED_RGB_S3TC_DXT1_EXT, "BC1", 8, FormatRequirement::S3tc},
+    {GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, "BC1", 8, FormatRequirement::S3tc},
+    {GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT, "BC1", 8, FormatRequirement::S3tcSrgb},
+    {GL_COMPRESSED_RGBA_S3TC_DXT3_EXT, "BC2", 16, FormatRequirement::S3tc},
+    {GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT, "BC2", 16, FormatRequirement::S3tcSrgb},
+    {GL_COMPRESSED_RGBA_S3TC_DXT5_EXT, "BC3", 16, FormatRequirement::S3tc},
+    {GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT, "BC3", 16, FormatRequirement::S3tcSrgb},
+    {GL_COMPRESSED_RED_RGTC1, "BC4", 8, FormatRequirement::Core},
+    {GL_COMPRESSED_SIGNED_RED_RGTC1, "BC4", 8, FormatRequirement::Core},
+    {GL_COMPRESSED_RG_RGTC2, "BC5", 16, FormatRequirement::Core},
+    {GL_COMPRESSED_SIGNED_RG_RGTC2, "BC5", 16, FormatRequirement::Core},
+    {GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT_ARB, "BC6H", 16, FormatRequirement::Bptc},
+    {GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT_ARB, "BC6H", 16, FormatRequirement::Bptc},
+    {GL_COMPRESSED_RGBA_BPTC_UNORM_ARB, "BC7", 16, FormatRequirement::Bptc},
+    {GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM_ARB, "BC7", 16, FormatRequirement::Bptc},
+};
+
+static const CompressedFormat *findFormat(GLenum format)
+{
+    for (const CompressedFormat &entry : compressedFormats)
+        if (entry.format == format)
+            return &entry;
+    return nullptr;
+}
+
+static uint32_t read32(const std::string &contents, size_t offset)
+{
+    uint32_t value;
+    std::memcpy(&value, contents.data() + offset, sizeof(value));
+    return value;
+}
+
+static uint32_t fourCc(const char code[5])
+{
+    return (uint32_t)(unsigned char)code[0] | (uint32_t)(unsigned char)code[1] << 8 |
+           (uint32_t)(unsigned char)code[2] << 16 | (uint32_t)(unsigned char)code[3] << 24;
+}
+
+// Function to translate the format code of a DDS file: a FourCC of the legacy header, or the DXGI_FORMAT of the DX10 header.
+// Returns 0 for formats that are not block-compressed.
+static GLenum ddsFormat(uint32_t code, bool dxgi)
+{
+    if (dxgi)
+        switch (code)
+        {
+        case 71: return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;              // DXGI_FORMAT_BC1_UNORM
+        case 72: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT;        // DXGI_FORMAT_BC1_UNORM_SRGB
+        case 74: return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;              // DXGI_FORMAT_BC2_UNORM
+        case 75: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT;        // DXGI_FORMAT_BC2_UNORM_SRGB
+        case 77: return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;              // DXGI_FORMAT_BC3_UNORM
+        case 78: return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;        // DXGI_FORMAT_BC3_UNORM_SRGB
+        case 80: return GL_COMPRESSED_RED_RGTC1;                       // DXGI_FORMAT_BC4_UNORM
+        case 81: return GL_COMPRESSED_SIGNED_RED_RGTC1;                // DXGI_FORMAT_BC4_SNORM
+        case 83: return GL_COMPRESSED_RG_RGTC2;                        // DXGI_FORMAT_BC5_UNORM
+        case 84: return GL_COMPRESSED_SIGNED_RG_RGTC2;                 // DXGI_FORMAT_BC5_SNORM
+        case 95: return GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT_ARB;     // DXGI_FORMAT_BC6H_UF16
+        case 96: return GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT_ARB;       // DXGI_FORMAT_BC6H_SF16
+        case 98: return GL_COMPRESSED_RGBA_BPTC_UNORM_ARB;             // DXGI_FORMAT_BC7_UNORM
+        case 99: return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM_ARB;       // DXGI_FORMAT_BC7_UNORM_SRGB
+        default: return 0;
+        }
+    if (code == fourCc("DXT1"))
+        return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+    if (code == fourCc("DXT2") || code == fourCc("DXT3")) // DXT2 is premultiplied; the blocks are the same
+        return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+    if (code == fourCc("DXT4") || code == fourCc("DXT5"))
+        return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+    if (code == fourCc("ATI1") || code == fourCc("BC4U"))
+        return GL_COMPRESSED_RED_RGTC1;
+    if (code == fourCc("BC4S"))
+        return GL_COMPRESSED_SIGNED_RED_RGTC1;
+    if (code == fourCc("ATI2") || code == fourCc("BC5U"))
+        return GL_COMPRESSED_RG_RGTC2;
+    if (code == fourCc("BC5S"))
+        return GL_COMPRESSED_SIGNED_RG_RGTC2;
+    return 0;
+}
+
+// Function to check that an image is block-compressed and that its size and mipmap chain are sane.
+static bool checkImage(const std::string &path, const TextureImage &image)
+{
+    if (findFormat(image.format) == nullptr)
+    {
+        logError("{} is not block-compressed (BC1 to BC7); only compressed textures are loaded", path);
+        return false;
+    }
+    int longestEdge = image.width > image.height ? image.width : image.height;
+    int fullChain = 1;
+    while ((longestEdge >> fullChain) > 0)
+        ++fullChain;
+    if (image.width <= 0 || image.height <= 0 || image.width > 16384 || image.height > 16384 || image.layers <= 0 ||
+        image.layers > 2048 || image.levels <= 0 || image.levels > fullChain)
+    {
+        logError("{} has an unsupported size: {}x{}, {} levels, {} layers", path, image.width, image.height, image.levels, image.layers);
+        return false;
+    }
+    return true;
+}
+
+// Function to parse a DDS file: "DDS ", the 124-byte DDS_HEADER, the DDS_HEADER_DXT10 if the FourCC is "DX10",
+// then every layer's mipmap chain.
+static bool parseDds(const std::string &path, const std::string &contents, TextureImage &image)
+{
+    const size_t headerEnd = 4 + 124;
+    const uint32_t mipmapCountFlag = 0x20000; // DDSD_MIPMAPCOUNT
+    const uint32_t fourCcFlag = 0x4;          // DDPF_FOURCC
+    const uint32_t cubemapOrVolume = 0x200 | 0x200000;
+    if (contents.size() < headerEnd || read32(contents, 4) != 124)
+    {
+        logError("{} has no valid DDS header", path);
+        return false;
+    }
+    uint32_t flags = read32(contents, 8);
+    image.height = (int)read32(contents, 12);
+    image.width = (int)read32(contents, 16);
+    uint32_t mipmapCount = read32(contents, 28);
+    image.levels = (flags & mipmapCountFlag) && mipmapCount > 0 ? (int)mipmapCount : 1;
+    image.layers = 1;
+    uint32_t pixelFlags = read32(contents, 80);
+    uint32_t code = read32(contents, 84);
+    if ((read32(contents, 112) & cubemapOrVolume) != 0 || !(pixelFlags & fourCcFlag))
+    {
+        logError("{} is a cube map, a volume or uncompressed; only compressed 2D textures are loaded", path);
+        return false;
+    }
+
+    size_t dataStart = headerEnd;
+    if (code == fourCc("DX10"))
+    {
+        const uint32_t texture2d = 3; // D3D10_RESOURCE_DIMENSION_TEXTURE2D
+        const uint32_t cubemap = 0x4; // D3D10_RESOURCE_MISC_TEXTURECUBE
+        dataStart += 20;
+        if (contents.size() < dataStart || read32(contents, headerEnd + 4) != texture2d || (read32(contents, headerEnd + 8) & cubemap))
+        {
+            logError("{} is not a 2D texture", path);
+            return false;
+        }
+        image.format = ddsFormat(read32(contents, headerEnd), true);
+        image.layers = (int)read32(contents, headerEnd + 12);
+    }
+    else
+        image.format = ddsFormat(code, false);
+    if (!checkImage(path, image))
+        return false;
+
+    // Every layer is a complete mipmap chain
+    size_t offset = dataStart;
+    image.offsets.clear();
+    for (int layer = 0; layer < image.layers; ++layer)
+        for (int level = 0; level < image.levels; ++level)
+        {
+            image.offsets.push_back(offset);
+            offset += (size_t)compressedImageSize(image.format, image.width >> level, image.height >> level);
+        }
+    if (offset > contents.size())
+    {
+        logError("{} is truncated: {} bytes of images, {} in the file", path, offset - dataStart, contents.size() - dataStart);
+        return false;
+    }
+    return true;
+}
+
+// Function to parse a KTX 1 file: the identifier, 13 header fields in the byte order of the writer, key/value
+// data, then per level an image size followed by the images of every layer.
+static bool parseKtx(const std::string &path, const std::string &contents, TextureImage &image)
+{
+    const size_t headerEnd = 12 + 13 * 4;
+    if (contents.size() < headerEnd)
+    {
+        logError("{} has no valid KTX header", path);
+        return false;
+    }
+    bool swapped = read32(contents, 12) == 0x01020304; // Written on a machine of the other byte order
+    auto field = [&](size_t offset)
+    {
+        uint32_t value = read32(contents, offset);
+        return swapped ? (value >> 24) | ((value >> 8) & 0xFF00) | ((value << 8) & 0xFF0000) | (value << 24) : value;
+    };
+    if (!swapped && read32(contents, 12) != 0x04030201)
+    {
+        logError("{} has no valid KTX header", path);
+        return false;
+    }
+    uint32_t glType = field(16);
+    image.format = glType == 0 ? field(28) : 0; // Compressed images have no type
+    image.width = (int)field(36);
+    image.height = (int)field(40);
+    uint32_t depth = field(44);
+    image.layers = field(48) > 0 ? (int)field(48) : 1;
+    uint32_t faces = field(52);
+    image.levels = field(56) > 0 ? (int)field(56) : 1; // 0 asks the loader to generate them, which compressed data cannot
+    uint32_t keyValueBytes = field(60);
+    if (depth > 1 || faces != 1)
+    {
+        logError("{} is a cube map or a volume; only compressed 2D textures are loaded", path);
+        return false;
+    }
+    if (!checkImage(path, image))
+        return false;
+
+    // KTX stores the levels one after the other, each with all its layers and preceded by its size
+    size_t offset = headerEnd + (size_t)keyValueBytes;
+    image.offsets.assign((size_t)image.layers * image.levels, 0);
+    for (int level = 0; level < image.levels; ++level)
+    {
+        size_t layerSize = (size_t)compressedImageSize(image.format, image.width >> level, image.height >> level);
+        if (offset + 4 > contents.size() || field(offset) != layerSize * image.layers ||
+            offset + 4 + layerSize * image.layers > contents.size())
+        {
+            logError("{} is truncated or has a wrong image size at level {}", path, level);
+            return false;
+        }
+        offset += 4;
+        for (int layer = 0; layer < image.layers; ++layer)
+        {
+            image.offsets[layer * image.levels + level] = offset;
+            offset += layerSize;
+        }
+        offset = (offset + 3) & ~(size_t)3; // mipPadding
+    }
+    return true;
+}
+
+// Function to parse a texture file, picking the format by the magic at its start.
+// path: For messages. contents: The whole file; image.offsets point into it.
+bool parseTextureFile(const std::string &path, const std::string &contents, TextureImage &image)
+{
+    static const unsigned char ktxIdentifier[12] = {0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n'};
+    if (contents.size() >= 4 && std::memcmp(contents.data(), "DDS ", 4) == 0)
+        return parseDds(path, contents, image);
+    if (contents.size() >= sizeof(ktxIdentifier) && std::memcmp(contents.data(), ktxIdentifier, sizeof(ktxIdentifier)) == 0)
+        return parseKtx(path, contents, image);
+    logError("{} is neither a DDS nor a KTX file", path);
+    return false;
+}
+
+// Function to calculate the size of one compressed image. Dimensions below 4 pixels still take a whole block.
+long long compressedImageSize(GLenum format, int width, int height)
+{
+    const CompressedFormat *entry = findFormat(format);
+    long long blocksWide = width > 4 ? (width + 3) / 4 : 1;
+    long long blocksHigh = height > 4 ? (height + 3) / 4 : 1;
+    return blocksWide * blocksHigh * (entry != nullptr ? entry->blockBytes : 16);
+}
+
+// Function to check whether the driver can sample a compressed format. Reads the extension flags of the last
+// context glad loaded; every context of the program runs on the same driver.
+bool compressedFormatSupported(GLenum format)
+{
+    const CompressedFormat *entry = findFormat(format);
+    if (entry == nullptr)
+        return false;
+    switch (entry->requirement)
+    {
+    case FormatRequirement::Core: return true;
+    case FormatRequirement::S3tc: return GLAD_GL_EXT_texture_compression_s3tc != 0;
+    case FormatRequirement::S3tcSrgb: return GLAD_GL_EXT_texture_compression_s3tc != 0 && GLAD_GL_EXT_texture_sRGB != 0;
+    case FormatRequirement::Bptc: return GLAD_GL_ARB_texture_compression_bptc != 0;
+    }
+    return false;
+}
+
+const char *compressedFormatName(GLenum format)
+{
+    const CompressedFormat *entry = findFormat(format);
+    return entry != nullptr ? entry->name : "uncompressed";
+}
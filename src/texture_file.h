@@ -0,0 +1,30 @@
+#ifndef TEXTURE_FILE_H
+#define TEXTURE_FILE_H
+
+// Pre-compressed texture files: DDS (including the DX10 header for BC6H and BC7) and KTX version 1.
+// Only block-compressed 2D images are accepted (BC1 to BC7, also known as DXT1/3/5, RGTC and BPTC). They stay
+// compressed on the GPU, 4 to 8 times smaller than RGBA8, so the files are uploaded as they are: parsing only
+// locates the images inside the file contents and never converts or copies pixels.
+#include "glad.h" // GLenum and the compressed format enums.
+#include <string> // File contents.
+#include <vector> // Image offsets.
+
+struct TextureImage
+{
+    GLenum format = 0; // Compressed internal format, e.g. GL_COMPRESSED_RGBA_BPTC_UNORM_ARB.
+    int width = 0;     // Of the first mipmap level, in pixels.
+    int height = 0;
+    int levels = 0;    // Mipmap levels in the file.
+    int layers = 0;    // Array layers in the file; 1 for a plain 2D texture.
+    std::vector<size_t> offsets; // Start of every image in the contents, by layer * levels + level.
+};
+
+// Parses the header of a DDS or KTX file (recognized by its magic) and checks that every image lies inside contents.
+// Logs the reason and returns false if the file is damaged or not a block-compressed 2D texture.
+bool parseTextureFile(const std::string &path, const std::string &contents, TextureImage &image);
+
+long long compressedImageSize(GLenum format, int width, int height); // Bytes of one image: 4x4 blocks of 8 or 16 bytes.
+bool compressedFormatSupported(GLenum format);                        // Whether the loaded context can sample the format.
+const char *compressedFormatName(GLenum format);                      // "BC1" to "BC7", for messages.
+
+#endif
@@ -0,0 +1,483 @@
+#include "texture_processing.h"
+#include <algorithm>          // std::min, std::max, std::sort and std::upper_bound.
+#include <atomic>             // Task counters of the parallel loops.
+#include <climits>            // INT_MAX.
+#include <cmath>              // std::pow, std::sin and std::sqrt for the filter weights and sRGB curves.
+#include <condition_variable> // Waits for the helpers of a parallel loop.
+#include <cstring>            // std::strcmp, std::memcpy.
+#include <functional>         // Tasks of the parallel loops.
+#include <memory>             // Shares the loop state with late helpers.
+#include <mutex>              // Guards the end of a parallel loop.
+#if defined(__SSE2__)
+#include <emmintrin.h> // SSE2 intrinsics, available on every x86-64 compiler.
+#endif
+
+static const int bandRows = 32; // Output rows filtered per task.
+
+// Function to parse a mipmap filter name.
+bool parseMipFilter(const char *name, MipFilter &filter)
+{
+    if (std::strcmp(name, "box") == 0)
+        filter = MipFilter::Box;
+    else if (std::strcmp(name, "kaiser") == 0)
+        filter = MipFilter::Kaiser;
+    else
+        return false;
+    return true;
+}
+
+// Function to run task(0) to task(count - 1) on the calling thread and on the workers.
+// The caller takes tasks like the helpers do, so it never waits for a job that is still queued, and a job of the
+// same pool may call it without a deadlock. Helpers that start after the loop has ended find no task left.
+static void parallelFor(WorkerPool &workers, int count, const std::function<void(int)> &task)
+{
+    struct Loop
+    {
+        std::function<void(int)> task;
+        int count = 0;
+        std::atomic<int> next{0};
+        std::atomic<int> done{0};
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+    auto loop = std::make_shared<Loop>();
+    loop->task = task;
+    loop->count = count;
+    auto run = [loop]
+    {
+        for (int i = loop->next.fetch_add(1); i < loop->count; i = loop->next.fetch_add(1))
+        {
+            loop->task(i);
+            if (loop->done.fetch_add(1) + 1 == loop->count)
+            {
+                std::lock_guard<std::mutex> lock(loop->mutex);
+                loop->finished.notify_all();
+            }
+        }
+    };
+    for (int helper = 0; helper < std::min(workers.threadCount(), count - 1); ++helper)
+        workers.submit(run);
+    run();
+    std::unique_lock<std::mutex> lock(loop->mutex);
+    loop->finished.wait(lock, [&loop] { return loop->done.load() == loop->count; });
+}
+
+// sRGB transfer curves: decoding by table, encoding by searching the table of the midpoints between the codes,
+// which rounds exactly where the sRGB curve puts the boundary between two codes.
+struct SrgbTables
+{
+    float decode[256];
+    float midpoints[255]; // Linear value halfway between code i and i + 1, in sRGB terms.
+
+    SrgbTables()
+    {
+        for (int i = 0; i < 256; ++i)
+            decode[i] = toLinear(i / 255.0);
+        for (int i = 0; i < 255; ++i)
+            midpoints[i] = toLinear((i + 0.5) / 255.0);
+    }
+    static float toLinear(double value)
+    {
+        return (float)(value <= 0.04045 ? value / 12.92 : std::pow((value + 0.055) / 1.055, 2.4));
+    }
+};
+
+static const SrgbTables &srgbTables()
+{
+    static const SrgbTables tables; // Built once, thread-safe since C++11.
+    return tables;
+}
+
+static inline unsigned char encodeSrgb(const SrgbTables &tables, float value)
+{
+    return (unsigned char)(std::upper_bound(tables.midpoints, tables.midpoints + 255, value) - tables.midpoints);
+}
+
+static inline unsigned char encodeLinear(float value)
+{
+    return (unsigned char)std::min(std::max((int)(value * 255.0f + 0.5f), 0), 255);
+}
+
+// Separable downsampling kernel: output texel x reads input texels factor * x + first + t, t < taps.
+struct Kernel
+{
+    int first = 0;
+    int taps = 1;
+    float weights[12] = {1.0f};
+};
+
+// Function to compute the modified Bessel function I0, for the Kaiser window.
+static double besselI0(double x)
+{
+    double sum = 1.0, term = 1.0;
+    for (int k = 1; k < 50 && term > 1e-12 * sum; ++k)
+    {
+        double factor = x / (2.0 * k);
+        term *= factor * factor;
+        sum += term;
+    }
+    return sum;
+}
+
+// Function to build the kernel that halves an axis.
+// The output texel x is centered on input position 2x + 1, between the texels 2x and 2x + 1. The Kaiser
+// filter (width 3 output texels, alpha 4) windows a sinc over the input texels 2x - 5 to 2x + 6.
+static Kernel halvingKernel(MipFilter filter)
+{
+    Kernel kernel;
+    if (filter == MipFilter::Box)
+    {
+        kernel.first = 0;
+        kernel.taps = 2;
+        kernel.weights[0] = kernel.weights[1] = 0.5f;
+        return kernel;
+    }
+    const double width = 3.0, alpha = 4.0, pi = 3.14159265358979323846;
+    kernel.first = -5;
+    kernel.taps = 12;
+    double total = 0.0;
+    for (int t = 0; t < kernel.taps; ++t)
+    {
+        double distance = (kernel.first + t - 0.5) / 2.0; // In output texels
+        double sinc = std::sin(pi * distance) / (pi * distance);
+        double window = distance / width;
+        double weight = sinc * besselI0(alpha * std::sqrt(std::max(0.0, 1.0 - window * window))) / besselI0(alpha);
+        kernel.weights[t] = (float)weight;
+        total += weight;
+    }
+    for (int t = 0; t < kernel.taps; ++t)
+        kernel.weights[t] = (float)(kernel.weights[t] / total);
+    return kernel;
+}
+
+// Function to filter one row horizontally, one RGBA texel per vector. Reads past the edges are clamped.
+// input: inWidth texels of 4 floats. output: outWidth texels.
+static void filterRow(const float *input, int inWidth, float *output, int outWidth, int factor, const Kernel &kernel)
+{
+    for (int x = 0; x < outWidth; ++x)
+    {
+        int start = factor * x + kernel.first;
+#if defined(__SSE2__)
+        __m128 sum = _mm_setzero_ps();
+        for (int t = 0; t < kernel.taps; ++t)
+        {
+            int i = std::min(std::max(start + t, 0), inWidth - 1);
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(kernel.weights[t]), _mm_loadu_ps(input + i * 4)));
+        }
+        _mm_storeu_ps(output + x * 4, sum);
+#else
+        float sum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        for (int t = 0; t < kernel.taps; ++t)
+        {
+            const float *texel = input + std::min(std::max(start + t, 0), inWidth - 1) * 4;
+            for (int c = 0; c < 4; ++c)
+                sum[c] += kernel.weights[t] * texel[c];
+        }
+        for (int c = 0; c < 4; ++c)
+            output[x * 4 + c] = sum[c];
+#endif
+    }
+}
+
+// Function to blend whole rows: output = sum of weights[t] * rows[t], count floats (a multiple of 4).
+static void blendRows(const float *const *rows, const float *weights, int taps, float *output, int count)
+{
+    for (int i = 0; i < count; i += 4)
+    {
+#if defined(__SSE2__)
+        __m128 sum = _mm_setzero_ps();
+        for (int t = 0; t < taps; ++t)
+            sum = _mm_add_ps(sum, _mm_mul_ps(_mm_set1_ps(weights[t]), _mm_loadu_ps(rows[t] + i)));
+        _mm_storeu_ps(output + i, sum);
+#else
+        for (int c = 0; c < 4; ++c)
+        {
+            float sum = 0.0f;
+            for (int t = 0; t < taps; ++t)
+                sum += weights[t] * rows[t][i + c];
+            output[i + c] = sum;
+        }
+#endif
+    }
+}
+
+// A chain being built: the level filtered last, in linear floats, and the one being filtered from it.
+struct ChainState
+{
+    std::vector<float> source;
+    std::vector<float> target;
+};
+
+// Function to filter the output rows [firstRow, endRow) of a level from the level above it and to encode them.
+// The input rows the band needs are filtered horizontally first, then blended vertically.
+static void filterBand(const std::vector<float> &source, int sourceWidth, int sourceHeight, std::vector<float> &target,
+                       RgbaImage &level, int firstRow, int endRow, const Kernel &halving, bool srgb)
+{
+    Kernel identity;
+    const Kernel &horizontal = sourceWidth > 1 ? halving : identity;
+    const Kernel &vertical = sourceHeight > 1 ? halving : identity;
+    int factorX = sourceWidth > 1 ? 2 : 1;
+    int factorY = sourceHeight > 1 ? 2 : 1;
+    int width = level.width;
+
+    int lowRow = std::max(factorY * firstRow + vertical.first, 0);
+    int highRow = std::min(factorY * (endRow - 1) + vertical.first + vertical.taps - 1, sourceHeight - 1);
+    std::vector<float> filtered((size_t)(highRow - lowRow + 1) * width * 4);
+    for (int row = lowRow; row <= highRow; ++row)
+        filterRow(&source[(size_t)row * sourceWidth * 4], sourceWidth, &filtered[(size_t)(row - lowRow) * width * 4], width,
+                  factorX, horizontal);
+
+    const SrgbTables &tables = srgbTables();
+    const float *rows[12];
+    for (int y = firstRow; y < endRow; ++y)
+    {
+        for (int t = 0; t < vertical.taps; ++t)
+        {
+            int row = std::min(std::max(factorY * y + vertical.first + t, 0), sourceHeight - 1);
+            rows[t] = &filtered[(size_t)(row - lowRow) * width * 4];
+        }
+        float *output = &target[(size_t)y * width * 4];
+        blendRows(rows, vertical.weights, vertical.taps, output, width * 4);
+
+        unsigned char *pixels = &level.pixels[(size_t)y * width * 4];
+        for (int i = 0; i < width * 4; i += 4)
+        {
+            for (int c = 0; c < 3; ++c)
+                pixels[i + c] = srgb ? encodeSrgb(tables, output[i + c]) : encodeLinear(output[i + c]);
+            pixels[i + 3] = encodeLinear(output[i + 3]);
+        }
+    }
+}
+
+// Function to generate the mipmap levels of many images.
+// The levels are built in waves, each from the previous level kept in linear floats, so rounding to 8 bits
+// never accumulates; within a wave, every row band of every image is a task.
+void generateMipChains(std::vector<std::vector<RgbaImage>> &chains, MipFilter filter, bool srgb, WorkerPool &workers, int maxLevels)
+{
+    const SrgbTables &tables = srgbTables();
+    Kernel halving = halvingKernel(filter);
+    std::vector<ChainState> states(chains.size());
+
+    // Decode the first levels
+    parallelFor(workers, (int)chains.size(), [&](int i)
+                {
+                    const RgbaImage &image = chains[i][0];
+                    std::vector<float> &linear = states[i].source;
+                    linear.resize(image.pixels.size());
+                    for (size_t p = 0; p < image.pixels.size(); p += 4)
+                    {
+                        for (int c = 0; c < 3; ++c)
+                            linear[p + c] = srgb ? tables.decode[image.pixels[p + c]] : image.pixels[p + c] / 255.0f;
+                        linear[p + 3] = image.pixels[p + 3] / 255.0f;
+                    } });
+
+    struct Band
+    {
+        int chain;
+        int firstRow;
+        int endRow;
+    };
+    std::vector<Band> bands;
+    for (;;)
+    {
+        // Allocate the next level of every chain that is not complete, and split it into bands
+        bands.clear();
+        for (size_t i = 0; i < chains.size(); ++i)
+        {
+            std::vector<RgbaImage> &chain = chains[i];
+            const RgbaImage &last = chain.back();
+            if ((int)chain.size() >= maxLevels || (last.width == 1 && last.height == 1) || last.width == 0 || last.height == 0)
+                continue;
+            RgbaImage level;
+            level.width = std::max(last.width / 2, 1);
+            level.height = std::max(last.height / 2, 1);
+            level.pixels.resize((size_t)level.width * level.height * 4);
+            chain.push_back(std::move(level));
+            states[i].target.resize((size_t)chain.back().width * chain.back().height * 4);
+            for (int row = 0; row < chain.back().height; row += bandRows)
+                bands.push_back({(int)i, row, std::min(row + bandRows, chain.back().height)});
+        }
+        if (bands.empty())
+            break;
+
+        parallelFor(workers, (int)bands.size(), [&](int b)
+                    {
+                        const Band &band = bands[b];
+                        std::vector<RgbaImage> &chain = chains[band.chain];
+                        const RgbaImage &above = chain[chain.size() - 2];
+                        filterBand(states[band.chain].source, above.width, above.height, states[band.chain].target, chain.back(),
+                                   band.firstRow, band.endRow, halving, srgb); });
+
+        for (ChainState &state : states)
+            state.source.swap(state.target);
+    }
+}
+
+// Constructor: an empty atlas, its skyline flat at the bottom.
+SkylinePacker::SkylinePacker(int width, int height) : atlasWidth(width), atlasHeight(height)
+{
+    skyline.push_back({0, 0, width});
+}
+
+// Function to find the lowest y at which a rectangle starting at the left end of a segment clears the skyline.
+int SkylinePacker::fitHeight(size_t segment, int width) const
+{
+    if (skyline[segment].x + width > atlasWidth)
+        return -1;
+    int y = 0;
+    for (size_t i = segment; width > 0; ++i) // The segments cover the whole width, so this stays in range
+    {
+        y = std::max(y, skyline[i].y);
+        width -= skyline[i].width;
+    }
+    return y;
+}
+
+// Function to place a rectangle at the lowest position of the skyline; among equally low ones, on the
+// narrowest segment, which leaves the wide gaps for wide rectangles.
+// rect: Receives the position.
+bool SkylinePacker::insert(int width, int height, AtlasRect &rect)
+{
+    int bestY = INT_MAX, bestWidth = INT_MAX;
+    size_t best = 0;
+    for (size_t i = 0; i < skyline.size(); ++i)
+    {
+        int y = fitHeight(i, width);
+        if (y < 0 || y + height > atlasHeight)
+            continue;
+        if (y < bestY || (y == bestY && skyline[i].width < bestWidth))
+        {
+            bestY = y;
+            bestWidth = skyline[i].width;
+            best = i;
+        }
+    }
+    if (bestY == INT_MAX)
+        return false;
+    rect.x = skyline[best].x;
+    rect.y = bestY;
+    rect.width = width;
+    rect.height = height;
+
+    // The rectangle's top becomes a segment; the segments under it are cut away
+    Segment placed = {rect.x, bestY + height, width};
+    skyline.insert(skyline.begin() + best, placed);
+    for (size_t i = best + 1; i < skyline.size();)
+    {
+        Segment &segment = skyline[i];
+        int overlap = placed.x + placed.width - segment.x;
+        if (overlap <= 0)
+            break;
+        if (overlap < segment.width)
+        {
+            segment.x += overlap;
+            segment.width -= overlap;
+            break;
+        }
+        skyline.erase(skyline.begin() + i);
+    }
+    for (size_t i = 0; i + 1 < skyline.size();) // Neighbors of the same height become one segment
+    {
+        if (skyline[i].y == skyline[i + 1].y)
+        {
+            skyline[i].width += skyline[i + 1].width;
+            skyline.erase(skyline.begin() + i + 1);
+        }
+        else
+            ++i;
+    }
+    return true;
+}
+
+// Function to pack textures into an atlas and copy their levels into it.
+// Every texture sits in a slot with a gutter of one texel of the coarsest level on each side, filled with its
+// edge texels, and slot sizes are multiples of that texel, so at every level the texture starts on a whole
+// texel and bilinear filtering at its border reads its own edge instead of the neighbor.
+bool buildTextureAtlas(const std::vector<std::vector<RgbaImage>> &chains, int levels, int maxSize, TextureAtlas &atlas)
+{
+    int gutter = 1 << (levels - 1);
+    std::vector<AtlasRect> slots(chains.size());
+    long long area = 0;
+    int widest = 0, tallest = 0;
+    for (size_t i = 0; i < chains.size(); ++i)
+    {
+        slots[i].width = (chains[i][0].width + gutter - 1) / gutter * gutter + 2 * gutter;
+        slots[i].height = (chains[i][0].height + gutter - 1) / gutter * gutter + 2 * gutter;
+        area += (long long)slots[i].width * slots[i].height;
+        widest = std::max(widest, slots[i].width);
+        tallest = std::max(tallest, slots[i].height);
+    }
+
+    // Tall slots first: the skyline stays flat when the rows are filled with slots of similar heights
+    std::vector<size_t> order(chains.size());
+    for (size_t i = 0; i < order.size(); ++i)
+        order[i] = i;
+    std::sort(order.begin(), order.end(), [&slots](size_t a, size_t b)
+              { return slots[a].height != slots[b].height ? slots[a].height > slots[b].height : slots[a].width > slots[b].width; });
+
+    // The smallest power-of-two atlas that holds the area, grown one side at a time until everything fits
+    int width = 1, height = 1;
+    while (width < widest || (long long)width * width < area)
+        width *= 2;
+    while (height < tallest || (long long)width * height < area)
+        height *= 2;
+    for (;;)
+    {
+        if (width > maxSize || height > maxSize)
+            return false;
+        SkylinePacker packer(width, height);
+        bool packed = true;
+        for (size_t i : order)
+            if (!packer.insert(slots[i].width, slots[i].height, slots[i]))
+            {
+                packed = false;
+                break;
+            }
+        if (packed)
+            break;
+        if (width <= height)
+            width *= 2;
+        else
+            height *= 2;
+    }
+
+    atlas.width = width;
+    atlas.height = height;
+    atlas.rects.resize(chains.size());
+    for (size_t i = 0; i < chains.size(); ++i)
+        atlas.rects[i] = {slots[i].x + gutter, slots[i].y + gutter, chains[i][0].width, chains[i][0].height};
+
+    // Copy every level of every texture into its slot, extending the edges over the gutter
+    atlas.levels.resize(levels);
+    for (int l = 0; l < levels; ++l)
+    {
+        RgbaImage &level = atlas.levels[l];
+        level.width = std::max(width >> l, 1);
+        level.height = std::max(height >> l, 1);
+        level.pixels.assign((size_t)level.width * level.height * 4, 0);
+        for (size_t i = 0; i < chains.size(); ++i)
+        {
+            const RgbaImage &image = chains[i][std::min((size_t)l, chains[i].size() - 1)];
+            int originX = atlas.rects[i].x >> l, originY = atlas.rects[i].y >> l;
+            for (int y = slots[i].y >> l; y < (slots[i].y + slots[i].height) >> l; ++y)
+            {
+                int sourceY = std::min(std::max(y - originY, 0), image.height - 1);
+                const unsigned char *sourceRow = &image.pixels[(size_t)sourceY * image.width * 4];
+                unsigned char *row = &level.pixels[(size_t)y * level.width * 4];
+                for (int x = slots[i].x >> l; x < (slots[i].x + slots[i].width) >> l; ++x)
+                {
+                    int sourceX = std::min(std::max(x - originX, 0), image.width - 1);
+                    std::memcpy(row + x * 4, sourceRow + sourceX * 4, 4);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// Function to compute the texture coordinate transform of a texture in an atlas.
+glm::vec4 atlasUvTransform(const AtlasRect &rect, int atlasWidth, int atlasHeight)
+{
+    return glm::vec4((float)rect.width / atlasWidth, (float)rect.height / atlasHeight, (float)rect.x / atlasWidth,
+                     (float)rect.y / atlasHeight);
+}
@@ -0,0 +1,87 @@
+#ifndef TEXTURE_PROCESSING_H
+#define TEXTURE_PROCESSING_H
+
+// CPU processing of uncompressed textures at load time: mipmap generation and atlas packing.
+// Mipmaps are filtered in linear light: sRGB colors are decoded to linear floats, filtered (SSE2 on x86-64,
+// one pixel per vector) and encoded again, so dark and bright texels mix as they do on screen instead of
+// the smaller levels turning darker. Every level is built from the one above it; the images and the row
+// bands of a level are filtered in parallel.
+// The atlas packer places many small textures into one, so they are drawn with a single texture bind. Each
+// texture gets a gutter of repeated edge texels and an origin aligned to the coarsest atlas level, so its
+// mipmaps never mix with those of its neighbors.
+#include "worker_pool.h" // Parallel filtering.
+#include <glm/glm.hpp>   // Texture coordinate transforms.
+#include <string>        // Filter names.
+#include <vector>        // Pixels, levels and rectangles.
+
+// RGBA8 pixels, bottom row first (OpenGL order).
+struct RgbaImage
+{
+    int width = 0;
+    int height = 0;
+    std::vector<unsigned char> pixels; // width * height * 4 bytes.
+};
+
+enum class MipFilter
+{
+    Box,   // 2x2 average: fast, slightly blurry.
+    Kaiser // Kaiser-windowed sinc over 12 texels per axis: sharper, keeps the detail of the coarse levels.
+};
+
+bool parseMipFilter(const char *name, MipFilter &filter); // "box" or "kaiser".
+
+// Appends the mipmap levels of every chain: chains[i][0] is an image, levels are added down to 1x1 or until the
+// chain has maxLevels levels. srgb: the color channels are sRGB encoded (alpha is always linear).
+// workers: Threads that help with the filtering; the calling thread works too, so it may be a job of the same pool.
+void generateMipChains(std::vector<std::vector<RgbaImage>> &chains, MipFilter filter, bool srgb, WorkerPool &workers,
+                       int maxLevels = 32);
+
+// Place of a texture in an atlas, in texels of the first level.
+struct AtlasRect
+{
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+};
+
+// Skyline bottom-left rectangle packer: the free space is described by the top edge of the placed rectangles,
+// and each rectangle goes where that edge is lowest. Fast and tight for textures of similar heights.
+class SkylinePacker
+{
+public:
+    SkylinePacker(int width, int height);
+    bool insert(int width, int height, AtlasRect &rect); // False if the rectangle does not fit anywhere.
+
+private:
+    struct Segment
+    {
+        int x;
+        int y; // Height of the skyline over [x, x + width).
+        int width;
+    };
+    int fitHeight(size_t segment, int width) const; // Lowest y for a rectangle starting at the segment; -1 if it overflows.
+
+    int atlasWidth;
+    int atlasHeight;
+    std::vector<Segment> skyline;
+};
+
+// An atlas of mipmapped textures: its levels and where every texture went.
+struct TextureAtlas
+{
+    int width = 0;
+    int height = 0;
+    std::vector<RgbaImage> levels; // levels[0] is width x height.
+    std::vector<AtlasRect> rects;  // By texture.
+};
+
+// Packs the mip chains (generateMipChains, at least levels deep) into a power-of-two atlas of at most maxSize
+// texels per side with the given number of levels. Returns false if they do not fit.
+bool buildTextureAtlas(const std::vector<std::vector<RgbaImage>> &chains, int levels, int maxSize, TextureAtlas &atlas);
+
+// Transform from the texture coordinates of a texture to those of its place in the atlas: scale in xy, offset in
+// zw. Coordinates in [0, 1] stay inside the texture's rectangle.
+glm::vec4 atlasUvTransform(const AtlasRect &rect, int atlasWidth, int atlasHeight);
+
+#endif
@@ -0,0 +1,251 @@
+#include "tiled_render.h"
+#include "batch_renderer.h"             // defaultWriterThreads.
+#include "gl_context.h"                 // Hidden window providing the context.
+#include "gl_debug.h"                   // Object labels and debug groups for frame captures.
+#include "gl_objects.h"                 // Owner of the shader program.
+#include "gpu_memory.h"                 // GPU memory budgets.
+#include "logger.h"                     // Error messages.
+#include "memory_arena.h"               // Row conversion buffer.
+#include "offscreen.h"                  // Offscreen framebuffer of one tile.
+#include "readback.h"                   // PBO readback ring.
+#include "render_farm.h"                // Multi-process rendering.
+#include "scene.h"                      // The pyramid scene and camera presets.
+#include "shader.h"                     // Shader loading.
+#include "worker_pool.h"                // Tile writer threads.
+#include <glm/gtc/matrix_transform.hpp> // Provides glm::frustum.
+#include <algorithm>                    // std::min.
+#include <atomic>                       // Failed tile count shared with the writers.
+#include <chrono>                       // Throughput measurement.
+#include <cmath>                        // std::tan.
+#include <cstdio>                       // snprintf, builds the PPM header.
+#include <fcntl.h>                      // open.
+#include <iostream>                     // Included for status output.
+#include <unistd.h>                     // pwrite, ftruncate and close.
+
+// Same lens as the interactive view.
+static const float posterFovy = glm::radians(45.0f);
+static const float posterNear = 0.1f;
+static const float posterFar = 100.0f;
+
+// Function to compute the pixel rectangle of a tile.
+// Edge tiles are cut to the poster size, so posters need not be a multiple of the tile size.
+PosterTile posterTile(int index, int posterWidth, int posterHeight, int tileSize)
+{
+    int columns = (posterWidth + tileSize - 1) / tileSize;
+    PosterTile tile;
+    tile.x = (index % columns) * tileSize;
+    tile.y = (index / columns) * tileSize;
+    tile.width = std::min(tileSize, posterWidth - tile.x);
+    tile.height = std::min(tileSize, posterHeight - tile.y);
+    return tile;
+}
+
+// Function to build the off-center frustum of one tile.
+// The poster's symmetric frustum spans [-right, right] x [-top, top] on the near plane; each tile takes the
+// matching slice of it, so the tiles join without seams and the poster looks like one big perspective image.
+glm::mat4 tileProjection(const PosterTile &tile, int posterWidth, int posterHeight, float fovy, float nearPlane, float farPlane)
+{
+    float top = nearPlane * std::tan(fovy * 0.5f);
+    float right = top * (float)posterWidth / (float)posterHeight;
+
+    float left = -right + 2.0f * right * (float)tile.x / (float)posterWidth;
+    float tileRight = -right + 2.0f * right * (float)(tile.x + tile.width) / (float)posterWidth;
+    float bottom = -top + 2.0f * top * (float)tile.y / (float)posterHeight;
+    float tileTop = -top + 2.0f * top * (float)(tile.y + tile.height) / (float)posterHeight;
+    return glm::frustum(left, tileRight, bottom, tileTop, nearPlane, farPlane);
+}
+
+// Function to build the binary PPM header; the pixel data follows it directly.
+static std::string ppmHeader(int width, int height)
+{
+    char header[64];
+    std::snprintf(header, sizeof(header), "P6\n%d %d\n255\n", width, height);
+    return header;
+}
+
+// Function to create the poster file at its final size, so every tile can be written to its place in any order.
+static bool createPosterFile(const AppOptions &options)
+{
+    int file = open(options.posterPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (file < 0)
+    {
+        logError("Could not create {}", options.posterPath);
+        return false;
+    }
+    std::string header = ppmHeader(options.outputWidth, options.outputHeight);
+    off_t size = (off_t)header.size() + (off_t)options.outputWidth * options.outputHeight * 3;
+    bool ok = pwrite(file, header.data(), header.size(), 0) == (ssize_t)header.size() && ftruncate(file, size) == 0;
+    if (!ok)
+        logError("Could not allocate {} bytes for {}", size, options.posterPath);
+    close(file);
+    return ok;
+}
+
+// Function to write the rows of one tile into the poster file.
+// PPM stores the top row first and RGB only, while the readback is bottom row first RGBA.
+static bool writeTileRows(int file, const ReadbackImage &image, const PosterTile &tile, int posterWidth, int posterHeight, off_t dataOffset)
+{
+    ArenaScope scope(threadArena());
+    size_t rowSize = (size_t)tile.width * 3;
+    unsigned char *row = threadArena().allocateArray<unsigned char>(rowSize);
+    for (int r = 0; r < tile.height; ++r)
+    {
+        const unsigned char *source = image.pixels + (size_t)r * image.width * 4;
+        for (int x = 0; x < tile.width; ++x)
+        {
+            row[x * 3 + 0] = source[x * 4 + 0];
+            row[x * 3 + 1] = source[x * 4 + 1];
+            row[x * 3 + 2] = source[x * 4 + 2];
+        }
+        int posterRow = posterHeight - 1 - (tile.y + r);
+        off_t offset = dataOffset + ((off_t)posterRow * posterWidth + tile.x) * 3;
+        if (pwrite(file, row, rowSize, offset) != (ssize_t)rowSize)
+            return false;
+    }
+    return true;
+}
+
+// Function to render the tiles handed out by claimTile into the poster file.
+// Needs a current OpenGL context and a poster file created by createPosterFile.
+static bool renderPosterTiles(const AppOptions &options, const FarmClaimFunction &claimTile, int &tilesRendered)
+{
+    int file = open(options.posterPath.c_str(), O_WRONLY);
+    if (file < 0)
+    {
+        logError("Could not open {}", options.posterPath);
+        return false;
+    }
+
+    // The tile framebuffer must fit the implementation limits; this is the whole point of tiling.
+    int maxRenderbufferSize = 0, maxViewport[2] = {0, 0};
+    glGetIntegerv(GL_MAX_RENDERBUFFER_SIZE, &maxRenderbufferSize);
+    glGetIntegerv(GL_MAX_VIEWPORT_DIMS, maxViewport);
+    int maxTileSize = std::min(maxRenderbufferSize, std::min(maxViewport[0], maxViewport[1]));
+    if (options.tileSize > maxTileSize)
+    {
+        logError("Tiles of {} pixels are not supported, use --tile {} or less", options.tileSize, maxTileSize);
+        close(file);
+        return false;
+    }
+    int tileSize = options.tileSize;
+
+    UniqueProgram shaderProgram(createShaderProgram(readFile("vertex_shader.glsl"), readFile("fragment_shader.glsl")));
+    OffscreenTarget target;
+    if (!shaderProgram || !createOffscreenTarget(target, tileSize, tileSize))
+    {
+        close(file);
+        return false;
+    }
+    labelGlObject(GL_PROGRAM, shaderProgram.name(), "pyramid program");
+    PyramidMesh pyramid = createPyramidMesh();
+    glm::mat4 view = cameraPresetViewMatrix(options.cameraPreset);
+    off_t dataOffset = (off_t)ppmHeader(options.outputWidth, options.outputHeight).size();
+
+    std::atomic<int> failedTiles{0};
+    {
+        int writerCount = options.writerThreads > 0 ? options.writerThreads : defaultWriterThreads();
+        WorkerPool writers(writerCount);
+        FrameReadback readback(writers, writerCount + 2); // At most this many tiles are held in memory.
+
+        for (int index = claimTile(); index >= 0; index = claimTile())
+        {
+            PosterTile tile = posterTile(index, options.outputWidth, options.outputHeight, tileSize);
+            GlDebugGroup group("poster tile");
+
+            bindOffscreenTarget(target);
+            glViewport(0, 0, tile.width, tile.height); // Edge tiles only use part of the framebuffer.
+            glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+            drawPyramids(shaderProgram.name(), pyramid, view,
+                         tileProjection(tile, options.outputWidth, options.outputHeight, posterFovy, posterNear, posterFar));
+
+            if (!readback.hasFreeSlot())
+                readback.waitForFreeSlot();
+            int posterWidth = options.outputWidth, posterHeight = options.outputHeight;
+            readback.request(0, 0, tile.width, tile.height, index, [=, &failedTiles](const ReadbackImage &image)
+                             {
+                                 if (image.pixels == nullptr || !writeTileRows(file, image, tile, posterWidth, posterHeight, dataOffset))
+                                     ++failedTiles;
+                             });
+            readback.poll();
+            enforceGpuMemoryBudgets();
+            ++tilesRendered;
+        }
+        readback.finish(); // Every tile is in the file once this returns.
+    }
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    destroyPyramidMesh(pyramid);
+    destroyOffscreenTarget(target);
+    close(file);
+
+    if (failedTiles > 0)
+        logError("{} tiles could not be written to {}", failedTiles.load(), options.posterPath);
+    return failedTiles == 0;
+}
+
+// Function to render poster tiles in a hidden context of this process.
+static bool renderPosterWithHiddenContext(const AppOptions &options, const FarmClaimFunction &claimTile, int &tilesRendered)
+{
+    if (!glfwInit())
+        return false;
+
+    ContextSettings contextSettings;
+    contextSettings.width = 1;
+    contextSettings.height = 1;
+    contextSettings.title = "Poster renderer";
+    contextSettings.visible = false;
+    contextSettings.debugOutput = options.glDebug;
+    GLFWwindow *window = createContextWindow(contextSettings);
+    bool ok = window != nullptr;
+    if (ok)
+    {
+        glfwSwapInterval(0);
+        ok = renderPosterTiles(options, claimTile, tilesRendered);
+        destroyDeferredGlObjects(); // The mesh and program released by the render function
+        glfwDestroyWindow(window);
+    }
+    glfwTerminate();
+    return ok;
+}
+
+// Function to run the --poster mode.
+int runPosterRenderer(const AppOptions &options)
+{
+    auto start = std::chrono::steady_clock::now();
+    if (!createPosterFile(options))
+        return -1;
+
+    // Every process numbers the tiles on the same grid.
+    int tileSize = options.tileSize;
+    int tileCount = ((options.outputWidth + tileSize - 1) / tileSize) * ((options.outputHeight + tileSize - 1) / tileSize);
+
+    if (options.farmWorkers > 1)
+    {
+        AppOptions workerOptions = options;
+        if (workerOptions.writerThreads <= 0)
+        {
+            int cores = defaultWriterThreads() + 1;
+            workerOptions.writerThreads = cores / options.farmWorkers > 1 ? cores / options.farmWorkers - 1 : 1;
+        }
+        int failed = runRenderFarm(options.farmWorkers, tileCount, [&](int, const FarmClaimFunction &claim)
+                                   {
+                                       int tilesRendered = 0;
+                                       return renderPosterWithHiddenContext(workerOptions, claim, tilesRendered);
+                                   });
+        return failed == 0 ? 0 : -1;
+    }
+
+    int nextTile = 0;
+    FarmClaimFunction claimTile = [&nextTile, tileCount]
+    { return nextTile < tileCount ? nextTile++ : -1; };
+
+    int tilesRendered = 0;
+    if (!renderPosterWithHiddenContext(options, claimTile, tilesRendered))
+        return -1;
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Rendered a " << options.outputWidth << "x" << options.outputHeight << " poster in " << tilesRendered
+              << " tiles in " << seconds << " s: " << options.posterPath << std::endl;
+    return 0;
+}
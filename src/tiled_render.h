@@ -0,0 +1,28 @@
+#ifndef TILED_RENDER_H
+#define TILED_RENDER_H
+
+// Rendering of posters larger than the maximum framebuffer size.
+// The perspective projection of the poster is cut into off-center frusta, one per tile. Each tile is drawn
+// into an offscreen framebuffer, read back through the PBO ring and written by a worker directly to its
+// place in a preallocated PPM file, so only a few tiles are ever held in memory.
+#include "options.h"   // Poster size, tile size and camera.
+#include <glm/glm.hpp> // GLM provides the matrix types.
+
+// Pixel rectangle of a tile inside the poster; y counts from the bottom row like OpenGL.
+struct PosterTile
+{
+    int x = 0, y = 0;
+    int width = 0, height = 0;
+};
+
+// Returns the tile with the given index; tiles are numbered row by row from the bottom left.
+PosterTile posterTile(int index, int posterWidth, int posterHeight, int tileSize);
+
+// Returns the projection matrix covering exactly one tile of a glm::perspective(fovy, posterWidth / posterHeight, near, far) projection.
+glm::mat4 tileProjection(const PosterTile &tile, int posterWidth, int posterHeight, float fovy, float nearPlane, float farPlane);
+
+// Entry point of --poster: renders the poster in this process or, with --farm, across worker processes.
+// Initializes GLFW itself, so it must be called before glfwInit. Returns the process exit code.
+int runPosterRenderer(const AppOptions &options);
+
+#endif
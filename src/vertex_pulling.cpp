@@ -0,0 +1,190 @@
+#include "vertex_pulling.h"
+#include "glad.h"       // GLAD provides the OpenGL function pointers.
+#include "gl_debug.h"   // Object labels.
+#include "gpu_memory.h" // Tracked allocation of the encoded copies.
+#include "logger.h"     // Meshes too large for a buffer texture.
+#include <algorithm>    // std::min, std::max.
+#include <cmath>        // std::lround.
+#include <cstring>      // std::strcmp.
+
+// Texture units of the buffer textures; 0 and 1 are taken by the materials and the virtual texture residency.
+// Samplers of different types must not share a unit, so both vertex samplers get one even if only one is read.
+static const int floatVertexUnit = 2;
+static const int wordVertexUnit = 3;
+static const int indexUnit = 4;
+
+// The VAO of every pulled draw: it has no attributes, so neither a mesh nor a vertex format changes it.
+static UniqueVertexArray pullingVertexArray;
+
+// Function to parse the name of a vertex encoding.
+// name: "off", "float" or "quantized". encoding: Set if the name is known.
+bool parseVertexEncoding(const char *name, VertexEncoding &encoding)
+{
+    if (std::strcmp(name, "off") == 0)
+        encoding = VertexEncoding::Off;
+    else if (std::strcmp(name, "float") == 0)
+        encoding = VertexEncoding::Float;
+    else if (std::strcmp(name, "quantized") == 0)
+        encoding = VertexEncoding::Quantized;
+    else
+        return false;
+    return true;
+}
+
+// Function to quantize a value in [0, 1] to an unsigned integer of the given maximum, rounding to nearest.
+static uint32_t quantize(float value, uint32_t maximum)
+{
+    return (uint32_t)std::lround(std::min(std::max(value, 0.0f), 1.0f) * (float)maximum);
+}
+
+// Function to encode interleaved vertices into the quantized format of the pulling shader.
+// vertices: Position and color floats, 6 per vertex. words: Receives 2 words per vertex.
+// positionScale, positionOffset: Receive the transform from the 16-bit codes back to positions.
+void quantizeVertices(const float *vertices, size_t vertexCount, std::vector<uint32_t> &words, glm::vec3 &positionScale,
+                      glm::vec3 &positionOffset)
+{
+    glm::vec3 lower(0.0f), upper(0.0f);
+    for (size_t v = 0; v < vertexCount; ++v)
+    {
+        glm::vec3 position(vertices[v * 6], vertices[v * 6 + 1], vertices[v * 6 + 2]);
+        lower = v == 0 ? position : glm::min(lower, position);
+        upper = v == 0 ? position : glm::max(upper, position);
+    }
+    glm::vec3 extent = upper - lower;
+    positionOffset = lower;
+    positionScale = extent / 65535.0f;
+
+    words.resize(vertexCount * 2);
+    for (size_t v = 0; v < vertexCount; ++v)
+    {
+        const float *vertex = vertices + v * 6;
+        uint32_t code[3];
+        for (int axis = 0; axis < 3; ++axis) // A flat axis keeps code 0, its scale is 0
+            code[axis] = extent[axis] > 0.0f ? quantize((vertex[axis] - lower[axis]) / extent[axis], 65535) : 0;
+        uint32_t color = quantize(vertex[3], 31) << 11 | quantize(vertex[4], 63) << 5 | quantize(vertex[5], 31);
+        words[v * 2] = code[0] | code[1] << 16;
+        words[v * 2 + 1] = code[2] | color << 16;
+    }
+}
+
+// Function to create a buffer texture over a buffer.
+// format: How the shader sees the buffer's contents, e.g. GL_R32F.
+static UniqueTexture createBufferTexture(GLuint buffer, GLenum format, const char *label)
+{
+    UniqueTexture texture = UniqueTexture::create();
+    glBindTexture(GL_TEXTURE_BUFFER, texture.name());
+    glTexBuffer(GL_TEXTURE_BUFFER, format, buffer);
+    glBindTexture(GL_TEXTURE_BUFFER, 0);
+    labelGlObject(GL_TEXTURE, texture.name(), label);
+    return texture;
+}
+
+// Function to set up a mesh for vertex pulling.
+// mesh: Vertices in the setPyramidVertexAttributes layout and 32-bit indices. encoding: Float or Quantized.
+PulledMesh createPulledMesh(const PyramidMesh &mesh, VertexEncoding encoding)
+{
+    PulledMesh pulled;
+    if (encoding == VertexEncoding::Off || mesh.indexCount <= 0)
+        return pulled;
+
+    // The vertex count is not kept with the mesh; the buffer size tells it
+    GLint vertexBytes = 0;
+    glBindBuffer(GL_COPY_READ_BUFFER, mesh.VBO.name());
+    glGetBufferParameteriv(GL_COPY_READ_BUFFER, GL_BUFFER_SIZE, &vertexBytes);
+    size_t vertexCount = (size_t)vertexBytes / (6 * sizeof(float));
+
+    // Buffer textures are limited in texels, not bytes; 3.3 only guarantees 65536
+    GLint maxTexels = 0;
+    glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+    size_t vertexTexels = encoding == VertexEncoding::Float ? vertexCount * 6 : vertexCount;
+    if (vertexTexels > (size_t)maxTexels || (size_t)mesh.indexCount > (size_t)maxTexels)
+    {
+        logWarning("A mesh of {} vertices exceeds the {} texels of a buffer texture; it is drawn with vertex attributes",
+                   vertexCount, maxTexels);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        return pulled;
+    }
+
+    pulled.encoding = encoding;
+    pulled.indexCount = mesh.indexCount;
+    if (encoding == VertexEncoding::Float)
+    {
+        // The interleaved floats are read as they are, one texel per float
+        pulled.vertices = createBufferTexture(mesh.VBO.name(), GL_R32F, "pulled vertices");
+        pulled.indices = createBufferTexture(mesh.EBO.name(), GL_R32UI, "pulled indices");
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        return pulled;
+    }
+
+    // Quantized: read the vertices and indices back once, at load time, and upload the encoded copies
+    std::vector<float> vertices(vertexCount * 6);
+    glGetBufferSubData(GL_COPY_READ_BUFFER, 0, (GLsizeiptr)(vertices.size() * sizeof(float)), vertices.data());
+    std::vector<uint32_t> words;
+    quantizeVertices(vertices.data(), vertexCount, words, pulled.positionScale, pulled.positionOffset);
+
+    pulled.vertexData = UniqueBuffer::create();
+    glBindBuffer(GL_TEXTURE_BUFFER, pulled.vertexData.name());
+    trackedBufferData(GL_TEXTURE_BUFFER, pulled.vertexData.name(), (long long)(words.size() * sizeof(uint32_t)), words.data(),
+                      GL_STATIC_DRAW, GpuMemoryCategory::Geometry, "pulled vertices");
+    labelGlObject(GL_BUFFER, pulled.vertexData.name(), "pulled vertices");
+    pulled.vertices = createBufferTexture(pulled.vertexData.name(), GL_RG32UI, "pulled vertices");
+
+    if (vertexCount <= 65536)
+    {
+        std::vector<uint32_t> indices(mesh.indexCount);
+        glBindBuffer(GL_COPY_READ_BUFFER, mesh.EBO.name());
+        glGetBufferSubData(GL_COPY_READ_BUFFER, 0, (GLsizeiptr)(indices.size() * sizeof(uint32_t)), indices.data());
+        std::vector<uint16_t> shortIndices(indices.begin(), indices.end());
+
+        pulled.indexData = UniqueBuffer::create();
+        glBindBuffer(GL_TEXTURE_BUFFER, pulled.indexData.name());
+        trackedBufferData(GL_TEXTURE_BUFFER, pulled.indexData.name(), (long long)(shortIndices.size() * sizeof(uint16_t)),
+                          shortIndices.data(), GL_STATIC_DRAW, GpuMemoryCategory::Geometry, "pulled indices");
+        labelGlObject(GL_BUFFER, pulled.indexData.name(), "pulled indices");
+        pulled.indices = createBufferTexture(pulled.indexData.name(), GL_R16UI, "pulled indices");
+    }
+    else
+        pulled.indices = createBufferTexture(mesh.EBO.name(), GL_R32UI, "pulled indices");
+    glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    return pulled;
+}
+
+// Function to create the VAO shared by the pulled meshes.
+void createPullingVertexArray()
+{
+    if (pullingVertexArray)
+        return;
+    pullingVertexArray = UniqueVertexArray::create();
+    labelGlObject(GL_VERTEX_ARRAY, pullingVertexArray.name(), "vertex pulling");
+}
+
+// Function to release the VAO shared by the pulled meshes.
+void destroyPullingVertexArray()
+{
+    pullingVertexArray.reset();
+}
+
+// Function to prepare the draws of a pulled mesh.
+// program: A pyramid program built with VERTEX_PULLING defined; it must be in use.
+// mesh: If empty, the program is set to read the vertex attributes of the VAO drawn next.
+void bindPulledMesh(unsigned int program, const PulledMesh &mesh)
+{
+    // The samplers get their units even when unused, so they never alias the material array on unit 0
+    glUniform1i(glGetUniformLocation(program, "vertexFloats"), floatVertexUnit);
+    glUniform1i(glGetUniformLocation(program, "vertexWords"), wordVertexUnit);
+    glUniform1i(glGetUniformLocation(program, "vertexIndices"), indexUnit);
+    glUniform1i(glGetUniformLocation(program, "vertexEncoding"), mesh.indexCount > 0 ? (int)mesh.encoding : 0);
+    if (mesh.indexCount <= 0)
+        return;
+
+    bool quantized = mesh.encoding == VertexEncoding::Quantized;
+    glActiveTexture(GL_TEXTURE0 + (quantized ? wordVertexUnit : floatVertexUnit));
+    glBindTexture(GL_TEXTURE_BUFFER, mesh.vertices.name());
+    glActiveTexture(GL_TEXTURE0 + indexUnit);
+    glBindTexture(GL_TEXTURE_BUFFER, mesh.indices.name());
+    glActiveTexture(GL_TEXTURE0);
+    glUniform4f(glGetUniformLocation(program, "positionScale"), mesh.positionScale.x, mesh.positionScale.y, mesh.positionScale.z, 0.0f);
+    glUniform4f(glGetUniformLocation(program, "positionOffset"), mesh.positionOffset.x, mesh.positionOffset.y, mesh.positionOffset.z, 0.0f);
+    glBindVertexArray(pullingVertexArray.name());
+}
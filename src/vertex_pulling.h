@@ -0,0 +1,60 @@
+#ifndef VERTEX_PULLING_H
+#define VERTEX_PULLING_H
+
+// Vertex pulling for the pyramid programs: with VERTEX_PULLING defined, vertex_shader.glsl has no vertex
+// attributes and fetches its vertex itself, first the index at gl_VertexID from an index buffer texture,
+// then the position and color at that index from a vertex buffer texture. The draws are plain
+// glDrawArrays over an attribute-less VAO, so one VAO serves every mesh and vertex format, switching
+// formats is a uniform and a texture bind, and the vertices can be stored in encodings that no vertex
+// attribute format describes and be decoded by the shader.
+// All functions must be called on the thread that owns the OpenGL context.
+#include "gl_objects.h" // Owners of the buffers and buffer textures.
+#include "scene.h"      // PyramidMesh.
+#include <cstdint>      // Encoded vertex words.
+#include <glm/glm.hpp>  // Dequantization transform.
+#include <vector>       // Encoded vertices.
+
+// The values are those of the vertexEncoding uniform of vertex_shader.glsl.
+enum class VertexEncoding
+{
+    Off,      // Vertex attributes through the mesh's own VAO.
+    Float,    // The mesh's interleaved floats, read in place: 24 bytes per vertex and 4 per index.
+    Quantized // 16-bit positions within the mesh bounds and RGB565 colors: 8 bytes per vertex, 2 per index when they fit.
+};
+
+bool parseVertexEncoding(const char *name, VertexEncoding &encoding); // "off", "float" or "quantized".
+
+// Buffer textures a pulling program reads a mesh from. Float views the buffers of the PyramidMesh it was
+// created from, so it must not outlive that mesh; Quantized owns copies.
+struct PulledMesh
+{
+    UniqueBuffer vertexData;          // Quantized vertices; empty for Float.
+    UniqueBuffer indexData;           // 16-bit indices; empty if the mesh's 32-bit ones are read.
+    UniqueTexture vertices;           // GL_TEXTURE_BUFFER: GL_R32F (6 per vertex) or GL_RG32UI (1 per vertex).
+    UniqueTexture indices;            // GL_TEXTURE_BUFFER: GL_R32UI or GL_R16UI.
+    VertexEncoding encoding = VertexEncoding::Off;
+    glm::vec3 positionScale = glm::vec3(1.0f);  // Quantized: position = code * scale + offset.
+    glm::vec3 positionOffset = glm::vec3(0.0f);
+    int indexCount = 0;               // Vertices drawn; 0 if the mesh could not be set up for pulling.
+};
+
+// Sets up the buffer textures of a mesh with the setPyramidVertexAttributes layout. Quantized reads the
+// vertices back once to encode them. Logs the reason and returns an empty PulledMesh if the buffer
+// textures would exceed GL_MAX_TEXTURE_BUFFER_SIZE.
+PulledMesh createPulledMesh(const PyramidMesh &mesh, VertexEncoding encoding);
+
+// Create and release the attribute-less VAO that bindPulledMesh binds for every mesh; core profiles draw
+// nothing without a VAO bound. Create it before drawing a pulled mesh and release it before the context goes away.
+void createPullingVertexArray();
+void destroyPullingVertexArray();
+
+// Binds the shared VAO and the buffer textures of the mesh and sets the pulling uniforms of the (current) program; for an
+// empty mesh, sets the program to read vertex attributes instead.
+void bindPulledMesh(unsigned int program, const PulledMesh &mesh);
+
+// Encodes interleaved position and color floats (6 per vertex) into two 32-bit words per vertex: x | y << 16
+// and z | rgb565 << 16, with the positions quantized to 16 bits within their bounding box.
+void quantizeVertices(const float *vertices, size_t vertexCount, std::vector<uint32_t> &words, glm::vec3 &positionScale,
+                      glm::vec3 &positionOffset);
+
+#endif
@@ -0,0 +1,227 @@
+#include "video_recorder.h"
+#include "yuv.h"    // RGBA to YUV 4:2:0 conversion.
+#include "logger.h" // Status and error messages.
+#include <algorithm> // std::max.
+#include <chrono>   // Timing of the conversion, the writes and the render thread cost.
+#include <iostream> // Included for status output.
+
+// Function to measure elapsed milliseconds since a time point.
+static double millisecondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Constructor: only records the collaborators; frame buffers are allocated when a recording starts.
+VideoRecorder::VideoRecorder(FrameReadback &readback, int bufferCount)
+    : readback(readback), frames(bufferCount < 2 ? 2 : bufferCount)
+{
+}
+
+// Destructor: a recording still running is flushed and closed.
+VideoRecorder::~VideoRecorder()
+{
+    stop();
+}
+
+// Function to start a recording.
+// target: Output file (.y4m or .yuv) or, with pipeToCommand, a shell command that reads Y4M from its standard input.
+// width, height: Size of the recorded frames; odd sizes are rounded down because 4:2:0 needs even dimensions.
+// fps: Frame rate written into the Y4M header.
+bool VideoRecorder::start(const std::string &target, bool pipeToCommand, int width, int height, int fps)
+{
+    if (recording)
+        return false;
+
+    this->width = width & ~1;
+    this->height = height & ~1;
+    if (this->width <= 0 || this->height <= 0)
+        return false;
+
+    outputIsPipe = pipeToCommand;
+    rawOutput = !pipeToCommand && target.size() > 4 && target.compare(target.size() - 4, 4, ".yuv") == 0;
+    output = pipeToCommand ? popen(target.c_str(), "w") : std::fopen(target.c_str(), "wb");
+    if (output == nullptr)
+    {
+        logError("Could not open recording output {}", target);
+        return false;
+    }
+    std::setvbuf(output, nullptr, _IOFBF, 1 << 20); // Large buffer so each frame is written with few system calls.
+    outputName = target;
+
+    if (!rawOutput)
+        std::fprintf(output, "YUV4MPEG2 W%d H%d F%d:1 Ip A1:1 C420jpeg XCOLORRANGE=LIMITED\n", this->width, this->height, fps);
+
+    // Allocate every frame buffer up front so the recording itself does not allocate.
+    size_t frameSize = (size_t)this->width * this->height * 3 / 2;
+    freeFrames.clear();
+    readyFrames.clear();
+    for (int i = 0; i < (int)frames.size(); ++i)
+    {
+        frames[i].yuv.resize(frameSize);
+        freeFrames.push_back(i);
+    }
+
+    counters = VideoRecorderStats();
+    nextSequence = 0;
+    writeSequence = 0;
+    stopping = false;
+    recording = true;
+    writer = std::thread(&VideoRecorder::writerMain, this);
+
+    logInfo("Recording {}x{} to {}", this->width, this->height, target);
+    return true;
+}
+
+// Function to capture the frame that was just rendered.
+// Never waits: if no frame buffer or readback slot is free, the frame is skipped and counted.
+void VideoRecorder::captureFrame(int framebufferWidth, int framebufferHeight, long long frameIndex)
+{
+    if (!recording)
+        return;
+    auto start = std::chrono::steady_clock::now();
+
+    int frameSlot = -1;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        bool fits = framebufferWidth >= width && framebufferHeight >= height;
+        if (fits && !freeFrames.empty() && readback.hasFreeSlot())
+        {
+            frameSlot = freeFrames.back();
+            freeFrames.pop_back();
+            int inFlight = (int)frames.size() - (int)freeFrames.size();
+            counters.maxFramesInFlight = std::max(counters.maxFramesInFlight, inFlight);
+        }
+        else
+            ++counters.framesSkipped;
+    }
+
+    if (frameSlot >= 0)
+    {
+        frames[frameSlot].sequence = nextSequence;
+        if (readback.request(0, 0, width, height, frameIndex, [this, frameSlot](const ReadbackImage &image)
+                             { convertFrame(frameSlot, image); }))
+            ++nextSequence;
+        else
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            freeFrames.push_back(frameSlot);
+            ++counters.framesSkipped;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    counters.renderThreadMs += millisecondsSince(start);
+}
+
+// Function run on a worker: converts the mapped pixels and queues the frame for the writer.
+void VideoRecorder::convertFrame(int frameSlot, const ReadbackImage &image)
+{
+    auto start = std::chrono::steady_clock::now();
+    Frame &frame = frames[frameSlot];
+    frame.valid = image.pixels != nullptr;
+    if (frame.valid)
+    {
+        unsigned char *y = frame.yuv.data();
+        unsigned char *u = y + (size_t)width * height;
+        unsigned char *v = u + (size_t)(width / 2) * (height / 2);
+        convertRgbaToYuv420(image.pixels, width, height, y, u, v);
+    }
+    double elapsed = millisecondsSince(start);
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        counters.convertMsTotal += elapsed;
+        counters.convertMsMax = std::max(counters.convertMsMax, elapsed);
+        readyFrames.push_back(frameSlot);
+    }
+    frameReady.notify_one();
+}
+
+// Writer thread: conversions finish out of order on the workers, so frames are written strictly by sequence number.
+void VideoRecorder::writerMain()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;)
+    {
+        int frameSlot = -1;
+        frameReady.wait(lock, [&]
+                        {
+                            for (size_t i = 0; i < readyFrames.size(); ++i)
+                                if (frames[readyFrames[i]].sequence == writeSequence)
+                                {
+                                    frameSlot = readyFrames[i];
+                                    readyFrames.erase(readyFrames.begin() + i);
+                                    return true;
+                                }
+                            return stopping;
+                        });
+        if (frameSlot < 0)
+            return; // Stopping, and every captured frame has been written.
+
+        Frame &frame = frames[frameSlot];
+        lock.unlock();
+        auto start = std::chrono::steady_clock::now();
+        if (frame.valid)
+        {
+            if (!rawOutput)
+                std::fputs("FRAME\n", output);
+            std::fwrite(frame.yuv.data(), 1, frame.yuv.size(), output);
+        }
+        double elapsed = millisecondsSince(start);
+        lock.lock();
+
+        if (frame.valid)
+            ++counters.framesWritten;
+        else
+            ++counters.framesLost;
+        counters.writeMsTotal += elapsed;
+        counters.writeMsMax = std::max(counters.writeMsMax, elapsed);
+        freeFrames.push_back(frameSlot);
+        ++writeSequence;
+    }
+}
+
+// Function to end the recording.
+// Waits for the readbacks still in flight so every captured frame reaches the output, then closes it.
+void VideoRecorder::stop()
+{
+    if (!recording)
+        return;
+    recording = false;
+
+    readback.finish(); // Every conversion has finished and queued its frame once this returns.
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    frameReady.notify_one();
+    writer.join();
+
+    if (outputIsPipe)
+        pclose(output);
+    else
+        std::fclose(output);
+    output = nullptr;
+
+    printStats();
+}
+
+// Function to copy the counters under the lock.
+VideoRecorderStats VideoRecorder::stats() const
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return counters;
+}
+
+// Function to print a summary of the recording.
+void VideoRecorder::printStats() const
+{
+    VideoRecorderStats s = stats();
+    long long captured = s.framesWritten + s.framesLost;
+    std::cout << "Recording " << outputName << " finished: " << s.framesWritten << " frames written, "
+              << s.framesSkipped << " skipped, " << s.framesLost << " lost\n"
+              << "  render thread " << (captured + s.framesSkipped > 0 ? s.renderThreadMs / (captured + s.framesSkipped) : 0.0) << " ms/frame"
+              << ", convert avg " << (captured > 0 ? s.convertMsTotal / captured : 0.0) << " ms (max " << s.convertMsMax << ")"
+              << ", write avg " << (captured > 0 ? s.writeMsTotal / captured : 0.0) << " ms (max " << s.writeMsMax << ")"
+              << ", max queue depth " << s.maxFramesInFlight << "/" << frames.size() << std::endl;
+}
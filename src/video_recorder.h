@@ -0,0 +1,81 @@
+#ifndef VIDEO_RECORDER_H
+#define VIDEO_RECORDER_H
+
+// Real-time recording of the rendered frames.
+// The render thread only queues a PBO readback per frame. A worker converts the mapped pixels to YUV 4:2:0
+// into one of a fixed number of frame buffers, and a dedicated writer thread streams the frames in order to
+// a Y4M or raw .yuv file, or to the standard input of an encoder process.
+// When every frame buffer is busy the frame is skipped instead of stalling the render loop; the skips and
+// the queue depth are reported as backpressure metrics.
+#include "readback.h"         // Non-blocking framebuffer readback.
+#include <condition_variable> // Wakes the writer when a frame is converted.
+#include <cstdio>             // FILE streams for the file and pipe output.
+#include <mutex>              // Protects the frame queues.
+#include <string>             // Output file name or encoder command.
+#include <thread>             // The writer thread.
+#include <vector>             // Frame buffers and queues.
+
+// Counters describing how well the recording keeps up.
+struct VideoRecorderStats
+{
+    long long framesWritten = 0;   // Frames streamed to the output.
+    long long framesSkipped = 0;   // Frames not captured because no buffer was free (backpressure) or the size changed.
+    long long framesLost = 0;      // Frames captured but lost because the readback could not be mapped.
+    int maxFramesInFlight = 0;     // Highest number of frames between readback and write.
+    double renderThreadMs = 0.0;   // Total time the render thread spent in captureFrame().
+    double convertMsTotal = 0.0;   // Total conversion time on the workers.
+    double convertMsMax = 0.0;     // Slowest conversion.
+    double writeMsTotal = 0.0;     // Total time the writer spent in fwrite.
+    double writeMsMax = 0.0;       // Slowest frame write.
+};
+
+class VideoRecorder
+{
+public:
+    VideoRecorder(FrameReadback &readback, int bufferCount = 6); // Converts on the readback's workers; bufferCount: frames that can be queued at once.
+    ~VideoRecorder();                                            // Stops a running recording.
+
+    VideoRecorder(const VideoRecorder &) = delete;
+    VideoRecorder &operator=(const VideoRecorder &) = delete;
+
+    bool start(const std::string &target, bool pipeToCommand, int width, int height, int fps); // Opens the output and starts the writer.
+    void captureFrame(int framebufferWidth, int framebufferHeight, long long frameIndex);      // Queues the current frame. Render thread only.
+    void stop();                                                                              // Flushes every queued frame and closes the output.
+
+    bool isRecording() const { return recording; }
+    VideoRecorderStats stats() const; // Copy of the counters of the current or last recording.
+
+private:
+    struct Frame
+    {
+        std::vector<unsigned char> yuv; // Y, U and V planes, one after the other.
+        long long sequence = -1;        // Position of the frame in the output.
+        bool valid = false;             // False if the pixels could not be read.
+    };
+
+    void convertFrame(int frameSlot, const ReadbackImage &image); // Worker: converts pixels into a frame buffer.
+    void writerMain();                                           // Writer thread: writes frames in sequence order.
+    void printStats() const;
+
+    FrameReadback &readback;
+    std::vector<Frame> frames;
+    std::vector<int> freeFrames;  // Frame buffers ready for a new capture.
+    std::vector<int> readyFrames; // Converted frames waiting for the writer.
+    mutable std::mutex mutex;     // Protects the two lists, the stats and 'stopping'.
+    std::condition_variable frameReady;
+    std::thread writer;
+
+    FILE *output = nullptr;
+    bool outputIsPipe = false;
+    bool rawOutput = false; // True for .yuv files, which have no headers.
+    std::string outputName;
+    int width = 0;
+    int height = 0;
+    bool recording = false;
+    bool stopping = false;
+    long long nextSequence = 0;  // Sequence number of the next captured frame (render thread).
+    long long writeSequence = 0; // Sequence number the writer waits for (writer thread).
+    VideoRecorderStats counters;
+};
+
+#endif
@@ -0,0 +1,623 @@
+#include "virtual_texture.h"
+#include "gl_debug.h"   // Object labels and debug groups for frame captures.
+#include "gpu_memory.h" // Committed memory tracking and eviction.
+#include "logger.h"     // Error messages.
+#include "shader.h"     // readFile, which also looks in the mounted asset pack.
+#include <algorithm>    // std::min, std::sort and std::unique.
+#include <cstring>      // std::memcpy copies the block rows of a page.
+
+// The feedback pass draws at 1/8 of the framebuffer size every 4th frame: enough to find the visible pages,
+// cheap to draw and to read back. The shader corrects its mipmap level for the smaller target.
+static const int feedbackShift = 3;    // log2 of the downscale of the feedback target.
+static const int feedbackInterval = 4; // Frames between feedback passes.
+static const int maxPagesPerBatch = 16; // 1 MiB of staging memory with 64 KiB pages.
+
+// Constructor: reads the texture files and creates the sparse array and the residency texture.
+// paths: One compressed file per layer.
+// pageBudget: Pages of the paged levels that may be committed at once.
+// workers: Threads that decode the feedback and copy the pages.
+VirtualTexture::VirtualTexture(const std::vector<std::string> &paths, int pageBudget, WorkerPool &workers)
+    : workers(workers), pageBudget(pageBudget < 1 ? 1 : pageBudget)
+{
+    if (!GLAD_GL_ARB_sparse_texture || !GLAD_GL_ARB_texture_storage)
+    {
+        logWarning("Virtual texturing needs ARB_sparse_texture and ARB_texture_storage");
+        return;
+    }
+    if (paths.empty() || paths.size() > 254)
+    {
+        logError("Virtual texturing takes 1 to 254 texture files, got {}", paths.size());
+        return;
+    }
+
+    // The files stay in memory compressed: the pages are copied from there, never from the disk in the frame
+    contents.resize(paths.size());
+    images.resize(paths.size());
+    for (size_t i = 0; i < paths.size(); ++i)
+    {
+        contents[i] = readFile(paths[i].c_str());
+        if (contents[i].empty() || !parseTextureFile(paths[i], contents[i], images[i]))
+            return;
+        const TextureImage &first = images[0];
+        const TextureImage &image = images[i];
+        if (image.layers != 1)
+        {
+            logError("{} is a texture array; virtual texturing takes one layer per file", paths[i]);
+            return;
+        }
+        if (image.format != first.format || image.width != first.width || image.height != first.height || image.levels != first.levels)
+        {
+            logError("{} does not match the format, size and mipmap levels of {}", paths[i], paths[0]);
+            return;
+        }
+    }
+    format = images[0].format;
+    width = images[0].width;
+    height = images[0].height;
+    levels = images[0].levels;
+    layers = (int)images.size();
+    if (!compressedFormatSupported(format))
+    {
+        logError("The OpenGL context cannot sample {} textures", compressedFormatName(format));
+        return;
+    }
+
+    if (!createTextures())
+    {
+        materials_ = PyramidMaterials();
+        residency.reset();
+        staging.reset();
+        return;
+    }
+
+    feedbackReadback.reset(new FrameReadback(workers, 2));
+
+    // Over the texture budget, the least recently used pages are decommitted and the page budget shrinks with them
+    evictionHandler = addGpuEvictionHandler(GpuMemoryCategory::Textures, [this](long long bytesOver)
+                                            {
+                                                long long freed = 0;
+                                                while (freed < bytesOver && evictOne(false))
+                                                    freed += pageBytes;
+                                                if (freed > 0)
+                                                {
+                                                    this->pageBudget = residentPages > 1 ? residentPages : 1;
+                                                    reportMemory();
+                                                }
+                                                return freed; });
+}
+
+// Destructor: the readback and the page copies reference the object, so they are completed first.
+VirtualTexture::~VirtualTexture()
+{
+    feedbackReadback.reset();
+    workers.waitIdle(); // The jobs of a batch read the files of this object until they return
+    if (batch)
+    {
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, staging.name());
+        glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+    if (evictionHandler != 0)
+        removeGpuEvictionHandler(evictionHandler);
+    if (feedbackTarget.framebuffer != 0)
+        destroyOffscreenTarget(feedbackTarget);
+}
+
+// Functions for the page geometry. Pages have the same size in texels at every level, so a page of level
+// l + 1 covers 2x2 pages of level l. Ids number the pages layer by layer, finest level first, row by row.
+int VirtualTexture::pagesX(int level) const
+{
+    int levelWidth = std::max(width >> level, 1);
+    return (levelWidth + pageWidth - 1) / pageWidth;
+}
+
+int VirtualTexture::pagesY(int level) const
+{
+    int levelHeight = std::max(height >> level, 1);
+    return (levelHeight + pageHeight - 1) / pageHeight;
+}
+
+int VirtualTexture::pageId(int layer, int level, int x, int y) const
+{
+    return layer * pagesPerLayer + levelBase[level] + y * pagesX(level) + x;
+}
+
+void VirtualTexture::pageLocation(int id, int &layer, int &level, int &x, int &y) const
+{
+    layer = id / pagesPerLayer;
+    level = pages[id].level;
+    int index = id - layer * pagesPerLayer - levelBase[level];
+    x = index % pagesX(level);
+    y = index / pagesX(level);
+}
+
+// Function to create the sparse array, commit and fill its pinned levels, and create the residency texture
+// and the staging buffer. Returns false if the driver cannot page the format or the texture does not fit.
+bool VirtualTexture::createTextures()
+{
+    GLint pageSizes = 0;
+    glGetInternalformativ(GL_TEXTURE_2D_ARRAY, format, GL_NUM_VIRTUAL_PAGE_SIZES_ARB, 1, &pageSizes);
+    if (pageSizes <= 0)
+    {
+        logWarning("The driver has no sparse pages for {} textures", compressedFormatName(format));
+        return false;
+    }
+    glGetInternalformativ(GL_TEXTURE_2D_ARRAY, format, GL_VIRTUAL_PAGE_SIZE_X_ARB, 1, &pageWidth);
+    glGetInternalformativ(GL_TEXTURE_2D_ARRAY, format, GL_VIRTUAL_PAGE_SIZE_Y_ARB, 1, &pageHeight);
+    GLint maxSize = 0, maxLayers = 0;
+    glGetIntegerv(GL_MAX_SPARSE_TEXTURE_SIZE_ARB, &maxSize);
+    glGetIntegerv(GL_MAX_SPARSE_ARRAY_TEXTURE_LAYERS_ARB, &maxLayers);
+    if (pageWidth <= 0 || pageHeight <= 0 || width > maxSize || height > maxSize || layers > maxLayers)
+    {
+        logError("{}x{} with {} layers exceeds the sparse texture limits ({} texels, {} layers)", width, height, layers, maxSize, maxLayers);
+        return false;
+    }
+    pageBytes = compressedImageSize(format, pageWidth, pageHeight);
+
+    // The storage is only reserved; nothing takes memory until it is committed
+    materials_.array = UniqueTexture::create();
+    glBindTexture(GL_TEXTURE_2D_ARRAY, materials_.array.name());
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_SPARSE_ARB, GL_TRUE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_VIRTUAL_PAGE_SIZE_INDEX_ARB, 0);
+    glTexStorage3D(GL_TEXTURE_2D_ARRAY, levels, format, width, height, layers);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAX_LEVEL, levels - 1);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    labelGlObject(GL_TEXTURE, materials_.array.name(), "virtual texture");
+
+    // Levels smaller than a page form the mip tail, which is committed as a whole. It and the coarsest level
+    // are pinned, so every texel always has a resident level to fall back to.
+    GLint sparseLevels = 0;
+    glGetTexParameteriv(GL_TEXTURE_2D_ARRAY, GL_NUM_SPARSE_LEVELS_ARB, &sparseLevels);
+    pagedLevels = std::min((int)sparseLevels, levels - 1);
+    if (pagedLevels <= 0)
+    {
+        logWarning("{}x{} textures are too small to be paged", width, height);
+        return false;
+    }
+    if (pagesX(0) > 256 || pagesY(0) > 256)
+    {
+        logError("{}x{} textures have more than 256 pages per side, which the feedback cannot address", width, height);
+        return false;
+    }
+    for (int level = pagedLevels; level < levels; ++level)
+    {
+        int levelWidth = std::max(width >> level, 1);
+        int levelHeight = std::max(height >> level, 1);
+        long long size = compressedImageSize(format, levelWidth, levelHeight);
+        glTexPageCommitmentARB(GL_TEXTURE_2D_ARRAY, level, 0, 0, 0, levelWidth, levelHeight, layers, GL_TRUE);
+        for (int layer = 0; layer < layers; ++layer)
+            glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, levelWidth, levelHeight, 1, format, (GLsizei)size,
+                                      contents[layer].data() + images[layer].offsets[level]);
+        pinnedBytes += size * layers;
+    }
+    materials_.layerCount = layers;
+
+    // Page records of the paged levels
+    levelBase.resize(pagedLevels);
+    pagesPerLayer = 0;
+    for (int level = 0; level < pagedLevels; ++level)
+    {
+        levelBase[level] = pagesPerLayer;
+        pagesPerLayer += pagesX(level) * pagesY(level);
+    }
+    pages.resize((size_t)pagesPerLayer * layers);
+    for (int layer = 0; layer < layers; ++layer)
+        for (int level = 0; level < pagedLevels; ++level)
+            for (int i = 0; i < pagesX(level) * pagesY(level); ++i)
+                pages[(size_t)layer * pagesPerLayer + levelBase[level] + i].level = (uint8_t)level;
+    pageBudget = std::min(pageBudget, (int)pages.size());
+    pagesPerBatch = std::min(maxPagesPerBatch, pageBudget);
+    queue.reserve(pages.size());
+
+    // Residency texture: until pages arrive, the whole texture samples the pinned levels
+    residency = UniqueTexture::create();
+    glBindTexture(GL_TEXTURE_2D_ARRAY, residency.name());
+    glTexStorage3D(GL_TEXTURE_2D_ARRAY, 1, GL_R8UI, pagesX(0), pagesY(0), layers);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+    labelGlObject(GL_TEXTURE, residency.name(), "virtual texture residency");
+    residencyTexels.assign((size_t)pagesX(0) * pagesY(0) * layers, (uint8_t)pagedLevels);
+    dirtyLayers.assign(layers, true);
+    trackGpuAllocation(GpuResourceKind::Texture, residency.name(), (long long)residencyTexels.size(), GpuMemoryCategory::Textures,
+                       "virtual texture residency");
+
+    // Staging buffer of one batch of pages
+    staging = UniqueBuffer::create();
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, staging.name());
+    trackedBufferData(GL_PIXEL_UNPACK_BUFFER, staging.name(), pagesPerBatch * pageBytes, nullptr, GL_STREAM_DRAW,
+                      GpuMemoryCategory::Textures, "virtual texture staging");
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    labelGlObject(GL_BUFFER, staging.name(), "virtual texture staging");
+
+    reportMemory();
+    logInfo("Virtual texture: {} layers of {}x{} {}, pages of {}x{}, {} paged levels, budget of {} pages", layers, width, height,
+            compressedFormatName(format), pageWidth, pageHeight, pagedLevels, pageBudget);
+    return true;
+}
+
+// Function to set the uniforms of the paging code in the fragment shader.
+// program: Built with VIRTUAL_TEXTURE (and VIRTUAL_TEXTURE_FEEDBACK for the feedback pass) defined.
+// feedback: The program draws into the feedback target, whose size shifts the mipmap levels.
+void VirtualTexture::bindUniforms(unsigned int program, bool feedback) const
+{
+    glUseProgram(program);
+    glActiveTexture(GL_TEXTURE1);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, residency.name());
+    glActiveTexture(GL_TEXTURE0);
+    glUniform1i(glGetUniformLocation(program, "residency"), 1);
+    glUniform2f(glGetUniformLocation(program, "pageSize"), (float)pageWidth, (float)pageHeight);
+    glUniform1i(glGetUniformLocation(program, "pagedLevels"), pagedLevels);
+    glUniform1i(glGetUniformLocation(program, "lodShift"), feedback ? feedbackShift : 0);
+}
+
+// Function to start the feedback pass of a frame.
+// frameIndex: Number of the frame; a pass runs every feedbackInterval frames if a readback slot is free.
+// framebufferWidth, framebufferHeight: Size of the window's framebuffer; the feedback target follows it.
+bool VirtualTexture::beginFeedback(long long frameIndex, int framebufferWidth, int framebufferHeight)
+{
+    if (frameIndex % feedbackInterval != 0 || !feedbackReadback->hasFreeSlot())
+        return false;
+
+    int targetWidth = std::max(framebufferWidth >> feedbackShift, 1);
+    int targetHeight = std::max(framebufferHeight >> feedbackShift, 1);
+    if (feedbackTarget.width != targetWidth || feedbackTarget.height != targetHeight)
+    {
+        if (feedbackTarget.framebuffer != 0)
+            destroyOffscreenTarget(feedbackTarget);
+        if (!createOffscreenTarget(feedbackTarget, targetWidth, targetHeight))
+            return false;
+        labelGlObject(GL_FRAMEBUFFER, feedbackTarget.framebuffer, "virtual texture feedback");
+    }
+
+    // Zero means "no page needed" to the decoder
+    bindOffscreenTarget(feedbackTarget);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    return true;
+}
+
+// Function to end the feedback pass: queues the readback and returns to the window's framebuffer.
+void VirtualTexture::endFeedback(long long frameIndex, int framebufferWidth, int framebufferHeight)
+{
+    if (feedbackReadback->request(0, 0, feedbackTarget.width, feedbackTarget.height, frameIndex,
+                                  [this](const ReadbackImage &image)
+                                  { decodeFeedback(image); }))
+        ++feedbackPasses;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glViewport(0, 0, framebufferWidth, framebufferHeight);
+}
+
+// Function to turn a feedback image into the sorted list of the pages it names. Runs on a worker.
+// Every pixel holds the page x and y, the level and the layer + 1 of what it samples, or zero.
+void VirtualTexture::decodeFeedback(const ReadbackImage &image)
+{
+    if (image.pixels == nullptr)
+        return;
+    std::vector<int> ids;
+    for (long long i = 0; i < (long long)image.width * image.height; ++i)
+    {
+        const unsigned char *pixel = image.pixels + i * 4;
+        if (pixel[3] == 0)
+            continue;
+        int layer = pixel[3] - 1, level = pixel[2], x = pixel[0], y = pixel[1];
+        if (layer < layers && level < pagedLevels && x < pagesX(level) && y < pagesY(level))
+            ids.push_back(pageId(layer, level, x, y));
+    }
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+
+    std::lock_guard<std::mutex> lock(feedbackMutex);
+    if (image.frameIndex > feedbackFrame) // Readbacks can finish out of order; keep the newest
+    {
+        feedbackPages = std::move(ids);
+        feedbackFrame = image.frameIndex;
+    }
+}
+
+// Function to mark a page and its ancestors as used by a feedback pass. The ancestors end up in front of
+// their children in the LRU list, so a page is never evicted before the finer pages that fall back on it.
+void VirtualTexture::touch(int id, long long frameIndex)
+{
+    int layer, level, x, y;
+    pageLocation(id, layer, level, x, y);
+    for (;;)
+    {
+        Page &page = pages[id];
+        if (page.state == PageState::Resident)
+        {
+            page.lastUsed = frameIndex;
+            unlink(id);
+            linkFront(id);
+        }
+        if (++level >= pagedLevels)
+            break;
+        x >>= 1;
+        y >>= 1;
+        id = pageId(layer, level, x, y);
+    }
+}
+
+// Function to queue a missing page. Its missing ancestors are queued before it: a page only shows once
+// every coarser level under it is resident, and the coarse pages cover more of the screen.
+void VirtualTexture::request(int id)
+{
+    int chain[32];
+    int count = 0;
+    int layer, level, x, y;
+    pageLocation(id, layer, level, x, y);
+    for (;;)
+    {
+        if (pages[id].state == PageState::Absent)
+            chain[count++] = id;
+        if (++level >= pagedLevels)
+            break;
+        x >>= 1;
+        y >>= 1;
+        id = pageId(layer, level, x, y);
+    }
+    while (count > 0)
+    {
+        int queued = chain[--count];
+        pages[queued].state = PageState::Queued;
+        queue.push_back(queued);
+    }
+}
+
+// Function to advance the paging once per frame: completes the copied batch, takes in the latest feedback,
+// starts the next batch and uploads the changed residency texels.
+void VirtualTexture::update()
+{
+    GlDebugGroup group("virtual texture");
+    feedbackReadback->poll();
+
+    if (batch && batch->jobsRunning.load() == 0)
+        finishBatch();
+
+    long long frame = -1;
+    {
+        std::lock_guard<std::mutex> lock(feedbackMutex);
+        if (feedbackFrame > lastFeedbackFrame)
+        {
+            requestedPages.swap(feedbackPages);
+            frame = feedbackFrame;
+        }
+    }
+    if (frame >= 0)
+    {
+        // The new feedback replaces the queue: pages that went off screen before their turn are not loaded
+        lastFeedbackFrame = frame;
+        for (size_t i = queueStart; i < queue.size(); ++i)
+            if (pages[queue[i]].state == PageState::Queued)
+                pages[queue[i]].state = PageState::Absent;
+        queue.clear();
+        queueStart = 0;
+        for (int id : requestedPages)
+            touch(id, frame);
+        for (int level = pagedLevels - 1; level >= 0; --level) // Coarse levels first
+            for (int id : requestedPages)
+                if (pages[id].level == level && pages[id].state == PageState::Absent)
+                    request(id);
+    }
+
+    if (!batch && queueStart < queue.size())
+        startBatch();
+
+    // Residency changes of this frame, uploaded before the draws that depend on them
+    bool uploaded = false;
+    for (int layer = 0; layer < layers; ++layer)
+    {
+        if (!dirtyLayers[layer])
+            continue;
+        if (!uploaded)
+        {
+            glBindTexture(GL_TEXTURE_2D_ARRAY, residency.name());
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            uploaded = true;
+        }
+        glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, pagesX(0), pagesY(0), 1, GL_RED_INTEGER, GL_UNSIGNED_BYTE,
+                        &residencyTexels[(size_t)layer * pagesX(0) * pagesY(0)]);
+        dirtyLayers[layer] = false;
+    }
+    if (uploaded)
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+}
+
+// Function to hand the next queued pages to the workers, which copy their blocks into the mapped staging buffer.
+void VirtualTexture::startBatch()
+{
+    std::shared_ptr<PageBatch> next = std::make_shared<PageBatch>();
+    while (queueStart < queue.size() && (int)next->pages.size() < pagesPerBatch)
+    {
+        int id = queue[queueStart++];
+        if (pages[id].state != PageState::Queued)
+            continue;
+        pages[id].state = PageState::Loading;
+        int layer, level, x, y;
+        pageLocation(id, layer, level, x, y); // The workers never read the page records the render thread updates
+        next->locations.insert(next->locations.end(), {layer, level, x, y});
+        next->offsets.push_back((long long)next->pages.size() * pageBytes);
+        next->pages.push_back(id);
+    }
+    if (next->pages.empty())
+        return;
+
+    // Invalidating lets the driver hand out fresh memory while the GPU may still read the previous batch
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, staging.name());
+    next->memory = (unsigned char *)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, pagesPerBatch * pageBytes,
+                                                     GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    if (next->memory == nullptr)
+    {
+        logError("Could not map the virtual texture staging buffer");
+        for (int id : next->pages)
+            pages[id].state = PageState::Absent;
+        return;
+    }
+
+    // One job per worker; each takes pages until none are left. The batch is complete when every job has
+    // returned, not when the last page is copied, so no job is still looking at it when it is unmapped.
+    int jobs = std::min(workers.threadCount(), (int)next->pages.size());
+    next->jobsRunning.store(jobs);
+    batch = next;
+    for (int job = 0; job < jobs; ++job)
+        workers.submit([this, next]
+                       {
+                           PageBatch &work = *next;
+                           long long blockBytes = compressedImageSize(format, 4, 4);
+                           for (int i = work.next.fetch_add(1); i < (int)work.pages.size(); i = work.next.fetch_add(1))
+                           {
+                               const int *location = &work.locations[(size_t)i * 4];
+                               int layer = location[0], level = location[1], x = location[2], y = location[3];
+                               int levelWidth = std::max(width >> level, 1);
+                               int levelHeight = std::max(height >> level, 1);
+                               int rowBlocks = (levelWidth + 3) / 4;
+                               int pageBlocksX = (std::min(pageWidth, levelWidth - x * pageWidth) + 3) / 4;
+                               int pageBlocksY = (std::min(pageHeight, levelHeight - y * pageHeight) + 3) / 4;
+                               const char *source = contents[layer].data() + images[layer].offsets[level];
+                               unsigned char *target = work.memory + work.offsets[i];
+                               for (int row = 0; row < pageBlocksY; ++row)
+                               {
+                                   long long block = (long long)(y * pageHeight / 4 + row) * rowBlocks + x * pageWidth / 4;
+                                   std::memcpy(target + row * pageBlocksX * blockBytes, source + block * blockBytes, pageBlocksX * blockBytes);
+                               }
+                           }
+                           work.jobsRunning.fetch_sub(1); // Last access to the batch and to this object
+                       });
+}
+
+// Function to commit the pages of a copied batch and fill them from the staging buffer. Pages are evicted
+// first to stay within the budget, but never ones the latest feedback needs: if all resident pages are in
+// use, the rest of the batch is dropped and requested again by a later feedback.
+void VirtualTexture::finishBatch()
+{
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, staging.name());
+    bool intact = glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER) == GL_TRUE; // False if the memory was lost, e.g. on a mode switch
+    std::shared_ptr<PageBatch> done = std::move(batch);
+
+    long long blockBytes = compressedImageSize(format, 4, 4);
+    for (size_t i = 0; i < done->pages.size(); ++i)
+    {
+        int id = done->pages[i];
+        if (!intact)
+        {
+            pages[id].state = PageState::Absent;
+            continue;
+        }
+        if (residentPages >= pageBudget && !evictOne(true))
+        {
+            pages[id].state = PageState::Absent;
+            ++requestsDropped;
+            continue;
+        }
+
+        int layer, level, x, y;
+        pageLocation(id, layer, level, x, y);
+        int pageX = x * pageWidth, pageY = y * pageHeight;
+        int regionWidth = std::min(pageWidth, std::max(width >> level, 1) - pageX);
+        int regionHeight = std::min(pageHeight, std::max(height >> level, 1) - pageY);
+        long long size = (long long)((regionWidth + 3) / 4) * ((regionHeight + 3) / 4) * blockBytes;
+        glBindTexture(GL_TEXTURE_2D_ARRAY, materials_.array.name());
+        glTexPageCommitmentARB(GL_TEXTURE_2D_ARRAY, level, pageX, pageY, layer, regionWidth, regionHeight, 1, GL_TRUE);
+        glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, pageX, pageY, layer, regionWidth, regionHeight, 1, format, (GLsizei)size,
+                                  (const void *)(uintptr_t)done->offsets[i]);
+
+        Page &page = pages[id];
+        page.state = PageState::Resident;
+        page.lastUsed = lastFeedbackFrame;
+        linkFront(id);
+        ++residentPages;
+        ++pagesLoaded;
+        updateResidency(layer, level, x, y);
+    }
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    reportMemory();
+}
+
+// Function to decommit the least recently used page.
+// keepUsed: Keep the pages the latest feedback needs; returns false instead of evicting one of them.
+bool VirtualTexture::evictOne(bool keepUsed)
+{
+    int id = lruTail;
+    if (id < 0 || (keepUsed && pages[id].lastUsed >= lastFeedbackFrame))
+        return false;
+
+    int layer, level, x, y;
+    pageLocation(id, layer, level, x, y);
+    int pageX = x * pageWidth, pageY = y * pageHeight;
+    glBindTexture(GL_TEXTURE_2D_ARRAY, materials_.array.name());
+    glTexPageCommitmentARB(GL_TEXTURE_2D_ARRAY, level, pageX, pageY, layer, std::min(pageWidth, std::max(width >> level, 1) - pageX),
+                           std::min(pageHeight, std::max(height >> level, 1) - pageY), 1, GL_FALSE);
+    unlink(id);
+    pages[id].state = PageState::Absent;
+    --residentPages;
+    ++pagesEvicted;
+    updateResidency(layer, level, x, y);
+    return true;
+}
+
+// Function to recompute the residency texels under a page that was committed or decommitted.
+// A texel holds the finest level from which every coarser level down to the pinned ones is resident.
+void VirtualTexture::updateResidency(int layer, int level, int x, int y)
+{
+    int columns = pagesX(0), rows = pagesY(0);
+    for (int row = y << level; row < std::min((y + 1) << level, rows); ++row)
+        for (int column = x << level; column < std::min((x + 1) << level, columns); ++column)
+        {
+            int finest = pagedLevels;
+            for (int l = pagedLevels - 1; l >= 0; --l)
+            {
+                int id = pageId(layer, l, std::min(column >> l, pagesX(l) - 1), std::min(row >> l, pagesY(l) - 1));
+                if (pages[id].state != PageState::Resident)
+                    break;
+                finest = l;
+            }
+            residencyTexels[((size_t)layer * rows + row) * columns + column] = (uint8_t)finest;
+        }
+    dirtyLayers[layer] = true;
+}
+
+// Function to report the committed memory of the sparse array: the pinned levels and the resident pages.
+void VirtualTexture::reportMemory()
+{
+    trackGpuAllocation(GpuResourceKind::Texture, materials_.array.name(), pinnedBytes + residentPages * pageBytes,
+                       GpuMemoryCategory::Textures, "virtual texture");
+}
+
+// Functions to maintain the LRU list of the resident pages.
+void VirtualTexture::linkFront(int id)
+{
+    Page &page = pages[id];
+    page.prev = -1;
+    page.next = lruHead;
+    if (lruHead >= 0)
+        pages[lruHead].prev = id;
+    lruHead = id;
+    if (lruTail < 0)
+        lruTail = id;
+}
+
+void VirtualTexture::unlink(int id)
+{
+    Page &page = pages[id];
+    if (page.prev >= 0)
+        pages[page.prev].next = page.next;
+    else
+        lruHead = page.next;
+    if (page.next >= 0)
+        pages[page.next].prev = page.prev;
+    else
+        lruTail = page.prev;
+    page.prev = page.next = -1;
+}
+
+// Function to print the paging statistics of the session.
+void VirtualTexture::printSummary(std::ostream &out) const
+{
+    out << "Virtual texture: " << residentPages << " of " << pages.size() << " pages resident (budget " << pageBudget << "), "
+        << pagesLoaded << " loaded, " << pagesEvicted << " evicted, " << requestsDropped << " dropped over budget, "
+        << feedbackPasses << " feedback passes, " << (pinnedBytes + residentPages * pageBytes) / 1024 << " KiB committed" << std::endl;
+}
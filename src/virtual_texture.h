@@ -0,0 +1,155 @@
+#ifndef VIRTUAL_TEXTURE_H
+#define VIRTUAL_TEXTURE_H
+
+// Sparse virtual texturing of the pyramid materials, for texture sets larger than the GPU memory.
+// The material array is created with ARB_sparse_texture: its storage is reserved but only the pages (64 KiB
+// tiles of one mipmap level of one layer) that were committed take memory. The coarse levels that are
+// smaller than a page are committed once and stay resident; the finer ones are paged in and out:
+// - every few frames a feedback pass draws the scene into a small target with a program that writes, per
+//   pixel, the page it would sample. The image comes back through a FrameReadback and a worker decodes it
+//   into a sorted list of page ids without stalling the render thread;
+// - update() marks the listed pages as used and queues the missing ones, coarse levels first, and each
+//   batch of queued pages is copied by the workers from the compressed files in memory into a mapped pixel
+//   unpack buffer;
+// - once a batch is complete, the least recently used pages are decommitted to stay within the page
+//   budget, and the new pages are committed and filled from the buffer by the GPU.
+// A residency texture holds, per finest-level page of every layer, the finest level that is resident there.
+// The shading program never samples below it, so a missing page shows as a blurrier image, not as garbage.
+// All functions must be called on the thread that owns the OpenGL context.
+#include "glad.h"         // GLenum and the OpenGL function pointers.
+#include "gl_objects.h"   // Owners of the textures and the staging buffer.
+#include "offscreen.h"    // The feedback target.
+#include "readback.h"     // Reading the feedback back.
+#include "scene.h"        // PyramidMaterials.
+#include "texture_file.h" // Compressed texture files.
+#include "worker_pool.h"  // Feedback decoding and page copies.
+#include <atomic>         // Page copy progress.
+#include <cstdint>        // Residency values.
+#include <memory>         // Owns the readback and shares the page batches with their jobs.
+#include <mutex>          // Protects the feedback result.
+#include <ostream>        // Summary output.
+#include <string>         // File paths and contents.
+#include <vector>         // Page records and queues.
+
+class VirtualTexture
+{
+public:
+    // Reads the compressed files (texture_file.h, one layer each, all of the same format, size and levels)
+    // and creates the sparse array. pageBudget: most pages of the paged levels resident at once.
+    // Logs the reason and stays invalid if the context has no sparse textures or the files do not fit.
+    VirtualTexture(const std::vector<std::string> &paths, int pageBudget, WorkerPool &workers);
+    ~VirtualTexture(); // Waits for the page copies and readbacks in flight. Needs the GL context current.
+
+    VirtualTexture(const VirtualTexture &) = delete;
+    VirtualTexture &operator=(const VirtualTexture &) = delete;
+
+    bool valid() const { return materials_.layerCount > 0; }
+    const PyramidMaterials &materials() const { return materials_; } // The sparse array, for drawPyramids.
+
+    // Sets the residency texture and paging uniforms of a program built with VIRTUAL_TEXTURE defined.
+    // feedback: the program also has VIRTUAL_TEXTURE_FEEDBACK and draws into the feedback target.
+    void bindUniforms(unsigned int program, bool feedback) const;
+
+    // Feedback pass. beginFeedback binds and clears the feedback target if a pass is due in this frame and
+    // returns false otherwise; after drawing the scene, endFeedback queues the readback and rebinds the
+    // default framebuffer with a viewport of framebufferWidth x framebufferHeight.
+    bool beginFeedback(long long frameIndex, int framebufferWidth, int framebufferHeight);
+    void endFeedback(long long frameIndex, int framebufferWidth, int framebufferHeight);
+
+    void update(); // Once per frame before drawing: finishes, evicts and starts page uploads.
+    void printSummary(std::ostream &out) const;
+
+private:
+    enum class PageState : uint8_t
+    {
+        Absent,   // Not committed.
+        Queued,   // Requested by the feedback, waiting for a batch.
+        Loading,  // Being copied into the staging buffer.
+        Resident  // Committed and filled.
+    };
+
+    // One page of a paged level. Resident pages are linked into the LRU list, most recent first.
+    struct Page
+    {
+        int prev = -1;
+        int next = -1;
+        long long lastUsed = -1; // Frame of the last feedback pass that needed the page.
+        PageState state = PageState::Absent;
+        uint8_t level = 0;
+    };
+
+    // Page geometry.
+    int pagesX(int level) const;
+    int pagesY(int level) const;
+    int pageId(int layer, int level, int x, int y) const;
+    void pageLocation(int id, int &layer, int &level, int &x, int &y) const;
+
+    bool createTextures();
+    void decodeFeedback(const ReadbackImage &image); // On a worker: the page ids of a feedback image.
+    void touch(int id, long long frameIndex);        // Marks a page and its coarser ancestors as used.
+    void request(int id);                            // Queues a page and its missing ancestors.
+    void startBatch();                               // Maps the staging buffer and hands the next pages to the workers.
+    void finishBatch();                              // Commits and fills the pages of a copied batch.
+    bool evictOne(bool keepUsed);                    // Decommits the least recently used page; false if none may go.
+    void updateResidency(int layer, int level, int x, int y); // Recomputes the residency texels under a page.
+    void reportMemory();
+    void linkFront(int id);
+    void unlink(int id);
+
+    WorkerPool &workers;
+    std::vector<std::string> contents; // The compressed files, one per layer: the backing store of the pages.
+    std::vector<TextureImage> images;
+    PyramidMaterials materials_;
+    UniqueTexture residency;           // GL_R8UI array, one texel per finest-level page.
+    UniqueBuffer staging;              // Pixel unpack buffer the pages are copied through.
+    std::vector<uint8_t> residencyTexels;
+    std::vector<bool> dirtyLayers;     // Layers of the residency texture to upload.
+
+    GLenum format = 0;
+    int width = 0, height = 0, levels = 0, layers = 0;
+    int pageWidth = 0, pageHeight = 0;
+    long long pageBytes = 0;         // Size of a full page; edge pages are committed whole as well.
+    int pagedLevels = 0;             // Levels below this one are paged; it and the coarser ones are pinned.
+    long long pinnedBytes = 0;
+    std::vector<int> levelBase;      // First page id of every paged level within a layer.
+    int pagesPerLayer = 0;
+    int pageBudget = 0;
+    int pagesPerBatch = 0;
+
+    std::vector<Page> pages;
+    int lruHead = -1, lruTail = -1;
+    int residentPages = 0;
+    std::vector<int> queue;          // Requested pages, in the order they are loaded.
+    size_t queueStart = 0;           // Pages before it have been handed to a batch.
+
+    // Batch of pages being copied into the staging buffer by the workers. Every batch has its own state,
+    // shared with its jobs, so a job that is still leaving never sees the members of the next batch.
+    struct PageBatch
+    {
+        std::vector<int> pages;
+        std::vector<int> locations;        // Layer, level, x and y of every page, found on the render thread.
+        std::vector<long long> offsets;    // Offset of every page in the staging buffer.
+        unsigned char *memory = nullptr;   // Mapped staging buffer.
+        std::atomic<int> next{0};          // Next page of the batch a job takes.
+        std::atomic<int> jobsRunning{0};   // Jobs not finished yet; the last one to finish completes the batch.
+    };
+    std::shared_ptr<PageBatch> batch;      // Null when no batch is in flight.
+
+    // Feedback
+    OffscreenTarget feedbackTarget;
+    std::unique_ptr<FrameReadback> feedbackReadback;
+    std::mutex feedbackMutex;
+    std::vector<int> feedbackPages;    // Latest decoded feedback, guarded by feedbackMutex.
+    long long feedbackFrame = -1;      // Frame the latest feedback was drawn in, guarded by feedbackMutex.
+    std::vector<int> requestedPages;   // Render thread copy of the feedback being processed.
+    long long lastFeedbackFrame = -1;  // Frame of the feedback processed last.
+
+    // Statistics
+    long long pagesLoaded = 0;
+    long long pagesEvicted = 0;
+    long long requestsDropped = 0;     // Pages not loaded because every resident page was in use.
+    long long feedbackPasses = 0;
+    int evictionHandler = 0;
+};
+
+#endif
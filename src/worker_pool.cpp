@@ -0,0 +1,67 @@
+#include "worker_pool.h"
+#include "memory_arena.h" // Scratch memory of the jobs.
+
+// Constructor: starts the worker threads.
+// threadCount: Number of threads; values below one still start a single worker.
+WorkerPool::WorkerPool(int threadCount)
+{
+    if (threadCount < 1)
+        threadCount = 1;
+    for (int i = 0; i < threadCount; ++i)
+        threads.emplace_back(&WorkerPool::workerMain, this);
+}
+
+// Destructor: lets the workers drain the queue, then joins them.
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    jobAvailable.notify_all();
+    for (std::thread &thread : threads)
+        thread.join();
+}
+
+// Function to queue a job for the workers.
+void WorkerPool::submit(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(std::move(job));
+    }
+    jobAvailable.notify_one();
+}
+
+// Function to wait until the queue is empty and no job is running.
+void WorkerPool::waitIdle()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return jobs.empty() && runningJobs == 0; });
+}
+
+// Loop run by every worker: take the oldest job, run it without holding the lock, repeat.
+// Exits once the pool is stopping and no job is left.
+void WorkerPool::workerMain()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;)
+    {
+        jobAvailable.wait(lock, [this] { return stopping || !jobs.empty(); });
+        if (jobs.empty())
+            return; // Only reached when stopping.
+
+        std::function<void()> job = std::move(jobs.front());
+        jobs.pop_front();
+        ++runningJobs;
+
+        lock.unlock();
+        job();
+        threadArena().reset(); // Whatever the job took from the thread arena is released
+        lock.lock();
+
+        --runningJobs;
+        if (jobs.empty() && runningJobs == 0)
+            idle.notify_all();
+    }
+}
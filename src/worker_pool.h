@@ -0,0 +1,38 @@
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+// A fixed set of background threads that run jobs submitted from any thread.
+// Used for the work that must stay off the render thread, such as converting and encoding captured pixels.
+#include <condition_variable> // Wakes the workers when jobs arrive.
+#include <deque>              // Queue of pending jobs.
+#include <functional>         // std::function holds the submitted jobs.
+#include <mutex>              // Protects the job queue.
+#include <thread>             // The worker threads.
+#include <vector>             // Storage for the worker threads.
+
+class WorkerPool
+{
+public:
+    explicit WorkerPool(int threadCount); // Starts the given number of worker threads (at least one).
+    ~WorkerPool();                        // Finishes the queued jobs and joins the workers.
+
+    WorkerPool(const WorkerPool &) = delete;
+    WorkerPool &operator=(const WorkerPool &) = delete;
+
+    void submit(std::function<void()> job); // Queues a job; it runs on one of the worker threads.
+    void waitIdle();                        // Blocks until every submitted job has finished.
+    int threadCount() const { return (int)threads.size(); }
+
+private:
+    void workerMain(); // Loop run by every worker thread.
+
+    std::vector<std::thread> threads;
+    std::deque<std::function<void()>> jobs;
+    std::mutex mutex;
+    std::condition_variable jobAvailable; // Signalled when a job is queued or the pool shuts down.
+    std::condition_variable idle;         // Signalled when the last running job finishes.
+    int runningJobs = 0;
+    bool stopping = false;
+};
+
+#endif
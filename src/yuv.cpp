@@ -0,0 +1,124 @@
+#include "yuv.h"
+#include <cstring> // memcpy, stores four chroma bytes without alignment requirements.
+#if defined(__SSE2__)
+#include <emmintrin.h> // SSE2 intrinsics, available on every x86-64 compiler.
+#endif
+
+// BT.601 limited range coefficients in 8.8 fixed point:
+// Y = (( 66 R + 129 G +  25 B + 128) >> 8) +  16
+// U = ((-38 R -  74 G + 112 B + 128) >> 8) + 128
+// V = ((112 R -  94 G -  18 B + 128) >> 8) + 128
+
+// Function to compute the luma of one pixel.
+static inline unsigned char lumaOf(const unsigned char *p)
+{
+    return (unsigned char)(((66 * p[0] + 129 * p[1] + 25 * p[2] + 128) >> 8) + 16);
+}
+
+// Function to compute the chroma of one 2x2 block.
+// top and bottom point to the left pixel of the block in its two rows.
+static inline void chromaOf(const unsigned char *top, const unsigned char *bottom, unsigned char *u, unsigned char *v)
+{
+    int r = (top[0] + top[4] + bottom[0] + bottom[4] + 2) >> 2;
+    int g = (top[1] + top[5] + bottom[1] + bottom[5] + 2) >> 2;
+    int b = (top[2] + top[6] + bottom[2] + bottom[6] + 2) >> 2;
+    *u = (unsigned char)(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+    *v = (unsigned char)(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+}
+
+#if defined(__SSE2__)
+// Function to apply a coefficient vector to four RGBA pixels.
+// Returns coefficient . (R, G, B, A) for each pixel as four 32-bit integers.
+static inline __m128i weightPixels(__m128i pixels, __m128i coefficients)
+{
+    __m128i zero = _mm_setzero_si128();
+    // Widen to 16 bits; pmaddwd then sums R*cr + G*cg and B*cb + A*0 per pixel.
+    __m128i low = _mm_madd_epi16(_mm_unpacklo_epi8(pixels, zero), coefficients);  // Pixels 0 and 1.
+    __m128i high = _mm_madd_epi16(_mm_unpackhi_epi8(pixels, zero), coefficients); // Pixels 2 and 3.
+    // Add the two partial sums of each pixel: even lanes plus odd lanes.
+    __m128 evens = _mm_shuffle_ps(_mm_castsi128_ps(low), _mm_castsi128_ps(high), _MM_SHUFFLE(2, 0, 2, 0));
+    __m128 odds = _mm_shuffle_ps(_mm_castsi128_ps(low), _mm_castsi128_ps(high), _MM_SHUFFLE(3, 1, 3, 1));
+    return _mm_add_epi32(_mm_castps_si128(evens), _mm_castps_si128(odds));
+}
+
+// Function to round, shift and offset eight 32-bit sums into eight bytes.
+static inline __m128i finishSamples(__m128i first, __m128i second, __m128i offset)
+{
+    __m128i rounding = _mm_set1_epi32(128);
+    first = _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(first, rounding), 8), offset);
+    second = _mm_add_epi32(_mm_srai_epi32(_mm_add_epi32(second, rounding), 8), offset);
+    __m128i words = _mm_packs_epi32(first, second);
+    return _mm_packus_epi16(words, words);
+}
+
+// Function to average the 2x2 blocks of four pixel pairs.
+// top and bottom hold pixels 0-3 of the two rows; returns blocks (0,1) and (2,3) in lanes 0 and 2.
+static inline __m128i averageBlocks(__m128i top, __m128i bottom)
+{
+    __m128i vertical = _mm_avg_epu8(top, bottom);
+    return _mm_avg_epu8(vertical, _mm_shuffle_epi32(vertical, _MM_SHUFFLE(2, 3, 0, 1)));
+}
+#endif
+
+// Function to convert a frame to YUV 4:2:0.
+// Each chroma row c covers the output luma rows 2c and 2c + 1, which are the source rows
+// height - 1 - 2c and height - 2 - 2c because OpenGL stores the bottom row first.
+void convertRgbaToYuv420(const unsigned char *rgbaPixels, int width, int height,
+                         unsigned char *yPlane, unsigned char *uPlane, unsigned char *vPlane)
+{
+    int chromaWidth = width / 2;
+    for (int c = 0; c < height / 2; ++c)
+    {
+        const unsigned char *top = rgbaPixels + (size_t)(height - 1 - 2 * c) * width * 4;
+        const unsigned char *bottom = rgbaPixels + (size_t)(height - 2 - 2 * c) * width * 4;
+        unsigned char *yTop = yPlane + (size_t)(2 * c) * width;
+        unsigned char *yBottom = yTop + width;
+        unsigned char *u = uPlane + (size_t)c * chromaWidth;
+        unsigned char *v = vPlane + (size_t)c * chromaWidth;
+
+        int x = 0;
+#if defined(__SSE2__)
+        const __m128i lumaWeights = _mm_setr_epi16(66, 129, 25, 0, 66, 129, 25, 0);
+        const __m128i uWeights = _mm_setr_epi16(-38, -74, 112, 0, -38, -74, 112, 0);
+        const __m128i vWeights = _mm_setr_epi16(112, -94, -18, 0, 112, -94, -18, 0);
+        const __m128i lumaOffset = _mm_set1_epi32(16);
+        const __m128i chromaOffset = _mm_set1_epi32(128);
+
+        // Eight pixels of both rows per iteration: 16 luma samples and 4 samples of each chroma plane.
+        for (; x + 8 <= width; x += 8)
+        {
+            __m128i top0 = _mm_loadu_si128((const __m128i *)(top + x * 4));
+            __m128i top1 = _mm_loadu_si128((const __m128i *)(top + x * 4 + 16));
+            __m128i bottom0 = _mm_loadu_si128((const __m128i *)(bottom + x * 4));
+            __m128i bottom1 = _mm_loadu_si128((const __m128i *)(bottom + x * 4 + 16));
+
+            _mm_storel_epi64((__m128i *)(yTop + x),
+                             finishSamples(weightPixels(top0, lumaWeights), weightPixels(top1, lumaWeights), lumaOffset));
+            _mm_storel_epi64((__m128i *)(yBottom + x),
+                             finishSamples(weightPixels(bottom0, lumaWeights), weightPixels(bottom1, lumaWeights), lumaOffset));
+
+            // Gather the four block averages (lanes 0 and 2 of each half) into one register.
+            __m128i blocks0 = averageBlocks(top0, bottom0);
+            __m128i blocks1 = averageBlocks(top1, bottom1);
+            __m128i blocks = _mm_castps_si128(_mm_shuffle_ps(_mm_castsi128_ps(blocks0), _mm_castsi128_ps(blocks1),
+                                                             _MM_SHUFFLE(2, 0, 2, 0)));
+
+            __m128i uWeighted = weightPixels(blocks, uWeights);
+            __m128i vWeighted = weightPixels(blocks, vWeights);
+            int uBytes = _mm_cvtsi128_si32(finishSamples(uWeighted, uWeighted, chromaOffset));
+            int vBytes = _mm_cvtsi128_si32(finishSamples(vWeighted, vWeighted, chromaOffset));
+            std::memcpy(u + x / 2, &uBytes, 4);
+            std::memcpy(v + x / 2, &vBytes, 4);
+        }
+#endif
+        // Remaining pixels (and the whole row without SSE2).
+        for (; x < width; x += 2)
+        {
+            yTop[x] = lumaOf(top + x * 4);
+            yTop[x + 1] = lumaOf(top + x * 4 + 4);
+            yBottom[x] = lumaOf(bottom + x * 4);
+            yBottom[x + 1] = lumaOf(bottom + x * 4 + 4);
+            chromaOf(top + x * 4, bottom + x * 4, u + x / 2, v + x / 2);
+        }
+    }
+}
@@ -0,0 +1,11 @@
+#ifndef YUV_H
+#define YUV_H
+
+// RGBA to planar YUV 4:2:0 conversion (BT.601, limited range) for video capture.
+
+// Converts RGBA8 pixels read from OpenGL (bottom row first) to top-first Y, U and V planes.
+// width and height must be even. yPlane holds width * height bytes, uPlane and vPlane (width / 2) * (height / 2) bytes each.
+void convertRgbaToYuv420(const unsigned char *rgbaPixels, int width, int height,
+                         unsigned char *yPlane, unsigned char *uPlane, unsigned char *vPlane);
+
+#endif